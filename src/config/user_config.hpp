@@ -847,6 +847,10 @@ namespace UserConfigParams
         PARAM_DEFAULT(IntUserConfigParam(0, "default-ip-type",
         &m_network_group, "Default IP type of this machine, "
         "0 detect every time, 1 IPv4, 2 IPv6, 3 IPv6 NAT64, 4 Dual stack."));
+    PARAM_PREFIX BoolUserConfigParam m_partial_rewind
+        PARAM_DEFAULT(BoolUserConfigParam(true, "partial-rewind",
+        &m_network_group, "Only simulate the karts affected by a "
+        "misprediction again when rewinding to a server state."));
 
     // ---- Gamemode setup
     PARAM_PREFIX UIntToUIntUserConfigParam m_num_karts_per_gamemode
@@ -1053,6 +1057,20 @@ namespace UserConfigParams
                                                "wasn't asked, 1: allowed, 2: "
                                                "not allowed") );
 
+    PARAM_PREFIX IntUserConfigParam        m_http_max_connections
+            PARAM_DEFAULT(  IntUserConfigParam(4, "http_max_connections",
+                                               "Number of online requests "
+                                               "executed at the same time, "
+                                               "connections to a server are "
+                                               "reused between requests.") );
+
+    PARAM_PREFIX IntUserConfigParam        m_http_request_timeout
+            PARAM_DEFAULT(  IntUserConfigParam(60, "http_request_timeout",
+                                               "Time in seconds after which "
+                                               "an online request (except "
+                                               "downloads) is aborted, 0 for "
+                                               "no limit.") );
+
     PARAM_PREFIX GroupUserConfigParam       m_hw_report_group
             PARAM_DEFAULT( GroupUserConfigParam("HWReport",
                                           "Everything related to hardware configuration.") );
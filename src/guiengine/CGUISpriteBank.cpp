@@ -62,29 +62,46 @@ core::array< core::rect<s32> >& STKModifiedSpriteBank::getPositions()
     //       item xD but I have no choice, short of re-implementing
     //       IGUIListBox too
 
-    for (int n=0; n<(int)Rectangles.size(); n++)
-    {
-        float icon_scale_x = 1.0f;
-        float icon_scale_y = 1.0f;
-        
-        if (m_target_icon_size.Width > 0 && m_target_icon_size.Height > 0)
-        {
-            icon_scale_x = (float)m_target_icon_size.Width /
-                           (float)Rectangles[n].getWidth();
-            icon_scale_y = (float)m_target_icon_size.Height /
-                           (float)Rectangles[n].getHeight();
-        }
- 
-        const int h = getScaledHeight(Rectangles[n].getHeight()) * icon_scale_y;
-        const int w = getScaledWidth(Rectangles[n].getWidth()) * icon_scale_x;
-        copy.push_back( core::rect<s32>(Rectangles[n].UpperLeftCorner,
-                                       core::dimension2d<s32>(w,h) )
-                       );
-    }
+    for (u32 n=0; n<Rectangles.size(); n++)
+        copy.push_back(getScaledPosition(n));
 
     return copy;
 }   // getPositions
 
+// ----------------------------------------------------------------------------
+core::rect<s32> STKModifiedSpriteBank::getScaledPosition(u32 index) const
+{
+    float icon_scale_x = 1.0f;
+    float icon_scale_y = 1.0f;
+
+    if (m_target_icon_size.Width > 0 && m_target_icon_size.Height > 0)
+    {
+        icon_scale_x = (float)m_target_icon_size.Width /
+                       (float)Rectangles[index].getWidth();
+        icon_scale_y = (float)m_target_icon_size.Height /
+                       (float)Rectangles[index].getHeight();
+    }
+
+    const int h = getScaledHeight(Rectangles[index].getHeight()) * icon_scale_y;
+    const int w = getScaledWidth(Rectangles[index].getWidth()) * icon_scale_x;
+    return core::rect<s32>(Rectangles[index].UpperLeftCorner,
+                           core::dimension2d<s32>(w,h));
+}   // getScaledPosition
+
+// ----------------------------------------------------------------------------
+/** Changes an unscaled rectangle, the scaled copy returned by getPositions()
+ *  is updated too.
+ */
+void STKModifiedSpriteBank::setPosition(u32 index,
+                                        const core::rect<s32>& rect)
+{
+    assert( m_magic_number == 0xCAFEC001 );
+    assert(index < Rectangles.size());
+    Rectangles[index] = rect;
+    if (index < copy.size())
+        copy[index] = getScaledPosition(index);
+}   // setPosition
+
 // ----------------------------------------------------------------------------
 core::array< SGUISprite >& STKModifiedSpriteBank::getSprites()
 {
@@ -38,6 +38,10 @@ public:
     virtual core::array< core::rect<s32> >& getPositions();
     virtual core::array< SGUISprite >& getSprites();
 
+    //! Changes an unscaled rectangle, e.g. when the texture of a sprite is
+    //! replaced by one of another size
+    void setPosition(u32 index, const core::rect<s32>& rect);
+
     virtual u32 getTextureCount() const;
     virtual video::ITexture* getTexture(u32 index) const;
     virtual void addTexture(video::ITexture* texture);
@@ -100,6 +104,7 @@ protected:
 
     s32 getScaledWidth(s32 width) const;
     s32 getScaledHeight(s32 height) const;
+    core::rect<s32> getScaledPosition(u32 index) const;
 };
 
 } // end namespace gui
@@ -0,0 +1,276 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "guiengine/thumbnail_cache.hpp"
+
+#include "graphics/irr_driver.hpp"
+#include "graphics/stk_tex_manager.hpp"
+#include "graphics/stk_texture.hpp"
+#include "guiengine/CGUISpriteBank.hpp"
+#include "utils/log.hpp"
+#include "utils/vs.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace irr;
+
+namespace GUIEngine
+{
+// ----------------------------------------------------------------------------
+/** Creates the cache and starts its worker thread.
+ *  \param bank The sprite bank the icons are added to.
+ *  \param placeholder_sprite Sprite returned while an icon is not loaded.
+ *  \param max_bytes Size of the loaded images kept before the least
+ *         recently used ones are evicted.
+ *  \param max_size Larger images are scaled down to this width or height.
+ */
+ThumbnailCache::ThumbnailCache(gui::STKModifiedSpriteBank* bank,
+                               int placeholder_sprite, size_t max_bytes,
+                               unsigned max_size)
+              : m_bank(bank), m_placeholder_sprite(placeholder_sprite),
+                m_max_bytes(max_bytes), m_total_bytes(0),
+                m_max_size(max_size), m_frame(0)
+{
+    assert(placeholder_sprite >= 0 &&
+           (u32)placeholder_sprite < m_bank->getSprites().size());
+    m_placeholder_texture = m_bank->getTexture(
+        m_bank->getSprites()[placeholder_sprite].Frames[0].textureNumber);
+    m_stop.store(false);
+    m_worker = std::thread([this]()
+        {
+            VS::setThreadName("ThumbnailCache");
+            workerLoop();
+        });
+}   // ThumbnailCache
+
+// ----------------------------------------------------------------------------
+/** Stops the worker thread and removes all loaded icons (their sprites show
+ *  the placeholder afterwards).
+ */
+ThumbnailCache::~ThumbnailCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop.store(true);
+    }
+    m_cv.notify_one();
+    m_worker.join();
+
+    for (auto& d : m_decoded)
+    {
+        if (d.second)
+            d.second->drop();
+    }
+    for (auto& e : m_entries)
+    {
+        setSpriteTexture(e.second.m_sprite, m_placeholder_texture);
+        irr_driver->removeTexture(e.second.m_texture);
+    }
+}   // ~ThumbnailCache
+
+// ----------------------------------------------------------------------------
+void ThumbnailCache::workerLoop()
+{
+    while (true)
+    {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]()
+                { return m_stop.load() || !m_pending.empty(); });
+            if (m_stop.load())
+                return;
+            path = m_pending.back();
+            m_pending.pop_back();
+            m_decoding = path;
+        }
+        video::IImage* image = decode(path);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_decoding.clear();
+            m_decoded.emplace_back(path, image);
+        }
+    }
+}   // workerLoop
+
+// ----------------------------------------------------------------------------
+/** Loads an image file in the worker thread, scaled down so that it is at
+ *  most m_max_size pixels wide and high.
+ *  \return The image, or NULL if it can't be loaded.
+ */
+video::IImage* ThumbnailCache::decode(const std::string& path) const
+{
+    video::IVideoDriver* driver = irr_driver->getVideoDriver();
+    video::IImageLoader* loader =
+        driver->getImageLoaderForFile(path.c_str());
+    io::IReadFile* file = loader ? io::createReadFile(path.c_str()) : NULL;
+    video::IImage* image = file ? loader->loadImage(file) : NULL;
+    if (file)
+        file->drop();
+    if (image == NULL || image->getDimension().Width == 0 ||
+        image->getDimension().Height == 0)
+    {
+        Log::warn("ThumbnailCache", "Failed to load image %s", path.c_str());
+        if (image)
+            image->drop();
+        return NULL;
+    }
+
+    const core::dimension2du& dim = image->getDimension();
+    const unsigned longest = std::max(dim.Width, dim.Height);
+    if (longest <= m_max_size)
+        return image;
+
+    core::dimension2du size(
+        std::max(1u, dim.Width  * m_max_size / longest),
+        std::max(1u, dim.Height * m_max_size / longest));
+    video::IImage* scaled = driver->createImage(video::ECF_A8R8G8B8, size);
+    image->copyToScalingBoxFilter(scaled);
+    image->drop();
+    return scaled;
+}   // decode
+
+// ----------------------------------------------------------------------------
+void ThumbnailCache::setSpriteTexture(int sprite, video::ITexture* texture)
+{
+    const gui::SGUISpriteFrame& frame =
+        m_bank->getSprites()[sprite].Frames[0];
+    m_bank->setTexture(frame.textureNumber, texture);
+    m_bank->setPosition(frame.rectNumber,
+        core::rect<s32>(0, 0, texture->getSize().Width,
+                        texture->getSize().Height));
+}   // setSpriteTexture
+
+// ----------------------------------------------------------------------------
+/** Uploads a decoded image and adds it as an icon, in the sprite of an
+ *  evicted icon if possible.
+ */
+void ThumbnailCache::addIcon(const std::string& path, video::IImage* image)
+{
+    const core::dimension2du& dim = image->getDimension();
+    Entry entry;
+    entry.m_bytes = (size_t)dim.Width * dim.Height * 4;
+    entry.m_last_used = m_frame;
+    // The texture takes ownership of the image
+    entry.m_texture = STKTexManager::getInstance()->addTexture(
+        new STKTexture(image, path + "_thumbnail"));
+    if (m_free_sprites.empty())
+    {
+        entry.m_sprite = m_bank->addTextureAsSprite(entry.m_texture);
+    }
+    else
+    {
+        entry.m_sprite = m_free_sprites.back();
+        m_free_sprites.pop_back();
+        setSpriteTexture(entry.m_sprite, entry.m_texture);
+    }
+    m_lru.push_front(path);
+    entry.m_lru = m_lru.begin();
+    m_entries[path] = entry;
+    m_total_bytes += entry.m_bytes;
+    evict();
+}   // addIcon
+
+// ----------------------------------------------------------------------------
+/** Removes the least recently used icons until the cache fits into its
+ *  limit, or only icons used since the last update() are left.
+ */
+void ThumbnailCache::evict()
+{
+    while (m_total_bytes > m_max_bytes && !m_lru.empty())
+    {
+        auto it = m_entries.find(m_lru.back());
+        assert(it != m_entries.end());
+        Entry& e = it->second;
+        if (e.m_last_used == m_frame)
+            break;
+        setSpriteTexture(e.m_sprite, m_placeholder_texture);
+        m_free_sprites.push_back(e.m_sprite);
+        irr_driver->removeTexture(e.m_texture);
+        m_total_bytes -= e.m_bytes;
+        m_lru.pop_back();
+        m_entries.erase(it);
+    }
+}   // evict
+
+// ----------------------------------------------------------------------------
+/** Returns the sprite of an image file. If it is not loaded yet, it is
+ *  requested from the worker thread in the next update() and the
+ *  placeholder is returned.
+ */
+int ThumbnailCache::getIcon(const std::string& path)
+{
+    auto it = m_entries.find(path);
+    if (it != m_entries.end())
+    {
+        it->second.m_last_used = m_frame;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.m_lru);
+        return it->second.m_sprite;
+    }
+    if (m_failed.find(path) == m_failed.end())
+        m_wanted.push_back(path);
+    return m_placeholder_sprite;
+}   // getIcon
+
+// ----------------------------------------------------------------------------
+/** Replaces the requests for the worker thread with the icons asked for
+ *  since the last call (icons no longer displayed are not loaded), and adds
+ *  the images decoded in the meantime.
+ */
+void ThumbnailCache::update()
+{
+    std::vector<std::pair<std::string, video::IImage*> > decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        decoded.swap(m_decoded);
+        m_pending.clear();
+        std::set<std::string> skip;
+        skip.insert(m_decoding);
+        for (auto& d : decoded)
+            skip.insert(d.first);
+        for (const std::string& path : m_wanted)
+        {
+            if (skip.insert(path).second)
+                m_pending.push_back(path);
+        }
+        // The worker takes the last one, so the first request is decoded
+        // first
+        std::reverse(m_pending.begin(), m_pending.end());
+    }
+    m_wanted.clear();
+    m_cv.notify_one();
+
+    for (auto& d : decoded)
+    {
+        if (d.second == NULL)
+        {
+            m_failed.insert(d.first);
+            continue;
+        }
+        if (m_entries.find(d.first) != m_entries.end())
+        {
+            d.second->drop();
+            continue;
+        }
+        addIcon(d.first, d.second);
+    }
+    m_frame++;
+}   // update
+
+}   // namespace GUIEngine
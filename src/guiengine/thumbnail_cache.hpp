@@ -0,0 +1,137 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_THUMBNAIL_CACHE_HPP
+#define HEADER_THUMBNAIL_CACHE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace irr
+{
+    namespace gui { class STKModifiedSpriteBank; }
+    namespace video { class IImage; class ITexture; }
+}
+
+namespace GUIEngine
+{
+    /** \ingroup guiengine
+     *  Loads image files as icons of a sprite bank on demand. Images are
+     *  decoded and scaled down by a background thread, only the texture
+     *  upload happens in the main thread in update(). Until an image is
+     *  available (or if it can't be loaded) the placeholder sprite is used.
+     *  The loaded icons are kept in a least recently used cache limited by
+     *  the size of their images, icons requested since the last update()
+     *  are never evicted. The sprite of an evicted icon shows the
+     *  placeholder and is reused for the next loaded icon, so users must ask
+     *  again for the icons they display after each update().
+     */
+    class ThumbnailCache : public NoCopy
+    {
+    private:
+        struct Entry
+        {
+            irr::video::ITexture* m_texture;
+            int m_sprite;
+            size_t m_bytes;
+            unsigned m_last_used;
+            std::list<std::string>::iterator m_lru;
+        };
+        std::map<std::string, Entry> m_entries;
+
+        /** Paths of the entries, most recently used first. */
+        std::list<std::string> m_lru;
+
+        irr::gui::STKModifiedSpriteBank* m_bank;
+
+        irr::video::ITexture* m_placeholder_texture;
+
+        int m_placeholder_sprite;
+
+        /** Sprites of evicted icons which can be reused. */
+        std::vector<int> m_free_sprites;
+
+        /** Images which failed to load, not requested again. */
+        std::set<std::string> m_failed;
+
+        /** Paths requested since the last update(), in request order. */
+        std::vector<std::string> m_wanted;
+
+        size_t m_max_bytes;
+
+        size_t m_total_bytes;
+
+        unsigned m_max_size;
+
+        unsigned m_frame;
+
+        /** Paths to be decoded by the worker thread, taken from the back. */
+        std::vector<std::string> m_pending;
+
+        /** Path the worker thread is decoding. */
+        std::string m_decoding;
+
+        /** Decoded images not uploaded yet, NULL if loading failed. */
+        std::vector<std::pair<std::string, irr::video::IImage*> > m_decoded;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_cv;
+
+        std::atomic_bool m_stop;
+
+        std::thread m_worker;
+
+        // --------------------------------------------------------------------
+        void workerLoop();
+        // --------------------------------------------------------------------
+        irr::video::IImage* decode(const std::string& path) const;
+        // --------------------------------------------------------------------
+        void setSpriteTexture(int sprite, irr::video::ITexture* texture);
+        // --------------------------------------------------------------------
+        void addIcon(const std::string& path, irr::video::IImage* image);
+        // --------------------------------------------------------------------
+        void evict();
+
+    public:
+        ThumbnailCache(irr::gui::STKModifiedSpriteBank* bank,
+                       int placeholder_sprite, size_t max_bytes,
+                       unsigned max_size);
+        // --------------------------------------------------------------------
+        ~ThumbnailCache();
+        // --------------------------------------------------------------------
+        int getIcon(const std::string& path);
+        // --------------------------------------------------------------------
+        void update();
+        // --------------------------------------------------------------------
+        int getPlaceholder() const             { return m_placeholder_sprite; }
+
+    };   // class ThumbnailCache
+}
+
+#endif
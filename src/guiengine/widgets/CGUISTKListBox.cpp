@@ -147,6 +147,20 @@ s32 CGUISTKListBox::getItemAt(s32 xpos, s32 ypos) const
     return item;
 }
 
+
+void CGUISTKListBox::getVisibleItems(s32* first, s32* last) const
+{
+    *first = 0;
+    *last = -1;
+    if (ItemHeight == 0 || Items.empty())
+        return;
+
+    const s32 pos = ScrollBar ? ScrollBar->getPos() : 0;
+    *first = core::max_(0, (pos - 1) / ItemHeight);
+    *last = core::min_((s32)Items.size() - 1,
+                       (pos + AbsoluteRect.getHeight()) / ItemHeight);
+}
+
 //! clears the list
 void CGUISTKListBox::clear()
 {
@@ -122,6 +122,10 @@ namespace irr
             //! get the the id of the item at the given absolute coordinates
             virtual s32 getItemAt(s32 xpos, s32 ypos) const;
 
+            //! get the range of items which are at least partially visible,
+            //! last is smaller than first if no item is visible
+            void getVisibleItems(s32* first, s32* last) const;
+
             //! Sets the sprite bank which should be used to draw list icons. This font is set to the sprite bank of
             //! the built-in-font by default. A sprite can be displayed in front of every list item.
             //! An icon is an index within the icon sprite bank. Several default icons are available in the
@@ -430,6 +430,16 @@ int ListWidget::getItemCount() const
 
 // -----------------------------------------------------------------------------
 
+void ListWidget::getVisibleRange(int* first, int* last) const
+{
+    // May only be called AFTER this widget has been add()ed
+    assert(m_element != NULL);
+
+    getIrrlichtElement<CGUISTKListBox>()->getVisibleItems(first, last);
+}
+
+// -----------------------------------------------------------------------------
+
 void ListWidget::elementRemoved()
 {
     Widget::elementRemoved();
@@ -178,6 +178,13 @@ namespace GUIEngine
           * \pre may only be called after the widget has been added to the screen with add()
           */
         int getItemCount() const;
+
+        /**
+          * \brief get the indices of the first and last item which are at
+          *        least partially scrolled into view, last < first if none
+          * \pre may only be called after the widget has been added to the screen with add()
+          */
+        void getVisibleRange(int* first, int* last) const;
         
         /**
           * \return the index of the selected element within the list, or -1 if none
@@ -32,6 +32,7 @@
 #include "utils/file_utils.hpp"
 #include "utils/log.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/vs.hpp"
 
 #ifdef ANDROID
 #include "io/assets_android.hpp"
@@ -39,8 +40,11 @@
 
 #include <irrlicht.h>
 
+#include <algorithm>
+#include <atomic>
 #include <stdio.h>
 #include <stdexcept>
+#include <thread>
 #include <sstream>
 #include <sys/stat.h>
 #include <iostream>
@@ -254,6 +258,7 @@ FileManager::FileManager()
     checkAndCreateScreenshotDir();
     checkAndCreateReplayDir();
     checkAndCreateCachedTexturesDir();
+    checkAndCreateCachedAssetsDir();
     checkAndCreateGPDir();
 
     redirectOutput();
@@ -604,6 +609,53 @@ XMLNode *FileManager::createXMLTreeFromString(const std::string & content)
     }
 }   // createXMLTreeFromString
 
+//-----------------------------------------------------------------------------
+/** Reads in many XML files in parallel, e.g. all kart.xml files at startup.
+ *  The search paths must not be changed while this function runs. Files are
+ *  only read in parallel if all mounted archives are folders, as the other
+ *  archives (zip files, android assets, ...) share one file handle.
+ *  \param filenames Names of the XML files to read.
+ *  \return The trees in the order of filenames, NULL for files which cannot
+ *          be read (see createXMLTree).
+ */
+std::vector<std::unique_ptr<XMLNode> >
+    FileManager::createXMLTrees(const std::vector<std::string> &filenames)
+{
+    std::vector<std::unique_ptr<XMLNode> > trees(filenames.size());
+    std::atomic<unsigned> next(0);
+    auto parse = [this, &filenames, &trees, &next]()
+    {
+        for (unsigned i = next++; i < filenames.size(); i = next++)
+            trees[i].reset(createXMLTree(filenames[i]));
+    };
+    bool only_folders = true;
+    {
+        std::lock_guard<std::mutex> lock(m_file_system_lock);
+        for (unsigned i = 0; i < m_file_system->getFileArchiveCount(); i++)
+        {
+            if (m_file_system->getFileArchive(i)->getType() !=
+                io::EFAT_FOLDER)
+                only_folders = false;
+        }
+    }
+    unsigned thread_count = !only_folders ? 1 :
+        std::min((unsigned)filenames.size(),
+        std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; i++)
+    {
+        threads.emplace_back([parse]()
+            {
+                VS::setThreadName("XMLLoader");
+                parse();
+            });
+    }
+    parse();
+    for (std::thread& t : threads)
+        t.join();
+    return trees;
+}   // createXMLTrees
+
 //-----------------------------------------------------------------------------
 /** In order to add and later remove paths we have to specify the absolute
  *  filename (and replace '\' with '/' on windows).
@@ -839,6 +891,15 @@ std::string FileManager::getCachedTexturesDir() const
     return m_cached_textures_dir;
 }   // getCachedTexturesDir
 
+//-----------------------------------------------------------------------------
+/** Returns the directory in which binary versions of assets are cached,
+ *  empty if caching is not possible.
+ */
+std::string FileManager::getCachedAssetsDir() const
+{
+    return m_cached_assets_dir;
+}   // getCachedAssetsDir
+
 //-----------------------------------------------------------------------------
 /** Returns the directory in which user-defined grand prix should be stored.
  */
@@ -1181,6 +1242,31 @@ void FileManager::checkAndCreateCachedTexturesDir()
 
 }   // checkAndCreateCachedTexturesDir
 
+// ----------------------------------------------------------------------------
+/** Creates the directory for cached binary assets. This will set
+*  m_cached_assets_dir with the appropriate path.
+*/
+void FileManager::checkAndCreateCachedAssetsDir()
+{
+#if defined(WIN32)
+    m_cached_assets_dir = m_user_config_dir + "cached-assets/";
+#elif defined(__APPLE__)
+    m_cached_assets_dir = getenv("HOME");
+    m_cached_assets_dir += "/Library/Application Support/SuperTuxKart/CachedAssets/";
+#else
+    m_cached_assets_dir = checkAndCreateLinuxDir("XDG_CACHE_HOME", "supertuxkart", ".cache/", ".");
+    m_cached_assets_dir += "cached-assets/";
+#endif
+
+    if (!checkAndCreateDirectory(m_cached_assets_dir))
+    {
+        Log::error("FileManager", "Can not create cached assets directory "
+            "'%s', assets will not be cached.", m_cached_assets_dir.c_str());
+        m_cached_assets_dir = "";
+    }
+
+}   // checkAndCreateCachedAssetsDir
+
 // ----------------------------------------------------------------------------
 /** Creates the directories for user-defined grand prix. This will set m_gp_dir
  *  with the appropriate path.
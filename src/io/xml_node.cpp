@@ -18,36 +18,216 @@
 
 #include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
+#include "utils/constants.hpp"
+#include "utils/file_utils.hpp"
 #include "utils/interpolation_array.hpp"
 #include "utils/log.hpp"
+#include "utils/mapped_file.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/vec3.hpp"
 
+#include <IFileSystem.h>
+#include <IReadFile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <stdexcept>
+#include <unordered_map>
+#ifdef WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace
+{
+    /** Increase if the layout of the compiled files changes. */
+    const uint32_t COMPILED_MAGIC   = 0x584d5453; // "STMX"
+    const uint32_t COMPILED_VERSION = 1;
+
+    // ------------------------------------------------------------------------
+    uint64_t hashData(const void* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }   // hashData
+
+    // ------------------------------------------------------------------------
+    /** Returns the compiled file of a XML file, empty if there is no cache
+     *  directory. */
+    std::string getCompiledFile(const std::string& filename)
+    {
+        std::string dir = file_manager->getCachedAssetsDir();
+        if (dir.empty())
+            return "";
+        char name[64];
+        snprintf(name, sizeof(name), "xml-%016llx.bin",
+            (unsigned long long)hashData(filename.data(), filename.size()));
+        return dir + name;
+    }   // getCompiledFile
+
+    // ------------------------------------------------------------------------
+    /** Converts a value to 3 floats like XMLNode::get(Vec3*). */
+    bool parseVec3(const std::string& s, float* xyz)
+    {
+        std::vector<std::string> v = StringUtils::split(s, ' ');
+        return v.size() == 3 &&
+            StringUtils::parseString<float>(v[0], &xyz[0]) &&
+            StringUtils::parseString<float>(v[1], &xyz[1]) &&
+            StringUtils::parseString<float>(v[2], &xyz[2]);
+    }   // parseVec3
+
+    // ------------------------------------------------------------------------
+    void write(FILE* f, const void* data, size_t size)
+    {
+        if (size > 0)
+            fwrite(data, 1, size, f);
+    }   // write
+    // ------------------------------------------------------------------------
+    void writeUInt32(FILE* f, uint32_t v)                { write(f, &v, 4); }
+    // ------------------------------------------------------------------------
+    void writeString(FILE* f, const std::string& s)
+    {
+        writeUInt32(f, (uint32_t)s.size());
+        write(f, s.data(), s.size());
+    }   // writeString
+
+    // ------------------------------------------------------------------------
+    /** Reads the data of a compiled file. */
+    struct CompiledReader
+    {
+        const uint8_t* m_pos;
+        const uint8_t* m_end;
+        // --------------------------------------------------------------------
+        bool get(void* out, size_t size)
+        {
+            if ((size_t)(m_end - m_pos) < size)
+                return false;
+            memcpy(out, m_pos, size);
+            m_pos += size;
+            return true;
+        }
+        // --------------------------------------------------------------------
+        bool getUInt32(uint32_t* v)                   { return get(v, 4); }
+        // --------------------------------------------------------------------
+        /** Returns true if count items of at least size bytes can follow. */
+        bool canRead(uint32_t count, size_t size) const
+        {
+            return (size_t)(m_end - m_pos) / size >= count;
+        }
+        // --------------------------------------------------------------------
+        bool getString(std::string* s)
+        {
+            uint32_t len = 0;
+            if (!getUInt32(&len) || !canRead(len, 1))
+                return false;
+            s->assign((const char*)m_pos, len);
+            m_pos += len;
+            return true;
+        }
+    };   // CompiledReader
+    // ------------------------------------------------------------------------
+    /** Returns true if the attribute of a node has the expected value. */
+    template<typename T>
+    bool hasValue(const XMLNode* node, const std::string& name,
+                  const T& expected)
+    {
+        T value;
+        return node->get(name, &value) == 1 && value == expected;
+    }   // hasValue
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Used for the nodes of a tree loaded from a compiled file. */
+XMLNode::XMLNode()
+{
+    m_node_array = NULL;
+    m_node_array_size = 0;
+}   // XMLNode
 
+// ----------------------------------------------------------------------------
 XMLNode::XMLNode(io::IXMLReader *xml)
 {
     m_file_name = "[unknown]";
+    m_node_array = NULL;
+    m_node_array_size = 0;
 
     while(xml->getNodeType()!=io::EXN_ELEMENT && xml->read());
     readXML(xml);
 }   // XMLNode
 
 // ----------------------------------------------------------------------------
-/** Reads a XML file and convert it into a XMLNode tree.
+/** Reads a XML file and convert it into a XMLNode tree. The compiled file
+ *  is used instead if it was created from the same content, otherwise it is
+ *  written after parsing the XML.
  *  \param filename Name of the XML file to read.
+ *  \param use_compiled False to always parse the XML.
  */
-XMLNode::XMLNode(const std::string &filename)
+XMLNode::XMLNode(const std::string &filename, bool use_compiled)
 {
     m_file_name = filename;
+    m_node_array = NULL;
+    m_node_array_size = 0;
 
-    io::IXMLReader *xml = file_manager->createXMLReader(filename);
-    
-    if (xml == NULL)
+    io::IFileSystem* fs = file_manager->getFileSystem();
+    io::IReadFile* file = fs->createAndOpenFile(filename.c_str());
+    if (file == NULL)
     {
         throw std::runtime_error("Cannot find file "+filename);
     }
+    const long size = std::max(file->getSize(), 0L);
+    // Deleted by the memory read file below
+    char* data = new char[size + 1];
+    const long read = file->read(data, (unsigned)size);
+    file->drop();
+    if (read != size)
+    {
+        delete [] data;
+        throw std::runtime_error("Cannot read file "+filename);
+    }
+
+    std::string compiled_file;
+    uint64_t hash = 0;
+    if (use_compiled && IS_LITTLE_ENDIAN)
+        compiled_file = getCompiledFile(filename);
+    if (!compiled_file.empty())
+    {
+        hash = hashData(data, size);
+        if (loadCompiled(compiled_file, hash))
+        {
+            delete [] data;
+            return;
+        }
+    }
+
+    io::IReadFile* memory_file = fs->createMemoryReadFile(data, (s32)size,
+        filename.c_str(), /*deleteMemoryWhenDropped*/true);
+    io::IXMLReader *xml = fs->createXMLReader(memory_file);
+    memory_file->drop();
+    if (xml == NULL)
+    {
+        throw std::runtime_error("Cannot read file "+filename);
+    }
+    readFile(xml);
+    xml->drop();
 
+    if (!compiled_file.empty())
+        saveCompiled(compiled_file, hash);
+}   // XMLNode
+
+// ----------------------------------------------------------------------------
+/** Reads the root element of a file.
+ *  \param xml The XML reader.
+ */
+void XMLNode::readFile(io::IXMLReader *xml)
+{
     bool is_first_element = true;
     while(xml->read())
     {
@@ -59,7 +239,7 @@ XMLNode::XMLNode(const std::string &filename)
                 {
                     Log::warn("[XMLNode]",
                                 "More than one root element in '%s' - ignored.",
-                            filename.c_str());
+                            m_file_name.c_str());
                 }
                 readXML(xml);
                 is_first_element = false;
@@ -72,16 +252,25 @@ XMLNode::XMLNode(const std::string &filename)
         default:                   break;
         }   // switch
     }   // while
-    xml->drop();
-}   // XMLNode
+}   // readFile
 
 // ----------------------------------------------------------------------------
 /** Destructor. */
 XMLNode::~XMLNode()
 {
-    for(unsigned int i=0; i<m_nodes.size(); i++)
+    if (m_node_array)
     {
-        delete m_nodes[i];
+        // All nodes below are deleted at once
+        for (unsigned int i = 0; i < m_node_array_size; i++)
+            m_node_array[i].m_nodes.clear();
+        delete [] m_node_array;
+    }
+    else
+    {
+        for(unsigned int i=0; i<m_nodes.size(); i++)
+        {
+            delete m_nodes[i];
+        }
     }
     m_nodes.clear();
 }   // ~XMLNode
@@ -98,7 +287,7 @@ void XMLNode::readXML(io::IXMLReader *xml)
     {
         std::string   name  = core::stringc(xml->getAttributeName(i)).c_str();
         core::stringw value = xml->getAttributeValue(i);
-        m_attributes[name] = value;
+        setAttribute(name, value);
     }   // for i
 
     // If no children, we are done
@@ -129,6 +318,243 @@ void XMLNode::readXML(io::IXMLReader *xml)
     }   // while
 }   // readXML
 
+// ----------------------------------------------------------------------------
+/** Sets an attribute, replacing the previous value of the same name.
+ *  Converted values are only set when compiling the file.
+ */
+void XMLNode::setAttribute(const std::string &name, const core::stringw &value)
+{
+    auto it = std::lower_bound(m_attributes.begin(), m_attributes.end(), name,
+        [](const Attribute& a, const std::string& n) { return a.m_name < n; });
+    if (it == m_attributes.end() || it->m_name != name)
+        it = m_attributes.insert(it, Attribute());
+    it->m_name   = name;
+    it->m_value  = value;
+    it->m_string = core::stringc(value).c_str();
+    it->m_types  = 0;
+}   // setAttribute
+
+// ----------------------------------------------------------------------------
+/** Returns the attribute with the given name, NULL if it is not defined. */
+const XMLNode::Attribute *XMLNode::findAttribute(const std::string &name) const
+{
+    auto it = std::lower_bound(m_attributes.begin(), m_attributes.end(), name,
+        [](const Attribute& a, const std::string& n) { return a.m_name < n; });
+    if (it == m_attributes.end() || it->m_name != name)
+        return NULL;
+    return &*it;
+}   // findAttribute
+
+// ----------------------------------------------------------------------------
+/** Loads the tree from a compiled file. All nodes below this one are
+ *  allocated in one array.
+ *  \param hash Hash of the XML content the compiled file must be made of.
+ *  \return False if the file is missing, invalid or of another content.
+ */
+bool XMLNode::loadCompiled(const std::string &compiled_file, uint64_t hash)
+{
+    MappedFile file;
+    if (!file.open(compiled_file))
+        return false;
+    CompiledReader r;
+    r.m_pos = file.getData();
+    r.m_end = r.m_pos + file.getSize();
+
+    uint32_t magic = 0, version = 0, name_count = 0, node_count = 0;
+    uint64_t compiled_hash = 0;
+    if (!r.getUInt32(&magic) || magic != COMPILED_MAGIC ||
+        !r.getUInt32(&version) || version != COMPILED_VERSION ||
+        !r.get(&compiled_hash, 8) || compiled_hash != hash ||
+        !r.getUInt32(&name_count) || !r.canRead(name_count, 4))
+        return false;
+    std::vector<std::string> names(name_count);
+    for (std::string& name : names)
+    {
+        if (!r.getString(&name))
+            return false;
+    }
+    if (!r.getUInt32(&node_count) || node_count == 0 ||
+        !r.canRead(node_count, 12))
+        return false;
+
+    XMLNode* array = node_count > 1 ? new XMLNode[node_count - 1] : NULL;
+    // Nodes which still miss children, with the number of missing children
+    std::vector<std::pair<XMLNode*, uint32_t> > parents;
+    bool ok = true;
+    for (uint32_t i = 0; i < node_count && ok; i++)
+    {
+        XMLNode* node = i == 0 ? this : &array[i - 1];
+        if (i > 0)
+        {
+            if (parents.empty())
+            {
+                ok = false;
+                break;
+            }
+            parents.back().first->m_nodes.push_back(node);
+            if (--parents.back().second == 0)
+                parents.pop_back();
+        }
+        uint32_t name_id = 0, child_count = 0, attribute_count = 0;
+        ok = r.getUInt32(&name_id) && name_id < name_count &&
+            r.getUInt32(&child_count) && r.getUInt32(&attribute_count) &&
+            r.canRead(attribute_count, 44);
+        if (!ok)
+            break;
+        node->m_name = names[name_id];
+        node->m_file_name = m_file_name;
+        if (child_count > 0)
+        {
+            node->m_nodes.reserve(child_count);
+            parents.emplace_back(node, child_count);
+        }
+        node->m_attributes.resize(attribute_count);
+        for (Attribute& a : node->m_attributes)
+        {
+            uint32_t len = 0;
+            ok = r.getUInt32(&name_id) && name_id < name_count &&
+                r.getUInt32(&len) && r.canRead(len, 4);
+            if (!ok)
+                break;
+            a.m_name = names[name_id];
+            std::vector<wchar_t> value(len);
+            for (uint32_t j = 0; j < len; j++)
+            {
+                uint32_t c = 0;
+                r.getUInt32(&c);
+                value[j] = (wchar_t)c;
+            }
+            a.m_value = core::stringw(value.data(), len);
+            ok = r.getString(&a.m_string) && r.getUInt32(&a.m_types) &&
+                r.get(&a.m_int, 4) && r.get(&a.m_float, 4) &&
+                r.get(&a.m_double, 8) && r.get(a.m_vec3, 12);
+            if (!ok)
+                break;
+        }
+    }
+    if (!ok || !parents.empty() || r.m_pos != r.m_end)
+    {
+        for (uint32_t i = 0; i + 1 < node_count; i++)
+            array[i].m_nodes.clear();
+        delete [] array;
+        m_name.clear();
+        m_attributes.clear();
+        m_nodes.clear();
+        Log::warn("[XMLNode]", "Invalid compiled file %s of %s.",
+            compiled_file.c_str(), m_file_name.c_str());
+        return false;
+    }
+    m_node_array = array;
+    m_node_array_size = node_count - 1;
+    return true;
+}   // loadCompiled
+
+// ----------------------------------------------------------------------------
+/** Writes the tree to a compiled file: the names of elements and attributes
+ *  are stored once, then all nodes follow in pre-order with their
+ *  attributes and values converted to numbers and vectors if possible.
+ *  \param hash Hash of the XML content.
+ */
+void XMLNode::saveCompiled(const std::string &compiled_file,
+                           uint64_t hash) const
+{
+    std::vector<const XMLNode*> nodes;
+    std::vector<const XMLNode*> stack(1, this);
+    while (!stack.empty())
+    {
+        const XMLNode* node = stack.back();
+        stack.pop_back();
+        nodes.push_back(node);
+        for (auto it = node->m_nodes.rbegin(); it != node->m_nodes.rend();
+             it++)
+            stack.push_back(*it);
+    }
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> name_ids;
+    auto intern = [&names, &name_ids](const std::string& name)
+    {
+        auto it = name_ids.find(name);
+        if (it != name_ids.end())
+            return it->second;
+        uint32_t id = (uint32_t)names.size();
+        names.push_back(name);
+        name_ids[name] = id;
+        return id;
+    };
+    for (const XMLNode* node : nodes)
+    {
+        intern(node->m_name);
+        for (const Attribute& a : node->m_attributes)
+            intern(a.m_name);
+    }
+
+    // Other threads or processes may compile the same file
+    static std::atomic<unsigned> tmp_counter(0);
+#ifdef WIN32
+    int pid = _getpid();
+#else
+    int pid = getpid();
+#endif
+    std::string tmp = compiled_file + "." + StringUtils::toString(pid) +
+        "." + StringUtils::toString(tmp_counter++) + ".tmp";
+    FILE* f = FileUtils::fopenU8Path(tmp, "wb");
+    if (!f)
+        return;
+    writeUInt32(f, COMPILED_MAGIC);
+    writeUInt32(f, COMPILED_VERSION);
+    write(f, &hash, 8);
+    writeUInt32(f, (uint32_t)names.size());
+    for (const std::string& name : names)
+        writeString(f, name);
+    writeUInt32(f, (uint32_t)nodes.size());
+    for (const XMLNode* node : nodes)
+    {
+        writeUInt32(f, name_ids[node->m_name]);
+        writeUInt32(f, (uint32_t)node->m_nodes.size());
+        writeUInt32(f, (uint32_t)node->m_attributes.size());
+        for (const Attribute& a : node->m_attributes)
+        {
+            writeUInt32(f, name_ids[a.m_name]);
+            writeUInt32(f, a.m_value.size());
+            for (unsigned i = 0; i < a.m_value.size(); i++)
+                writeUInt32(f, (uint32_t)a.m_value[i]);
+            writeString(f, a.m_string);
+            Attribute c = a;
+            c.m_int = 0;
+            c.m_float = 0.0f;
+            c.m_double = 0.0;
+            c.m_vec3[0] = c.m_vec3[1] = c.m_vec3[2] = 0.0f;
+            if (StringUtils::parseString<int>(c.m_string, &c.m_int))
+                c.m_types |= AT_INT;
+            if (StringUtils::parseString<float>(c.m_string, &c.m_float))
+                c.m_types |= AT_FLOAT;
+            if (StringUtils::parseString<double>(c.m_string, &c.m_double))
+                c.m_types |= AT_DOUBLE;
+            if (parseVec3(c.m_string, c.m_vec3))
+                c.m_types |= AT_VEC3;
+            writeUInt32(f, c.m_types);
+            write(f, &c.m_int, 4);
+            write(f, &c.m_float, 4);
+            write(f, &c.m_double, 8);
+            write(f, c.m_vec3, 12);
+        }
+    }
+    bool ok = ferror(f) == 0;
+    fclose(f);
+    if (ok)
+    {
+        remove(FileUtils::getPortableWritingPath(compiled_file).c_str());
+        ok = FileUtils::renameU8Path(tmp, compiled_file) == 0;
+    }
+    if (!ok)
+    {
+        Log::warn("[XMLNode]", "Cannot write compiled file %s of %s.",
+            compiled_file.c_str(), m_file_name.c_str());
+        remove(FileUtils::getPortableWritingPath(tmp).c_str());
+    }
+}   // saveCompiled
+
 // ----------------------------------------------------------------------------
 /** Returns the i.th node.
  *  \param i Number of node to return.
@@ -175,32 +601,25 @@ const void XMLNode::getNodes(const std::string &s, std::vector<XMLNode*>& out) c
 */
 int XMLNode::get(const std::string &attribute, std::string *value) const
 {
-    if(m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if(o==m_attributes.end()) return 0;
-    *value=core::stringc(o->second).c_str();
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
+    *value = a->m_string;
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, core::stringw *value) const
 {
-    if(m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if(o==m_attributes.end()) return 0;
-    *value = o->second;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
+    *value = a->m_value;
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
 int XMLNode::getAndDecode(const std::string &attribute, core::stringw *value) const
 {
-    if (m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if (o == m_attributes.end()) return 0;
-    std::string raw_value = core::stringc(o->second).c_str();
-    *value = StringUtils::xmlDecode(raw_value);
+    const Attribute *a = findAttribute(attribute);
+    if (!a) return 0;
+    *value = StringUtils::xmlDecode(a->m_string);
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
@@ -229,34 +648,24 @@ int XMLNode::get(const std::string &attribute, core::vector3df *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, Vec3 *value) const
 {
-    std::string s = "";
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
 
-    std::vector<std::string> v = StringUtils::split(s,' ');
-    if (v.size() != 3)
+    float xyz[3];
+    if ((a->m_types & AT_VEC3) != 0)
     {
-        Log::warn("[XMLNode]", "WARNING: Expected 3 floating-point values, but found '%s' in file %s",
-                    s.c_str(), m_file_name.c_str());
-        return 0;
+        memcpy(xyz, a->m_vec3, sizeof(xyz));
     }
-
-    float x, y, z;
-
-    if (StringUtils::parseString<float>(v[0], &x) &&
-        StringUtils::parseString<float>(v[1], &y) &&
-        StringUtils::parseString<float>(v[2], &z) )
-    {
-        value->setX(x);
-        value->setY(y);
-        value->setZ(z);
-    }
-    else
+    else if (!parseVec3(a->m_string, xyz))
     {
         Log::warn("[XMLNode]", "WARNING: Expected 3 floating-point values, but found '%s' in file %s",
-                    s.c_str(), m_file_name.c_str());
+                    a->m_string.c_str(), m_file_name.c_str());
         return 0;
     }
 
+    value->setX(xyz[0]);
+    value->setY(xyz[1]);
+    value->setZ(xyz[2]);
     return 1;
 }   // get(Vec3)
 
@@ -312,8 +721,14 @@ int XMLNode::get(const std::string &attribute, video::SColorf *color) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, int32_t *value) const
 {
-    std::string s;
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
+    if ((a->m_types & AT_INT) != 0)
+    {
+        *value = a->m_int;
+        return 1;
+    }
+    const std::string &s = a->m_string;
 
     if (!StringUtils::parseString<int>(s, value))
     {
@@ -377,8 +792,14 @@ int XMLNode::get(const std::string &attribute, uint32_t *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, float *value) const
 {
-    std::string s;
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
+    if ((a->m_types & AT_FLOAT) != 0)
+    {
+        *value = a->m_float;
+        return 1;
+    }
+    const std::string &s = a->m_string;
 
     if (!StringUtils::parseString<float>(s, value))
     {
@@ -393,8 +814,14 @@ int XMLNode::get(const std::string &attribute, float *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, double *value) const
 {
-    std::string s;
-    if (!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if (!a) return 0;
+    if ((a->m_types & AT_DOUBLE) != 0)
+    {
+        *value = a->m_double;
+        return 1;
+    }
+    const std::string &s = a->m_string;
 
     if (!StringUtils::parseString<double>(s, value))
     {
@@ -649,3 +1076,86 @@ bool XMLNode::hasChildNamed(const char* name) const
     }
     return false;
 }
+
+// ----------------------------------------------------------------------------
+/** Compares compiled files of the XML files in data with the parsed XML and
+ *  shows the time to load them both ways.
+ */
+void XMLNode::unitTesting()
+{
+    if (!IS_LITTLE_ENDIAN || file_manager->getCachedAssetsDir().empty())
+        return;
+    const char* files[] = { "stk_config.xml", "kart_characteristics.xml",
+                            "achievements.xml", "items.xml", "powerup.xml" };
+    for (const char* name : files)
+    {
+        std::string filename = file_manager->getAsset(name);
+        XMLNode parsed(filename, /*use_compiled*/false);
+        // Writes the compiled file
+        XMLNode(filename, /*use_compiled*/true);
+        XMLNode compiled(filename, /*use_compiled*/true);
+        assert(compiled.getNumNodes() == 0 || compiled.m_node_array != NULL);
+
+        std::vector<std::pair<const XMLNode*, const XMLNode*> > pairs;
+        pairs.emplace_back(&parsed, &compiled);
+        while (!pairs.empty())
+        {
+            const XMLNode* p = pairs.back().first;
+            const XMLNode* c = pairs.back().second;
+            pairs.pop_back();
+            assert(p->getName() == c->getName());
+            assert(p->getNumNodes() == c->getNumNodes());
+            assert(p->m_attributes.size() == c->m_attributes.size());
+            for (unsigned i = 0; i < p->getNumNodes(); i++)
+                pairs.emplace_back(p->getNode(i), c->getNode(i));
+            for (const Attribute& a : c->m_attributes)
+            {
+                assert(hasValue(p, a.m_name, a.m_string));
+                assert(hasValue(p, a.m_name, a.m_value));
+                if ((a.m_types & AT_INT) != 0)
+                    assert(hasValue(p, a.m_name, a.m_int));
+                if ((a.m_types & AT_FLOAT) != 0)
+                    assert(hasValue(p, a.m_name, a.m_float));
+                if ((a.m_types & AT_DOUBLE) != 0)
+                    assert(hasValue(p, a.m_name, a.m_double));
+                if ((a.m_types & AT_VEC3) != 0)
+                {
+                    assert(hasValue(p, a.m_name, Vec3(a.m_vec3[0],
+                        a.m_vec3[1], a.m_vec3[2])));
+                }
+            }
+        }
+
+        // Benchmark, including reading all numbers once
+        const int loops = 20;
+        double ms[2];
+        for (int compiled_loop = 0; compiled_loop < 2; compiled_loop++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < loops; i++)
+            {
+                XMLNode root(filename, compiled_loop == 1);
+                pairs.emplace_back(&root, &compiled);
+                float f = 0.0f;
+                while (!pairs.empty())
+                {
+                    const XMLNode* node = pairs.back().first;
+                    const XMLNode* c = pairs.back().second;
+                    pairs.pop_back();
+                    for (const Attribute& a : c->m_attributes)
+                    {
+                        if ((a.m_types & AT_FLOAT) != 0)
+                            node->get(a.m_name, &f);
+                    }
+                    for (unsigned j = 0; j < node->getNumNodes(); j++)
+                        pairs.emplace_back(node->getNode(j), c->getNode(j));
+                }
+            }
+            ms[compiled_loop] = std::chrono::duration_cast<
+                std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                start).count() / 1000.0 / loops;
+        }
+        Log::info("XMLNode", "%s: parsed in %.3fms, compiled in %.3fms.",
+            name, ms[0], ms[1]);
+    }
+}   // unitTesting
@@ -19,6 +19,7 @@
 #ifndef HEADER_XML_NODE_HPP
 #define HEADER_XML_NODE_HPP
 
+#include <cstdint>
 #include <string>
 #include <map>
 #include <vector>
@@ -42,28 +43,67 @@ class Vec3;
 
 /**
   * \brief utility class used to parse XML files
+  *  Files are compiled to a binary form in the cached assets directory,
+  *  with the attribute names stored once and numbers and vectors already
+  *  converted. The compiled file is used instead of parsing the XML as long
+  *  as the hash of the XML content matches.
   * \ingroup io
   */
 class XMLNode : public NoCopy
 {
 private:
+    /** Bits of Attribute::m_types, set if the value was converted when the
+     *  file was compiled. */
+    enum AttributeType
+    {
+        AT_INT    = 1,
+        AT_FLOAT  = 2,
+        AT_DOUBLE = 4,
+        AT_VEC3   = 8
+    };
+
+    struct Attribute
+    {
+        std::string   m_name;
+        core::stringw m_value;
+        /** The value as returned by get(std::string*). */
+        std::string   m_string;
+        /** Values converted when the file was compiled, see AttributeType. */
+        uint32_t      m_types;
+        int32_t       m_int;
+        float         m_float;
+        double        m_double;
+        float         m_vec3[3];
+    };
+
     /** Name of this element. */
     std::string                          m_name;
-    /** List of all attributes. */
-    std::map<std::string, core::stringw> m_attributes;
+    /** List of all attributes, sorted by name. */
+    std::vector<Attribute>               m_attributes;
     /** List of all sub nodes. */
     std::vector<XMLNode *>               m_nodes;
+    /** All nodes below the root of a tree loaded from a compiled file, which
+     *  are allocated at once. NULL for all other nodes. */
+    XMLNode                             *m_node_array;
+    unsigned                             m_node_array_size;
 
     void readXML(io::IXMLReader *xml);
 
     std::string                          m_file_name;
 
+         XMLNode();
+    void readFile(io::IXMLReader *xml);
+    void setAttribute(const std::string &name, const core::stringw &value);
+    const Attribute *findAttribute(const std::string &name) const;
+    bool loadCompiled(const std::string &compiled_file, uint64_t hash);
+    void saveCompiled(const std::string &compiled_file, uint64_t hash) const;
+
 public:
          LEAK_CHECK();
          XMLNode(io::IXMLReader *xml);
 
          /** \throw runtime_error if the file is not found */
-         XMLNode(const std::string &filename);
+         XMLNode(const std::string &filename, bool use_compiled = true);
 
         ~XMLNode();
 
@@ -99,6 +139,8 @@ public:
 
     bool hasChildNamed(const char* name) const;
 
+    static void unitTesting();
+
     /** Handy functions to test the bit pattern returned by get(vector3df*).*/
     static bool hasX(int b) { return (b&1)==1; }
     static bool hasY(int b) { return (b&2)==2; }
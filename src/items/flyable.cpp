@@ -41,12 +41,14 @@
 #include "karts/explosion_animation.hpp"
 #include "modes/linear_world.hpp"
 #include "network/compress_network_body.hpp"
+#include "network/game_events.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
 #include "network/rewind_manager.hpp"
 #include "physics/physics.hpp"
 #include "tracks/track.hpp"
 #include "utils/constants.hpp"
+#include "utils/mini_glm.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/vs.hpp"
 
@@ -556,6 +558,15 @@ bool Flyable::hit(AbstractKart *kart_hit, PhysicalObject* object)
     // the owner of this flyable should not be hit by his own flyable
     if(isOwnerImmunity(kart_hit)) return false;
     m_has_hit_something=true;
+    if (GameEvents::get() && kart_hit && m_owner)
+    {
+        GameEvents::get()->push(GameEvents::GE_ITEM_HIT,
+            StringUtils::wideToUtf8(m_owner->getController()->getName(
+            false/*include_handicap_string*/)),
+            StringUtils::wideToUtf8(kart_hit->getController()->getName(
+            false/*include_handicap_string*/)), -1,
+            World::getWorld()->getTimeSinceStart(), (int)m_type);
+    }
 
     return true;
 
@@ -239,6 +239,8 @@ void Powerup::adjustSound()
 void Powerup::use()
 {
     const int ticks = World::getWorld()->getTicksSinceStart();
+    // Most powerups change other karts without a contact
+    RewindManager::get()->addUnknownInteraction();
     bool has_played_sound = false;
     auto it = m_played_sound_ticks.find(ticks);
     if (it != m_played_sound_ticks.end())
@@ -108,6 +108,9 @@ void ProjectileManager::updateGraphics(float dt)
 /** General projectile update call. */
 void ProjectileManager::update(int ticks)
 {
+    // Flyables can hit any kart, and homing ones follow the karts
+    if (!m_active_projectiles.empty())
+        RewindManager::get()->addUnknownInteraction();
     updateServer(ticks);
 
     if (RewindManager::get()->isRewinding())
@@ -67,6 +67,7 @@
 #include "modes/overworld.hpp"
 #include "modes/soccer_world.hpp"
 #include "network/compress_network_body.hpp"
+#include "network/game_events.hpp"
 #include "network/network_config.hpp"
 #include "network/protocols/client_lobby.hpp"
 #include "network/race_event_manager.hpp"
@@ -941,6 +942,13 @@ void Kart::finishedRace(float time, bool from_server)
         if (NetworkConfig::get()->isServer())
         {
             RaceEventManager::get()->kartFinishedRace(this, time);
+            if (GameEvents::get())
+            {
+                GameEvents::get()->push(GameEvents::GE_FINISH,
+                    StringUtils::wideToUtf8(m_controller->getName(
+                    false/*include_handicap_string*/)), "", -1, time,
+                    getPosition());
+            }
         }   // isServer
 
         // Ignore local detection of a kart finishing a race in a 
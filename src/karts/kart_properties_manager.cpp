@@ -161,14 +161,24 @@ void KartPropertiesManager::loadAllKarts(bool loading_icon)
         // -------------------------------------------------------
         if(loadKart(*dir)) continue;
 
-        // If not, check each subdir of this directory.
+        // If not, check each subdir of this directory. All kart.xml files
+        // are read in parallel first, the karts are then loaded in order.
         // --------------------------------------------
         std::set<std::string> result;
         file_manager->listFiles(result, *dir);
+        std::vector<std::string> kart_files;
         for(std::set<std::string>::const_iterator subdir=result.begin();
             subdir!=result.end(); subdir++)
         {
-            const bool loaded = loadKart(*dir+*subdir);
+            kart_files.push_back(*dir+*subdir+"/kart.xml");
+        }
+        std::vector<std::unique_ptr<XMLNode> > xml =
+            file_manager->createXMLTrees(kart_files);
+        unsigned int i = 0;
+        for(std::set<std::string>::const_iterator subdir=result.begin();
+            subdir!=result.end(); subdir++, i++)
+        {
+            const bool loaded = loadKart(*dir+*subdir, xml[i].get());
 
             if (loaded && loading_icon)
             {
@@ -241,8 +251,10 @@ void KartPropertiesManager::loadCharacteristics(const XMLNode *root)
 //-----------------------------------------------------------------------------
 /** Loads a single kart and (if not disabled) the corresponding 3d model.
  *  \param filename Full path to the kart config file.
+ *  \param xml The kart.xml file if it was already read, or NULL.
  */
-bool KartPropertiesManager::loadKart(const std::string &dir)
+bool KartPropertiesManager::loadKart(const std::string &dir,
+                                     const XMLNode *xml)
 {
     std::string config_filename = dir + "/kart.xml";
     if(!file_manager->fileExists(config_filename))
@@ -251,7 +263,7 @@ bool KartPropertiesManager::loadKart(const std::string &dir)
     KartProperties* kart_properties;
     try
     {
-        kart_properties = new KartProperties(config_filename);
+        kart_properties = new KartProperties(config_filename, xml);
     }
     catch (std::runtime_error& err)
     {
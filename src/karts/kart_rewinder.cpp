@@ -31,7 +31,9 @@
 #include "karts/max_speed.hpp"
 #include "karts/skidding.hpp"
 #include "modes/world.hpp"
+#include "network/bit_stream.hpp"
 #include "network/compress_network_body.hpp"
+#include "network/network_config.hpp"
 #include "network/protocols/client_lobby.hpp"
 #include "network/rewind_manager.hpp"
 #include "network/network_string.hpp"
@@ -41,6 +43,7 @@
 #include "utils/vec3.hpp"
 
 #include <ISceneNode.h>
+#include <memory>
 #include <string.h>
 
 KartRewinder::KartRewinder(const std::string& ident,
@@ -177,75 +180,67 @@ BareNetworkString* KartRewinder::saveState(std::vector<std::string>* ru)
     getControls().saveState(buffer);
     bool sign_neg = getController()->saveState(buffer);
 
-    // 2) Boolean handling to determine if need saving
+    // 2) Boolean handling to determine if need saving, the flags, timers
+    //    and (without animation) physics values are bit packed
     const bool has_animation = m_kart_animation != NULL;
-    uint8_t bool_for_each_data = 0;
-    if (m_fire_clicked)
-        bool_for_each_data |= 1;
-    if (m_bubblegum_ticks > 0)
-        bool_for_each_data |= (1 << 1);
-    if (m_view_blocked_by_plunger > 0)
-        bool_for_each_data |= (1 << 2);
-    if (m_invulnerable_ticks > 0)
-        bool_for_each_data |= (1 << 3);
-    if (getEnergy() > 0.0f)
-        bool_for_each_data |= (1 << 4);
-    if (has_animation)
-        bool_for_each_data |= (1 << 5);
-    if (m_vehicle->getTimedRotationTicks() > 0)
-        bool_for_each_data |= (1 << 6);
-    if (m_vehicle->getCentralImpulseTicks() > 0)
-        bool_for_each_data |= (1 << 7);
-    buffer->addUInt8(bool_for_each_data);
-
-    uint8_t bool_for_each_data_2 = 0;
-    if (sign_neg)
-        bool_for_each_data_2 |= 1;
-    if (m_bounce_back_ticks > 0)
-        bool_for_each_data_2 |= (1 << 1);
-    if (getAttachment()->getType() != Attachment::ATTACH_NOTHING)
-        bool_for_each_data_2 |= (1 << 2);
-    if (getPowerup()->getType() != PowerupManager::POWERUP_NOTHING)
-        bool_for_each_data_2 |= (1 << 3);
-    if (m_bubblegum_torque_sign)
-        bool_for_each_data_2 |= (1 << 4);
-    buffer->addUInt8(bool_for_each_data_2);
+    const bool has_timed_rotation = m_vehicle->getTimedRotationTicks() > 0;
+    const bool has_impulse = m_vehicle->getCentralImpulseTicks() > 0;
+    std::unique_ptr<BitWriter> bw(new BitWriter(buffer));
+    bw->addBool(m_fire_clicked);
+    bw->addBool(m_bubblegum_ticks > 0);
+    bw->addBool(m_view_blocked_by_plunger > 0);
+    bw->addBool(m_invulnerable_ticks > 0);
+    bw->addBool(getEnergy() > 0.0f);
+    bw->addBool(has_animation);
+    bw->addBool(has_timed_rotation);
+    bw->addBool(has_impulse);
+    bw->addBool(sign_neg);
+    bw->addBool(m_bounce_back_ticks > 0);
+    bw->addBool(getAttachment()->getType() != Attachment::ATTACH_NOTHING);
+    bw->addBool(getPowerup()->getType() != PowerupManager::POWERUP_NOTHING);
+    bw->addBool(m_bubblegum_torque_sign);
 
     if (m_bubblegum_ticks > 0)
-        buffer->addUInt16(m_bubblegum_ticks);
+        bw->addTicks(m_bubblegum_ticks);
     if (m_view_blocked_by_plunger > 0)
-        buffer->addUInt16(m_view_blocked_by_plunger);
+        bw->addTicks(m_view_blocked_by_plunger);
     if (m_invulnerable_ticks > 0)
-        buffer->addUInt16(m_invulnerable_ticks);
+        bw->addTicks(m_invulnerable_ticks);
     if (getEnergy() > 0.0f)
-        buffer->addFloat(getEnergy());
+        setEnergy(bw->addFixed(getEnergy(), 0.0f, 1024.0f, 16));
 
     // 3) Kart animation status or physics values (transform and velocities)
     // -------------------------------------------
     if (has_animation)
     {
+        // Kart animations use byte aligned states
+        bw.reset();
         buffer->addUInt8(m_kart_animation->getAnimationType());
         m_kart_animation->saveState(buffer);
     }
     else
     {
         CompressNetworkBody::compress(
-            m_body.get(), m_motion_state.get(), buffer);
+            m_body.get(), m_motion_state.get(), bw.get());
 
-        if (m_vehicle->getTimedRotationTicks() > 0)
+        if (has_timed_rotation)
         {
-            buffer->addUInt16(m_vehicle->getTimedRotationTicks());
-            buffer->addFloat(m_vehicle->getTimedRotation());
+            bw->addTicks(m_vehicle->getTimedRotationTicks());
+            bw->addFloat(m_vehicle->getTimedRotation());
         }
 
         // For collision rewind
         if (m_bounce_back_ticks > 0)
-            buffer->addUInt8(m_bounce_back_ticks);
-        if (m_vehicle->getCentralImpulseTicks() > 0)
+            bw->addBits(m_bounce_back_ticks, 8);
+        if (has_impulse)
         {
-            buffer->addUInt16(m_vehicle->getCentralImpulseTicks());
-            buffer->add(m_vehicle->getAdditionalImpulse());
+            bw->addTicks(m_vehicle->getCentralImpulseTicks());
+            const Vec3& impulse = m_vehicle->getAdditionalImpulse();
+            bw->addFloat(impulse.getX());
+            bw->addFloat(impulse.getY());
+            bw->addFloat(impulse.getZ());
         }
+        bw.reset();
     }
 
     // 4) Attachment, powerup, nitro
@@ -255,13 +250,12 @@ BareNetworkString* KartRewinder::saveState(std::vector<std::string>* ru)
     if (getPowerup()->getType() != PowerupManager::POWERUP_NOTHING)
         getPowerup()->saveState(buffer);
 
-    // 5) Max speed info
-    // ------------------
-    m_max_speed->saveState(buffer);
-
-    // 6) Skidding
-    // -----------
-    m_skidding->saveState(buffer);
+    // 5) Max speed info and skidding
+    // ------------------------------
+    bw.reset(new BitWriter(buffer));
+    m_max_speed->saveState(bw.get());
+    m_skidding->saveState(bw.get());
+    bw.reset();
 
     return buffer;
 }   // saveState
@@ -283,47 +277,45 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
 
     // 2) Boolean handling to determine if need saving
     // -----------
-    uint8_t bool_for_each_data = buffer->getUInt8();
-    m_fire_clicked = (bool_for_each_data & 1) == 1;
-    bool read_bubblegum = ((bool_for_each_data >> 1) & 1) == 1;
-    bool read_plunger = ((bool_for_each_data >> 2) & 1) == 1;
-    bool read_invulnerable = ((bool_for_each_data >> 3) & 1) == 1;
-    bool read_energy =  ((bool_for_each_data >> 4) & 1) == 1;
-    bool has_animation_in_state = ((bool_for_each_data >> 5) & 1) == 1;
-    bool read_timed_rotation =  ((bool_for_each_data >> 6) & 1) == 1;
-    bool read_impulse = ((bool_for_each_data >> 7) & 1) == 1;
-
-    uint8_t bool_for_each_data_2 = buffer->getUInt8();
-    bool controller_steer_sign = (bool_for_each_data_2 & 1) == 1;
+    std::unique_ptr<BitReader> br(new BitReader(buffer));
+    m_fire_clicked = br->getBool();
+    bool read_bubblegum = br->getBool();
+    bool read_plunger = br->getBool();
+    bool read_invulnerable = br->getBool();
+    bool read_energy = br->getBool();
+    bool has_animation_in_state = br->getBool();
+    bool read_timed_rotation = br->getBool();
+    bool read_impulse = br->getBool();
+    bool controller_steer_sign = br->getBool();
     if (controller_steer_sign)
     {
         PlayerController* pc = dynamic_cast<PlayerController*>(m_controller);
         if (pc)
             pc->m_steer_val = pc->m_steer_val * -1;
     }
-    bool read_bounce_back = ((bool_for_each_data_2 >> 1) & 1) == 1;
-    bool read_attachment = ((bool_for_each_data_2 >> 2) & 1) == 1;
-    bool read_powerup = ((bool_for_each_data_2 >> 3) & 1) == 1;
-    m_bubblegum_torque_sign = ((bool_for_each_data_2 >> 4) & 1) == 1;
+    bool read_bounce_back = br->getBool();
+    bool read_attachment = br->getBool();
+    bool read_powerup = br->getBool();
+    m_bubblegum_torque_sign = br->getBool();
 
     if (read_bubblegum)
-        m_bubblegum_ticks = buffer->getUInt16();
+        m_bubblegum_ticks = (int16_t)br->getTicks();
     else
         m_bubblegum_ticks = 0;
 
     if (read_plunger)
-        m_view_blocked_by_plunger = buffer->getUInt16();
+        m_view_blocked_by_plunger = (int16_t)br->getTicks();
     else
         m_view_blocked_by_plunger = 0;
 
     if (read_invulnerable)
-        m_invulnerable_ticks = buffer->getUInt16();
+        m_invulnerable_ticks = (int16_t)br->getTicks();
     else
         m_invulnerable_ticks = 0;
 
     if (read_energy)
     {
-        float nitro = buffer->getFloat();
+        float nitro = br->getFixed(0.0f, 1024.0f, 16);
         setEnergy(nitro);
     }
     else
@@ -333,6 +325,7 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
     // -----------
     if (has_animation_in_state)
     {
+        br.reset();
         KartAnimationType kat = (KartAnimationType)(buffer->getUInt8());
         if (!m_kart_animation ||
             m_kart_animation->getAnimationType() != kat)
@@ -377,15 +370,15 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
         // Clear any forces applied (like by plunger or bubble gum torque)
         m_body->clearForces();
         CompressNetworkBody::decompress(
-            buffer, m_body.get(), m_motion_state.get());
+            br.get(), m_body.get(), m_motion_state.get());
         // Update kart transform in case that there are access to its value
         // before Moveable::update() is called (which updates the transform)
         m_transform = m_body->getWorldTransform();
 
         if (read_timed_rotation)
         {
-            uint16_t time_rot = buffer->getUInt16();
-            float timed_rotation_y = buffer->getFloat();
+            uint16_t time_rot = (uint16_t)br->getTicks();
+            float timed_rotation_y = br->getFloat();
             // Set timed rotation divides by time_rot
             m_vehicle->setTimedRotation(time_rot,
                 stk_config->ticks2Time(time_rot) * timed_rotation_y);
@@ -395,13 +388,16 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
 
         // Collision rewind
         if (read_bounce_back)
-            m_bounce_back_ticks = buffer->getUInt8();
+            m_bounce_back_ticks = (uint8_t)br->getBits(8);
         else
             m_bounce_back_ticks = 0;
         if (read_impulse)
         {
-            uint16_t central_impulse_ticks = buffer->getUInt16();
-            Vec3 additional_impulse = buffer->getVec3();
+            uint16_t central_impulse_ticks = (uint16_t)br->getTicks();
+            Vec3 additional_impulse;
+            additional_impulse.setX(br->getFloat());
+            additional_impulse.setY(br->getFloat());
+            additional_impulse.setZ(br->getFloat());
             m_vehicle->setTimedCentralImpulse(central_impulse_ticks,
                 additional_impulse, true/*rewind*/);
         }
@@ -414,6 +410,7 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
         // would still point at the kart position at the previous rewind
         // (i.e. different terrain --> different slowdown).
         m_vehicle->updateAllWheelTransformsWS();
+        br.reset();
     }
 
     // 4) Attachment, powerup, nitro
@@ -430,13 +427,11 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
     else
         getPowerup()->set(PowerupManager::POWERUP_NOTHING, 0);
 
-    // 5) Max speed info
-    // ------------------
-    m_max_speed->rewindTo(buffer);
-
-    // 6) Skidding
-    // -----------
-    m_skidding->rewindTo(buffer);
+    // 5) Max speed info and skidding
+    // ------------------------------
+    br.reset(new BitReader(buffer));
+    m_max_speed->rewindTo(br.get());
+    m_skidding->rewindTo(br.get());
 
 }   // restoreState
 
@@ -446,6 +441,17 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
  */
 void KartRewinder::update(int ticks)
 {
+    // The server rounds the fixed point values of the kart state when saving
+    // it, do the same at the same time (the body is rounded in Kart::update)
+    if (!m_eliminated && NetworkConfig::get()->roundValuesNow())
+    {
+        BareNetworkString discard;
+        BitWriter bw(&discard);
+        if (getEnergy() > 0.0f)
+            setEnergy(bw.addFixed(getEnergy(), 0.0f, 1024.0f, 16));
+        m_max_speed->saveState(&bw);
+        m_skidding->saveState(&bw);
+    }
     Kart::update(ticks);
 }   // update
 
@@ -498,3 +504,56 @@ std::function<void()> KartRewinder::getLocalStateRestoreFunction()
         m_skidding->m_remaining_jump_time = remaining_jump_time;
     };
 }   // getLocalStateRestoreFunction
+
+// ----------------------------------------------------------------------------
+/** Returns a function which gives the kart back the values saveState rounds
+ *  to fixed point (physics, energy, skidding and slowdowns), as they are now.
+ *  It allows saving and restoring a state locally without changing the kart.
+ */
+std::function<void()> KartRewinder::getExactStateRestoreFunction()
+{
+    if (m_eliminated)
+        return nullptr;
+
+    const btTransform trans = m_body->getWorldTransform();
+    const btTransform interpolation_trans =
+        m_body->getInterpolationWorldTransform();
+    btTransform motion_trans;
+    m_motion_state->getWorldTransform(motion_trans);
+    const btVector3 lv = m_body->getLinearVelocity();
+    const btVector3 av = m_body->getAngularVelocity();
+    const btVector3 interpolation_lv = m_body->getInterpolationLinearVelocity();
+    const btVector3 interpolation_av =
+        m_body->getInterpolationAngularVelocity();
+    const float energy = getEnergy();
+    const float skid_factor = m_skidding->m_skid_factor;
+    const float visual_rotation = m_skidding->m_visual_rotation;
+    float current_fraction[MaxSpeed::MS_DECREASE_MAX];
+    for (unsigned i = 0; i < MaxSpeed::MS_DECREASE_MAX; i++)
+    {
+        current_fraction[i] =
+            m_max_speed->m_speed_decrease[i].m_current_fraction;
+    }
+
+    return [trans, interpolation_trans, motion_trans, lv, av,
+        interpolation_lv, interpolation_av, energy, skid_factor,
+        visual_rotation, current_fraction, this]()
+    {
+        m_body->setWorldTransform(trans);
+        m_body->setInterpolationWorldTransform(interpolation_trans);
+        m_motion_state->setWorldTransform(motion_trans);
+        m_body->setLinearVelocity(lv);
+        m_body->setAngularVelocity(av);
+        m_body->setInterpolationLinearVelocity(interpolation_lv);
+        m_body->setInterpolationAngularVelocity(interpolation_av);
+        m_body->updateInertiaTensor();
+        setEnergy(energy);
+        m_skidding->m_skid_factor = skid_factor;
+        m_skidding->m_visual_rotation = visual_rotation;
+        for (unsigned i = 0; i < MaxSpeed::MS_DECREASE_MAX; i++)
+        {
+            m_max_speed->m_speed_decrease[i].m_current_fraction =
+                current_fraction[i];
+        }
+    };
+}   // getExactStateRestoreFunction
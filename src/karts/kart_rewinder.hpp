@@ -47,6 +47,9 @@ public:
     virtual void rewindToEvent(BareNetworkString *p) OVERRIDE {}
     virtual void update(int ticks) OVERRIDE;
     // -------------------------------------------------------------------------
+    /** True if the last restored server state contained this kart. */
+    bool hasServerState() const                  { return m_has_server_state; }
+    // -------------------------------------------------------------------------
     virtual float getSteerPercent() const OVERRIDE
     {
         if (m_steering_smoothing_dt >= 0.0f)
@@ -73,6 +76,8 @@ public:
     virtual void undoEvent(BareNetworkString *p) OVERRIDE {}
     // ------------------------------------------------------------------------
     virtual std::function<void()> getLocalStateRestoreFunction() OVERRIDE;
+    // ------------------------------------------------------------------------
+    std::function<void()> getExactStateRestoreFunction();
 
 
 };   // Rewinder
@@ -21,7 +21,7 @@
 #include "config/stk_config.hpp"
 #include "karts/abstract_kart.hpp"
 #include "karts/kart_properties.hpp"
-#include "network/network_string.hpp"
+#include "network/bit_stream.hpp"
 #include "physics/btKart.hpp"
 
 #include <algorithm>
@@ -220,24 +220,24 @@ void MaxSpeed::SpeedIncrease::update(int ticks)
 }   // SpeedIncrease::update
 
 // ----------------------------------------------------------------------------
-void MaxSpeed::SpeedIncrease::saveState(BareNetworkString *buffer) const
+void MaxSpeed::SpeedIncrease::saveState(BitWriter *buffer)
 {
-    buffer->addUInt16(m_max_add_speed);
-    buffer->addUInt16(m_duration);
-    buffer->addUInt16(m_fade_out_time);
-    buffer->addUInt16(m_engine_force);
+    buffer->addBits(m_max_add_speed, 16);
+    buffer->addTicks(m_duration);
+    buffer->addTicks(m_fade_out_time);
+    buffer->addBits(m_engine_force, 16);
 }   // saveState
 
 // ----------------------------------------------------------------------------
-void MaxSpeed::SpeedIncrease::rewindTo(BareNetworkString *buffer,
+void MaxSpeed::SpeedIncrease::rewindTo(BitReader *buffer,
                                        bool is_active)
 {
     if(is_active)
     {
-        m_max_add_speed   = buffer->getUInt16();
-        m_duration        = buffer->getUInt16();
-        m_fade_out_time   = buffer->getUInt16();
-        m_engine_force    = buffer->getUInt16();
+        m_max_add_speed   = (uint16_t)buffer->getBits(16);
+        m_duration        = (int16_t)buffer->getTicks();
+        m_fade_out_time   = (int16_t)buffer->getTicks();
+        m_engine_force    = (uint16_t)buffer->getBits(16);
     }
     else   // make sure to disable this category
     {
@@ -337,26 +337,28 @@ void MaxSpeed::SpeedDecrease::update(int ticks)
  *  if the speed decrease is not active.
  *  \param buffer Buffer which will store the state information.
  */
-void MaxSpeed::SpeedDecrease::saveState(BareNetworkString *buffer) const
+void MaxSpeed::SpeedDecrease::saveState(BitWriter *buffer)
 {
-    buffer->addUInt16(m_max_speed_fraction);
-    buffer->addFloat(m_current_fraction);
-    buffer->addUInt16(m_fade_in_ticks);
-    buffer->addUInt16(m_duration);
+    buffer->addBits(m_max_speed_fraction, 16);
+    // Keep the rounded value, so the server continues with what clients get
+    m_current_fraction = buffer->addFixed(m_current_fraction, 0.0f, 32768.0f,
+                                          16);
+    buffer->addTicks(m_fade_in_ticks);
+    buffer->addTicks(m_duration);
 }   // saveState
 
 // ----------------------------------------------------------------------------
 /** Restores a previously saved state for an active speed decrease category.
  */
-void MaxSpeed::SpeedDecrease::rewindTo(BareNetworkString *buffer,
+void MaxSpeed::SpeedDecrease::rewindTo(BitReader *buffer,
                                        bool is_active)
 {
     if(is_active)
     {
-        m_max_speed_fraction = buffer->getUInt16();
-        m_current_fraction   = buffer->getFloat();
-        m_fade_in_ticks      = buffer->getUInt16();
-        m_duration           = buffer->getUInt16();
+        m_max_speed_fraction = (uint16_t)buffer->getBits(16);
+        m_current_fraction   = buffer->getFixed(0.0f, 32768.0f, 16);
+        m_fade_in_ticks      = (int16_t)buffer->getTicks();
+        m_duration           = (int16_t)buffer->getTicks();
     }
     else   // make sure it is not active
     {
@@ -455,7 +457,7 @@ void MaxSpeed::update(int ticks)
 /** Saves the speed data in a network string for rewind.
  *  \param buffer Pointer to the network string to store the data.
  */
-void MaxSpeed::saveState(BareNetworkString *buffer) const
+void MaxSpeed::saveState(BitWriter *buffer)
 {
     // Save the slowdown states
     // ------------------------
@@ -469,7 +471,7 @@ void MaxSpeed::saveState(BareNetworkString *buffer) const
         if (m_speed_decrease[i].isActive()) 
             active_slowdown |= b;
     }
-    buffer->addUInt8(active_slowdown);
+    buffer->addBits(active_slowdown, MS_DECREASE_MAX);
 
     for(unsigned int i=MS_DECREASE_MIN, b=1; i<MS_DECREASE_MAX; i++, b <<= 1)
     {
@@ -491,7 +493,7 @@ void MaxSpeed::saveState(BareNetworkString *buffer) const
         if(m_speed_increase[i].isActive())
             active_speedups |= b;
     }
-    buffer->addUInt8(active_speedups);
+    buffer->addBits(active_speedups, MS_INCREASE_MAX);
     for(unsigned int i=MS_INCREASE_MIN, b=1; i<MS_INCREASE_MAX; i++, b <<= 1)
     {
         if(active_speedups & b)
@@ -504,12 +506,12 @@ void MaxSpeed::saveState(BareNetworkString *buffer) const
 /** Restore a saved state.
  *  \param buffer Saved state.
  */
-void MaxSpeed::rewindTo(BareNetworkString *buffer)
+void MaxSpeed::rewindTo(BitReader *buffer)
 {
     // Restore the slowdown states
     // ---------------------------
     // Get the bit pattern of all active slowdowns
-    uint8_t active_slowdown = buffer->getUInt8();
+    uint8_t active_slowdown = (uint8_t)buffer->getBits(MS_DECREASE_MAX);
 
     for(unsigned int i=MS_DECREASE_MIN, b=1; i<MS_DECREASE_MAX; i++, b <<= 1)
     {
@@ -525,7 +527,7 @@ void MaxSpeed::rewindTo(BareNetworkString *buffer)
     // Restore the speedup state
     // --------------------------
     // Get the bit pattern of all active speedups
-    uint8_t active_speedups = buffer->getUInt8();
+    uint8_t active_speedups = (uint8_t)buffer->getBits(MS_INCREASE_MAX);
     for(unsigned int i=MS_INCREASE_MIN, b=1; i<MS_INCREASE_MAX; i++, b <<= 1)
     {
         m_speed_increase[i].rewindTo(buffer, (active_speedups & b) == b);
@@ -29,7 +29,7 @@
 #include "karts/max_speed.hpp"
 #include "karts/controller/controller.hpp"
 #include "modes/world.hpp"
-#include "network/network_string.hpp"
+#include "network/bit_stream.hpp"
 #include "network/rewind_manager.hpp"
 #include "physics/btKart.hpp"
 #include "tracks/track.hpp"
@@ -99,24 +99,26 @@ void Skidding::reset()
  *  m_skid_bonus_ready
  *  \param buffer Buffer for the state information. 
  */
-void Skidding::saveState(BareNetworkString *buffer)
+void Skidding::saveState(BitWriter *buffer)
 {
-    buffer->addUInt8(m_skid_state);
-    buffer->addUInt16(m_skid_time);
-    buffer->addFloat(m_skid_factor);
-    buffer->addFloat(m_visual_rotation);
+    buffer->addBits(m_skid_state, 3);
+    buffer->addTicks(m_skid_time);
+    // Keep the rounded values, so the server continues with what clients get
+    m_skid_factor = buffer->addFixed(m_skid_factor, 0.0f, 4096.0f, 16);
+    m_visual_rotation = buffer->addFixed(m_visual_rotation, -8.0f, 4096.0f,
+                                         16);
 }   // saveState
 
 // ----------------------------------------------------------------------------
 /** Restores the skidding state of a kart.
  *  \param buffer Buffer with state information. 
  */
-void Skidding::rewindTo(BareNetworkString *buffer)
+void Skidding::rewindTo(BitReader *buffer)
 {
-    m_skid_state = (SkidState)buffer->getUInt8();
-    m_skid_time = buffer->getUInt16();
-    m_skid_factor = buffer->getFloat();
-    m_visual_rotation = buffer->getFloat();
+    m_skid_state = (SkidState)buffer->getBits(3);
+    m_skid_time = (uint16_t)buffer->getTicks();
+    m_skid_factor = buffer->getFixed(0.0f, 4096.0f, 16);
+    m_visual_rotation = buffer->getFixed(-8.0f, 4096.0f, 16);
 }   // rewindTo
 
 // ----------------------------------------------------------------------------
@@ -24,7 +24,8 @@
 #include "utils/no_copy.hpp"
 #include "utils/types.hpp"
 
-class BareNetworkString;
+class BitReader;
+class BitWriter;
 class Kart;
 class ShowCurve;
 
@@ -111,8 +112,8 @@ public:
     float updateGraphics(float dt);
     void update(int dt, bool is_on_ground, float steer,
                 KartControl::SkidControl skidding);
-    void saveState(BareNetworkString *buffer);
-    void rewindTo(BareNetworkString *buffer);
+    void saveState(BitWriter *buffer);
+    void rewindTo(BitReader *buffer);
     // ------------------------------------------------------------------------
     /** Determines how much the graphics model of the kart should be rotated
      *  additionally (for skidding), depending on how long the kart has been
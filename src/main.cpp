@@ -208,6 +208,7 @@
 #include "input/keyboard_device.hpp"
 #include "input/wiimote_manager.hpp"
 #include "io/file_manager.hpp"
+#include "io/xml_node.hpp"
 #include "items/attachment_manager.hpp"
 #include "items/item_manager.hpp"
 #include "items/network_item_manager.hpp"
@@ -224,21 +225,32 @@
 #include "network/protocols/connect_to_server.hpp"
 #include "network/protocols/client_lobby.hpp"
 #include "network/protocols/server_lobby.hpp"
+#include "network/bit_stream.hpp"
+#include "network/client_swarm.hpp"
+#include "network/game_events.hpp"
+#include "network/handshake_pipeline.hpp"
 #include "network/network.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
+#include "network/packet_capture.hpp"
+#include "network/packet_replay.hpp"
 #include "network/protocols/connect_to_server.hpp"
 #include "network/protocols/client_lobby.hpp"
 #include "network/protocols/server_lobby.hpp"
 #include "network/race_event_manager.hpp"
+#include "network/rewind_islands.hpp"
 #include "network/rewind_manager.hpp"
+#include "network/records_index.hpp"
 #include "network/rewind_queue.hpp"
 #include "network/server.hpp"
 #include "network/server_config.hpp"
 #include "network/servers_manager.hpp"
+#include "network/soccer_ranking.hpp"
 #include "network/socket_address.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
+#include "network/team_balancer.hpp"
+#include "online/http_multi_executor.hpp"
 #include "online/profile_manager.hpp"
 #include "online/request_manager.hpp"
 #include "race/grand_prix_manager.hpp"
@@ -267,6 +279,7 @@
 #include "utils/profiler.hpp"
 #include "utils/stk_process.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/tick_scheduler.hpp"
 #include "utils/translation.hpp"
 
 static void cleanSuperTuxKart();
@@ -594,6 +607,12 @@ void cmdLineHelp()
     "       --server-id=n      Server id in stk addons for --connect-now.\n"
     "       --network-ai=n     Numbers of AI for connecting to linear race server, used\n"
     "                          together with --connect-now.\n"
+    "       --swarm=n          Simulate n light clients on the --connect-now server for load\n"
+    "                          testing, they chat, race, leave and live join (LAN only).\n"
+    "       --swarm-time=n     Seconds to run the clients of --swarm (default 60).\n"
+    "       --replay-capture=file Run the server of --server-config on a packet capture (see\n"
+    "                          packet-capture in the server config) without network, and\n"
+    "                          report the tick times and differences to the capture.\n"
     "       --login=s          Automatically log in (set the login).\n"
     "       --password=s       Automatically log in (set the password).\n"
     "       --init-user        Save the above login and password (if set) in config.\n"
@@ -625,6 +644,12 @@ void cmdLineHelp()
     "       --log=N            Set the verbosity to a value between\n"
     "                          0 (Debug) and 5 (Only Fatal messages)\n"
     "       --logbuffer=N      Buffers up to N lines log lines before writing.\n"
+    "       --log-async        Write log lines from a background thread.\n"
+    "       --log-rate-limit=N Log at most N info or lower lines per second\n"
+    "                          for each component and message.\n"
+    "       --log-rotate=N     Rotate the log file after N MB (needs\n"
+    "                          --log-async).\n"
+    "       --log-rotate-count=N Number of rotated log files to keep.\n"
     "       --root=DIR         Path to add to the list of STK root directories.\n"
     "                          You can specify more than one by separating them\n"
     "                          with colons (:).\n"
@@ -706,6 +731,17 @@ int handleCmdLineOutputModifier()
         Log::setLogLevel(n);
     if (CommandLine::has("--logbuffer", &n))
         Log::setBufferSize(n);
+    if (CommandLine::has("--log-async"))
+        Log::setAsync(true);
+    if (CommandLine::has("--log-rate-limit", &n) && n >= 0)
+        Log::setRateLimit(n);
+    if (CommandLine::has("--log-rotate", &n) && n > 0)
+    {
+        int count = 3;
+        CommandLine::has("--log-rotate-count", &count);
+        Log::setRotation((size_t)n * 1024 * 1024,
+            count < 0 ? 0 : (unsigned)count);
+    }
 
     if(CommandLine::has("--log=nocolor"))
     {
@@ -1184,6 +1220,15 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
         }
     }
 
+    if (NetworkConfig::get()->isServer() &&
+        CommandLine::has("--replay-capture"))
+    {
+        // Replays run offline as LAN server, see PacketReplay
+        STKHost::m_packet_replay = true;
+        ServerConfig::m_wan_server = false;
+        ServerConfig::m_validating_player = false;
+    }
+
     if (CommandLine::has("--network-console"))
     {
         ServerConfig::m_enable_console = true;
@@ -1333,6 +1378,26 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
     bool has_addr = CommandLine::has("--connect-now", &addr);
     if (has_addr)
     {
+        int swarm_size = 0;
+        if (CommandLine::has("--swarm", &swarm_size) && swarm_size > 0)
+        {
+            SocketAddress swarm_addr(addr);
+            if (swarm_addr.getIP() == 0 && !swarm_addr.isIPv6())
+            {
+                Log::error("Main", "Invalid server address: %s",
+                    addr.c_str());
+                cleanSuperTuxKart();
+                return false;
+            }
+            if (swarm_addr.getPort() == 0)
+                swarm_addr.setPort(stk_config->m_server_port);
+            int seconds = 60;
+            CommandLine::has("--swarm-time", &seconds);
+            ClientSwarm swarm(swarm_addr, swarm_size, server_password);
+            swarm.run(seconds);
+            cleanSuperTuxKart();
+            return false;
+        }
         NetworkConfig::get()->setIsServer(false);
         if (CommandLine::has("--network-ai", &n))
         {
@@ -1719,6 +1784,18 @@ void clearGlobalVariables()
     GUIEngine::resetGlobalVariables();
 }   // clearGlobalVariables
 
+//=============================================================================
+/** Logs the time a startup phase took and starts timing the next one.
+ *  \param phase Name of the finished phase.
+ *  \param start Start time of the phase, set to the current time.
+ */
+static void logStartupPhase(const char* phase, uint64_t* start)
+{
+    uint64_t now = StkTime::getMonoTimeMs();
+    Log::info("main", "Startup: %s took %dms.", phase, (int)(now - *start));
+    *start = now;
+}   // logStartupPhase
+
 //=============================================================================
 void initRest()
 {
@@ -1816,16 +1893,20 @@ void initRest()
         kart_properties_manager->loadCharacteristics(&characteristicsNode);
     }
 
+    uint64_t phase_start = StkTime::getMonoTimeMs();
     track_manager->loadTrackList();
+    logStartupPhase("loading tracks", &phase_start);
     music_manager->addMusicToTracks();
 
     GUIEngine::addLoadingIcon(irr_driver->getTexture(FileManager::GUI_ICON,
                                                      "notes.png"      ) );
 
+    phase_start = StkTime::getMonoTimeMs();
     grand_prix_manager      = new GrandPrixManager     ();
     // Consistency check for challenges, and enable all challenges
     // that have all prerequisites fulfilled
     grand_prix_manager->checkConsistency();
+    logStartupPhase("loading grand prix", &phase_start);
     GUIEngine::addLoadingIcon( irr_driver->getTexture(FileManager::GUI_ICON,
                                                       "cup_gold.png"    ) );
 
@@ -2062,7 +2143,9 @@ int main(int argc, char *argv[])
         }
         else
             main_loop = new MainLoop(0/*parent_pid*/);
+        uint64_t phase_start = StkTime::getMonoTimeMs();
         material_manager->loadMaterial();
+        logStartupPhase("loading materials", &phase_start);
 
         // Preload the explosion effects (explode.png)
         ParticleKindManager::get()->getParticles("explosion.xml");
@@ -2072,7 +2155,9 @@ int main(int argc, char *argv[])
 
         GUIEngine::addLoadingIcon( irr_driver->getTexture(FileManager::GUI_ICON,
                                                           "options_video.png"));
+        phase_start = StkTime::getMonoTimeMs();
         kart_properties_manager -> loadAllKarts    ();
+        logStartupPhase("loading karts", &phase_start);
         handleXmasMode();
         handleEasterEarMode();
 
@@ -2347,7 +2432,15 @@ int main(int argc, char *argv[])
             RaceManager::get()->startNew(false);
         }
 
-        main_loop->run();
+        std::string capture;
+        if (STKHost::m_packet_replay &&
+            CommandLine::has("--replay-capture", &capture))
+        {
+            PacketReplay replay(capture);
+            replay.run();
+        }
+        else
+            main_loop->run();
 
     }  // try
     catch (std::exception &e)
@@ -2607,6 +2700,42 @@ void runUnitTests()
     Log::info("UnitTest", "RewindQueue");
     RewindQueue::unitTesting();
 
+    Log::info("UnitTest", "RecordsIndex");
+    RecordsIndex::unitTesting();
+
+    Log::info("UnitTest", "HTTPMultiExecutor");
+    Online::HTTPMultiExecutor::unitTesting();
+
+    Log::info("UnitTest", "SoccerRanking");
+    SoccerRanking::unitTesting();
+
+    Log::info("UnitTest", "TeamBalancer");
+    TeamBalancer::unitTesting();
+
+    Log::info("UnitTest", "XMLNode");
+    XMLNode::unitTesting();
+
+    Log::info("UnitTest", "GameEvents");
+    GameEvents::unitTesting();
+
+    Log::info("UnitTest", "ClientSwarm");
+    ClientSwarm::unitTesting();
+
+    Log::info("UnitTest", "RewindIslands");
+    RewindIslands::unitTesting();
+
+    Log::info("UnitTest", "BitStream");
+    BitWriter::unitTesting();
+
+    Log::info("UnitTest", "TickScheduler");
+    TickScheduler::unitTesting();
+
+    Log::info("UnitTest", "PacketCapture");
+    PacketCapture::unitTesting();
+
+    Log::info("UnitTest", "HandshakePipeline");
+    HandshakePipeline::unitTesting();
+
     Log::info("UnitTest", "=====================");
     Log::info("UnitTest", "Testing successful   ");
     Log::info("UnitTest", "=====================");
@@ -45,6 +45,7 @@
 #include "network/race_event_manager.hpp"
 #include "network/rewind_manager.hpp"
 #include "network/server.hpp"
+#include "network/server_config.hpp"
 #include "network/stk_host.hpp"
 #include "online/request_manager.hpp"
 #include "race/history.hpp"
@@ -54,6 +55,7 @@
 #include "states_screens/state_manager.hpp"
 #include "utils/profiler.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/tick_scheduler.hpp"
 #include "utils/time.hpp"
 #include "utils/translation.hpp"
 
@@ -445,10 +447,45 @@ void MainLoop::run()
 
         PROFILER_PUSH_CPU_MARKER("Main loop", 0xFF, 0x00, 0xF7);
 
-        left_over_time += getLimitedDt();
-        int num_steps   = stk_config->time2Ticks(left_over_time);
+        // A server without graphics uses a microsecond tick scheduler, as
+        // there is no frame rate to limit
+        const bool use_scheduler = GUIEngine::isNoGraphics() &&
+            !ProfileWorld::isProfileMode() &&
+            NetworkConfig::get()->isNetworking() &&
+            NetworkConfig::get()->isServer();
+        if (use_scheduler && !m_tick_scheduler)
+        {
+            m_tick_scheduler.reset(new TickScheduler("MainLoop",
+                stk_config->getPhysicsFPS(),
+                ServerConfig::m_max_ticks_per_frame,
+                ServerConfig::m_tick_watchdog));
+        }
+        else if (!use_scheduler && m_tick_scheduler)
+        {
+            m_tick_scheduler.reset();
+            m_curr_time = StkTime::getMonoTimeMs();
+        }
+        TickScheduler* scheduler = m_tick_scheduler.get();
+
+        int num_steps;
         float dt = stk_config->ticks2Time(1);
-        left_over_time -= num_steps * dt ;
+        if (scheduler)
+        {
+            // Without a world nothing has to stay in step with the clients,
+            // so limit the catch-up like getLimitedDt() limits the time step
+            if (!World::getWorld() && !m_allow_large_dt)
+            {
+                scheduler->limitLag(StkTime::getMonoTimeUs(),
+                    stk_config->time2Ticks(3.0f / 60.0f));
+            }
+            num_steps = scheduler->waitForTicks();
+        }
+        else
+        {
+            left_over_time += getLimitedDt();
+            num_steps = stk_config->time2Ticks(left_over_time);
+            left_over_time -= num_steps * dt;
+        }
 
         // Shutdown next frame if shutdown request is sent while loading the
         // world
@@ -568,6 +605,7 @@ void MainLoop::run()
             if (!m_download_assets)
             {
                 PROFILER_PUSH_CPU_MARKER("Database polling update", 0x00, 0x7F, 0x7F);
+                TickScheduler::Section section(scheduler, "requests");
                 Online::RequestManager::get()->update(frame_duration);
                 PROFILER_POP_CPU_MARKER();
             }
@@ -610,10 +648,14 @@ void MainLoop::run()
                                        World::getWorld()->getTicksSinceStart());
                 }
 
+                if (scheduler)
+                    scheduler->startTick();
                 PROFILER_PUSH_CPU_MARKER("Protocol manager update",
                                          0x7F, 0x00, 0x7F);
                 if (auto pm = ProtocolManager::lock())
                 {
+                    TickScheduler::Section section(scheduler,
+                                                   "protocol manager");
                     pm->update(1);
                 }
                 PROFILER_POP_CPU_MARKER();
@@ -621,9 +663,12 @@ void MainLoop::run()
                 PROFILER_PUSH_CPU_MARKER("Update race", 0, 255, 255);
                 if (World::getWorld())
                 {
+                    TickScheduler::Section section(scheduler, "world");
                     updateRace(1, fast_forward);
                 }
                 PROFILER_POP_CPU_MARKER();
+                if (scheduler)
+                    scheduler->endTick();
 
                 // We need to check again because update_race may have requested
                 // the main loop to abort; and it's not a good idea to continue
@@ -639,6 +684,8 @@ void MainLoop::run()
                     m_frame_before_loading_world = false;
                     m_curr_time = StkTime::getMonoTimeMs();
                     left_over_time = 0.0f;
+                    if (scheduler)
+                        scheduler->resynchronise(StkTime::getMonoTimeUs());
                     break;
                 }
 
@@ -648,6 +695,8 @@ void MainLoop::run()
                     {
                         // Skip the large num steps contributed by loading time
                         World::getWorld()->updateTime(1);
+                        if (scheduler)
+                            scheduler->resynchronise(StkTime::getMonoTimeUs());
                         break;
                     }
                     World::getWorld()->updateTime(1);
@@ -23,6 +23,9 @@
 #include "utils/synchronised.hpp"
 #include "utils/types.hpp"
 #include <atomic>
+#include <memory>
+
+class TickScheduler;
 
 /** Management class for the whole gameflow, this is where the
     main-loop is */
@@ -48,6 +51,9 @@ private:
 
     Synchronised<int> m_ticks_adjustment;
 
+    /** Schedules the ticks of a server without graphics, NULL otherwise. */
+    std::unique_ptr<TickScheduler> m_tick_scheduler;
+
     uint64_t m_curr_time;
     uint64_t m_prev_time;
     unsigned m_parent_pid;
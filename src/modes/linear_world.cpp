@@ -31,6 +31,7 @@
 #include "graphics/material.hpp"
 #include "guiengine/modaldialog.hpp"
 #include "physics/physics.hpp"
+#include "network/game_events.hpp"
 #include "network/network_config.hpp"
 #include "network/network_player_profile.hpp"
 #include "network/network_string.hpp"
@@ -409,6 +410,13 @@ void LinearWorld::newLap(unsigned int kart_index)
               m_kart_info[kart_index].m_finished_laps 
             * Track::getCurrentTrack()->getTrackLength()
             + getDistanceDownTrackForKart(kart->getWorldKartId(), true);
+        if (GameEvents::get() && kart_info.m_finished_laps > 0)
+        {
+            GameEvents::get()->push(GameEvents::GE_LAP,
+                StringUtils::wideToUtf8(kart->getController()->getName(
+                false/*include_handicap_string*/)), "", -1,
+                getTimeSinceStart(), kart_info.m_finished_laps);
+        }
     }
     // Last lap message (kart_index's assert in previous block already)
     if (raceHasLaps() && kart_info.m_finished_laps+1 == lap_count)
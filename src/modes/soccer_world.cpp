@@ -28,9 +28,11 @@
 #include "karts/kart_properties.hpp"
 #include "karts/controller/local_player_controller.hpp"
 #include "karts/controller/network_player_controller.hpp"
+#include "network/game_events.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
 #include "network/server_config.hpp"
+#include "network/soccer_ranking.hpp"
 #include "network/protocols/game_events_protocol.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
@@ -517,17 +519,77 @@ void add_goalscore(std::string player_name)
 {
     // Datei erstellen
     std::string singdrossel;
-    singdrossel="python3 update_list.py "+player_name+" goals 0 3vs3 &";
-    system(singdrossel.c_str());
+    singdrossel="python3 update_list.py "+SoccerRanking::escapeArgument(player_name)+" goals 0 3vs3";
+    SoccerRanking::get()->runCommand(singdrossel);
 }
 
 void add_gamescore(std::string player_name)
 {
     std::string ringdrossel;
-    ringdrossel="python3 update_list.py "+player_name+" games 0 3vs3 &";
-    system(ringdrossel.c_str());
+    ringdrossel="python3 update_list.py "+SoccerRanking::escapeArgument(player_name)+" games 0 3vs3";
+    SoccerRanking::get()->runCommand(ringdrossel);
 }
 
+/** Runs the python scripts of older versions which count the goals of the
+ *  current match, on the ranking worker thread. */
+void runGoalScripts(const std::string& player_name, bool own_goal,
+                    KartTeam team)
+{
+    std::string singdrossel;
+    if (!own_goal)
+    {
+        if (ServerConfig::m_rank_3vs3) add_goalscore(player_name);
+        if (ServerConfig::m_rank_1vs1)
+            singdrossel="python3 current_1vs1_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 1vs1 0";
+        else if (ServerConfig::m_rank_1vs1_2)
+            singdrossel="python3 current_1vs1_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 1vs1_2 0";
+        else if (ServerConfig::m_rank_1vs1_3)
+            singdrossel="python3 current_1vs1_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 1vs1_3 0";
+        else if (ServerConfig::m_rank_soccer)
+        {
+            singdrossel="python3 current_ranked-soccer_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 0";
+            if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel="python3 current_super_mp_quali_players_update_goals2.py "+SoccerRanking::escapeArgument(player_name)+" 0";
+            else if (ServerConfig::m_super_mp_quali) singdrossel="python3 current_super_mp_quali_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 0";
+        }
+        if (!singdrossel.empty())
+            SoccerRanking::get()->runCommand(singdrossel);
+        if (ServerConfig::m_super_tournament && ServerConfig::m_count_supertournament_game)
+        {
+            std::string bluename=ServerConfig::m_blue_team_name;
+            std::string redname=ServerConfig::m_red_team_name;
+            if (team==KART_TEAM_RED)
+                SoccerRanking::get()->runCommand("python3 supertournament_updatecurrentgoals.py "+SoccerRanking::escapeArgument(player_name)+" "+SoccerRanking::escapeArgument(redname));
+            if (team==KART_TEAM_BLUE)
+                SoccerRanking::get()->runCommand("python3 supertournament_updatecurrentgoals.py "+SoccerRanking::escapeArgument(player_name)+" "+SoccerRanking::escapeArgument(bluename));
+        }
+        return;
+    }
+
+    if (ServerConfig::m_count_supertournament_game)
+    {
+        std::string bluename=ServerConfig::m_blue_team_name;
+        std::string redname=ServerConfig::m_red_team_name;
+        if (team==KART_TEAM_RED)
+            SoccerRanking::get()->runCommand("python3 supertournament_updatecurrentgoals.py red_own_goals "+SoccerRanking::escapeArgument(bluename));
+        if (team==KART_TEAM_BLUE)
+            SoccerRanking::get()->runCommand("python3 supertournament_updatecurrentgoals.py blue_own_goals "+SoccerRanking::escapeArgument(redname));
+    }
+    if (ServerConfig::m_rank_1vs1)
+        singdrossel="python3 current_1vs1_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 1vs1 own_goal";
+    else if (ServerConfig::m_rank_1vs1_2)
+        singdrossel="python3 current_1vs1_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 1vs1_2 own_goal";
+    else if (ServerConfig::m_rank_1vs1_3)
+        singdrossel="python3 current_1vs1_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" 1vs1_3 own_goal";
+    else if (ServerConfig::m_rank_soccer)
+    {
+        singdrossel="python3 current_ranked-soccer_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" own_goal";
+        if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel="python3 current_super_mp_quali_players_update_goals2.py "+SoccerRanking::escapeArgument(player_name)+" own_goal";
+        else if (ServerConfig::m_super_mp_quali) singdrossel="python3 current_super_mp_quali_players_update_goals.py "+SoccerRanking::escapeArgument(player_name)+" own_goal";
+    }
+    if (!singdrossel.empty())
+        SoccerRanking::get()->runCommand(singdrossel);
+}   // runGoalScripts
+
 void SoccerWorld::onCheckGoalTriggered(bool first_goal)
 {
     if (isRaceOver() || isStartPhase() ||
@@ -583,6 +645,18 @@ void SoccerWorld::onCheckGoalTriggered(bool first_goal)
         }
         std::string team_name = (first_goal ? "red team" : "blue team");
         std::string player_name = StringUtils::wideToUtf8(sd.m_player);
+        float goal_time = RaceManager::get()->hasTimeTarget() ?
+            RaceManager::get()->getTimeTarget() - getTime() : getTime();
+        if (GameEvents::get() && !stopped)
+        {
+            // first_goal means the red team scored, the scorer is added
+            // below
+            GameEvents::get()->push(sd.m_correct_goal ? GameEvents::GE_GOAL :
+                GameEvents::GE_OWN_GOAL, player_name, "",
+                first_goal ? 0 : 1, getTimeSinceStart(),
+                getTotalScore(KART_TEAM_RED) + (first_goal ? 1 : 0),
+                getTotalScore(KART_TEAM_BLUE) + (first_goal ? 0 : 1));
+        }
         // if (!stopped)
         // {
             if (sd.m_correct_goal)
@@ -591,44 +665,12 @@ void SoccerWorld::onCheckGoalTriggered(bool first_goal)
                 {
                     Log::info("SoccerWorld", "[Goal] %s scored a goal for %s",
                         player_name.c_str(), team_name.c_str());
-                        if (ServerConfig::m_rank_3vs3) add_goalscore(player_name);
-                        if (ServerConfig::m_rank_1vs1)
-                        {
-                            std::string singdrossel="python3 current_1vs1_players_update_goals.py "+player_name+" 1vs1 0 &";
-                            system(singdrossel.c_str());
-                        }
-                        else if (ServerConfig::m_rank_1vs1_2)
+                        if (SoccerRanking::get())
                         {
-                            std::string singdrossel="python3 current_1vs1_players_update_goals.py "+player_name+" 1vs1_2 0 &";
-                            system(singdrossel.c_str());
-                        }
-                        else if (ServerConfig::m_rank_1vs1_3)
-                        {
-                            std::string singdrossel="python3 current_1vs1_players_update_goals.py "+player_name+" 1vs1_3 0 &";
-                            system(singdrossel.c_str());
-                        }
-		       	else if (ServerConfig::m_rank_soccer)
-                        {
-                            std::string singdrossel="python3 current_ranked-soccer_players_update_goals.py "+player_name+" 0 &";
-                            if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel="python3 current_super_mp_quali_players_update_goals2.py "+player_name+" 0 &";
-			    else if (ServerConfig::m_super_mp_quali) singdrossel="python3 current_super_mp_quali_players_update_goals.py "+player_name+" 0 &";
-                            system(singdrossel.c_str());
-                        }
-                        if (ServerConfig::m_super_tournament && ServerConfig::m_count_supertournament_game)
-                        {
-                            std::string singdrossel;
-                            std::string bluename=ServerConfig::m_blue_team_name;
-                            std::string redname=ServerConfig::m_red_team_name;
-                            KartTeam teamrb = getKartTeam(sd.m_id);
-                            if (teamrb==KART_TEAM_RED)
-                            {
-                                singdrossel="python3 supertournament_updatecurrentgoals.py "+player_name+" "+redname + " &";
-                            }
-                            if (teamrb==KART_TEAM_BLUE)
-                            {
-                                singdrossel="python3 supertournament_updatecurrentgoals.py "+player_name+" "+bluename + " &";
-                            }
-                            system(singdrossel.c_str());
+                            SoccerRanking::get()->addGoal(player_name, false,
+                                goal_time);
+                            if (ServerConfig::m_ranking_scripts)
+                                runGoalScripts(player_name, false, getKartTeam(sd.m_id));
                         }
 
                         m_karts[sd.m_id]->getKartModel()
@@ -641,43 +683,12 @@ void SoccerWorld::onCheckGoalTriggered(bool first_goal)
                 {
                     Log::info("SoccerWorld", "[Goal] %s scored an own goal for %s",
                     player_name.c_str(), team_name.c_str());
-                    if(ServerConfig::m_count_supertournament_game)
-                    {
-                        std::string singdrossel;
-                        std::string bluename=ServerConfig::m_blue_team_name;
-                        std::string redname=ServerConfig::m_red_team_name;
-                        KartTeam teamrb = getKartTeam(sd.m_id);
-                        if (teamrb==KART_TEAM_RED)
-                        {
-                            singdrossel="python3 supertournament_updatecurrentgoals.py red_own_goals "+bluename + " &";
-                        }
-                        if (teamrb==KART_TEAM_BLUE)
-                        {
-                            singdrossel="python3 supertournament_updatecurrentgoals.py blue_own_goals "+redname + " &";
-                        }
-                        system(singdrossel.c_str());
-                    }
-		    if (ServerConfig::m_rank_1vs1)
-                    {
-                        std::string singdrossel="python3 current_1vs1_players_update_goals.py "+player_name+" 1vs1 own_goal &";
-                        system(singdrossel.c_str());
-                    }
-                    else if (ServerConfig::m_rank_1vs1_2)
-                    {
-                        std::string singdrossel="python3 current_1vs1_players_update_goals.py "+player_name+" 1vs1_2 own_goal &";
-                        system(singdrossel.c_str());
-                    }
-                    else if (ServerConfig::m_rank_1vs1_3)
-                    {
-                        std::string singdrossel="python3 current_1vs1_players_update_goals.py "+player_name+" 1vs1_3 own_goal &";
-                        system(singdrossel.c_str());
-                    }
-		    else if (ServerConfig::m_rank_soccer)
+                    if (SoccerRanking::get())
                     {
-                        std::string singdrossel="python3 current_ranked-soccer_players_update_goals.py "+player_name+" own_goal &";
-                        if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel="python3 current_super_mp_quali_players_update_goals2.py "+player_name+" own_goal &";
-			else if (ServerConfig::m_super_mp_quali) singdrossel="python3 current_super_mp_quali_players_update_goals.py "+player_name+" own_goal &";
-                        system(singdrossel.c_str());
+                        SoccerRanking::get()->addGoal(player_name, true,
+                            goal_time);
+                        if (ServerConfig::m_ranking_scripts)
+                            runGoalScripts(player_name, true, getKartTeam(sd.m_id));
                     }
                     m_karts[sd.m_id]->getKartModel()
                         ->setAnimation(KartModel::AF_LOSE_START, true/* play_non_loop*/);
@@ -1171,6 +1171,9 @@ void World::update(int ticks)
     const int kart_amount = (int)m_karts.size();
     for (int i = 0 ; i < kart_amount; ++i)
     {
+        // Karts not affected by a misprediction are left out of a rewind
+        if (RewindManager::get()->isKartFrozen(i))
+            continue;
         SpareTireAI* sta =
             dynamic_cast<SpareTireAI*>(m_karts[i]->getController());
         // Update all karts that are not eliminated
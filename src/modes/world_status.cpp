@@ -526,6 +526,15 @@ void WorldStatus::setTicksForRewind(int ticks)
     m_time = stk_config->ticks2Time(m_time_ticks);
 }   // setTicksForRewind
 
+//-----------------------------------------------------------------------------
+/** Returns the time since the start of the race in seconds, regardless of
+ *  which way the clock counts.
+ */
+float WorldStatus::getTimeSinceStart() const
+{
+    return stk_config->ticks2Time(m_count_up_ticks);
+}   // getTimeSinceStart
+
 //-----------------------------------------------------------------------------
 /** Pauses the game and switches to the specified phase.
  *  \param phase Phase to switch to.
@@ -218,6 +218,8 @@ public:
     /** Get the ticks since start regardless of which way the clock counts */
     int getTicksSinceStart() const { return m_count_up_ticks; }
     // ------------------------------------------------------------------------
+    float getTimeSinceStart() const;
+    // ------------------------------------------------------------------------
     int getAuxiliaryTicks() const { return m_auxiliary_ticks; }
     // ------------------------------------------------------------------------
     bool isLiveJoinWorld() const { return m_live_join_world; }
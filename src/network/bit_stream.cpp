@@ -0,0 +1,133 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/bit_stream.hpp"
+#include "network/compress_network_body.hpp"
+#include "utils/log.hpp"
+#include "utils/vec3.hpp"
+
+#include "btBulletDynamicsCommon.h"
+
+#include <chrono>
+#include <limits>
+
+// ----------------------------------------------------------------------------
+/** Tests that all values are read back as written, and logs the size and
+ *  encoding time of a body state compared to the previous byte aligned
+ *  layout (3 floats, the compressed quaternion and 6 half floats).
+ */
+void BitWriter::unitTesting()
+{
+    BareNetworkString bns;
+    {
+        BitWriter bw(&bns);
+        bw.addBool(true);
+        bw.addBits(5, 3);
+        bw.addBits(0xdeadbeef, 32);
+        bw.addTicks(0);
+        bw.addTicks(-3);
+        bw.addTicks(511);
+        bw.addTicks(-512);
+        bw.addTicks(30000);
+        bw.addTicks(std::numeric_limits<int16_t>::min());
+        bw.addFloat(-1.5f);
+        float f = bw.addFixed(0.3f, 0.0f, 1024.0f, 16);
+        assert(f == 307.0f / 1024.0f);
+        f = bw.addFixed(100.0f, 0.0f, 1024.0f, 16);
+        assert(f == 65535.0f / 1024.0f);
+        f = bw.addFixed(-1.0f, 0.0f, 1024.0f, 16);
+        assert(f == 0.0f);
+        (void)f;
+        bw.flush();
+        // Byte aligned data after the bits
+        bns.addUInt8(42);
+        bw.addBool(true);
+    }
+    // 1+3+32 + 4*11 + 2*18 + 32 + 3*16 = 196 bits, then one byte and one bit
+    assert(bns.size() == 25 + 1 + 1);
+
+    BitReader br(&bns);
+    assert(br.getBool());
+    assert(br.getBits(3) == 5);
+    assert(br.getBits(32) == 0xdeadbeef);
+    assert(br.getTicks() == 0);
+    assert(br.getTicks() == -3);
+    assert(br.getTicks() == 511);
+    assert(br.getTicks() == -512);
+    assert(br.getTicks() == 30000);
+    assert(br.getTicks() == std::numeric_limits<int16_t>::min());
+    assert(br.getFloat() == -1.5f);
+    assert(br.getFixed(0.0f, 1024.0f, 16) == 307.0f / 1024.0f);
+    assert(br.getFixed(0.0f, 1024.0f, 16) == 65535.0f / 1024.0f);
+    assert(br.getFixed(0.0f, 1024.0f, 16) == 0.0f);
+    assert(bns.getUInt8() == 42);
+    BitReader br2(&bns);
+    assert(br2.getBool());
+
+    // Body states relative to track bounds
+    CompressNetworkBody::setPositionBounds(Vec3(-300.0f, -20.0f, -250.0f),
+                                           Vec3(450.0f, 90.0f, 600.0f));
+    btBoxShape shape(btVector3(0.5f, 0.3f, 1.0f));
+    btDefaultMotionState ms;
+    btRigidBody body(100.0f, &ms, &shape);
+    btTransform trans;
+    trans.setOrigin(btVector3(123.4567f, 5.4321f, -87.6543f));
+    trans.setRotation(btQuaternion(btVector3(0.0f, 1.0f, 0.0f), 0.7f));
+    body.setWorldTransform(trans);
+    body.setLinearVelocity(btVector3(20.1f, -0.5f, 3.3f));
+    body.setAngularVelocity(btVector3(0.01f, 1.2f, 0.0f));
+
+    BareNetworkString state;
+    CompressNetworkBody::compress(&body, &ms, &state);
+    const unsigned packed_size = state.size();
+    const btVector3 saved = body.getWorldTransform().getOrigin();
+    assert(std::abs(saved.x() - 123.4567f) <= 0.5f / 1024.0f);
+    // Rounding again changes nothing, so server and clients agree
+    CompressNetworkBody::compress(&body, &ms);
+    assert(body.getWorldTransform().getOrigin() == saved);
+    body.setWorldTransform(btTransform::getIdentity());
+    CompressNetworkBody::decompress(&state, &body, &ms);
+    assert(body.getWorldTransform().getOrigin() == saved);
+
+    // Outside of the bounds full floats are used
+    trans.setOrigin(btVector3(5000.0f, 5.0f, 5.0f));
+    body.setWorldTransform(trans);
+    BareNetworkString outside;
+    CompressNetworkBody::compress(&body, &ms, &outside);
+    const unsigned outside_size = outside.size();
+    body.setWorldTransform(btTransform::getIdentity());
+    CompressNetworkBody::decompress(&outside, &body, &ms);
+    assert(body.getWorldTransform().getOrigin().x() == 5000.0f);
+
+    // Encoding time of the body state
+    trans.setOrigin(saved);
+    const int count = 10000;
+    BareNetworkString bench(packed_size * count);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        body.setWorldTransform(trans);
+        CompressNetworkBody::compress(&body, &ms, &bench);
+    }
+    const double ns = (double)std::chrono::duration_cast
+        <std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+        .count() / count;
+    Log::info("BitStream", "Body state: %u bytes (%u outside of the track "
+        "bounds, 28 byte aligned), %.0f ns to encode.", packed_size,
+        outside_size, ns);
+}   // unitTesting
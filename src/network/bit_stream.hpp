@@ -0,0 +1,197 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_BIT_STREAM_HPP
+#define HEADER_BIT_STREAM_HPP
+
+#include "network/network_string.hpp"
+#include "utils/no_copy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/** \ingroup network
+ *  Writes values with an arbitrary number of bits into a BareNetworkString,
+ *  most significant bit first. Full bytes are appended immediately, the last
+ *  partial byte is written (padded with zeros) by flush() or the destructor,
+ *  so byte aligned data can follow a flushed BitWriter in the same string.
+ *  The fixed point functions return the value as it will be decoded, the
+ *  sender must use it instead of the original value so that server and
+ *  clients continue the simulation with identical values.
+ */
+class BitWriter : public NoCopy
+{
+private:
+    BareNetworkString* m_buffer;
+
+    /** Bits not yet written, at most 7 between two calls. */
+    uint64_t m_bits;
+
+    unsigned m_num_bits;
+
+public:
+    BitWriter(BareNetworkString* buffer)
+        : m_buffer(buffer), m_bits(0), m_num_bits(0)                       {}
+    // ------------------------------------------------------------------------
+    ~BitWriter()                                                  { flush(); }
+    // ------------------------------------------------------------------------
+    /** Adds the lowest bits of value, bits must be at most 32. */
+    void addBits(uint32_t value, unsigned bits)
+    {
+        assert(bits <= 32);
+        if (bits == 0)
+            return;
+        m_bits = (m_bits << bits) | (value & (uint32_t)(~0ull >> (64 - bits)));
+        m_num_bits += bits;
+        while (m_num_bits >= 8)
+        {
+            m_num_bits -= 8;
+            m_buffer->addUInt8((uint8_t)(m_bits >> m_num_bits));
+        }
+        m_bits &= (1u << m_num_bits) - 1;
+    }   // addBits
+    // ------------------------------------------------------------------------
+    void addBool(bool b)                             { addBits(b ? 1 : 0, 1); }
+    // ------------------------------------------------------------------------
+    /** Adds a full precision float. */
+    void addFloat(float f)
+    {
+        uint32_t u;
+        memcpy(&u, &f, sizeof(float));
+        addBits(u, 32);
+    }   // addFloat
+    // ------------------------------------------------------------------------
+    /** Adds a timer in ticks (which can be negative for fading timers):
+     *  values up to +-511 use 11 bits, others 18 bits. */
+    void addTicks(int ticks)
+    {
+        const uint32_t zigzag = ((uint32_t)ticks << 1) ^ (uint32_t)(ticks >> 31);
+        if (zigzag < 1024)
+        {
+            addBits(0, 1);
+            addBits(zigzag, 10);
+        }
+        else
+        {
+            addBits(1, 1);
+            addBits(zigzag, 17);
+        }
+    }   // addTicks
+    // ------------------------------------------------------------------------
+    /** Adds value as unsigned fixed point number (value - min) * scale with
+     *  the given number of bits, clamped to the representable range.
+     *  \return The value the reader will get. */
+    float addFixed(float value, float min, float scale, unsigned bits)
+    {
+        const uint32_t q = quantise(value, min, scale, bits);
+        addBits(q, bits);
+        return dequantise(q, min, scale);
+    }   // addFixed
+    // ------------------------------------------------------------------------
+    static uint32_t quantise(float value, float min, float scale,
+                             unsigned bits)
+    {
+        const float max_q = (float)((1u << bits) - 1);
+        float q = std::floor((value - min) * scale + 0.5f);
+        // Also catches NaN
+        if (!(q >= 0.0f))
+            q = 0.0f;
+        return (uint32_t)std::min(q, max_q);
+    }   // quantise
+    // ------------------------------------------------------------------------
+    static float dequantise(uint32_t q, float min, float scale)
+    {
+        return min + (float)q / scale;
+    }   // dequantise
+    // ------------------------------------------------------------------------
+    /** Writes the last partial byte. */
+    void flush()
+    {
+        if (m_num_bits == 0)
+            return;
+        m_buffer->addUInt8((uint8_t)(m_bits << (8 - m_num_bits)));
+        m_bits = 0;
+        m_num_bits = 0;
+    }   // flush
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class BitWriter
+
+// ============================================================================
+/** \ingroup network
+ *  Reads the values written by a BitWriter. Bytes are taken from the string
+ *  only when needed, so after reading all values the string is positioned
+ *  behind the padding of the last byte.
+ */
+class BitReader : public NoCopy
+{
+private:
+    const BareNetworkString* m_buffer;
+
+    uint64_t m_bits;
+
+    unsigned m_num_bits;
+
+public:
+    BitReader(const BareNetworkString* buffer)
+        : m_buffer(buffer), m_bits(0), m_num_bits(0)                       {}
+    // ------------------------------------------------------------------------
+    uint32_t getBits(unsigned bits)
+    {
+        assert(bits <= 32);
+        if (bits == 0)
+            return 0;
+        while (m_num_bits < bits)
+        {
+            m_bits = (m_bits << 8) | m_buffer->getUInt8();
+            m_num_bits += 8;
+        }
+        m_num_bits -= bits;
+        const uint32_t value =
+            (uint32_t)(m_bits >> m_num_bits) & (uint32_t)(~0ull >> (64 - bits));
+        m_bits &= (1ull << m_num_bits) - 1;
+        return value;
+    }   // getBits
+    // ------------------------------------------------------------------------
+    bool getBool()                                   { return getBits(1) == 1; }
+    // ------------------------------------------------------------------------
+    float getFloat()
+    {
+        const uint32_t u = getBits(32);
+        float f;
+        memcpy(&f, &u, sizeof(float));
+        return f;
+    }   // getFloat
+    // ------------------------------------------------------------------------
+    int getTicks()
+    {
+        const uint32_t zigzag = getBool() ? getBits(17) : getBits(10);
+        return (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+    }   // getTicks
+    // ------------------------------------------------------------------------
+    float getFixed(float min, float scale, unsigned bits)
+    {
+        return BitWriter::dequantise(getBits(bits), min, scale);
+    }   // getFixed
+
+};   // class BitReader
+
+#endif
@@ -16,6 +16,7 @@
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "network/child_loop.hpp"
+#include "config/stk_config.hpp"
 #include "config/user_config.hpp"
 #include "guiengine/engine.hpp"
 #include "items/projectile_manager.hpp"
@@ -30,49 +31,10 @@
 #include "states_screens/state_manager.hpp"
 #include "utils/log.hpp"
 #include "utils/stk_process.hpp"
+#include "utils/tick_scheduler.hpp"
 #include "utils/time.hpp"
 #include "utils/vs.hpp"
 
-// ----------------------------------------------------------------------------
-float ChildLoop::getLimitedDt()
-{
-    m_prev_time = m_curr_time;
-
-    float dt = 0;
-    while (1)
-    {
-        m_curr_time = StkTime::getMonoTimeMs();
-        if (m_prev_time > m_curr_time)
-        {
-            m_prev_time = m_curr_time;
-        }
-        dt = (float)(m_curr_time - m_prev_time);
-        while (dt == 0)
-        {
-            StkTime::sleep(1);
-            m_curr_time = StkTime::getMonoTimeMs();
-            if (m_prev_time > m_curr_time)
-            {
-                Log::error("MainLopp", "System clock keeps backwards!");
-                m_prev_time = m_curr_time;
-            }
-            dt = (float)(m_curr_time - m_prev_time);
-        }
-
-        const int current_fps = (int)(1000.0f / dt);
-        const int max_fps = UserConfigParams::m_max_fps;
-        if (current_fps <= max_fps)
-            break;
-
-        int wait_time = 1000 / max_fps - 1000 / current_fps;
-        if (wait_time < 1) wait_time = 1;
-
-        StkTime::sleep(wait_time);
-    }   // while(1)
-    dt *= 0.001f;
-    return dt;
-}   // getLimitedDt
-
 // ----------------------------------------------------------------------------
 void ChildLoop::run()
 {
@@ -104,8 +66,9 @@ void ChildLoop::run()
     ServerConfig::loadServerLobbyFromConfig();
     StateManager::get()->enterMenuState();
 
-    m_curr_time = StkTime::getMonoTimeMs();
-    float left_over_time = 0;
+    TickScheduler scheduler("ChildLoop", stk_config->getPhysicsFPS(),
+        ServerConfig::m_max_ticks_per_frame, ServerConfig::m_tick_watchdog);
+    scheduler.setMaxFPS(UserConfigParams::m_max_fps);
     while (!m_abort)
     {
         if (STKHost::existHost() && STKHost::get()->requestedShutdown())
@@ -123,26 +86,35 @@ void ChildLoop::run()
             }
         }
 
-        left_over_time += getLimitedDt();
-        int num_steps = stk_config->time2Ticks(left_over_time);
-        float dt = stk_config->ticks2Time(1);
-        left_over_time -= num_steps * dt;
-
+        // Without a world nothing has to stay in step with the clients
+        if (!World::getWorld())
+        {
+            scheduler.limitLag(StkTime::getMonoTimeUs(),
+                stk_config->time2Ticks(3.0f / 60.0f));
+        }
+        const int num_steps = scheduler.waitForTicks();
         for (int i = 0; i < num_steps; i++)
         {
+            scheduler.startTick();
             if (auto pm = ProtocolManager::lock())
+            {
+                TickScheduler::Section section(&scheduler, "protocol manager");
                 pm->update(1);
+            }
 
             World* w = World::getWorld();
             if (w && w->getPhase() == WorldStatus::SETUP_PHASE)
             {
                 // Skip the large num steps contributed by loading time
                 w->updateTime(1);
+                scheduler.endTick();
+                scheduler.resynchronise(StkTime::getMonoTimeUs());
                 break;
             }
 
             if (w)
             {
+                TickScheduler::Section section(&scheduler, "world");
                 auto rem = RaceEventManager::get();
                 if (rem && rem->isRunning())
                     RaceEventManager::get()->update(1, false/*fast_forward*/);
@@ -150,6 +122,7 @@ void ChildLoop::run()
                     w->updateWorld(1);
                 w->updateTime(1);
             }
+            scheduler.endTick();
             if (m_abort)
                 break;
         }
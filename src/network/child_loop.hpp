@@ -41,15 +41,11 @@ private:
 
     std::atomic<uint32_t> m_server_online_id;
 
-    uint64_t m_curr_time;
-    uint64_t m_prev_time;
-    float getLimitedDt();
 public:
     ChildLoop(const ChildLoopConfig& clc)
         : m_cl_config(new ChildLoopConfig(clc))
     {
         m_abort = false;
-        m_prev_time = m_curr_time = 0;
         m_port = 0;
         m_server_online_id = 0;
     }
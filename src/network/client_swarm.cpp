@@ -0,0 +1,862 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/client_swarm.hpp"
+
+#include "config/stk_config.hpp"
+#include "input/input.hpp"
+#include "karts/kart_properties_manager.hpp"
+#include "network/event.hpp"
+#include "network/network.hpp"
+#include "network/network_string.hpp"
+#include "network/protocols/game_protocol.hpp"
+#include "network/protocols/lobby_protocol.hpp"
+#include "network/remote_kart_info.hpp"
+#include "network/server_config.hpp"
+#include "network/stk_ipv6.hpp"
+#include "network/stk_peer.hpp"
+#include "tracks/track_manager.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    /** Number of clients handled by one thread. */
+    const unsigned CLIENTS_PER_WORKER = 64;
+
+    /** Milliseconds between two reports of the statistics. */
+    const uint64_t REPORT_INTERVAL = 10000;
+
+    const char* const CHAT_LINES[] =
+    {
+        "gg", "hi all", "nice one", "lag?", "one more", "who is red",
+        "pass!", "wp", "brb", "let's go"
+    };
+
+    /** Header of the ping packets of STKHost. */
+    const uint8_t PING_PACKET[] = { 255, 'p', 'i', 'n', 'g' };
+}   // namespace
+
+// ============================================================================
+void ClientSwarm::Stats::reset()
+{
+    m_packets_sent = m_packets_received = 0;
+    m_bytes_sent = m_bytes_received = 0;
+    m_connected = m_refused = m_kicked = m_left = 0;
+    m_races = m_live_joins = m_chats = m_actions = m_states = 0;
+    m_handshake_ms.clear();
+    m_chat_ms.clear();
+    m_ping_ms.clear();
+}   // reset
+
+// ----------------------------------------------------------------------------
+void ClientSwarm::Stats::add(const Stats& other)
+{
+    m_packets_sent     += other.m_packets_sent;
+    m_packets_received += other.m_packets_received;
+    m_bytes_sent       += other.m_bytes_sent;
+    m_bytes_received   += other.m_bytes_received;
+    m_connected        += other.m_connected;
+    m_refused          += other.m_refused;
+    m_kicked           += other.m_kicked;
+    m_left             += other.m_left;
+    m_races            += other.m_races;
+    m_live_joins       += other.m_live_joins;
+    m_chats            += other.m_chats;
+    m_actions          += other.m_actions;
+    m_states           += other.m_states;
+    m_handshake_ms.insert(m_handshake_ms.end(), other.m_handshake_ms.begin(),
+        other.m_handshake_ms.end());
+    m_chat_ms.insert(m_chat_ms.end(), other.m_chat_ms.begin(),
+        other.m_chat_ms.end());
+    m_ping_ms.insert(m_ping_ms.end(), other.m_ping_ms.begin(),
+        other.m_ping_ms.end());
+}   // add
+
+// ============================================================================
+/** Prepares the clients, nothing is sent before run().
+ *  \param server_address Address of the server to load.
+ *  \param clients Number of simulated clients.
+ *  \param password Password of the server if it is private.
+ */
+ClientSwarm::ClientSwarm(const SocketAddress& server_address,
+                         unsigned clients, const std::string& password)
+           : m_server_address(server_address), m_password(password)
+{
+    m_stop.store(false);
+
+    std::random_device rd;
+    for (unsigned i = 0; i < clients; i++)
+    {
+        if (i % CLIENTS_PER_WORKER == 0)
+        {
+            m_workers.emplace_back(new Worker());
+            m_workers.back()->m_random.seed(rd());
+            m_workers.back()->m_last_publish = 0;
+        }
+        Worker* worker = m_workers.back().get();
+        worker->m_clients.emplace_back();
+        Client& client = worker->m_clients.back();
+        client.m_peer = NULL;
+        client.m_name = "Swarm" + StringUtils::toString(i + 1);
+        client.m_state = CS_IDLE;
+        // Relative to the start of run(), spread over the first seconds
+        client.m_connect_time = random(worker, 0, 1000 + clients * 10);
+    }
+}   // ClientSwarm
+
+// ----------------------------------------------------------------------------
+ClientSwarm::~ClientSwarm()
+{
+}   // ~ClientSwarm
+
+// ----------------------------------------------------------------------------
+/** Returns a random number between min and max (inclusive). */
+uint64_t ClientSwarm::random(Worker* worker, uint64_t min, uint64_t max)
+{
+    std::uniform_int_distribution<uint64_t> dist(min, max);
+    return dist(worker->m_random);
+}   // random
+
+// ----------------------------------------------------------------------------
+/** Runs the clients for the given time, then disconnects them and logs the
+ *  final statistics.
+ */
+void ClientSwarm::run(unsigned seconds)
+{
+    if (enet_initialize() != 0)
+    {
+        Log::error("ClientSwarm", "Could not initialize enet.");
+        return;
+    }
+    setIPv6Socket(m_server_address.isIPv6() ? 1 : 0);
+
+    // Capabilities, karts and tracks of this installation, like in
+    // ClientLobby::getKartsTracksNetworkString
+    m_assets.reset(new BareNetworkString());
+    m_assets->addUInt16((uint16_t)stk_config->m_network_capabilities.size());
+    for (const std::string& cap : stk_config->m_network_capabilities)
+        m_assets->encodeString(cap);
+    auto all_k = kart_properties_manager->getAllAvailableKarts();
+    auto all_t = track_manager->getAllTrackIdentifiers();
+    if (all_k.size() >= 65536)
+        all_k.resize(65535);
+    if (all_t.size() >= 65536)
+        all_t.resize(65535);
+    m_assets->addUInt16((uint16_t)all_k.size())
+        .addUInt16((uint16_t)all_t.size());
+    for (const std::string& kart : all_k)
+        m_assets->encodeString(kart);
+    for (const std::string& track : all_t)
+        m_assets->encodeString(track);
+
+    unsigned clients = 0;
+    for (auto& worker : m_workers)
+        clients += (unsigned)worker->m_clients.size();
+    Log::info("ClientSwarm", "Starting %u clients in %u threads against "
+        "%s for %u seconds.", clients, (unsigned)m_workers.size(),
+        m_server_address.toString().c_str(), seconds);
+
+    const uint64_t start = StkTime::getMonoTimeMs();
+    const uint64_t end_time = start + (uint64_t)seconds * 1000;
+    std::vector<std::thread> threads;
+    for (auto& worker : m_workers)
+    {
+        for (Client& client : worker->m_clients)
+            client.m_connect_time += start;
+        worker->m_last_publish = start;
+        threads.emplace_back(&ClientSwarm::runWorker, this, worker.get());
+    }
+
+    uint64_t next_report = start + REPORT_INTERVAL;
+    while (!m_stop.load())
+    {
+        const uint64_t now = StkTime::getMonoTimeMs();
+        if (now >= end_time)
+            break;
+        if (now >= next_report)
+        {
+            report(now - start);
+            next_report = now + REPORT_INTERVAL;
+        }
+        StkTime::sleep(100);
+    }
+    m_stop.store(true);
+    for (auto& thread : threads)
+        thread.join();
+    report(StkTime::getMonoTimeMs() - start);
+    enet_deinitialize();
+}   // run
+
+// ----------------------------------------------------------------------------
+/** Main loop of a thread: services the ENet hosts of its clients and
+ *  updates their state machines.
+ */
+void ClientSwarm::runWorker(Worker* worker)
+{
+    while (!m_stop.load())
+    {
+        const uint64_t now = StkTime::getMonoTimeMs();
+        for (Client& client : worker->m_clients)
+        {
+            updateClient(worker, &client, now);
+            if (!client.m_network)
+                continue;
+            ENetEvent event;
+            ENetHost* host = client.m_network->getENetHost();
+            while (client.m_network &&
+                   enet_host_service(host, &event, 0) > 0)
+            {
+                if (event.type == ENET_EVENT_TYPE_CONNECT)
+                {
+                    NetworkString* request = getConnectionRequest(client);
+                    send(worker, &client, *request);
+                    delete request;
+                    client.m_state = CS_REQUESTING;
+                }
+                else if (event.type == ENET_EVENT_TYPE_DISCONNECT)
+                {
+                    disconnected(worker, &client, now);
+                }
+                else if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                {
+                    worker->m_stats.m_packets_received++;
+                    worker->m_stats.m_bytes_received +=
+                        event.packet->dataLength;
+                    if (event.packet->dataLength > 0)
+                    {
+                        NetworkString data(event.packet->data,
+                            (int)event.packet->dataLength);
+                        try
+                        {
+                            handlePacket(worker, &client, data, now);
+                        }
+                        catch (std::exception& e)
+                        {
+                            Log::warn("ClientSwarm", "%s: invalid packet "
+                                "(%s).", client.m_name.c_str(), e.what());
+                        }
+                    }
+                    enet_packet_destroy(event.packet);
+                }
+            }
+        }
+        if (now >= worker->m_last_publish + 1000)
+            publish(worker, now);
+        StkTime::sleep(2);
+    }
+
+    // Leave properly so the server frees the slots at once
+    for (Client& client : worker->m_clients)
+    {
+        if (client.m_network && client.m_peer)
+        {
+            enet_peer_disconnect_now(client.m_peer, PDI_NORMAL);
+            enet_host_flush(client.m_network->getENetHost());
+        }
+        client.m_network.reset();
+        client.m_peer = NULL;
+    }
+    publish(worker, StkTime::getMonoTimeMs());
+}   // runWorker
+
+// ----------------------------------------------------------------------------
+/** Moves the counters of a worker to the published statistics. */
+void ClientSwarm::publish(Worker* worker, uint64_t now)
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_stats.add(worker->m_stats);
+    worker->m_stats.reset();
+    worker->m_last_publish = now;
+}   // publish
+
+// ----------------------------------------------------------------------------
+/** Time driven part of the state machine of a client. */
+void ClientSwarm::updateClient(Worker* worker, Client* client, uint64_t now)
+{
+    switch (client->m_state)
+    {
+    case CS_IDLE:
+        if (now >= client->m_connect_time)
+            connect(worker, client, now);
+        break;
+    case CS_CONNECTING:
+    case CS_REQUESTING:
+        // ENet gives up after about 30 seconds itself, the server may keep
+        // the request without answer when it is busy loading a game
+        if (now > client->m_connect_time + 60000)
+        {
+            Log::warn("ClientSwarm", "%s: no answer from the server.",
+                client->m_name.c_str());
+            enet_peer_reset(client->m_peer);
+            disconnected(worker, client, now);
+        }
+        break;
+    case CS_LOBBY:
+        if (client->m_server_playing && now >= client->m_next_live_join)
+        {
+            // Join the running game, as spectator half of the time
+            NetworkString live_join(PROTOCOL_LOBBY_ROOM);
+            live_join.setSynchronous(true);
+            const bool spectator = random(worker, 0, 1) == 0;
+            live_join.addUInt8(LobbyProtocol::LE_LIVE_JOIN)
+                .addUInt8(spectator ? 1 : 0);
+            if (!spectator)
+            {
+                // Invalid or missing karts are replaced by the server
+                live_join.addUInt8(1).encodeString(client->m_karts.empty() ?
+                    std::string("randomkart") :
+                    client->m_karts[random(worker, 0,
+                    client->m_karts.size() - 1)]);
+            }
+            send(worker, client, live_join);
+            worker->m_stats.m_live_joins++;
+            client->m_next_live_join = now + random(worker, 10000, 30000);
+        }
+        break;
+    case CS_LOADING:
+        if (now >= client->m_loaded_time)
+        {
+            NetworkString loaded(PROTOCOL_LOBBY_ROOM);
+            loaded.setSynchronous(client->m_live_join_world);
+            loaded.addUInt8(LobbyProtocol::LE_CLIENT_LOADED_WORLD);
+            send(worker, client, loaded);
+            client->m_state = CS_RACING;
+            client->m_next_action = now;
+        }
+        break;
+    case CS_RACING:
+        if (client->m_race_start_time != 0 && client->m_kart_id != -1 &&
+            now >= client->m_next_action)
+        {
+            sendActions(worker, client, now);
+            client->m_next_action = now + random(worker, 30, 250);
+        }
+        break;
+    case CS_LEAVING:
+        break;
+    }
+
+    if (client->m_state >= CS_LOBBY && client->m_state != CS_LEAVING)
+    {
+        if (now >= client->m_next_chat)
+        {
+            sendChat(worker, client, now);
+            client->m_next_chat = now + random(worker, 10000, 60000);
+        }
+        if (now >= client->m_leave_time)
+        {
+            enet_peer_disconnect(client->m_peer, PDI_NORMAL);
+            client->m_state = CS_LEAVING;
+            worker->m_stats.m_left++;
+            // Force the disconnection if the server does not answer
+            client->m_connect_time = now;
+        }
+    }
+    else if (client->m_state == CS_LEAVING &&
+        now > client->m_connect_time + 5000)
+    {
+        enet_peer_reset(client->m_peer);
+        disconnected(worker, client, now);
+    }
+}   // updateClient
+
+// ----------------------------------------------------------------------------
+/** Creates the ENet host of a client and starts connecting. */
+void ClientSwarm::connect(Worker* worker, Client* client, uint64_t now)
+{
+    ENetAddress addr = {};
+    // Any port, each client looks like a different player to the server
+    client->m_network.reset(new Network(/*peer_count*/1,
+        /*channel_limit*/EVENT_CHANNEL_COUNT, /*max_in_bandwidth*/0,
+        /*max_out_bandwidth*/0, &addr));
+    if (!client->m_network->getENetHost())
+    {
+        Log::error("ClientSwarm", "%s: cannot create a socket.",
+            client->m_name.c_str());
+        client->m_network.reset();
+        client->m_connect_time = now + 5000;
+        return;
+    }
+    client->m_peer =
+        client->m_network->connectTo(m_server_address.toENetAddress());
+    if (!client->m_peer)
+    {
+        client->m_network.reset();
+        client->m_connect_time = now + 5000;
+        return;
+    }
+    client->m_state = CS_CONNECTING;
+    client->m_connect_time = now;
+    client->m_host_id = 0;
+    client->m_kart_id = -1;
+    client->m_live_join_world = false;
+    client->m_chat_sent_time = 0;
+    client->m_server_time_offset = 0;
+    client->m_race_start_time = 0;
+    client->m_server_playing = false;
+    client->m_steer = 0;
+    client->m_karts.clear();
+    client->m_tracks.clear();
+}   // connect
+
+// ----------------------------------------------------------------------------
+/** Called when the connection of a client is closed, by the server or after
+ *  leaving. The client connects again after a few seconds.
+ */
+void ClientSwarm::disconnected(Worker* worker, Client* client, uint64_t now)
+{
+    if (client->m_state != CS_LEAVING)
+        worker->m_stats.m_kicked++;
+    client->m_network.reset();
+    client->m_peer = NULL;
+    client->m_state = CS_IDLE;
+    client->m_connect_time = now + random(worker, 2000, 10000);
+}   // disconnected
+
+// ----------------------------------------------------------------------------
+void ClientSwarm::send(Worker* worker, Client* client,
+                       const NetworkString& data, bool reliable)
+{
+    // Same flags as STKPeer::sendPacket, without encryption everything goes
+    // to the normal channel
+    ENetPacket* packet = enet_packet_create(data.getData(),
+        data.getTotalSize(), (reliable ? ENET_PACKET_FLAG_RELIABLE :
+        (ENET_PACKET_FLAG_UNSEQUENCED | ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT)));
+    if (!packet)
+        return;
+    if (enet_peer_send(client->m_peer, EVENT_CHANNEL_NORMAL, packet) < 0)
+    {
+        enet_packet_destroy(packet);
+        return;
+    }
+    worker->m_stats.m_packets_sent++;
+    worker->m_stats.m_bytes_sent += data.getTotalSize();
+}   // send
+
+// ----------------------------------------------------------------------------
+/** Returns the connection request of ClientLobby for one player, without
+ *  encryption.
+ */
+NetworkString* ClientSwarm::getConnectionRequest(const Client& client) const
+{
+    NetworkString* ns = new NetworkString(PROTOCOL_LOBBY_ROOM);
+    ns->addUInt8(LobbyProtocol::LE_CONNECTION_REQUESTED)
+        .addUInt32(ServerConfig::m_server_version)
+        .encodeString(StringUtils::getUserAgentString());
+    *ns += *m_assets;
+    // 1 player, no online id and no encrypted part
+    ns->addUInt8(1).addUInt32(0).addUInt32(0);
+    ns->encodeString(m_password).addUInt8(1)
+        .encodeString(StringUtils::utf8ToWide(client.m_name))
+        .addFloat(0.0f).addUInt8(HANDICAP_NONE);
+    return ns;
+}   // getConnectionRequest
+
+// ----------------------------------------------------------------------------
+/** Returns the kart id of the player of a host in a LE_LOAD_WORLD message
+ *  (the read position is after the message type), -1 if it is spectating.
+ */
+int ClientSwarm::getKartId(NetworkString& load_world, uint32_t host_id)
+{
+    // See ServerLobby::getLoadWorldMessage and encodePlayers
+    load_world.getUInt32();
+    std::string track;
+    irr::core::stringw name;
+    load_world.decodeStringW(&name);
+    load_world.decodeString(&track);
+    load_world.skip(3);
+    unsigned player_count = load_world.getUInt8();
+    int kart_id = -1;
+    for (unsigned i = 0; i < player_count; i++)
+    {
+        std::string country, kart;
+        load_world.decodeStringW(&name);
+        uint32_t player_host_id = load_world.getUInt32();
+        load_world.skip(4 + 4 + 1 + 1 + 1);
+        load_world.decodeString(&country);
+        load_world.decodeString(&kart);
+        if (player_host_id == host_id && kart_id == -1)
+            kart_id = (int)i;
+    }
+    return kart_id;
+}   // getKartId
+
+// ----------------------------------------------------------------------------
+/** Event driven part of the state machine, handles a packet from the
+ *  server.
+ */
+void ClientSwarm::handlePacket(Worker* worker, Client* client,
+                               NetworkString& data, uint64_t now)
+{
+    const uint8_t* raw = (const uint8_t*)data.getData();
+    if (data.getTotalSize() > sizeof(PING_PACKET) &&
+        memcmp(raw, PING_PACKET, sizeof(PING_PACKET)) == 0)
+    {
+        // Same format as read in STKHost::mainLoop
+        BareNetworkString ping((const char*)raw, (int)data.getTotalSize());
+        ping.skip(sizeof(PING_PACKET));
+        const uint64_t server_time = ping.getUInt64();
+        const unsigned peer_count = ping.getUInt8();
+        uint32_t my_ping = 0;
+        for (unsigned i = 0; i < peer_count; i++)
+        {
+            uint32_t host_id = ping.getUInt32();
+            uint32_t peer_ping = ping.getUInt32();
+            if (host_id == client->m_host_id)
+                my_ping = peer_ping;
+        }
+        ping.skip(8);
+        std::string track;
+        ping.decodeString(&track);
+        client->m_server_playing = !track.empty();
+        if (client->m_host_id != 0)
+        {
+            worker->m_stats.m_ping_ms.push_back(my_ping);
+            client->m_server_time_offset =
+                (int64_t)(server_time + my_ping / 2) - (int64_t)now;
+        }
+        return;
+    }
+
+    const ProtocolType type = data.getProtocolType();
+    if (type == PROTOCOL_CONTROLLER_EVENTS)
+    {
+        if (data.getUInt8() == GameProtocol::GP_STATE)
+            worker->m_stats.m_states++;
+        return;
+    }
+    if (type != PROTOCOL_LOBBY_ROOM)
+        return;
+
+    const uint8_t message = data.getUInt8();
+    switch (message)
+    {
+    case LobbyProtocol::LE_CONNECTION_ACCEPTED:
+    {
+        client->m_host_id = data.getUInt32();
+        client->m_state = CS_LOBBY;
+        worker->m_stats.m_connected++;
+        worker->m_stats.m_handshake_ms.push_back(
+            (uint32_t)(now - client->m_connect_time));
+        client->m_next_chat = now + random(worker, 5000, 30000);
+        client->m_next_live_join = now + random(worker, 1000, 10000);
+        // Most players stay for a few games, some leave quickly
+        client->m_leave_time = now + (random(worker, 0, 3) == 0 ?
+            random(worker, 10000, 60000) : random(worker, 120000, 600000));
+        break;
+    }
+    case LobbyProtocol::LE_CONNECTION_REFUSED:
+    {
+        const uint8_t reason = data.getUInt8();
+        Log::warn("ClientSwarm", "%s: connection refused (reason %d).",
+            client->m_name.c_str(), reason);
+        worker->m_stats.m_refused++;
+        client->m_state = CS_LEAVING;
+        enet_peer_disconnect(client->m_peer, PDI_NORMAL);
+        client->m_connect_time = now;
+        break;
+    }
+    case LobbyProtocol::LE_START_SELECTION:
+    {
+        // See ClientLobby::startSelection
+        data.getFloat();
+        data.skip(3);
+        const unsigned kart_num = data.getUInt16();
+        const unsigned track_num = data.getUInt16();
+        client->m_karts.resize(kart_num);
+        client->m_tracks.resize(track_num);
+        for (unsigned i = 0; i < kart_num; i++)
+            data.decodeString(&client->m_karts[i]);
+        for (unsigned i = 0; i < track_num; i++)
+            data.decodeString(&client->m_tracks[i]);
+
+        NetworkString kart(PROTOCOL_LOBBY_ROOM);
+        kart.addUInt8(LobbyProtocol::LE_KART_SELECTION).addUInt8(1)
+            .encodeString(kart_num == 0 ? std::string("randomkart") :
+            client->m_karts[random(worker, 0, kart_num - 1)]);
+        send(worker, client, kart);
+        if (track_num > 0)
+        {
+            // The server corrects the laps and reverse if needed
+            NetworkString vote(PROTOCOL_LOBBY_ROOM);
+            vote.addUInt8(LobbyProtocol::LE_VOTE)
+                .encodeString(StringUtils::utf8ToWide(client->m_name))
+                .encodeString(client->m_tracks[random(worker, 0,
+                track_num - 1)])
+                .addUInt8((uint8_t)random(worker, 1, 3))
+                .addUInt8((uint8_t)random(worker, 0, 1));
+            send(worker, client, vote);
+        }
+        break;
+    }
+    case LobbyProtocol::LE_LOAD_WORLD:
+    {
+        client->m_kart_id = getKartId(data, client->m_host_id);
+        // The live join flag is the byte after the vote
+        data.reset();
+        data.skip(1 + 1 + 4);
+        std::string track;
+        irr::core::stringw name;
+        data.decodeStringW(&name);
+        data.decodeString(&track);
+        data.skip(2);
+        client->m_live_join_world = data.getUInt8() == 1;
+        client->m_race_start_time = 0;
+        client->m_state = CS_LOADING;
+        // Like a slow or fast computer loading the track
+        client->m_loaded_time = now + random(worker, 500, 5000);
+        break;
+    }
+    case LobbyProtocol::LE_START_RACE:
+        client->m_race_start_time = data.getUInt64();
+        worker->m_stats.m_races++;
+        break;
+    case LobbyProtocol::LE_LIVE_JOIN_ACK:
+        client->m_race_start_time = data.getUInt64();
+        break;
+    case LobbyProtocol::LE_RACE_FINISHED:
+    {
+        client->m_state = CS_LOBBY;
+        client->m_kart_id = -1;
+        NetworkString done(PROTOCOL_LOBBY_ROOM);
+        done.setSynchronous(true);
+        done.addUInt8(LobbyProtocol::LE_RACE_FINISHED_ACK);
+        send(worker, client, done);
+        break;
+    }
+    case LobbyProtocol::LE_BACK_LOBBY:
+        client->m_state = CS_LOBBY;
+        client->m_kart_id = -1;
+        client->m_race_start_time = 0;
+        break;
+    case LobbyProtocol::LE_CHAT:
+    {
+        if (client->m_chat_sent_time == 0)
+            break;
+        irr::core::stringw text;
+        data.decodeString16(&text);
+        if (StringUtils::wideToUtf8(text).find(client->m_chat_text) !=
+            std::string::npos)
+        {
+            worker->m_stats.m_chat_ms.push_back(
+                (uint32_t)(now - client->m_chat_sent_time));
+            client->m_chat_sent_time = 0;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}   // handlePacket
+
+// ----------------------------------------------------------------------------
+void ClientSwarm::sendChat(Worker* worker, Client* client, uint64_t now)
+{
+    const unsigned lines = sizeof(CHAT_LINES) / sizeof(CHAT_LINES[0]);
+    // The number makes the message unique to measure the echo time
+    client->m_chat_text = client->m_name + ": " +
+        CHAT_LINES[random(worker, 0, lines - 1)] + " #" +
+        StringUtils::toString(random(worker, 0, 9999));
+    NetworkString chat(PROTOCOL_LOBBY_ROOM);
+    chat.addUInt8(LobbyProtocol::LE_CHAT)
+        .encodeString16(StringUtils::utf8ToWide(client->m_chat_text));
+    send(worker, client, chat);
+    client->m_chat_sent_time = now;
+    worker->m_stats.m_chats++;
+}   // sendChat
+
+// ----------------------------------------------------------------------------
+/** Sends one to three controller actions like GameProtocol::sendActions,
+ *  mostly accelerating with a random steering.
+ */
+void ClientSwarm::sendActions(Worker* worker, Client* client, uint64_t now)
+{
+    // Estimated world ticks on the server
+    const int64_t server_now = (int64_t)now + client->m_server_time_offset;
+    const int64_t race_ms = std::max<int64_t>(0,
+        server_now - (int64_t)client->m_race_start_time);
+    const int ticks = stk_config->time2Ticks(race_ms / 1000.0f);
+
+    const unsigned count = (unsigned)random(worker, 1, 3);
+    NetworkString actions(PROTOCOL_CONTROLLER_EVENTS);
+    actions.addUInt8(GameProtocol::GP_CONTROLLER_ACTION)
+        .addUInt8((uint8_t)count);
+    for (unsigned i = 0; i < count; i++)
+    {
+        PlayerAction action = PA_ACCEL;
+        int value = Input::MAX_VALUE;
+        const uint64_t r = random(worker, 0, 99);
+        if (r < 50)
+        {
+            client->m_steer = (int)random(worker, 0, 2 * Input::MAX_VALUE) -
+                Input::MAX_VALUE;
+            action = client->m_steer < 0 ? PA_STEER_LEFT : PA_STEER_RIGHT;
+            value = std::abs(client->m_steer);
+        }
+        else if (r < 55)
+            action = PA_NITRO;
+        else if (r < 60)
+            action = PA_FIRE;
+        else if (r < 65)
+        {
+            action = PA_DRIFT;
+            value = random(worker, 0, 1) == 0 ? 0 : Input::MAX_VALUE;
+        }
+        const int value_l = client->m_steer < 0 ? -client->m_steer : 0;
+        const int value_r = client->m_steer > 0 ? client->m_steer : 0;
+        // Same layout as GameProtocol::compressAction
+        actions.addUInt32(ticks).addUInt8((uint8_t)client->m_kart_id)
+            .addUInt8((uint8_t)((action & 63) | (value_l > 0 ? 64 : 0) |
+            (value_r > 0 ? 128 : 0)))
+            .addUInt16((uint16_t)value).addUInt16((uint16_t)value_l)
+            .addUInt16((uint16_t)value_r);
+    }
+    send(worker, client, actions);
+    worker->m_stats.m_actions += count;
+}   // sendActions
+
+// ----------------------------------------------------------------------------
+/** Returns count, average, median, 95th and 99th percentile and maximum of
+ *  a list of values.
+ */
+std::string ClientSwarm::summary(std::vector<uint32_t> values)
+{
+    if (values.empty())
+        return "none";
+    std::sort(values.begin(), values.end());
+    uint64_t sum = 0;
+    for (uint32_t v : values)
+        sum += v;
+    auto percentile = [&values](unsigned p)
+        {
+            return values[(values.size() - 1) * p / 100];
+        };
+    return StringUtils::insertValues("%d samples, avg %d, p50 %d, p95 %d, "
+        "p99 %d, max %d", (unsigned)values.size(),
+        (unsigned)(sum / values.size()), percentile(50), percentile(95),
+        percentile(99), values.back());
+}   // summary
+
+// ----------------------------------------------------------------------------
+void ClientSwarm::report(uint64_t elapsed_ms) const
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    const float seconds = std::max(elapsed_ms / 1000.0f, 0.001f);
+    Log::info("ClientSwarm", "After %ds: %d connections, %d refused, %d "
+        "disconnected by the server, %d left, %d races, %d live joins, "
+        "%d chats, %d actions, %d states.", (int)seconds,
+        m_stats.m_connected, m_stats.m_refused, m_stats.m_kicked,
+        m_stats.m_left, m_stats.m_races, m_stats.m_live_joins,
+        m_stats.m_chats, m_stats.m_actions, m_stats.m_states);
+    Log::info("ClientSwarm", "Sent %lu packets (%.1f/s, %.1f KB/s), "
+        "received %lu packets (%.1f/s, %.1f KB/s).",
+        (unsigned long)m_stats.m_packets_sent,
+        m_stats.m_packets_sent / seconds,
+        m_stats.m_bytes_sent / seconds / 1024.0f,
+        (unsigned long)m_stats.m_packets_received,
+        m_stats.m_packets_received / seconds,
+        m_stats.m_bytes_received / seconds / 1024.0f);
+    Log::info("ClientSwarm", "Handshake ms: %s.",
+        summary(m_stats.m_handshake_ms).c_str());
+    Log::info("ClientSwarm", "Chat echo ms: %s.",
+        summary(m_stats.m_chat_ms).c_str());
+    Log::info("ClientSwarm", "Ping ms: %s.",
+        summary(m_stats.m_ping_ms).c_str());
+}   // report
+
+// ----------------------------------------------------------------------------
+void ClientSwarm::unitTesting()
+{
+    // The connection request is read like ServerLobby::connectionRequested
+    ClientSwarm swarm(SocketAddress("127.0.0.1", 2759), 3, "secret");
+    assert(swarm.m_workers.size() == 1);
+    assert(swarm.m_workers[0]->m_clients.size() == 3);
+    swarm.m_assets.reset(new BareNetworkString());
+    swarm.m_assets->addUInt16(1).encodeString(std::string("soccer"))
+        .addUInt16(1).addUInt16(0).encodeString(std::string("tux"));
+    NetworkString* request =
+        swarm.getConnectionRequest(swarm.m_workers[0]->m_clients[1]);
+    NetworkString data((const uint8_t*)request->getData(),
+        (int)request->getTotalSize());
+    delete request;
+    assert(data.getProtocolType() == PROTOCOL_LOBBY_ROOM);
+    assert(!data.isSynchronous());
+    assert(data.getUInt8() == LobbyProtocol::LE_CONNECTION_REQUESTED);
+    assert(data.getUInt32() == ServerConfig::m_server_version);
+    std::string s;
+    data.decodeString(&s);
+    assert(s == StringUtils::getUserAgentString());
+    assert(data.getUInt16() == 1);
+    data.decodeString(&s);
+    assert(s == "soccer");
+    assert(data.getUInt16() == 1);
+    assert(data.getUInt16() == 0);
+    data.decodeString(&s);
+    assert(s == "tux");
+    assert(data.getUInt8() == 1);
+    assert(data.getUInt32() == 0);
+    assert(data.getUInt32() == 0);
+    data.decodeString(&s);
+    assert(s == "secret");
+    assert(data.getUInt8() == 1);
+    irr::core::stringw name;
+    data.decodeStringW(&name);
+    assert(name == L"Swarm2");
+    data.getFloat();
+    assert(data.getUInt8() == HANDICAP_NONE);
+    assert(data.size() == 0);
+
+    // Kart id of a host in the load world message
+    NetworkString load_world(PROTOCOL_LOBBY_ROOM);
+    load_world.addUInt8(LobbyProtocol::LE_LOAD_WORLD).addUInt32(7)
+        .encodeString(irr::core::stringw(L"Swarm1"))
+        .encodeString(std::string("soccer_field")).addUInt8(0).addUInt8(0)
+        .addUInt8(0).addUInt8(3);
+    const uint32_t hosts[] = { 5, 7, 9 };
+    for (unsigned i = 0; i < 3; i++)
+    {
+        load_world.encodeString(irr::core::stringw(L"player"))
+            .addUInt32(hosts[i]).addFloat(0.0f).addUInt32(0).addUInt8(0)
+            .addUInt8(0).addUInt8(KART_TEAM_NONE)
+            .encodeString(std::string("")).encodeString(std::string("tux"));
+    }
+    NetworkString received((const uint8_t*)load_world.getData(),
+        (int)load_world.getTotalSize());
+    received.getUInt8();
+    assert(getKartId(received, 9) == 2);
+    received.reset();
+    received.skip(2);
+    assert(getKartId(received, 7) == 1);
+    received.reset();
+    received.skip(2);
+    assert(getKartId(received, 8) == -1);
+
+    std::vector<uint32_t> values;
+    for (uint32_t i = 100; i > 0; i--)
+        values.push_back(i);
+    assert(summary(values) ==
+        "100 samples, avg 50, p50 50, p95 95, p99 99, max 100");
+    assert(summary(std::vector<uint32_t>()) == "none");
+}   // unitTesting
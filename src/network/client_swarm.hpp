@@ -0,0 +1,196 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_CLIENT_SWARM_HPP
+#define HEADER_CLIENT_SWARM_HPP
+
+#include "network/socket_address.hpp"
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+class BareNetworkString;
+class Network;
+class NetworkString;
+typedef struct _ENetPeer ENetPeer;
+
+/** \ingroup network
+ *  Load generator for servers: simulates hundreds of clients in one process
+ *  without creating a ClientLobby, a World or the physics. Each client has
+ *  its own ENet host and speaks the lobby and game protocols directly: it
+ *  sends the connection request with the karts and tracks of this
+ *  installation, picks a kart and votes, acknowledges the world loading,
+ *  sends steering and acceleration during races, chats, leaves and comes
+ *  back, and live-joins running games. The clients are split over a few
+ *  threads, the latencies and packet counters are logged every few seconds
+ *  and at the end.
+ *
+ *  Only LAN style (unencrypted) connections are made, validated connections
+ *  need an online session per player from the stk-addons server.
+ */
+class ClientSwarm : public NoCopy
+{
+public:
+    /** Counters of one thread, summed up for the reports. */
+    struct Stats
+    {
+        uint64_t m_packets_sent;
+        uint64_t m_packets_received;
+        uint64_t m_bytes_sent;
+        uint64_t m_bytes_received;
+        unsigned m_connected;
+        unsigned m_refused;
+        unsigned m_kicked;
+        unsigned m_left;
+        unsigned m_races;
+        unsigned m_live_joins;
+        unsigned m_chats;
+        unsigned m_actions;
+        unsigned m_states;
+        /** Milliseconds from the ENet connection to the acceptance. */
+        std::vector<uint32_t> m_handshake_ms;
+        /** Milliseconds from sending a chat message to its broadcast. */
+        std::vector<uint32_t> m_chat_ms;
+        /** Ping of the client as reported by the server. */
+        std::vector<uint32_t> m_ping_ms;
+        // --------------------------------------------------------------------
+        Stats()                                                    { reset(); }
+        // --------------------------------------------------------------------
+        void reset();
+        // --------------------------------------------------------------------
+        void add(const Stats& other);
+    };   // Stats
+
+private:
+    enum ClientState : uint8_t
+    {
+        CS_IDLE,
+        CS_CONNECTING,
+        CS_REQUESTING,
+        CS_LOBBY,
+        CS_LOADING,
+        CS_RACING,
+        CS_LEAVING
+    };
+
+    struct Client
+    {
+        std::unique_ptr<Network> m_network;
+        ENetPeer*      m_peer;
+        std::string    m_name;
+        ClientState    m_state;
+        uint32_t       m_host_id;
+        int            m_kart_id;
+        bool           m_live_join_world;
+        /** Monotonic times in ms of the next events of this client. */
+        uint64_t       m_connect_time;
+        uint64_t       m_loaded_time;
+        uint64_t       m_next_action;
+        uint64_t       m_next_chat;
+        uint64_t       m_next_live_join;
+        uint64_t       m_leave_time;
+        uint64_t       m_chat_sent_time;
+        std::string    m_chat_text;
+        /** Server network time minus the local monotonic time. */
+        int64_t        m_server_time_offset;
+        uint64_t       m_race_start_time;
+        bool           m_server_playing;
+        int            m_steer;
+        std::vector<std::string> m_karts;
+        std::vector<std::string> m_tracks;
+    };   // Client
+
+    /** The clients handled by one thread. */
+    struct Worker
+    {
+        std::vector<Client> m_clients;
+        std::mt19937        m_random;
+        /** Counters since the last publication in ClientSwarm::m_stats. */
+        Stats               m_stats;
+        uint64_t            m_last_publish;
+    };
+
+    SocketAddress m_server_address;
+
+    std::string m_password;
+
+    /** Capabilities, karts and tracks sent in the connection requests. */
+    std::unique_ptr<BareNetworkString> m_assets;
+
+    std::vector<std::unique_ptr<Worker> > m_workers;
+
+    /** Counters of all workers, published about once per second. */
+    Stats m_stats;
+
+    mutable std::mutex m_stats_mutex;
+
+    std::atomic_bool m_stop;
+
+    // ------------------------------------------------------------------------
+    void runWorker(Worker* worker);
+    // ------------------------------------------------------------------------
+    void updateClient(Worker* worker, Client* client, uint64_t now);
+    // ------------------------------------------------------------------------
+    void handlePacket(Worker* worker, Client* client, NetworkString& data,
+                      uint64_t now);
+    // ------------------------------------------------------------------------
+    void connect(Worker* worker, Client* client, uint64_t now);
+    // ------------------------------------------------------------------------
+    void disconnected(Worker* worker, Client* client, uint64_t now);
+    // ------------------------------------------------------------------------
+    void send(Worker* worker, Client* client, const NetworkString& data,
+              bool reliable = true);
+    // ------------------------------------------------------------------------
+    void sendChat(Worker* worker, Client* client, uint64_t now);
+    // ------------------------------------------------------------------------
+    void sendActions(Worker* worker, Client* client, uint64_t now);
+    // ------------------------------------------------------------------------
+    NetworkString* getConnectionRequest(const Client& client) const;
+    // ------------------------------------------------------------------------
+    static int getKartId(NetworkString& load_world, uint32_t host_id);
+    // ------------------------------------------------------------------------
+    static uint64_t random(Worker* worker, uint64_t min, uint64_t max);
+    // ------------------------------------------------------------------------
+    static std::string summary(std::vector<uint32_t> values);
+    // ------------------------------------------------------------------------
+    void publish(Worker* worker, uint64_t now);
+    // ------------------------------------------------------------------------
+    void report(uint64_t elapsed_ms) const;
+
+public:
+    ClientSwarm(const SocketAddress& server_address, unsigned clients,
+                const std::string& password);
+    // ------------------------------------------------------------------------
+    ~ClientSwarm();
+    // ------------------------------------------------------------------------
+    void run(unsigned seconds);
+    // ------------------------------------------------------------------------
+    /** Makes run() return early, can be called from any thread. */
+    void requestStop()                                  { m_stop.store(true); }
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class ClientSwarm
+
+#endif
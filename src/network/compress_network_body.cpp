@@ -0,0 +1,217 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/compress_network_body.hpp"
+#include "network/bit_stream.hpp"
+#include "network/network_string.hpp"
+#include "utils/mini_glm.hpp"
+#include "utils/vec3.hpp"
+
+#include "LinearMath/btMotionState.h"
+#include "btBulletDynamicsCommon.h"
+
+#include <cmath>
+
+namespace CompressNetworkBody
+{
+using namespace MiniGLM;
+
+namespace
+{
+    /** Number of fixed point steps per meter for positions. */
+    const float POSITION_SCALE = 1024.0f;
+    /** Extra space around the track bounds, so karts and flyables flying
+     *  a bit outside of the track still use fixed point positions. */
+    const float POSITION_MARGIN = 64.0f;
+
+    /** Position bounds of the current track, set with the physics. */
+    struct PositionBounds
+    {
+        bool     m_valid;
+        float    m_origin[3];
+        float    m_max[3];
+        unsigned m_bits[3];
+        PositionBounds() : m_valid(false) {}
+    } g_bounds;
+
+    // ------------------------------------------------------------------------
+    /** Returns the position stored as fixed point number, if the position is
+     *  within the bounds (it is unchanged otherwise). */
+    bool roundPosition(float* xyz)
+    {
+        if (!g_bounds.m_valid)
+            return false;
+        for (unsigned i = 0; i < 3; i++)
+        {
+            if (!(xyz[i] >= g_bounds.m_origin[i] && xyz[i] <= g_bounds.m_max[i]))
+                return false;
+        }
+        for (unsigned i = 0; i < 3; i++)
+        {
+            xyz[i] = BitWriter::dequantise(BitWriter::quantise(xyz[i],
+                g_bounds.m_origin[i], POSITION_SCALE, g_bounds.m_bits[i]),
+                g_bounds.m_origin[i], POSITION_SCALE);
+        }
+        return true;
+    }   // roundPosition
+
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Sets the bounds used for fixed point positions from the track bounds,
+ *  called when the physics is initialised for a track. The origin is rounded
+ *  to whole meters, and the bounds must be within +-8192 m: there floats
+ *  represent all multiples of 1/1024 exactly, so rounding a position twice
+ *  gives the same value, and the result is the same on all platforms.
+ */
+void setPositionBounds(const Vec3& min, const Vec3& max)
+{
+    g_bounds.m_valid = true;
+    for (unsigned i = 0; i < 3; i++)
+    {
+        const float origin = std::floor(min[i] - POSITION_MARGIN);
+        const float end = std::ceil(max[i] + POSITION_MARGIN);
+        unsigned bits = 1;
+        while (bits < 24 && (float)(1u << bits) <= (end - origin) *
+                                                   POSITION_SCALE)
+            bits++;
+        g_bounds.m_origin[i] = origin;
+        g_bounds.m_bits[i] = bits;
+        g_bounds.m_max[i] = BitWriter::dequantise((1u << bits) - 1, origin,
+                                                  POSITION_SCALE);
+        if (!(origin >= -8192.0f && g_bounds.m_max[i] <= 8192.0f))
+            g_bounds.m_valid = false;
+    }
+}   // setPositionBounds
+
+// ----------------------------------------------------------------------------
+/** Set body and motion state of bullet object with compressed values. */
+void setCompressedValues(float x, float y, float z, uint32_t compressed_q,
+                         short lvx, short lvy, short lvz,
+                         short avx, short avy, short avz,
+                         btRigidBody* body, btMotionState* ms)
+{
+    btTransform trans;
+    trans.setOrigin(btVector3(x,y,z));
+    trans.setRotation(decompressbtQuaternion(compressed_q));
+    btVector3 lv(toFloat32(lvx), toFloat32(lvy), toFloat32(lvz));
+    btVector3 av(toFloat32(avx), toFloat32(avy), toFloat32(avz));
+
+    body->setWorldTransform(trans);
+    ms->setWorldTransform(trans);
+    body->setInterpolationWorldTransform(trans);
+    body->setLinearVelocity(lv);
+    body->setAngularVelocity(av);
+    body->setInterpolationLinearVelocity(lv);
+    body->setInterpolationAngularVelocity(av);
+    body->updateInertiaTensor();
+}   // setCompressedValues
+
+// ----------------------------------------------------------------------------
+/** Compress transformation and velocities of bullet object: the position
+ *  is rounded to the fixed point grid of the track bounds, the quaternion is
+ *  compressed with MiniGLM::compressQuaternion and linear and angular
+ *  velocities are converted to half floats. It can be used by client to
+ *  locally round values to make sure client and server have similar state
+ *  when saving state if you don't provide bw.
+ */
+void compress(btRigidBody* body, btMotionState* ms, BitWriter* bw)
+{
+    const btVector3& origin = body->getWorldTransform().getOrigin();
+    float xyz[3] = { origin.x(), origin.y(), origin.z() };
+    const bool fixed_point = roundPosition(xyz);
+    uint32_t compressed_q =
+        compressQuaternion(body->getWorldTransform().getRotation());
+    short lvx = toFloat16(body->getLinearVelocity().x());
+    short lvy = toFloat16(body->getLinearVelocity().y());
+    short lvz = toFloat16(body->getLinearVelocity().z());
+    short avx = toFloat16(body->getAngularVelocity().x());
+    short avy = toFloat16(body->getAngularVelocity().y());
+    short avz = toFloat16(body->getAngularVelocity().z());
+    setCompressedValues(xyz[0], xyz[1], xyz[2], compressed_q, lvx, lvy, lvz,
+        avx, avy, avz, body, ms);
+    // if bw is null, it's locally compress (for rounding values)
+    if (!bw)
+        return;
+
+    bw->addBool(fixed_point);
+    for (unsigned i = 0; i < 3; i++)
+    {
+        if (fixed_point)
+        {
+            bw->addFixed(xyz[i], g_bounds.m_origin[i], POSITION_SCALE,
+                         g_bounds.m_bits[i]);
+        }
+        else
+            bw->addFloat(xyz[i]);
+    }
+    bw->addBits(compressed_q, 32);
+    bw->addBits((uint16_t)lvx, 16);
+    bw->addBits((uint16_t)lvy, 16);
+    bw->addBits((uint16_t)lvz, 16);
+    bw->addBits((uint16_t)avx, 16);
+    bw->addBits((uint16_t)avy, 16);
+    bw->addBits((uint16_t)avz, 16);
+}   // compress
+
+// ----------------------------------------------------------------------------
+/** Byte aligned version of compress, for states without other bit packed
+ *  values. */
+void compress(btRigidBody* body, btMotionState* ms, BareNetworkString* bns)
+{
+    if (!bns)
+    {
+        compress(body, ms, (BitWriter*)NULL);
+        return;
+    }
+    BitWriter bw(bns);
+    compress(body, ms, &bw);
+}   // compress
+
+// ----------------------------------------------------------------------------
+/* Called during rewind when restoring data from game state. */
+void decompress(BitReader* br, btRigidBody* body, btMotionState* ms)
+{
+    const bool fixed_point = br->getBool();
+    float xyz[3];
+    for (unsigned i = 0; i < 3; i++)
+    {
+        xyz[i] = fixed_point ?
+            br->getFixed(g_bounds.m_origin[i], POSITION_SCALE,
+                         g_bounds.m_bits[i]) : br->getFloat();
+    }
+    uint32_t compressed_q = br->getBits(32);
+    short lvx = (short)br->getBits(16);
+    short lvy = (short)br->getBits(16);
+    short lvz = (short)br->getBits(16);
+    short avx = (short)br->getBits(16);
+    short avy = (short)br->getBits(16);
+    short avz = (short)br->getBits(16);
+    setCompressedValues(xyz[0], xyz[1], xyz[2], compressed_q, lvx, lvy, lvz,
+        avx, avy, avz, body, ms);
+}   // decompress
+
+// ----------------------------------------------------------------------------
+void decompress(const BareNetworkString* bns, btRigidBody* body,
+                btMotionState* ms)
+{
+    BitReader br(bns);
+    decompress(&br, body, ms);
+}   // decompress
+
+}   // namespace CompressNetworkBody
@@ -19,88 +19,42 @@
 #ifndef HEADER_COMPRESS_NETWORK_BODY_HPP
 #define HEADER_COMPRESS_NETWORK_BODY_HPP
 
-#include "network/network_string.hpp"
-#include "utils/mini_glm.hpp"
+#include <cstddef>
+#include <cstdint>
 
-#include "LinearMath/btMotionState.h"
-#include "btBulletDynamicsCommon.h"
+class BareNetworkString;
+class BitReader;
+class BitWriter;
+class btMotionState;
+class btRigidBody;
+class Vec3;
 
+/** Positions are saved as fixed point numbers relative to the track bounds
+ *  (with a resolution of 1/1024 m), velocities as half floats and the
+ *  rotation as compressed quaternion. The server sets the body to the values
+ *  it sends, and clients round their values at the same time steps, so that
+ *  both continue the simulation with identical values.
+ */
 namespace CompressNetworkBody
 {
-    using namespace MiniGLM;
     // ------------------------------------------------------------------------
-    /** Set body and motion state of bullet object with compressed values. */
-    inline void setCompressedValues(float x, float y, float z,
-                                    uint32_t compressed_q,
-                                    short lvx, short lvy, short lvz,
-                                    short avx, short avy, short avz,
-                                    btRigidBody* body, btMotionState* ms)
-    {
-        btTransform trans;
-        trans.setOrigin(btVector3(x,y,z));
-        trans.setRotation(decompressbtQuaternion(compressed_q));
-        btVector3 lv(toFloat32(lvx), toFloat32(lvy), toFloat32(lvz));
-        btVector3 av(toFloat32(avx), toFloat32(avy), toFloat32(avz));
-
-        body->setWorldTransform(trans);
-        ms->setWorldTransform(trans);
-        body->setInterpolationWorldTransform(trans);
-        body->setLinearVelocity(lv);
-        body->setAngularVelocity(av);
-        body->setInterpolationLinearVelocity(lv);
-        body->setInterpolationAngularVelocity(av);
-        body->updateInertiaTensor();
-    }   // setCompressedValues
+    void setPositionBounds(const Vec3& min, const Vec3& max);
     // ------------------------------------------------------------------------
-    /** Compress transformation and velocities of bullet object, it will
-     *  call MiniGLM::compressQuaternion for compress quaternion of
-     *  transformation and convert linear and angular velocities to half floats
-     *  it can be used by client to locally round values to make sure client
-     *  and server have similar state when saving state if you don't provoide
-     *  bns.
-     */
-    inline void compress(btRigidBody* body, btMotionState* ms,
-                         BareNetworkString* bns = NULL)
-    {
-        float x = body->getWorldTransform().getOrigin().x();
-        float y = body->getWorldTransform().getOrigin().y();
-        float z = body->getWorldTransform().getOrigin().z();
-        uint32_t compressed_q =
-            compressQuaternion(body->getWorldTransform().getRotation());
-        short lvx = toFloat16(body->getLinearVelocity().x());
-        short lvy = toFloat16(body->getLinearVelocity().y());
-        short lvz = toFloat16(body->getLinearVelocity().z());
-        short avx = toFloat16(body->getAngularVelocity().x());
-        short avy = toFloat16(body->getAngularVelocity().y());
-        short avz = toFloat16(body->getAngularVelocity().z());
-        setCompressedValues(x, y, z, compressed_q, lvx, lvy, lvz, avx, avy,
-            avz, body, ms);
-        // if bns is null, it's locally compress (for rounding values)
-        if (!bns)
-            return;
-
-        bns->addFloat(x).addFloat(y).addFloat(z).addUInt32(compressed_q);
-        bns->addUInt16(lvx).addUInt16(lvy).addUInt16(lvz)
-            .addUInt16(avx).addUInt16(avy).addUInt16(avz);
-    }   // compress
+    void setCompressedValues(float x, float y, float z,
+                             uint32_t compressed_q,
+                             short lvx, short lvy, short lvz,
+                             short avx, short avy, short avz,
+                             btRigidBody* body, btMotionState* ms);
+    // ------------------------------------------------------------------------
+    void compress(btRigidBody* body, btMotionState* ms, BitWriter* bw);
+    // ------------------------------------------------------------------------
+    void compress(btRigidBody* body, btMotionState* ms,
+                  BareNetworkString* bns = NULL);
+    // ------------------------------------------------------------------------
+    void decompress(BitReader* br, btRigidBody* body, btMotionState* ms);
     // ------------------------------------------------------------------------
-    /* Called during rewind when restoring data from game state. */
-    inline void decompress(const BareNetworkString* bns,
-                           btRigidBody* body, btMotionState* ms)
-    {
-        float x = bns->getFloat();
-        float y = bns->getFloat();
-        float z = bns->getFloat();
-        uint32_t compressed_q = bns->getUInt32();
-        short lvx = bns->getUInt16();
-        short lvy = bns->getUInt16();
-        short lvz = bns->getUInt16();
-        short avx = bns->getUInt16();
-        short avy = bns->getUInt16();
-        short avz = bns->getUInt16();
-        setCompressedValues(x, y, z, compressed_q, lvx, lvy, lvz, avx, avy,
-            avz, body, ms);
-    }   // decompress
+    void decompress(const BareNetworkString* bns, btRigidBody* body,
+                    btMotionState* ms);
 };
 
 #endif // HEADER_COMPRESS_NETWORK_BODY_HPP
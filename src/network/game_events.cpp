@@ -0,0 +1,636 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/game_events.hpp"
+
+#include "io/file_manager.hpp"
+#include "network/server_config.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/vs.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef ENABLE_SQLITE3
+#include <sqlite3.h>
+#endif
+
+#ifndef WIN32
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#endif
+
+GameEvents* GameEvents::m_game_events = NULL;
+
+namespace
+{
+    /** Appends the events to a file, one JSON object per line. When the file
+     *  is bigger than the maximum size after a batch it is renamed to
+     *  file.1 (file.1 to file.2 etc) and a new file is started. */
+    class FileSink : public GameEvents::Sink
+    {
+    private:
+        std::string m_path;
+        FILE*       m_file;
+        size_t      m_bytes;
+        size_t      m_max_bytes;
+        unsigned    m_keep;
+        // --------------------------------------------------------------------
+        void open()
+        {
+            m_file = FileUtils::fopenU8Path(m_path, "a");
+            m_bytes = 0;
+            if (!m_file)
+            {
+                Log::error("GameEvents", "Cannot open %s.", m_path.c_str());
+                return;
+            }
+            fseek(m_file, 0, SEEK_END);
+            long size = ftell(m_file);
+            m_bytes = size > 0 ? (size_t)size : 0;
+        }   // open
+        // --------------------------------------------------------------------
+        void rotate()
+        {
+            fclose(m_file);
+            m_file = NULL;
+            for (unsigned i = m_keep; i > 1; i--)
+            {
+                std::string older = m_path + "." + std::to_string(i);
+                std::string newer = m_path + "." + std::to_string(i - 1);
+                remove(FileUtils::getPortableWritingPath(older).c_str());
+                FileUtils::renameU8Path(newer, older);
+            }
+            if (m_keep > 0)
+            {
+                remove(FileUtils::getPortableWritingPath(m_path + ".1")
+                    .c_str());
+                FileUtils::renameU8Path(m_path, m_path + ".1");
+            }
+            else
+                remove(FileUtils::getPortableWritingPath(m_path).c_str());
+            open();
+        }   // rotate
+
+    public:
+        FileSink(const std::string& path, size_t max_bytes, unsigned keep)
+            : m_path(path), m_max_bytes(max_bytes), m_keep(keep)
+        {
+            open();
+        }   // FileSink
+        // --------------------------------------------------------------------
+        ~FileSink()
+        {
+            if (m_file)
+                fclose(m_file);
+        }   // ~FileSink
+        // --------------------------------------------------------------------
+        virtual void write(const GameEvents::Event& event,
+                           const std::string& json)
+        {
+            if (!m_file)
+                return;
+            fwrite(json.c_str(), 1, json.size(), m_file);
+            fputc('\n', m_file);
+            m_bytes += json.size() + 1;
+        }   // write
+        // --------------------------------------------------------------------
+        virtual void flush()
+        {
+            if (!m_file)
+                return;
+            fflush(m_file);
+            if (m_max_bytes > 0 && m_bytes >= m_max_bytes)
+                rotate();
+        }   // flush
+    };   // FileSink
+
+#ifndef WIN32
+    /** Sends each event as a JSON datagram to a UNIX socket. Events are lost
+     *  silently when no one listens or the receiver is too slow, the
+     *  socket never blocks. */
+    class SocketSink : public GameEvents::Sink
+    {
+    private:
+        int                m_socket;
+        struct sockaddr_un m_address;
+
+    public:
+        SocketSink(const std::string& path)
+        {
+            m_socket = -1;
+            memset(&m_address, 0, sizeof(m_address));
+            if (path.size() >= sizeof(m_address.sun_path))
+            {
+                Log::error("GameEvents", "Socket path %s is too long.",
+                    path.c_str());
+                return;
+            }
+            m_address.sun_family = AF_UNIX;
+            memcpy(m_address.sun_path, path.c_str(), path.size());
+            m_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+            if (m_socket == -1)
+            {
+                Log::error("GameEvents", "Cannot create socket for %s.",
+                    path.c_str());
+            }
+        }   // SocketSink
+        // --------------------------------------------------------------------
+        ~SocketSink()
+        {
+            if (m_socket != -1)
+                close(m_socket);
+        }   // ~SocketSink
+        // --------------------------------------------------------------------
+        virtual void write(const GameEvents::Event& event,
+                           const std::string& json)
+        {
+            if (m_socket == -1)
+                return;
+            sendto(m_socket, json.c_str(), json.size(), MSG_DONTWAIT,
+                (const struct sockaddr*)&m_address, sizeof(m_address));
+        }   // write
+    };   // SocketSink
+#endif
+
+#ifdef ENABLE_SQLITE3
+    /** Inserts the events into an sqlite table, one transaction per batch.
+     *  The database is opened by the worker thread on the first event. */
+    class DatabaseSink : public GameEvents::Sink
+    {
+    private:
+        std::string   m_path;
+        std::string   m_table;
+        sqlite3*      m_db;
+        sqlite3_stmt* m_insert;
+        bool          m_failed;
+        bool          m_in_transaction;
+        // --------------------------------------------------------------------
+        bool open()
+        {
+            if (sqlite3_open_v2(m_path.c_str(), &m_db, SQLITE_OPEN_READWRITE,
+                NULL) != SQLITE_OK)
+            {
+                Log::error("GameEvents", "Cannot open database: %s.",
+                    sqlite3_errmsg(m_db));
+                return false;
+            }
+            sqlite3_busy_timeout(m_db, std::max(100,
+                (int)ServerConfig::m_database_timeout));
+            std::string query = StringUtils::insertValues(
+                "CREATE TABLE IF NOT EXISTS %s ("
+                "time INTEGER NOT NULL, type TEXT NOT NULL, player TEXT, "
+                "other TEXT, team INTEGER, game_time REAL, value INTEGER, "
+                "value2 INTEGER);", m_table.c_str());
+            char* error = NULL;
+            if (sqlite3_exec(m_db, query.c_str(), NULL, NULL, &error) !=
+                SQLITE_OK)
+            {
+                Log::error("GameEvents", "Cannot create table %s: %s.",
+                    m_table.c_str(), error);
+                sqlite3_free(error);
+                return false;
+            }
+            query = StringUtils::insertValues("INSERT INTO %s (time, type, "
+                "player, other, team, game_time, value, value2) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?);", m_table.c_str());
+            return sqlite3_prepare_v2(m_db, query.c_str(), -1, &m_insert, 0)
+                == SQLITE_OK;
+        }   // open
+
+    public:
+        DatabaseSink(const std::string& path, const std::string& table)
+            : m_path(path), m_table(table)
+        {
+            m_db = NULL;
+            m_insert = NULL;
+            m_failed = false;
+            m_in_transaction = false;
+        }   // DatabaseSink
+        // --------------------------------------------------------------------
+        ~DatabaseSink()
+        {
+            flush();
+            if (m_insert)
+                sqlite3_finalize(m_insert);
+            if (m_db)
+                sqlite3_close(m_db);
+        }   // ~DatabaseSink
+        // --------------------------------------------------------------------
+        virtual void write(const GameEvents::Event& event,
+                           const std::string& json)
+        {
+            if (m_failed)
+                return;
+            if (!m_insert && !open())
+            {
+                m_failed = true;
+                return;
+            }
+            if (!m_in_transaction)
+            {
+                sqlite3_exec(m_db, "BEGIN;", NULL, NULL, NULL);
+                m_in_transaction = true;
+            }
+            sqlite3_bind_int64(m_insert, 1, (sqlite3_int64)event.m_time);
+            sqlite3_bind_text(m_insert, 2,
+                GameEvents::getTypeName((GameEvents::EventType)event.m_type),
+                -1, SQLITE_STATIC);
+            sqlite3_bind_text(m_insert, 3, event.m_player, -1,
+                SQLITE_TRANSIENT);
+            sqlite3_bind_text(m_insert, 4, event.m_other, -1,
+                SQLITE_TRANSIENT);
+            sqlite3_bind_int(m_insert, 5, event.m_team);
+            sqlite3_bind_double(m_insert, 6, event.m_game_time);
+            sqlite3_bind_int(m_insert, 7, event.m_value);
+            sqlite3_bind_int(m_insert, 8, event.m_value2);
+            if (sqlite3_step(m_insert) != SQLITE_DONE)
+            {
+                Log::error("GameEvents", "Cannot save event: %s.",
+                    sqlite3_errmsg(m_db));
+            }
+            sqlite3_reset(m_insert);
+        }   // write
+        // --------------------------------------------------------------------
+        virtual void flush()
+        {
+            if (!m_in_transaction)
+                return;
+            sqlite3_exec(m_db, "COMMIT;", NULL, NULL, NULL);
+            m_in_transaction = false;
+        }   // flush
+    };   // DatabaseSink
+#endif
+
+    // ------------------------------------------------------------------------
+    /** Copies a name into a fixed size field, without cutting an UTF-8
+     *  character. */
+    void copyName(const std::string& name, char* field, size_t size)
+    {
+        size_t len = std::min(name.size(), size - 1);
+        if (len < name.size())
+        {
+            while (len > 0 && ((uint8_t)name[len] & 0xC0) == 0x80)
+                len--;
+        }
+        memcpy(field, name.c_str(), len);
+        field[len] = 0;
+    }   // copyName
+
+    // ------------------------------------------------------------------------
+    void appendJsonString(const char* s, std::string* json)
+    {
+        json->push_back('"');
+        for (; *s; s++)
+        {
+            const char c = *s;
+            if (c == '"' || c == '\\')
+            {
+                json->push_back('\\');
+                json->push_back(c);
+            }
+            else if ((uint8_t)c < 0x20)
+            {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+                json->append(escaped);
+            }
+            else
+                json->push_back(c);
+        }
+        json->push_back('"');
+    }   // appendJsonString
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Creates the event stream with the sinks enabled in the server config, it
+ *  stays NULL if there is none. */
+void GameEvents::create()
+{
+    assert(!m_game_events);
+    GameEvents* events = new GameEvents();
+    const std::string file = ServerConfig::m_game_events_file;
+    if (!file.empty())
+    {
+        size_t max_bytes = (size_t)std::max(0,
+            (int)ServerConfig::m_game_events_file_size) * 1024;
+        events->m_sinks.emplace_back(new FileSink(
+            ServerConfig::getConfigDirectory() + "/" + file, max_bytes, 3));
+    }
+    const std::string socket = ServerConfig::m_game_events_socket;
+    if (!socket.empty())
+    {
+#ifdef WIN32
+        Log::warn("GameEvents", "game-events-socket is not supported on "
+            "Windows.");
+#else
+        events->m_sinks.emplace_back(new SocketSink(socket));
+#endif
+    }
+#ifdef ENABLE_SQLITE3
+    const std::string table = ServerConfig::m_game_events_table;
+    if (ServerConfig::m_sql_management && !table.empty())
+    {
+        events->m_sinks.emplace_back(new DatabaseSink(
+            ServerConfig::getConfigDirectory() + "/" +
+            ServerConfig::m_database_file.c_str(), table));
+    }
+#endif
+    if (events->m_sinks.empty())
+    {
+        delete events;
+        return;
+    }
+    events->start();
+    m_game_events = events;
+}   // create
+
+// ----------------------------------------------------------------------------
+void GameEvents::destroy()
+{
+    delete m_game_events;
+    m_game_events = NULL;
+}   // destroy
+
+// ----------------------------------------------------------------------------
+GameEvents::GameEvents()
+{
+    m_ring.reset(new MPSCRingBuffer<Event, 1024>());
+    m_worker_sleeping.store(false);
+    m_stop.store(false);
+    m_dropped.store(0);
+    m_flushed.store(0);
+}   // GameEvents
+
+// ----------------------------------------------------------------------------
+/** Writes the pending events before returning. */
+GameEvents::~GameEvents()
+{
+    if (!m_worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_worker_mutex);
+        m_stop.store(true);
+    }
+    m_worker_cv.notify_one();
+    m_worker.join();
+}   // ~GameEvents
+
+// ----------------------------------------------------------------------------
+/** Starts the worker thread, the sinks must not be changed after this. */
+void GameEvents::start()
+{
+    m_worker = std::thread([this]()
+        {
+            VS::setThreadName("GameEvents");
+            workerLoop();
+        });
+}   // start
+
+// ----------------------------------------------------------------------------
+void GameEvents::workerLoop()
+{
+    while (true)
+    {
+        unsigned count = 0;
+        // Limit the batch size, so a flood of events can't delay the flush
+        while (count < 256 && m_ring->tryPopWith([this](Event& event)
+            {
+                const std::string json = toJson(event);
+                for (auto& sink : m_sinks)
+                    sink->write(event, json);
+            }))
+        {
+            count++;
+        }
+        uint32_t dropped = m_dropped.exchange(0);
+        if (dropped > 0)
+        {
+            Log::warn("GameEvents", "%u events dropped, the queue was full.",
+                dropped);
+        }
+        if (count > 0)
+        {
+            for (auto& sink : m_sinks)
+                sink->flush();
+            std::lock_guard<std::mutex> lock(m_worker_mutex);
+            m_flushed.store(m_ring->getPopCount());
+            m_drained_cv.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> ul(m_worker_mutex);
+        if (m_stop.load())
+            break;
+        m_worker_sleeping.store(true);
+        // Producers only notify when this thread is sleeping, a missed
+        // notification is picked up by the timeout
+        m_worker_cv.wait_for(ul, std::chrono::milliseconds(100), [this]()
+            { return !m_ring->empty() || m_stop.load(); });
+        m_worker_sleeping.store(false);
+    }
+}   // workerLoop
+
+// ----------------------------------------------------------------------------
+/** Adds an event, never blocks. Can be called from any thread.
+ *  \param team -1 for no team, 0 for red, 1 for blue.
+ *  \param game_time Time since the start of the race or match in seconds.
+ */
+void GameEvents::push(EventType type, const std::string& player,
+                      const std::string& other, int team, float game_time,
+                      int value, int value2)
+{
+    const uint64_t time = std::chrono::duration_cast<
+        std::chrono::milliseconds>(std::chrono::system_clock::now()
+        .time_since_epoch()).count();
+    bool pushed = m_ring->tryPushWith([&](Event& event)
+        {
+            event.m_time = time;
+            event.m_game_time = game_time;
+            event.m_value = value;
+            event.m_value2 = value2;
+            event.m_type = type;
+            event.m_team = (int8_t)team;
+            copyName(player, event.m_player, sizeof(event.m_player));
+            copyName(other, event.m_other, sizeof(event.m_other));
+        });
+    if (!pushed)
+        m_dropped.fetch_add(1);
+    else if (m_worker_sleeping.load())
+        m_worker_cv.notify_one();
+}   // push
+
+// ----------------------------------------------------------------------------
+/** Blocks until all events pushed so far are written by the sinks, only for
+ *  tests. */
+void GameEvents::waitForEvents()
+{
+    const size_t target = m_ring->getPushCount();
+    m_worker_cv.notify_one();
+    std::unique_lock<std::mutex> lock(m_worker_mutex);
+    m_drained_cv.wait(lock, [this, target]()
+        { return m_flushed.load() >= target; });
+}   // waitForEvents
+
+// ----------------------------------------------------------------------------
+const char* GameEvents::getTypeName(EventType type)
+{
+    switch (type)
+    {
+    case GE_GOAL:         return "goal";
+    case GE_OWN_GOAL:     return "own_goal";
+    case GE_LAP:          return "lap";
+    case GE_FINISH:       return "finish";
+    case GE_ITEM_HIT:     return "item_hit";
+    case GE_KICK:         return "kick";
+    case GE_BAN:          return "ban";
+    case GE_JOIN:         return "join";
+    case GE_LEAVE:        return "leave";
+    case GE_MATCH_RESULT: return "match_result";
+    default:              break;
+    }
+    return "";
+}   // getTypeName
+
+// ----------------------------------------------------------------------------
+/** Returns the event as a JSON object on one line, empty fields are left
+ *  out. */
+std::string GameEvents::toJson(const Event& event)
+{
+    std::string json;
+    json.reserve(256);
+    char number[64];
+    snprintf(number, sizeof(number), "{\"time\":%llu,\"type\":",
+        (unsigned long long)event.m_time);
+    json += number;
+    appendJsonString(getTypeName((EventType)event.m_type), &json);
+    if (event.m_player[0])
+    {
+        json += ",\"player\":";
+        appendJsonString(event.m_player, &json);
+    }
+    if (event.m_other[0])
+    {
+        json += ",\"other\":";
+        appendJsonString(event.m_other, &json);
+    }
+    if (event.m_team == 0)
+        json += ",\"team\":\"red\"";
+    else if (event.m_team == 1)
+        json += ",\"team\":\"blue\"";
+    snprintf(number, sizeof(number),
+        ",\"game_time\":%.3f,\"value\":%d,\"value2\":%d}",
+        event.m_game_time, event.m_value, event.m_value2);
+    json += number;
+    return json;
+}   // toJson
+
+// ----------------------------------------------------------------------------
+void GameEvents::unitTesting()
+{
+    Event event = {};
+    event.m_time = 1234;
+    event.m_type = GE_GOAL;
+    event.m_team = 1;
+    event.m_game_time = 12.5f;
+    event.m_value = 2;
+    event.m_value2 = 1;
+    copyName("al\"i\\ce\n", event.m_player, sizeof(event.m_player));
+    assert(toJson(event) == "{\"time\":1234,\"type\":\"goal\","
+        "\"player\":\"al\\\"i\\\\ce\\u000a\",\"team\":\"blue\","
+        "\"game_time\":12.500,\"value\":2,\"value2\":1}");
+
+    // Names are cut before an incomplete UTF-8 character
+    std::string long_name(62, 'a');
+    long_name += "\xc3\xa9";
+    copyName(long_name, event.m_player, sizeof(event.m_player));
+    assert(std::string(event.m_player) == std::string(62, 'a'));
+
+    // Events of all threads arrive, in order for each thread
+    class TestSink : public Sink
+    {
+    public:
+        std::vector<Event> m_events;
+        virtual void write(const Event& event, const std::string& json)
+        {
+            m_events.push_back(event);
+        }
+    };
+    const std::string file =
+        file_manager->getUserConfigFile("game_events_test.jsonl");
+    remove(file.c_str());
+    remove((file + ".1").c_str());
+    GameEvents* events = new GameEvents();
+    TestSink* sink = new TestSink();
+    events->m_sinks.emplace_back(sink);
+    events->m_sinks.emplace_back(new FileSink(file, 4096, 1));
+    events->start();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([events, t]()
+            {
+                for (int i = 0; i < 200; i++)
+                {
+                    events->push(GE_LAP, "player" + std::to_string(t), "",
+                        -1, 0.0f, i);
+                    if (i % 64 == 63)
+                        events->waitForEvents();
+                }
+            });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    events->waitForEvents();
+    assert(sink->m_events.size() == 800);
+    int last[4] = { -1, -1, -1, -1 };
+    unsigned in_order = 0;
+    for (const Event& e : sink->m_events)
+    {
+        int t = e.m_player[6] - '0';
+        if (e.m_value == last[t] + 1)
+            in_order++;
+        last[t] = e.m_value;
+    }
+    assert(in_order == 800);
+    delete events;
+
+    // The file was rotated and only the last lines are kept
+    std::ifstream in(file);
+    std::string line;
+    unsigned lines = 0;
+    while (std::getline(in, line))
+    {
+        assert(line.front() == '{' && line.back() == '}');
+        lines++;
+    }
+    assert(lines > 0 && lines < 800);
+    in.close();
+    std::ifstream rotated(file + ".1");
+    assert(rotated.is_open());
+    rotated.close();
+    remove(file.c_str());
+    remove((file + ".1").c_str());
+}   // unitTesting
@@ -0,0 +1,153 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_GAME_EVENTS_HPP
+#define HEADER_GAME_EVENTS_HPP
+
+#include "utils/mpsc_ring_buffer.hpp"
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** \ingroup network
+ *  Stream of the game events of a server (goals, laps, finishes, item hits,
+ *  kicks, bans, joins and leaves, match results) for external
+ *  integrations. Events are fixed size records pushed into a lock-free
+ *  ring, a worker thread hands them to the sinks set in the server config:
+ *  a rotated JSONL file, a UNIX datagram socket and an sqlite table. The
+ *  game and lobby threads never wait for the disk, the socket or a child
+ *  process, events are dropped (and counted) if the ring is full. push()
+ *  copies the names into the record, the callers still build them (e.g.
+ *  with wideToUtf8) on their thread.
+ */
+class GameEvents : public NoCopy
+{
+public:
+    enum EventType : uint8_t
+    {
+        GE_GOAL = 0,
+        GE_OWN_GOAL,
+        GE_LAP,
+        GE_FINISH,
+        GE_ITEM_HIT,
+        GE_KICK,
+        GE_BAN,
+        GE_JOIN,
+        GE_LEAVE,
+        GE_MATCH_RESULT,
+        GE_COUNT
+    };
+
+    /** An event as stored in the ring, longer names are truncated. */
+    struct Event
+    {
+        /** Milliseconds since 1.1.1970. */
+        uint64_t m_time;
+        /** Time since the start of the race or match in seconds. */
+        float    m_game_time;
+        /** Lap number for laps, item type for item hits, red goals for
+         *  goals and match results. */
+        int32_t  m_value;
+        /** Blue goals for goals and match results. */
+        int32_t  m_value2;
+        uint8_t  m_type;
+        /** -1 for no team, 0 for red, 1 for blue. */
+        int8_t   m_team;
+        /** Scorer, kart owner or concerned player. */
+        char     m_player[64];
+        /** Hit player, player who kicked or banned, or the track. */
+        char     m_other[64];
+    };
+
+    /** Receives the events on the worker thread. */
+    class Sink
+    {
+    public:
+        virtual ~Sink() {}
+        // --------------------------------------------------------------------
+        /** Called for each event, json is the event as a JSON object. */
+        virtual void write(const Event& event, const std::string& json) = 0;
+        // --------------------------------------------------------------------
+        /** Called after each batch of events. */
+        virtual void flush() {}
+    };
+
+private:
+    static GameEvents* m_game_events;
+
+    /** Allocated separately, it is too big for the stack of tests. */
+    std::unique_ptr<MPSCRingBuffer<Event, 1024> > m_ring;
+
+    std::vector<std::unique_ptr<Sink> > m_sinks;
+
+    std::thread m_worker;
+
+    std::mutex m_worker_mutex;
+
+    std::condition_variable m_worker_cv;
+
+    std::condition_variable m_drained_cv;
+
+    std::atomic_bool m_worker_sleeping;
+
+    std::atomic_bool m_stop;
+
+    /** Number of events dropped because the ring was full. */
+    std::atomic<uint32_t> m_dropped;
+
+    /** Number of events written and flushed by all sinks. */
+    std::atomic<size_t> m_flushed;
+
+    GameEvents();
+    // ------------------------------------------------------------------------
+    ~GameEvents();
+    // ------------------------------------------------------------------------
+    void start();
+    // ------------------------------------------------------------------------
+    void workerLoop();
+
+public:
+    static const char* getTypeName(EventType type);
+    // ------------------------------------------------------------------------
+    static std::string toJson(const Event& event);
+    // ------------------------------------------------------------------------
+    static void create();
+    // ------------------------------------------------------------------------
+    static void destroy();
+    // ------------------------------------------------------------------------
+    /** Returns the event stream, NULL if no sink is configured. */
+    static GameEvents* get()                           { return m_game_events; }
+    // ------------------------------------------------------------------------
+    void push(EventType type, const std::string& player,
+              const std::string& other = "", int team = -1,
+              float game_time = 0.0f, int value = 0, int value2 = 0);
+    // ------------------------------------------------------------------------
+    void waitForEvents();
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class GameEvents
+
+#endif
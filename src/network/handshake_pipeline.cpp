@@ -0,0 +1,297 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/handshake_pipeline.hpp"
+
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+#include "utils/vs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+
+namespace
+{
+    /** Maximum number of latencies kept between two reports. */
+    const size_t MAX_LATENCY_SAMPLES = 4096;
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** \param threads Number of worker threads, 0 to run the jobs in submit().
+ *  \param max_queue Maximum number of handshakes queued or running.
+ *  \param worker_exit Run by each worker thread before it ends, e.g. to
+ *         close its own database connection.
+ */
+HandshakePipeline::HandshakePipeline(unsigned threads, unsigned max_queue,
+                                     const Action& worker_exit)
+{
+    m_max_queue = std::max(max_queue, 1u);
+    m_stop = false;
+    m_running = 0;
+    m_num_accepted = 0;
+    m_num_rejected = 0;
+    m_num_dropped = 0;
+    m_last_report = StkTime::getMonoTimeUs();
+    for (unsigned i = 0; i < threads; i++)
+    {
+        m_workers.emplace_back([this, worker_exit]()
+            {
+                VS::setThreadName("Handshake");
+                workerLoop();
+                if (worker_exit)
+                    worker_exit();
+            });
+    }
+}   // HandshakePipeline
+
+// ----------------------------------------------------------------------------
+/** Waits for the running jobs, the queued ones and the connections not
+ *  handled yet are dropped.
+ */
+HandshakePipeline::~HandshakePipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (std::thread& t : m_workers)
+        t.join();
+    report(StkTime::getMonoTimeUs(), /*force*/true);
+}   // ~HandshakePipeline
+
+// ----------------------------------------------------------------------------
+void HandshakePipeline::workerLoop()
+{
+    while (true)
+    {
+        Request r;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]()
+                { return m_stop || !m_requests.empty(); });
+            if (m_stop)
+                return;
+            r = m_requests.front();
+            m_requests.pop_front();
+            m_running++;
+        }
+        run(r);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running--;
+    }
+}   // workerLoop
+
+// ----------------------------------------------------------------------------
+/** Runs a job and queues its result for the lobby thread. */
+void HandshakePipeline::run(const Request& r)
+{
+    Finished f;
+    f.m_submit_time = r.m_submit_time;
+    try
+    {
+        f.m_result = r.m_job();
+    }
+    catch (std::exception& e)
+    {
+        Log::error("HandshakePipeline", "Handshake failed: %s", e.what());
+        f.m_result = Result::reject();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finished.push_back(f);
+}   // run
+
+// ----------------------------------------------------------------------------
+/** Adds a handshake latency, m_mutex must be locked. */
+void HandshakePipeline::addLatency(uint64_t submit_time, uint64_t now)
+{
+    const uint64_t latency = now > submit_time ? now - submit_time : 0;
+    if (m_latencies.size() < MAX_LATENCY_SAMPLES)
+        m_latencies.push_back(latency);
+    else
+    {
+        m_latencies[(m_num_accepted + m_num_rejected) %
+            MAX_LATENCY_SAMPLES] = latency;
+    }
+}   // addLatency
+
+// ----------------------------------------------------------------------------
+/** Queues a handshake job.
+ *  \return False if too many handshakes are in progress, in which case the
+ *  job is not run.
+ */
+bool HandshakePipeline::submit(const Job& job)
+{
+    Request r;
+    r.m_job = job;
+    r.m_submit_time = StkTime::getMonoTimeUs();
+    if (m_workers.empty())
+    {
+        run(r);
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_requests.size() + m_running >= m_max_queue)
+        {
+            m_num_dropped++;
+            return false;
+        }
+        m_requests.push_back(r);
+    }
+    m_cv.notify_one();
+    return true;
+}   // submit
+
+// ----------------------------------------------------------------------------
+/** Runs the actions of the finished handshakes, called by the lobby
+ *  thread.
+ *  \return The number of connections accepted.
+ */
+unsigned HandshakePipeline::handleFinished()
+{
+    std::deque<Finished> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(finished, m_finished);
+    }
+    unsigned accepted = 0;
+    for (Finished& f : finished)
+    {
+        if (f.m_result.m_action)
+            f.m_result.m_action();
+        const uint64_t now = StkTime::getMonoTimeUs();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (f.m_result.m_accepted)
+        {
+            accepted++;
+            m_num_accepted++;
+        }
+        else
+            m_num_rejected++;
+        addLatency(f.m_submit_time, now);
+    }
+    report(StkTime::getMonoTimeUs(), /*force*/false);
+    return accepted;
+}   // handleFinished
+
+// ----------------------------------------------------------------------------
+/** Logs the handshake counts and latency percentiles once a minute. */
+void HandshakePipeline::report(uint64_t now, bool force)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!force && now - m_last_report < 60000000)
+        return;
+    if (!m_latencies.empty() || m_num_dropped > 0)
+    {
+        Log::info("HandshakePipeline", "%u handshakes accepted, %u rejected, "
+            "%u refused with a full queue, latency p50 %.1f ms, p90 %.1f ms, "
+            "p99 %.1f ms, max %.1f ms.", m_num_accepted, m_num_rejected,
+            m_num_dropped, getPercentile(&m_latencies, 50) / 1000.0,
+            getPercentile(&m_latencies, 90) / 1000.0,
+            getPercentile(&m_latencies, 99) / 1000.0,
+            getPercentile(&m_latencies, 100) / 1000.0);
+    }
+    m_latencies.clear();
+    m_num_accepted = 0;
+    m_num_rejected = 0;
+    m_num_dropped = 0;
+    m_last_report = now;
+}   // report
+
+// ----------------------------------------------------------------------------
+/** Returns the nearest rank percentile of the samples (which are
+ *  reordered), 0 if there are none. */
+uint64_t HandshakePipeline::getPercentile(std::vector<uint64_t>* samples,
+                                          unsigned percent)
+{
+    if (samples->empty())
+        return 0;
+    size_t rank = (samples->size() * percent + 99) / 100;
+    rank = std::min(std::max(rank, (size_t)1), samples->size());
+    std::nth_element(samples->begin(), samples->begin() + (rank - 1),
+        samples->end());
+    return (*samples)[rank - 1];
+}   // getPercentile
+
+// ----------------------------------------------------------------------------
+void HandshakePipeline::unitTesting()
+{
+    std::vector<uint64_t> samples;
+    assert(getPercentile(&samples, 50) == 0);
+    for (uint64_t i = 100; i > 0; i--)
+        samples.push_back(i);
+    assert(getPercentile(&samples, 50) == 50);
+    assert(getPercentile(&samples, 90) == 90);
+    assert(getPercentile(&samples, 99) == 99);
+    assert(getPercentile(&samples, 100) == 100);
+    assert(getPercentile(&samples, 0) == 1);
+
+    // Without workers the jobs are run at once, but their actions are only
+    // run by handleFinished
+    int accepted = 0;
+    int rejected = 0;
+    {
+        HandshakePipeline inline_pipeline(0, 1);
+        bool submitted = inline_pipeline.submit([&accepted]()
+            { return Result::accept([&accepted]() { accepted++; }); });
+        submitted &= inline_pipeline.submit([]() { return Result::reject(); });
+        submitted &= inline_pipeline.submit([&rejected]()
+            { return Result::reject([&rejected]() { rejected++; }); });
+        submitted &= inline_pipeline.submit([]() -> Result
+            { throw std::runtime_error("Invalid request"); });
+        assert(submitted);
+        assert(accepted == 0 && rejected == 0);
+        unsigned num_accepted = inline_pipeline.handleFinished();
+        assert(num_accepted == 1);
+        assert(accepted == 1 && rejected == 1);
+        num_accepted = inline_pipeline.handleFinished();
+        assert(num_accepted == 0);
+        (void)num_accepted;
+    }
+
+    // Queued and running jobs count for the queue size
+    std::atomic_bool release(false);
+    HandshakePipeline pipeline(2, 3);
+    auto blocked = [&release, &accepted]()
+    {
+        while (!release.load())
+            StkTime::sleep(1);
+        return Result::accept([&accepted]() { accepted++; });
+    };
+    unsigned submitted = 0;
+    for (unsigned i = 0; i < 4; i++)
+        submitted += pipeline.submit(blocked) ? 1 : 0;
+    assert(submitted == 3);
+    release.store(true);
+    unsigned total = 0;
+    const uint64_t start = StkTime::getMonoTimeMs();
+    while (total < 3 && StkTime::getMonoTimeMs() < start + 5000)
+    {
+        total += pipeline.handleFinished();
+        StkTime::sleep(1);
+    }
+    assert(total == 3);
+    assert(accepted == 4);
+    submitted += pipeline.submit(blocked) ? 1 : 0;
+    assert(submitted == 4);
+}   // unitTesting
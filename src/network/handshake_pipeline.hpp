@@ -0,0 +1,142 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_HANDSHAKE_PIPELINE_HPP
+#define HEADER_HANDSHAKE_PIPELINE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** \ingroup network
+ *  Runs the expensive parts of the connection requests (ban checks in the
+ *  database, decryption) on worker threads, so a burst of connections after
+ *  a server restart or join spam does not hold up the lobby updates.
+ *  The number of handshakes in progress is limited: when the queue is full
+ *  submit() fails and the request can be refused at once. A job returns
+ *  whether the connection is accepted, with an action which is run later on
+ *  the lobby thread by handleFinished(): the workers never change the peers
+ *  or the lobby, they only tell the lobby thread what to do.
+ *  The time from submit() to the acceptance or rejection of each handshake
+ *  is measured, and its percentiles are logged every minute.
+ */
+class HandshakePipeline : public NoCopy
+{
+public:
+    typedef std::function<void()> Action;
+
+    /** Outcome of a handshake job. */
+    struct Result
+    {
+        /** Run on the lobby thread, can be empty. */
+        Action m_action;
+        bool   m_accepted;
+        // --------------------------------------------------------------------
+        static Result accept(const Action& action)
+        {
+            Result r;
+            r.m_action = action;
+            r.m_accepted = true;
+            return r;
+        }   // accept
+        // --------------------------------------------------------------------
+        static Result reject(const Action& action = Action())
+        {
+            Result r;
+            r.m_action = action;
+            r.m_accepted = false;
+            return r;
+        }   // reject
+    };
+
+    typedef std::function<Result()> Job;
+
+private:
+    struct Request
+    {
+        Job      m_job;
+        uint64_t m_submit_time;
+    };
+    struct Finished
+    {
+        Result   m_result;
+        uint64_t m_submit_time;
+    };
+
+    std::vector<std::thread> m_workers;
+
+    /** Maximum number of handshakes queued or running. */
+    unsigned m_max_queue;
+
+    /** Protects all members below. */
+    std::mutex m_mutex;
+
+    std::condition_variable m_cv;
+
+    bool m_stop;
+
+    std::deque<Request> m_requests;
+
+    /** Jobs being run by the workers. */
+    unsigned m_running;
+
+    std::deque<Finished> m_finished;
+
+    /** Statistics since the last report, the latencies in us. */
+    std::vector<uint64_t> m_latencies;
+    unsigned m_num_accepted;
+    unsigned m_num_rejected;
+    unsigned m_num_dropped;
+    uint64_t m_last_report;
+
+    // ------------------------------------------------------------------------
+    void workerLoop();
+    // ------------------------------------------------------------------------
+    void run(const Request& r);
+    // ------------------------------------------------------------------------
+    void addLatency(uint64_t submit_time, uint64_t now);
+
+public:
+    HandshakePipeline(unsigned threads, unsigned max_queue,
+                      const Action& worker_exit = Action());
+    // ------------------------------------------------------------------------
+    ~HandshakePipeline();
+    // ------------------------------------------------------------------------
+    bool submit(const Job& job);
+    // ------------------------------------------------------------------------
+    /** Returns false if the jobs are run by the thread calling submit(). */
+    bool hasWorkers() const                      { return !m_workers.empty(); }
+    // ------------------------------------------------------------------------
+    unsigned handleFinished();
+    // ------------------------------------------------------------------------
+    void report(uint64_t now, bool force);
+    // ------------------------------------------------------------------------
+    static uint64_t getPercentile(std::vector<uint64_t>* samples,
+                                  unsigned percent);
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class HandshakePipeline
+
+#endif
@@ -0,0 +1,418 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/interest_manager.hpp"
+
+#include "config/stk_config.hpp"
+#include "karts/abstract_kart.hpp"
+#include "modes/soccer_world.hpp"
+#include "modes/world_with_rank.hpp"
+#include "network/network_config.hpp"
+#include "network/protocols/lobby_protocol.hpp"
+#include "network/rewind_manager.hpp"
+#include "network/rewinder.hpp"
+#include "network/server_config.hpp"
+#include "network/stk_host.hpp"
+#include "network/stk_peer.hpp"
+#include "physics/physical_object.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <enet/enet.h>
+
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+InterestManager::InterestManager()
+{
+    m_ticks = 0;
+    m_state_interval = stk_config->getPhysicsFPS() /
+        NetworkConfig::get()->getStateFrequency();
+    if (m_state_interval < 1)
+        m_state_interval = 1;
+    m_relevance_filter = ServerConfig::m_state_relevance_filter;
+    m_rate_control = ServerConfig::m_state_rate_control;
+    m_total_sent = 0;
+    m_total_full = 0;
+}   // InterestManager
+
+// ----------------------------------------------------------------------------
+InterestManager::~InterestManager()
+{
+    if (m_total_full == 0)
+        return;
+    Log::info("InterestManager", "Sent %llu of %llu bytes of game states "
+        "(%.1f%%) after relevance filtering and rate control.",
+        (unsigned long long)m_total_sent, (unsigned long long)m_total_full,
+        float(m_total_sent) / float(m_total_full) * 100.0f);
+}   // ~InterestManager
+
+// ----------------------------------------------------------------------------
+/** Called by the server before the rewinders save a new state.
+ *  \param ticks World ticks of the new state.
+ */
+void InterestManager::startNewState(int ticks)
+{
+    m_ticks = ticks;
+    m_states.clear();
+}   // startNewState
+
+// ----------------------------------------------------------------------------
+/** Adds the saved state of a rewinder to the current state.
+ *  \param uid Unique identity of the rewinder.
+ *  \param buffer The saved state, it is copied.
+ */
+void InterestManager::addState(const std::string& uid,
+                               const BareNetworkString& buffer)
+{
+    m_states.emplace_back(uid, buffer);
+    if (uid[0] == RN_PHYSICAL_OBJ)
+        m_last_object_state[uid] = buffer;
+}   // addState
+
+// ----------------------------------------------------------------------------
+/** Returns true if the rewinder with this uid can be sent less often, only
+ *  karts and physical objects are.
+ */
+bool InterestManager::isFiltered(const std::string& uid) const
+{
+    return uid[0] == RN_KART || uid[0] == RN_PHYSICAL_OBJ;
+}   // isFiltered
+
+// ----------------------------------------------------------------------------
+/** Finds the position and team of a kart or physical object.
+ *  \return False if the rewinder must always be sent.
+ */
+bool InterestManager::getPosition(const std::string& uid, Vec3* xyz,
+                                  int* team) const
+{
+    World* w = World::getWorld();
+    *team = -1;
+    if (uid[0] == RN_KART && uid.size() > 1)
+    {
+        unsigned kart_id = (uint8_t)uid[1];
+        // Clients can't keep a kart in an animation out of a rewind (see
+        // RewindIslands::freezeMissing), it must be in every state
+        if (kart_id >= w->getNumKarts() ||
+            w->getKart(kart_id)->getKartAnimation())
+            return false;
+        *xyz = w->getKart(kart_id)->getXYZ();
+        if (w->hasTeam())
+            *team = (int)w->getKartTeam(kart_id);
+        return true;
+    }
+    else if (uid[0] == RN_PHYSICAL_OBJ)
+    {
+        std::shared_ptr<PhysicalObject> po =
+            std::dynamic_pointer_cast<PhysicalObject>
+            (RewindManager::get()->getRewinder(uid));
+        if (!po || po->isSoccerBall())
+            return false;
+        *xyz = po->getBody()->getWorldTransform().getOrigin();
+        return true;
+    }
+    return false;
+}   // getPosition
+
+// ----------------------------------------------------------------------------
+/** Collects the positions a peer is interested in: its own karts, or for
+ *  spectators what the camera usually follows (the ball or the leader).
+ */
+void InterestManager::getFocus(STKPeer* peer, std::vector<Focus>* focus) const
+{
+    World* w = World::getWorld();
+    for (unsigned id : peer->getAvailableKartIDs())
+    {
+        if (id >= w->getNumKarts())
+            continue;
+        AbstractKart* k = w->getKart(id);
+        if (k->isEliminated())
+            continue;
+        Focus f;
+        f.m_xyz = k->getXYZ();
+        f.m_forward = k->getTrans().getBasis().getColumn(2);
+        f.m_team = w->hasTeam() ? (int)w->getKartTeam(id) : -1;
+        focus->push_back(f);
+    }
+    if (!focus->empty())
+        return;
+
+    Focus f;
+    f.m_forward = Vec3(0, 0, 0);
+    f.m_team = -1;
+    if (SoccerWorld* sw = dynamic_cast<SoccerWorld*>(w))
+    {
+        f.m_xyz = sw->getBallPosition();
+        focus->push_back(f);
+    }
+    else if (WorldWithRank* wwr = dynamic_cast<WorldWithRank*>(w))
+    {
+        AbstractKart* leader = wwr->getKartAtPosition(1);
+        if (leader)
+        {
+            f.m_xyz = leader->getXYZ();
+            focus->push_back(f);
+        }
+    }
+}   // getFocus
+
+// ----------------------------------------------------------------------------
+/** Computes the relevance of an object at xyz in [0, 1] for a peer.
+ */
+float InterestManager::getRelevance(const std::vector<Focus>& focus,
+                                    const Vec3& xyz, int team) const
+{
+    const float near_distance =
+        std::max(1.0f, (float)ServerConfig::m_state_relevance_distance);
+    float best = 0.0f;
+    for (const Focus& f : focus)
+    {
+        Vec3 diff = xyz - f.m_xyz;
+        float distance = diff.length();
+        float relevance = distance <= near_distance ?
+            1.0f : near_distance / distance;
+        // Objects behind the kart are not seen by the player
+        if (distance > near_distance && diff.dot(f.m_forward) < 0.0f)
+            relevance *= 0.5f;
+        // Team mates are shown on the minimap and matter for passing
+        if (team != -1 && team == f.m_team)
+            relevance = std::min(1.0f, relevance * 1.5f);
+        best = std::max(best, relevance);
+    }
+    return best;
+}   // getRelevance
+
+// ----------------------------------------------------------------------------
+/** Converts a relevance into the number of states between two updates.
+ */
+int InterestManager::getUpdateInterval(float relevance) const
+{
+    if (relevance >= 0.5f)
+        return 1;
+    int max_interval =
+        std::max(1, (int)ServerConfig::m_state_relevance_max_interval);
+    if (relevance <= 0.0f)
+        return max_interval;
+    return std::min(max_interval, (int)(0.5f / relevance) + 1);
+}   // getUpdateInterval
+
+// ----------------------------------------------------------------------------
+/** Adapts the state bandwidth of a peer about once per second (which is how
+ *  often STKHost updates ping and packet loss): it is reduced by 30% if the
+ *  connection loses more than 2% of the packets or the ping grows by half
+ *  above the lowest ping seen (at least 50 ms), and grows by 5% of the
+ *  maximum rate otherwise.
+ */
+void InterestManager::adaptRate(STKPeer* peer, PeerInterest* pi,
+                                uint64_t now) const
+{
+    const float max_rate =
+        std::max(1, (int)ServerConfig::m_state_peer_max_rate) * 1024.0f;
+    const float min_rate = max_rate / 8.0f;
+    if (pi->m_rate < 0.0f)
+    {
+        pi->m_rate = max_rate;
+        pi->m_last_adapt = now;
+    }
+    if (now - pi->m_last_adapt < 1000)
+        return;
+    pi->m_last_adapt = now;
+
+    const uint32_t ping = peer->getAveragePing();
+    if (ping > 0 && (pi->m_min_ping == 0 || ping < pi->m_min_ping))
+        pi->m_min_ping = ping;
+    const float loss =
+        (float)peer->getPacketLoss() / (float)ENET_PEER_PACKET_LOSS_SCALE;
+    const uint32_t queuing = std::max(50u, pi->m_min_ping / 2);
+    if (loss > 0.02f || (pi->m_min_ping > 0 && ping > pi->m_min_ping + queuing))
+        pi->m_rate = std::max(min_rate, pi->m_rate * 0.7f);
+    else
+        pi->m_rate = std::min(max_rate, pi->m_rate + max_rate * 0.05f);
+}   // adaptRate
+
+// ----------------------------------------------------------------------------
+/** Builds and sends the filtered state for each peer in game.
+ *  \param header The state message with protocol type, state event type and
+ *         ticks already written.
+ */
+void InterestManager::sendStates(NetworkString* header)
+{
+    bool send_all = false;
+    if (auto lp = LobbyProtocol::get<LobbyProtocol>())
+        send_all = lp->hasLiveJoiningRecently();
+
+    // Size of the unfiltered state for statistics
+    uint64_t full_size = header->getTotalSize() + 1;
+    for (auto& state : m_states)
+        full_size += state.first.size() + 1 + 2 + state.second.size();
+
+    std::vector<std::shared_ptr<STKPeer> > peers;
+    for (auto& peer : STKHost::get()->getPeers())
+    {
+        if (peer->isValidated() && !peer->isWaitingForGame())
+            peers.push_back(peer);
+    }
+
+    // With an upload limit the rates of all peers are scaled down by the
+    // same fraction
+    const uint64_t now = StkTime::getMonoTimeMs();
+    float rate_scale = 1.0f;
+    if (m_rate_control)
+    {
+        float total_rate = 0.0f;
+        for (auto& peer : peers)
+        {
+            PeerInterest& pi = m_peers[peer->getHostId()];
+            adaptRate(peer.get(), &pi, now);
+            total_rate += pi.m_rate;
+        }
+        const float limit = ServerConfig::m_state_upload_limit * 1024.0f;
+        if (limit > 0.0f && total_rate > limit)
+            rate_scale = limit / total_rate;
+    }
+    const float state_time = stk_config->ticks2Time(m_state_interval);
+
+    std::set<uint32_t> peers_seen;
+    for (auto& peer : peers)
+    {
+        peers_seen.insert(peer->getHostId());
+        PeerInterest& pi = m_peers[peer->getHostId()];
+
+        std::vector<Focus> focus;
+        getFocus(peer.get(), &focus);
+
+        // The karts of the peer are always sent, before the budget is used
+        std::set<std::string> own_karts;
+        for (unsigned id : peer->getAvailableKartIDs())
+            own_karts.insert(std::string(1, RN_KART) + (char)id);
+
+        // Sorted like the rewinders in RewindManager, which is the order
+        // they must be restored in
+        std::map<std::string, const BareNetworkString*> selected;
+        for (auto& state : m_states)
+        {
+            if (state.first[0] == RN_PHYSICAL_OBJ)
+                pi.m_pending.insert(state.first);
+            else
+                selected[state.first] = &state.second;
+        }
+        for (const std::string& uid : pi.m_pending)
+        {
+            auto it = m_last_object_state.find(uid);
+            if (it != m_last_object_state.end())
+                selected[uid] = &it->second;
+        }
+
+        // Karts and objects which can be left out if the budget is used up,
+        // with their priority
+        std::set<std::string> chosen;
+        std::vector<std::pair<float, std::string> > optional;
+        float used = (float)header->getTotalSize() + 1.0f;
+        for (auto& s : selected)
+        {
+            const std::string& uid = s.first;
+            const float size = uid.size() + 1 + 2 + s.second->size();
+            Vec3 xyz;
+            int team;
+            if (send_all || !isFiltered(uid) ||
+                own_karts.find(uid) != own_karts.end() ||
+                !getPosition(uid, &xyz, &team))
+            {
+                chosen.insert(uid);
+                used += size;
+                continue;
+            }
+            const float relevance =
+                focus.empty() ? 1.0f : getRelevance(focus, xyz, team);
+            auto last = pi.m_last_sent.find(uid);
+            const int states_since = last == pi.m_last_sent.end() ?
+                1000 : (m_ticks - last->second) / m_state_interval;
+            if (m_relevance_filter && !focus.empty() &&
+                last != pi.m_last_sent.end() &&
+                m_ticks - last->second <
+                getUpdateInterval(relevance) * m_state_interval)
+                continue;
+            if (!m_rate_control)
+            {
+                chosen.insert(uid);
+                used += size;
+                continue;
+            }
+            optional.emplace_back(relevance * std::max(1, states_since), uid);
+        }
+
+        if (m_rate_control)
+        {
+            // Allow a burst of two states, and don't let the states which
+            // are always sent starve the others forever
+            const float rate = pi.m_rate * rate_scale;
+            const float capacity = 2.0f * rate * state_time;
+            pi.m_budget = std::min(pi.m_budget + rate * state_time, capacity);
+            pi.m_budget = std::max(pi.m_budget - used, -capacity);
+            std::stable_sort(optional.begin(), optional.end(),
+                [](const std::pair<float, std::string>& a,
+                   const std::pair<float, std::string>& b)
+                { return a.first > b.first; });
+            for (auto& o : optional)
+            {
+                const float size =
+                    o.second.size() + 1 + 2 + selected[o.second]->size();
+                if (size > pi.m_budget)
+                    continue;
+                pi.m_budget -= size;
+                chosen.insert(o.second);
+            }
+            peer->setStateRate((uint32_t)rate);
+        }
+
+        NetworkString ns(*header);
+        std::vector<const BareNetworkString*> data;
+        std::vector<std::string> names;
+        for (auto& s : selected)
+        {
+            const std::string& uid = s.first;
+            if (chosen.find(uid) == chosen.end())
+                continue;
+            pi.m_last_sent[uid] = m_ticks;
+            pi.m_pending.erase(uid);
+            names.push_back(uid);
+            data.push_back(s.second);
+        }
+
+        ns.addUInt8((uint8_t)names.size());
+        for (const std::string& name : names)
+            ns.encodeString(name);
+        for (const BareNetworkString* d : data)
+        {
+            ns.addUInt16(d->size());
+            ns += *d;
+        }
+        peer->sendPacket(&ns, /*reliable*/false);
+        peer->addStateBytes(ns.getTotalSize(), full_size);
+        m_total_sent += ns.getTotalSize();
+        m_total_full += full_size;
+    }
+
+    for (auto it = m_peers.begin(); it != m_peers.end();)
+    {
+        if (peers_seen.find(it->first) == peers_seen.end())
+            it = m_peers.erase(it);
+        else
+            it++;
+    }
+}   // sendStates
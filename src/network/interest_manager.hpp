@@ -0,0 +1,131 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_INTEREST_MANAGER_HPP
+#define HEADER_INTEREST_MANAGER_HPP
+
+#include "network/network_string.hpp"
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+#include "utils/vec3.hpp"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+class NetworkString;
+class STKPeer;
+
+/** \ingroup network
+ *  Filters the state sent by the server for each peer. Karts and physical
+ *  objects get a relevance score for each peer (based on the distance to
+ *  the karts of the peer, whether they are in front of them and the team),
+ *  and less relevant ones are sent with a lower frequency. Everything else
+ *  (items, flags, projectiles, the soccer ball) is always sent. The server
+ *  simulation is not affected, clients keep predicting the skipped objects
+ *  which is what they already do between two states. In a rewind a client
+ *  does not simulate the karts missing in the server state again, they keep
+ *  their current state (see RewindIslands).
+ *  With rate control each peer also gets a bandwidth budget, which shrinks
+ *  when the connection loses packets or the ping grows above the lowest
+ *  ping seen (packets are queued), and grows slowly otherwise. The karts and
+ *  objects which do not fit in the budget are left out, starting with the
+ *  least relevant ones which were sent most recently. The karts of the peer
+ *  itself are always sent.
+ */
+class InterestManager : public NoCopy
+{
+private:
+    struct PeerInterest
+    {
+        /** Last state ticks each rewinder was sent to this peer. */
+        std::map<std::string, int> m_last_sent;
+
+        /** Physical objects which changed but were not sent yet, they
+         *  only save a state when moving so it must be delivered later. */
+        std::set<std::string> m_pending;
+
+        /** Bandwidth for states in bytes per second (negative until the
+         *  first state), and the bytes which can be sent now. */
+        float m_rate;
+        float m_budget;
+
+        /** Lowest ping seen, the ping of the link without queued packets. */
+        uint32_t m_min_ping;
+
+        /** Time in ms the rate was adapted last. */
+        uint64_t m_last_adapt;
+
+        PeerInterest() : m_rate(-1.0f), m_budget(0.0f), m_min_ping(0),
+                         m_last_adapt(0) {}
+    };
+
+    /** The rewinder states saved in the current state. */
+    std::vector<std::pair<std::string, BareNetworkString> > m_states;
+
+    /** Latest saved state of each physical object. */
+    std::map<std::string, BareNetworkString> m_last_object_state;
+
+    /** Interest information for each peer, indexed by host id. */
+    std::map<uint32_t, PeerInterest> m_peers;
+
+    /** Ticks of the current state. */
+    int m_ticks;
+
+    /** Number of physics ticks between two states. */
+    int m_state_interval;
+
+    /** Copies of the server config at the start of the game. */
+    bool m_relevance_filter;
+    bool m_rate_control;
+
+    /** Total bytes sent and bytes a full state would have used. */
+    uint64_t m_total_sent;
+    uint64_t m_total_full;
+
+    // ------------------------------------------------------------------------
+    struct Focus
+    {
+        Vec3 m_xyz;
+        Vec3 m_forward;
+        int  m_team;
+    };
+    void getFocus(STKPeer* peer, std::vector<Focus>* focus) const;
+    float getRelevance(const std::vector<Focus>& focus, const Vec3& xyz,
+                       int team) const;
+    int getUpdateInterval(float relevance) const;
+    bool getPosition(const std::string& uid, Vec3* xyz, int* team) const;
+    bool isFiltered(const std::string& uid) const;
+    void adaptRate(STKPeer* peer, PeerInterest* pi, uint64_t now) const;
+
+public:
+    InterestManager();
+    // ------------------------------------------------------------------------
+    ~InterestManager();
+    // ------------------------------------------------------------------------
+    void startNewState(int ticks);
+    // ------------------------------------------------------------------------
+    void addState(const std::string& uid, const BareNetworkString& buffer);
+    // ------------------------------------------------------------------------
+    void sendStates(NetworkString* header);
+
+};   // class InterestManager
+
+#endif
@@ -53,6 +53,8 @@ void showHelp()
     std::cout << "listpeers, List all peers with host ID and IP." << std::endl;
     std::cout << "listban, List IP ban list of server." << std::endl;
     std::cout << "speedstats, Show upload and download speed." << std::endl;
+    std::cout << "statestats, Show game state bytes sent to each peer, and "
+        "the rate chosen by state-rate-control." << std::endl;
 }   // showHelp
 
 // ----------------------------------------------------------------------------
@@ -178,6 +180,31 @@ void mainLoop(STKHost* host)
                 "   Download speed (KBps): " <<
                 (float)host->getDownloadSpeed() / 1024.0f  << std::endl;
         }
+        else if (str == "statestats")
+        {
+            auto peers = host->getPeers();
+            if (peers.empty())
+                std::cout << "No peers exist" << std::endl;
+            for (unsigned int i = 0; i < peers.size(); i++)
+            {
+                uint64_t sent = peers[i]->getStateBytesSent();
+                uint64_t full = peers[i]->getStateBytesFull();
+                std::cout << peers[i]->getHostId() << ": " <<
+                    peers[i]->getAddress().toString() << " state KB sent: " <<
+                    (float)sent / 1024.0f << " of " <<
+                    (float)full / 1024.0f;
+                if (peers[i]->getStateRate() > 0)
+                {
+                    std::cout << ", rate (KBps): " <<
+                        (float)peers[i]->getStateRate() / 1024.0f <<
+                        ", ping: " << peers[i]->getAveragePing() <<
+                        ", packet loss (%): " <<
+                        (float)peers[i]->getPacketLoss() * 100.0f /
+                        (float)ENET_PEER_PACKET_LOSS_SCALE;
+                }
+                std::cout << std::endl;
+            }
+        }
         else
         {
             std::cout << "Unknown command: " << str << std::endl;
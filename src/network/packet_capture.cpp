@@ -0,0 +1,378 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/packet_capture.hpp"
+
+#include "config/stk_config.hpp"
+#include "io/file_manager.hpp"
+#include "network/event.hpp"
+#include "network/network_string.hpp"
+#include "network/server_config.hpp"
+#include "network/socket_address.hpp"
+#include "network/stk_peer.hpp"
+#include "utils/constants.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+    const char* CAPTURE_MAGIC = "stk-packet-capture";
+    const uint8_t CAPTURE_FORMAT = 1;
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Opens the capture file, an existing file is overwritten.
+ *  \param path Full path of the file.
+ */
+PacketCapture::PacketCapture(const std::string& path)
+{
+    m_start_time = StkTime::getMonoTimeUs();
+    m_last_flush = m_start_time;
+    m_num_records = 0;
+    m_num_bytes = 0;
+    m_file = FileUtils::fopenU8Path(path, "wb");
+    if (!m_file)
+    {
+        Log::error("PacketCapture", "Cannot open '%s' for writing.",
+            path.c_str());
+        return;
+    }
+    BareNetworkString header;
+    header.encodeString(std::string(CAPTURE_MAGIC)).addUInt8(CAPTURE_FORMAT)
+        .addUInt32(ServerConfig::m_server_version)
+        .addUInt16((uint16_t)stk_config->getPhysicsFPS())
+        .addUInt64(StkTime::getTimeSinceEpoch())
+        .encodeString(std::string(STK_VERSION));
+    write(header);
+    Log::info("PacketCapture", "Capturing game packets in '%s'.",
+        path.c_str());
+}   // PacketCapture
+
+// ----------------------------------------------------------------------------
+PacketCapture::~PacketCapture()
+{
+    if (!m_file)
+        return;
+    fclose(m_file);
+    Log::info("PacketCapture", "Captured %llu records, %llu bytes.",
+        (unsigned long long)m_num_records, (unsigned long long)m_num_bytes);
+}   // ~PacketCapture
+
+// ----------------------------------------------------------------------------
+/** Writes a chunk with its size, the caller must hold the mutex (or be the
+ *  constructor). */
+void PacketCapture::write(const BareNetworkString& s)
+{
+    const uint32_t size = s.getTotalSize();
+    const uint8_t size_bytes[4] = { (uint8_t)(size >> 24),
+        (uint8_t)(size >> 16), (uint8_t)(size >> 8), (uint8_t)size };
+    fwrite(size_bytes, 1, 4, m_file);
+    fwrite(s.getData(), 1, size, m_file);
+    m_num_bytes += size + 4;
+}   // write
+
+// ----------------------------------------------------------------------------
+PacketCapture::Record PacketCapture::startRecord(RecordType type,
+                                                 const STKPeer* peer) const
+{
+    Record r;
+    r.m_time = StkTime::getMonoTimeUs() - m_start_time;
+    r.m_type = type;
+    r.m_host_id = peer->getHostId();
+    r.m_value = 0;
+    r.m_packet_loss = 0;
+    return r;
+}   // startRecord
+
+// ----------------------------------------------------------------------------
+/** Writes a record, thread-safe. */
+void PacketCapture::add(const Record& record)
+{
+    if (!m_file)
+        return;
+    BareNetworkString s((int)record.m_data.size() + 16);
+    s.addUInt64(record.m_time).addUInt8(record.m_type)
+        .addUInt32(record.m_host_id);
+    switch (record.m_type)
+    {
+    case PCR_CONNECT:
+        s.encodeString(record.m_address);
+        break;
+    case PCR_DISCONNECT:
+        s.addUInt32(record.m_value);
+        break;
+    case PCR_RECEIVE:
+    case PCR_SEND:
+        s.addUInt8((uint8_t)record.m_value);
+        s.getBuffer().insert(s.getBuffer().end(), record.m_data.begin(),
+            record.m_data.end());
+        break;
+    case PCR_PEER_STATS:
+        s.addUInt32(record.m_value).addUInt32(record.m_packet_loss);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    write(s);
+    m_num_records++;
+    // Flush once per second, so that little is lost if the server crashes
+    const uint64_t now = StkTime::getMonoTimeUs();
+    if (now > m_last_flush + 1000000)
+    {
+        fflush(m_file);
+        m_last_flush = now;
+    }
+}   // add
+
+// ----------------------------------------------------------------------------
+/** Records an event given to the protocol manager.
+ *  \param channel The enet channel of a message.
+ */
+void PacketCapture::addEvent(const Event* event, uint8_t channel)
+{
+    switch (event->getType())
+    {
+    case EVENT_TYPE_CONNECTED:
+    {
+        Record r = startRecord(PCR_CONNECT, event->getPeer());
+        r.m_address = event->getPeer()->getAddress().toString();
+        add(r);
+        break;
+    }
+    case EVENT_TYPE_DISCONNECTED:
+    {
+        Record r = startRecord(PCR_DISCONNECT, event->getPeer());
+        r.m_value = event->getPeerDisconnectInfo();
+        add(r);
+        break;
+    }
+    case EVENT_TYPE_MESSAGE:
+    {
+        Record r = startRecord(PCR_RECEIVE, event->getPeer());
+        r.m_value = channel;
+        r.m_data.assign(event->data().getData(), event->data().getTotalSize());
+        add(r);
+        break;
+    }
+    }
+}   // addEvent
+
+// ----------------------------------------------------------------------------
+/** Records a message sent to a peer (before it is encrypted). */
+void PacketCapture::addSent(const STKPeer* peer, const NetworkString* data,
+                            bool reliable)
+{
+    Record r = startRecord(PCR_SEND, peer);
+    r.m_value = reliable ? 1 : 0;
+    r.m_data.assign(data->getData(), data->getTotalSize());
+    add(r);
+}   // addSent
+
+// ----------------------------------------------------------------------------
+/** Records the ping and packet loss of a peer as measured by enet. */
+void PacketCapture::addPeerStats(const STKPeer* peer, uint32_t rtt,
+                                 uint32_t packet_loss)
+{
+    Record r = startRecord(PCR_PEER_STATS, peer);
+    r.m_value = rtt;
+    r.m_packet_loss = packet_loss;
+    add(r);
+}   // addPeerStats
+
+// ----------------------------------------------------------------------------
+/** Reads a capture file. A truncated last record (e.g. if the server was
+ *  killed) is ignored.
+ *  \return False if the file cannot be read or is not a capture.
+ */
+bool PacketCapture::load(const std::string& path, Header* header,
+                         std::vector<Record>* records)
+{
+    FILE* file = FileUtils::fopenU8Path(path, "rb");
+    if (!file)
+    {
+        Log::error("PacketCapture", "Cannot open '%s'.", path.c_str());
+        return false;
+    }
+
+    bool has_header = false;
+    std::vector<char> buffer;
+    while (true)
+    {
+        uint8_t size_bytes[4];
+        if (fread(size_bytes, 1, 4, file) != 4)
+            break;
+        const uint32_t size = ((uint32_t)size_bytes[0] << 24) |
+            ((uint32_t)size_bytes[1] << 16) | ((uint32_t)size_bytes[2] << 8) |
+            size_bytes[3];
+        buffer.resize(size);
+        if (size > 0 && fread(buffer.data(), 1, size, file) != size)
+        {
+            Log::warn("PacketCapture", "Ignoring truncated record at the end "
+                "of '%s'.", path.c_str());
+            break;
+        }
+        BareNetworkString s(buffer.data(), (int)size);
+        try
+        {
+            if (!has_header)
+            {
+                std::string magic;
+                s.decodeString(&magic);
+                if (magic != CAPTURE_MAGIC || s.getUInt8() != CAPTURE_FORMAT)
+                {
+                    Log::error("PacketCapture", "'%s' is not a packet "
+                        "capture of this version of STK.", path.c_str());
+                    fclose(file);
+                    return false;
+                }
+                header->m_server_version = s.getUInt32();
+                header->m_physics_fps = s.getUInt16();
+                header->m_start_date = s.getUInt64();
+                s.decodeString(&header->m_stk_version);
+                has_header = true;
+                continue;
+            }
+            Record r;
+            r.m_time = s.getUInt64();
+            r.m_type = (RecordType)s.getUInt8();
+            r.m_host_id = s.getUInt32();
+            r.m_value = 0;
+            r.m_packet_loss = 0;
+            switch (r.m_type)
+            {
+            case PCR_CONNECT:
+                s.decodeString(&r.m_address);
+                break;
+            case PCR_DISCONNECT:
+                r.m_value = s.getUInt32();
+                break;
+            case PCR_RECEIVE:
+            case PCR_SEND:
+                r.m_value = s.getUInt8();
+                r.m_data.assign(s.getCurrentData(), s.size());
+                break;
+            case PCR_PEER_STATS:
+                r.m_value = s.getUInt32();
+                r.m_packet_loss = s.getUInt32();
+                break;
+            default:
+                throw std::runtime_error("Unknown record type.");
+            }
+            records->push_back(std::move(r));
+        }
+        catch (std::exception& e)
+        {
+            Log::warn("PacketCapture", "Invalid record in '%s' after %d "
+                "records: %s", path.c_str(), (int)records->size(), e.what());
+            break;
+        }
+    }
+    fclose(file);
+    if (!has_header)
+    {
+        Log::error("PacketCapture", "'%s' is empty.", path.c_str());
+        return false;
+    }
+    return true;
+}   // load
+
+// ----------------------------------------------------------------------------
+void PacketCapture::unitTesting()
+{
+    const std::string file =
+        file_manager->getUserConfigFile("packet_capture_test.stkcap");
+    std::vector<Record> written;
+    {
+        PacketCapture capture(file);
+        assert(capture.isOpen());
+        Record r;
+        r.m_time = 100;
+        r.m_type = PCR_CONNECT;
+        r.m_host_id = 1;
+        r.m_value = 0;
+        r.m_packet_loss = 0;
+        r.m_address = "192.168.0.10:2757";
+        written.push_back(r);
+
+        r.m_time = 2500;
+        r.m_type = PCR_RECEIVE;
+        r.m_address.clear();
+        r.m_value = EVENT_CHANNEL_NORMAL;
+        // Binary data, including zeros
+        r.m_data = std::string("\x01\x00\x02\xff", 4);
+        written.push_back(r);
+
+        r.m_time = 2600;
+        r.m_type = PCR_SEND;
+        r.m_value = 1;
+        r.m_data = std::string(2000, 'x');
+        written.push_back(r);
+
+        r.m_time = 100000;
+        r.m_type = PCR_PEER_STATS;
+        r.m_data.clear();
+        r.m_value = 53;
+        r.m_packet_loss = 1200;
+        written.push_back(r);
+
+        r.m_time = 1000000000000ull;
+        r.m_type = PCR_DISCONNECT;
+        r.m_packet_loss = 0;
+        r.m_value = PDI_KICK;
+        written.push_back(r);
+
+        for (const Record& w : written)
+            capture.add(w);
+    }
+
+    Header header;
+    std::vector<Record> read;
+    assert(load(file, &header, &read));
+    assert(header.m_server_version ==
+        (uint32_t)ServerConfig::m_server_version);
+    assert(header.m_physics_fps == stk_config->getPhysicsFPS());
+    assert(header.m_stk_version == STK_VERSION);
+    assert(read.size() == written.size());
+    for (unsigned i = 0; i < read.size(); i++)
+    {
+        assert(read[i].m_time == written[i].m_time);
+        assert(read[i].m_type == written[i].m_type);
+        assert(read[i].m_host_id == written[i].m_host_id);
+        assert(read[i].m_value == written[i].m_value);
+        assert(read[i].m_packet_loss == written[i].m_packet_loss);
+        assert(read[i].m_address == written[i].m_address);
+        assert(read[i].m_data == written[i].m_data);
+    }
+
+    // A truncated record at the end is dropped
+    FILE* f = FileUtils::fopenU8Path(file, "ab");
+    const uint8_t partial[6] = { 0, 0, 0, 100, 1, 2 };
+    fwrite(partial, 1, 6, f);
+    fclose(f);
+    read.clear();
+    assert(load(file, &header, &read));
+    assert(read.size() == written.size());
+    remove(file.c_str());
+}   // unitTesting
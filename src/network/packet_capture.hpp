@@ -0,0 +1,127 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_PACKET_CAPTURE_HPP
+#define HEADER_PACKET_CAPTURE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class BareNetworkString;
+class Event;
+class NetworkString;
+class STKPeer;
+
+/** \ingroup network
+ *  Records the game packets of a server for offline replays (see
+ *  PacketReplay): connections, disconnections and messages received from
+ *  each peer, the messages sent to it and its ping, with microsecond
+ *  timestamps. Messages are stored as the protocols see them, i.e.
+ *  decrypted. The file is a header followed by records, each of them a
+ *  32 bit size followed by a BareNetworkString.
+ *  Captures contain player names and addresses, and everything they said
+ *  in the chat.
+ */
+class PacketCapture : public NoCopy
+{
+public:
+    enum RecordType : uint8_t
+    {
+        PCR_CONNECT = 0,
+        PCR_DISCONNECT,
+        PCR_RECEIVE,
+        PCR_SEND,
+        PCR_PEER_STATS,
+        PCR_COUNT
+    };
+
+    struct Record
+    {
+        /** Microseconds since the start of the capture. */
+        uint64_t    m_time;
+        RecordType  m_type;
+        uint32_t    m_host_id;
+        /** Channel (received), reliable flag (sent), disconnect info or
+         *  round trip time in ms (peer stats). */
+        uint32_t    m_value;
+        /** Packet loss as reported by enet (peer stats). */
+        uint32_t    m_packet_loss;
+        /** Address of the peer (connect). */
+        std::string m_address;
+        /** Message including the protocol type (received and sent). */
+        std::string m_data;
+    };
+
+    struct Header
+    {
+        uint32_t    m_server_version;
+        uint16_t    m_physics_fps;
+        /** Seconds since 1.1.1970 when the capture started. */
+        uint64_t    m_start_date;
+        std::string m_stk_version;
+    };
+
+private:
+    FILE* m_file;
+
+    /** Records are added by the network and the main thread. */
+    std::mutex m_mutex;
+
+    uint64_t m_start_time;
+
+    uint64_t m_last_flush;
+
+    uint64_t m_num_records;
+
+    uint64_t m_num_bytes;
+
+    // ------------------------------------------------------------------------
+    void write(const BareNetworkString& s);
+    // ------------------------------------------------------------------------
+    Record startRecord(RecordType type, const STKPeer* peer) const;
+
+public:
+    PacketCapture(const std::string& path);
+    // ------------------------------------------------------------------------
+    ~PacketCapture();
+    // ------------------------------------------------------------------------
+    bool isOpen() const                              { return m_file != NULL; }
+    // ------------------------------------------------------------------------
+    void add(const Record& record);
+    // ------------------------------------------------------------------------
+    void addEvent(const Event* event, uint8_t channel);
+    // ------------------------------------------------------------------------
+    void addSent(const STKPeer* peer, const NetworkString* data,
+                 bool reliable);
+    // ------------------------------------------------------------------------
+    void addPeerStats(const STKPeer* peer, uint32_t rtt,
+                      uint32_t packet_loss);
+    // ------------------------------------------------------------------------
+    static bool load(const std::string& path, Header* header,
+                     std::vector<Record>* records);
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class PacketCapture
+
+#endif
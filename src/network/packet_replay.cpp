@@ -0,0 +1,373 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/packet_replay.hpp"
+
+#include "config/stk_config.hpp"
+#include "modes/world.hpp"
+#include "network/event.hpp"
+#include "network/protocol_manager.hpp"
+#include "network/race_event_manager.hpp"
+#include "network/server_config.hpp"
+#include "network/socket_address.hpp"
+#include "network/stk_host.hpp"
+#include "network/stk_peer.hpp"
+#include "race/race_manager.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+/** Loads the capture.
+ *  \param path Path of the capture file.
+ */
+PacketReplay::PacketReplay(const std::string& path)
+{
+    m_captured_messages = 0;
+    m_sent_messages = 0;
+    m_sent_bytes = 0;
+    m_identical_messages = 0;
+    m_different_messages = 0;
+    m_unexpected_messages = 0;
+    m_rejected_events = 0;
+    m_async_time = 0;
+    m_protocol_time = 0;
+    m_world_time = 0;
+    m_world_ticks = 0;
+    m_loaded = PacketCapture::load(path, &m_header, &m_records);
+    if (!m_loaded)
+        return;
+    Log::info("PacketReplay", "Loaded %d records of STK %s (server version "
+        "%d) captured on %s.", (int)m_records.size(),
+        m_header.m_stk_version.c_str(), m_header.m_server_version,
+        StkTime::toString((StkTime::TimeType)m_header.m_start_date).c_str());
+    if (m_header.m_server_version != (uint32_t)ServerConfig::m_server_version
+        || m_header.m_physics_fps != stk_config->getPhysicsFPS())
+    {
+        Log::warn("PacketReplay", "The capture was made with server version "
+            "%d and %d physics fps, the replay will differ.",
+            m_header.m_server_version, m_header.m_physics_fps);
+    }
+}   // PacketReplay
+
+// ----------------------------------------------------------------------------
+PacketReplay::~PacketReplay()
+{
+}   // ~PacketReplay
+
+// ----------------------------------------------------------------------------
+void PacketReplay::propagateEvent(Event* event)
+{
+    auto pm = ProtocolManager::lock();
+    if (pm && !pm->isExiting())
+        pm->propagateEvent(event);
+    else
+        delete event;
+}   // propagateEvent
+
+// ----------------------------------------------------------------------------
+/** Gives a captured record to the server like STKHost::mainLoop does for
+ *  the enet events. */
+void PacketReplay::replayRecord(const PacketCapture::Record& r)
+{
+    STKHost* host = STKHost::get();
+    if (r.m_type == PacketCapture::PCR_SEND)
+    {
+        m_expected[r.m_host_id].push_back(&r.m_data);
+        m_captured_messages++;
+        return;
+    }
+
+    if (r.m_type == PacketCapture::PCR_CONNECT)
+    {
+        ENetPeer* enet_peer = new ENetPeer();
+        enet_peer->state = ENET_PEER_STATE_CONNECTED;
+        enet_peer->address = SocketAddress(r.m_address).toENetAddress();
+        m_enet_peers[r.m_host_id].reset(enet_peer);
+        // Use the captured host id, so that the messages and the server
+        // log can be compared with the ones of the capture
+        auto stk_peer = std::make_shared<STKPeer>(enet_peer, host,
+                                                  r.m_host_id);
+        std::unique_lock<std::mutex> lock(host->m_peers_mutex);
+        host->m_peers[enet_peer] = stk_peer;
+        host->m_next_unique_host_id =
+            std::max(host->m_next_unique_host_id, r.m_host_id);
+        lock.unlock();
+        ENetEvent event = {};
+        event.type = ENET_EVENT_TYPE_CONNECT;
+        event.peer = enet_peer;
+        propagateEvent(new Event(&event, stk_peer));
+        return;
+    }
+
+    auto it = m_enet_peers.find(r.m_host_id);
+    if (it == m_enet_peers.end())
+        return;
+    ENetPeer* enet_peer = it->second.get();
+    std::unique_lock<std::mutex> lock(host->m_peers_mutex);
+    auto peer_it = host->m_peers.find(enet_peer);
+    if (peer_it == host->m_peers.end())
+    {
+        // Removed by the server in the replay (e.g. not validated in time)
+        if (r.m_type == PacketCapture::PCR_RECEIVE)
+            m_rejected_events++;
+        return;
+    }
+    std::shared_ptr<STKPeer> peer = peer_it->second;
+
+    switch (r.m_type)
+    {
+    case PacketCapture::PCR_DISCONNECT:
+    {
+        host->m_peers.erase(peer_it);
+        lock.unlock();
+        enet_peer->state = ENET_PEER_STATE_DISCONNECTED;
+        ENetEvent event = {};
+        event.type = ENET_EVENT_TYPE_DISCONNECT;
+        event.peer = enet_peer;
+        event.data = r.m_value;
+        propagateEvent(new Event(&event, peer));
+        break;
+    }
+    case PacketCapture::PCR_RECEIVE:
+    {
+        lock.unlock();
+        ENetEvent event = {};
+        event.type = ENET_EVENT_TYPE_RECEIVE;
+        event.peer = enet_peer;
+        event.channelID = (uint8_t)r.m_value;
+        event.packet = enet_packet_create(r.m_data.data(), r.m_data.size(),
+            ENET_PACKET_FLAG_RELIABLE);
+        Event* stk_event = NULL;
+        try
+        {
+            stk_event = new Event(&event, peer);
+        }
+        catch (std::exception& e)
+        {
+            Log::warn("PacketReplay", "%s", e.what());
+            enet_packet_destroy(event.packet);
+            m_rejected_events++;
+            return;
+        }
+        propagateEvent(stk_event);
+        break;
+    }
+    case PacketCapture::PCR_PEER_STATS:
+        // Same as the ping update in STKHost::mainLoop
+        enet_peer->roundTripTime = r.m_value;
+        enet_peer->packetLoss = r.m_packet_loss;
+        peer->getPing();
+        peer->setPacketLoss(r.m_packet_loss);
+        break;
+    default:
+        break;
+    }
+}   // replayRecord
+
+// ----------------------------------------------------------------------------
+/** Compares a message sent by the server with the next captured one to the
+ *  same peer. */
+void PacketReplay::compareSent(ENetPeer* peer, const uint8_t* data,
+                               size_t length)
+{
+    m_sent_messages++;
+    m_sent_bytes += length;
+    uint32_t host_id = 0;
+    for (auto& p : m_enet_peers)
+    {
+        if (p.second.get() == peer)
+            host_id = p.first;
+    }
+    std::deque<const std::string*>& expected = m_expected[host_id];
+    if (expected.empty())
+    {
+        m_unexpected_messages++;
+        return;
+    }
+    const std::string* captured = expected.front();
+    expected.pop_front();
+    if (captured->size() == length &&
+        memcmp(captured->data(), data, length) == 0)
+    {
+        m_identical_messages++;
+        return;
+    }
+    m_different_messages++;
+    // The first differences are the interesting ones
+    if (m_different_messages <= 10)
+    {
+        Log::info("PacketReplay", "Message to host %d at %.3f s differs from "
+            "the capture: protocol %d (captured %d), %d bytes (captured %d).",
+            host_id, StkTime::getMonoTimeMs() / 1000.0,
+            length > 0 ? data[0] & ~PROTOCOL_SYNCHRONOUS : -1,
+            captured->empty() ? -1 :
+            (uint8_t)(*captured)[0] & ~PROTOCOL_SYNCHRONOUS,
+            (int)length, (int)captured->size());
+    }
+}   // compareSent
+
+// ----------------------------------------------------------------------------
+/** Handles the commands the listening thread would give to enet: sent
+ *  messages are compared with the capture and dropped. */
+void PacketReplay::handleEnetCommands()
+{
+    STKHost* host = STKHost::get();
+    std::vector<std::tuple<ENetPeer*, ENetPacket*, uint32_t,
+        ENetCommandType, ENetAddress> > commands;
+    std::unique_lock<std::mutex> lock(host->m_enet_cmd_mutex);
+    std::swap(commands, host->m_enet_cmd);
+    lock.unlock();
+
+    for (auto& c : commands)
+    {
+        ENetPeer* peer = std::get<0>(c);
+        ENetPacket* packet = std::get<1>(c);
+        switch (std::get<3>(c))
+        {
+        case ECT_SEND_PACKET:
+            if (peer->state == ENET_PEER_STATE_CONNECTED)
+                compareSent(peer, packet->data, packet->dataLength);
+            break;
+        case ECT_DISCONNECT:
+            // The disconnection event is in the capture
+            break;
+        case ECT_RESET:
+        {
+            peer->state = ENET_PEER_STATE_DISCONNECTED;
+            std::lock_guard<std::mutex> peers_lock(host->m_peers_mutex);
+            host->m_peers.erase(peer);
+            break;
+        }
+        }
+        if (packet)
+            enet_packet_destroy(packet);
+    }
+}   // handleEnetCommands
+
+// ----------------------------------------------------------------------------
+/** Runs the server until the end of the capture (and a few seconds after,
+ *  for the last disconnections) or until it shuts down. */
+void PacketReplay::run()
+{
+    if (!m_loaded || !STKHost::existHost() || !STKHost::m_packet_replay)
+        return;
+
+    const int fps = stk_config->getPhysicsFPS();
+    const uint64_t end_time =
+        (m_records.empty() ? 0 : m_records.back().m_time) + 5000000;
+    const int64_t start_ms = (int64_t)StkTime::getMonoTimeMs();
+    const uint64_t real_start = StkTime::getMonoTimeUs();
+    size_t next_record = 0;
+    uint64_t now = 0;
+    for (uint64_t tick = 0; now <= end_time; tick++)
+    {
+        now = tick * 1000000 / fps;
+        StkTime::setVirtualMonoTimeMs(start_ms + (int64_t)(now / 1000));
+        while (next_record < m_records.size() &&
+               m_records[next_record].m_time <= now)
+        {
+            replayRecord(m_records[next_record++]);
+        }
+        if (STKHost::get()->requestedShutdown())
+        {
+            Log::info("PacketReplay", "Server shut down after %.3f s.",
+                now / 1000000.0);
+            break;
+        }
+
+        const uint64_t tick_start = StkTime::getMonoTimeUs();
+        if (auto pm = ProtocolManager::lock())
+        {
+            pm->asynchronousUpdate();
+            const uint64_t async_end = StkTime::getMonoTimeUs();
+            m_async_time += async_end - tick_start;
+            pm->update(1);
+            m_protocol_time += StkTime::getMonoTimeUs() - async_end;
+        }
+
+        World* w = World::getWorld();
+        if (w && w->getPhase() == WorldStatus::SETUP_PHASE)
+        {
+            w->updateTime(1);
+        }
+        else if (w)
+        {
+            const uint64_t world_start = StkTime::getMonoTimeUs();
+            auto rem = RaceEventManager::get();
+            if (rem && rem->isRunning())
+                rem->update(1, false/*fast_forward*/);
+            else
+                w->updateWorld(1);
+            w->updateTime(1);
+            m_world_time += StkTime::getMonoTimeUs() - world_start;
+            m_world_ticks++;
+        }
+        m_tick_times.push_back(
+            (uint32_t)(StkTime::getMonoTimeUs() - tick_start));
+        handleEnetCommands();
+    }
+    const uint64_t real_time = StkTime::getMonoTimeUs() - real_start;
+    StkTime::setVirtualMonoTimeMs(-1);
+    report(now, real_time);
+
+    if (STKHost::existHost())
+        STKHost::get()->shutdown();
+    if (World::getWorld())
+        RaceManager::get()->exitRace();
+}   // run
+
+// ----------------------------------------------------------------------------
+void PacketReplay::report(uint64_t game_time, uint64_t real_time)
+{
+    Log::info("PacketReplay", "Replayed %.1f s in %.2f s.",
+        game_time / 1000000.0, real_time / 1000000.0);
+    if (!m_tick_times.empty())
+    {
+        std::vector<uint32_t> sorted = m_tick_times;
+        std::sort(sorted.begin(), sorted.end());
+        uint64_t total = 0;
+        for (uint32_t t : sorted)
+            total += t;
+        const size_t n = sorted.size();
+        Log::info("PacketReplay", "%d ticks: %.1f us on average, median %u "
+            "us, 99%% below %u us, max %u us.", (int)n, (double)total / n,
+            sorted[n / 2], sorted[std::min(n - 1, n * 99 / 100)],
+            sorted.back());
+        Log::info("PacketReplay", "Protocol updates %.1f us, asynchronous "
+            "updates %.1f us per tick, world %.1f us in %d ticks with a "
+            "world.", (double)m_protocol_time / n, (double)m_async_time / n,
+            m_world_ticks > 0 ? (double)m_world_time / m_world_ticks : 0.0,
+            m_world_ticks);
+    }
+    uint64_t not_sent = 0;
+    for (auto& e : m_expected)
+        not_sent += e.second.size();
+    Log::info("PacketReplay", "Sent %llu messages (%llu bytes): %llu "
+        "identical to the capture, %llu different, %llu not in the capture. "
+        "%llu of %llu captured messages were not sent, %d received messages "
+        "were rejected.", (unsigned long long)m_sent_messages,
+        (unsigned long long)m_sent_bytes,
+        (unsigned long long)m_identical_messages,
+        (unsigned long long)m_different_messages,
+        (unsigned long long)m_unexpected_messages,
+        (unsigned long long)not_sent,
+        (unsigned long long)m_captured_messages, m_rejected_events);
+}   // report
@@ -0,0 +1,104 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_PACKET_REPLAY_HPP
+#define HEADER_PACKET_REPLAY_HPP
+
+#include "network/packet_capture.hpp"
+#include "utils/no_copy.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Event;
+typedef struct _ENetPeer ENetPeer;
+
+/** \ingroup network
+ *  Runs a server on a PacketCapture instead of the network, to reproduce
+ *  problems of a production server offline and to measure the cost of a
+ *  server tick on real traffic. No socket is opened (see
+ *  STKHost::m_packet_replay): the captured connections, messages and pings
+ *  are given to STKHost and the ProtocolManager at their time on a virtual
+ *  clock which advances one physics tick per loop, as fast as the server
+ *  can go. The protocol manager updates that normally run in their own
+ *  threads are done in the loop, so that each replay of a capture gives the
+ *  same result.
+ *  The messages the server sends are compared with the captured ones, the
+ *  first differences are logged. At the end the time per tick and the
+ *  comparison are reported.
+ *  The server runs as a LAN server with the given server config, which
+ *  should be the one used for the capture.
+ */
+class PacketReplay : public NoCopy
+{
+private:
+    PacketCapture::Header m_header;
+
+    std::vector<PacketCapture::Record> m_records;
+
+    bool m_loaded;
+
+    /** Enet peers of the captured host ids, which the STKPeers point to.
+     *  They are only used to store the address, state and ping. */
+    std::map<uint32_t, std::unique_ptr<ENetPeer> > m_enet_peers;
+
+    /** Messages sent to each peer in the capture, not yet sent again. */
+    std::map<uint32_t, std::deque<const std::string*> > m_expected;
+
+    uint64_t m_captured_messages;
+    uint64_t m_sent_messages;
+    uint64_t m_sent_bytes;
+    uint64_t m_identical_messages;
+    uint64_t m_different_messages;
+    uint64_t m_unexpected_messages;
+    unsigned m_rejected_events;
+
+    /** Duration of each tick in microseconds. */
+    std::vector<uint32_t> m_tick_times;
+    uint64_t m_async_time;
+    uint64_t m_protocol_time;
+    uint64_t m_world_time;
+    unsigned m_world_ticks;
+
+    // ------------------------------------------------------------------------
+    void replayRecord(const PacketCapture::Record& r);
+    // ------------------------------------------------------------------------
+    void propagateEvent(Event* event);
+    // ------------------------------------------------------------------------
+    void handleEnetCommands();
+    // ------------------------------------------------------------------------
+    void compareSent(ENetPeer* peer, const uint8_t* data, size_t length);
+    // ------------------------------------------------------------------------
+    void report(uint64_t game_time, uint64_t real_time);
+
+public:
+    PacketReplay(const std::string& path);
+    // ------------------------------------------------------------------------
+    ~PacketReplay();
+    // ------------------------------------------------------------------------
+    bool isLoaded() const                                 { return m_loaded; }
+    // ------------------------------------------------------------------------
+    void run();
+
+};   // class PacketReplay
+
+#endif
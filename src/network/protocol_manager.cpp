@@ -39,7 +39,14 @@
 // ============================================================================
 std::weak_ptr<ProtocolManager> ProtocolManager::m_protocol_manager[PT_COUNT];
 // ============================================================================
-std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
+/** Creates the protocol manager.
+ *  \param use_threads If false, the asynchronous updates and the controller
+ *         events are not handled in separate threads: asynchronousUpdate()
+ *         must be called in the main loop instead (used by packet replays
+ *         to get the same result each time).
+ */
+std::shared_ptr<ProtocolManager> ProtocolManager::createInstance(
+                                                             bool use_threads)
 {
     if (!emptyInstance())
     {
@@ -51,6 +58,11 @@ std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
     // here
     ProcessType pt = STKProcess::getType();
     auto pm = std::make_shared<ProtocolManager>();
+    if (!use_threads)
+    {
+        m_protocol_manager[pt] = pm;
+        return pm;
+    }
     pm->m_asynchronous_update_thread = std::thread([pm, pt]()
         {
             std::string thread_name = "PtlMgr";
@@ -84,21 +96,7 @@ std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
                     ul.unlock();
                     if (event_top == NULL)
                         break;
-                    auto sl = LobbyProtocol::get<ServerLobby>();
-                    if (sl)
-                    {
-                        ServerLobby::ServerState ss = sl->getCurrentState();
-                        if (!(ss >= ServerLobby::WAIT_FOR_WORLD_LOADED &&
-                            ss <= ServerLobby::RACING))
-                        {
-                            delete event_top;
-                            continue;
-                        }
-                    }
-                    auto gp = GameProtocol::lock();
-                    if (gp)
-                        gp->notifyEventAsynchronous(event_top);
-                    delete event_top;
+                    pm->handleControllerEvent(event_top);
                 }
             });
     }
@@ -106,6 +104,29 @@ std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
     return pm;
 }   // createInstance
 
+// ----------------------------------------------------------------------------
+/** Gives a controller event to the game protocol in a server, and deletes
+ *  the event.
+ */
+void ProtocolManager::handleControllerEvent(Event* event)
+{
+    auto sl = LobbyProtocol::get<ServerLobby>();
+    if (sl)
+    {
+        ServerLobby::ServerState ss = sl->getCurrentState();
+        if (!(ss >= ServerLobby::WAIT_FOR_WORLD_LOADED &&
+            ss <= ServerLobby::RACING))
+        {
+            delete event;
+            return;
+        }
+    }
+    auto gp = GameProtocol::lock();
+    if (gp)
+        gp->notifyEventAsynchronous(event);
+    delete event;
+}   // handleControllerEvent
+
 // ----------------------------------------------------------------------------
 ProtocolManager::ProtocolManager()
 {
@@ -160,7 +181,7 @@ void ProtocolManager::OneProtocolType::abort()
 void ProtocolManager::abort()
 {
     m_exit.store(true);
-    if (NetworkConfig::get()->isServer())
+    if (m_game_protocol_thread.joinable())
     {
         std::unique_lock<std::mutex> ul(m_game_protocol_mutex);
         m_controller_events_list.push_back(NULL);
@@ -169,7 +190,8 @@ void ProtocolManager::abort()
         m_game_protocol_thread.join();
     }
     // wait the thread to finish
-    m_asynchronous_update_thread.join();
+    if (m_asynchronous_update_thread.joinable())
+        m_asynchronous_update_thread.join();
 }   // abort
 
 // ----------------------------------------------------------------------------
@@ -184,6 +206,11 @@ void ProtocolManager::propagateEvent(Event* event)
         event->getType() == EVENT_TYPE_MESSAGE &&
         event->data().getProtocolType() == PROTOCOL_CONTROLLER_EVENTS)
     {
+        if (!m_game_protocol_thread.joinable())
+        {
+            handleControllerEvent(event);
+            return;
+        }
         std::lock_guard<std::mutex> lock(m_game_protocol_mutex);
         m_controller_events_list.push_back(event);
         m_game_protocol_cv.notify_one();
@@ -424,7 +451,8 @@ void ProtocolManager::update(int ticks)
  *  protocols that they have events to process. Then ask all protocols
  *  to update themselves. Finally processes stored requests about
  *  starting, stopping, pausing etc... protocols.
- *  This function is called in a separate thread running in this instance.
+ *  This function is called in a separate thread running in this instance,
+ *  or by the main loop of a packet replay (see createInstance).
  *  This function IS NOT FPS-dependant.
  */
 void ProtocolManager::asynchronousUpdate()
@@ -180,7 +180,7 @@ private:
     bool sendEvent(Event* event,
                    std::array<OneProtocolType, PROTOCOL_MAX>& protocols);
 
-    void asynchronousUpdate();
+    void handleControllerEvent(Event* event);
 
 public:
     // ===========================================
@@ -194,6 +194,7 @@ public:
     void      requestTerminate(std::shared_ptr<Protocol> protocol);
     void      findAndTerminate(ProtocolType type);
     void      update(int ticks);
+    void      asynchronousUpdate();
     // ------------------------------------------------------------------------
     bool isExiting() const                            { return m_exit.load(); }
     // ------------------------------------------------------------------------
@@ -202,7 +203,8 @@ public:
         return m_asynchronous_update_thread; 
     }   // getThreadID
     // ------------------------------------------------------------------------
-    static std::shared_ptr<ProtocolManager> createInstance();
+    static std::shared_ptr<ProtocolManager> createInstance(
+                                                     bool use_threads = true);
     // ------------------------------------------------------------------------
     static bool emptyInstance()
     {
@@ -111,6 +111,7 @@ ClientLobby::ClientLobby(std::shared_ptr<Server> s)
     m_server_enabled_chat = true;
     m_server_enabled_track_voting = true;
     m_server_enabled_report_player = false;
+    m_player_list_version = 0;
 }   // ClientLobby
 
 //-----------------------------------------------------------------------------
@@ -174,6 +175,7 @@ bool ClientLobby::notifyEvent(Event* event)
         case LE_RACE_FINISHED:         raceFinished(event);        break;
         case LE_BACK_LOBBY:            backToLobby(event);         break;
         case LE_UPDATE_PLAYER_LIST:    updatePlayerList(event);    break;
+        case LE_PLAYER_LIST_DIFF:      updatePlayerListDiff(event); break;
         case LE_CHAT:                  handleChat(event);          break;
         case LE_CONNECTION_ACCEPTED:   connectionAccepted(event);  break;
         case LE_SERVER_INFO:           handleServerInfo(event);    break;
@@ -773,6 +775,109 @@ void ClientLobby::updatePlayerList(Event* event)
     if (!checkDataSize(event, 1)) return;
     NetworkString& data = event->data();
     bool waiting = data.getUInt8() == 1;
+    unsigned player_count = data.getUInt8();
+    setPlayerList(data, waiting, player_count);
+    // The version of this list, the next diff is based on it
+    m_player_list_version = data.getUInt32();
+}   // updatePlayerList
+
+//-----------------------------------------------------------------------------
+/** Applies the removed, added and changed players sent by the server to the
+ *  current player list. If the list it is based on isn't the current one
+ *  the full list is requested from the server.
+ */
+void ClientLobby::updatePlayerListDiff(Event* event)
+{
+    if (!checkDataSize(event, 10)) return;
+    NetworkString& data = event->data();
+    uint32_t base_version = data.getUInt32();
+    uint32_t version = data.getUInt32();
+    bool waiting = data.getUInt8() == 1;
+    if (base_version != m_player_list_version || m_player_list_version == 0)
+    {
+        Log::warn("ClientLobby", "Player list version %d doesn't match %d, "
+            "requesting full list.", base_version, m_player_list_version);
+        requestFullPlayerList();
+        return;
+    }
+
+    unsigned removed = data.getUInt8();
+    for (unsigned i = 0; i < removed; i++)
+    {
+        uint64_t key = (uint64_t)data.getUInt32() << 8;
+        key |= data.getUInt8();
+        for (auto it = m_player_list_data.begin();
+            it != m_player_list_data.end(); it++)
+        {
+            if (it->first == key)
+            {
+                m_player_list_data.erase(it);
+                break;
+            }
+        }
+    }
+    unsigned changed = data.getUInt8();
+    for (unsigned i = 0; i < changed; i++)
+    {
+        unsigned position = data.getUInt8();
+        unsigned size = data.getUInt16();
+        if (size > data.size())
+        {
+            requestFullPlayerList();
+            return;
+        }
+        std::string entry(data.getCurrentData(), size);
+        data.skip(size);
+        BareNetworkString entry_data(entry.c_str(), (int)entry.size());
+        uint64_t key = (uint64_t)entry_data.getUInt32() << 8;
+        entry_data.getUInt32();
+        key |= entry_data.getUInt8();
+        bool found = false;
+        for (auto& player : m_player_list_data)
+        {
+            if (player.first == key)
+            {
+                player.second = entry;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            position = std::min(position, (unsigned)m_player_list_data.size());
+            m_player_list_data.emplace(m_player_list_data.begin() + position,
+                key, entry);
+        }
+    }
+
+    std::string all_players;
+    for (auto& player : m_player_list_data)
+        all_players += player.second;
+    BareNetworkString list(all_players.c_str(), (int)all_players.size());
+    setPlayerList(list, waiting, (unsigned)m_player_list_data.size());
+    m_player_list_version = version;
+}   // updatePlayerListDiff
+
+//-----------------------------------------------------------------------------
+void ClientLobby::requestFullPlayerList()
+{
+    m_player_list_version = 0;
+    NetworkString* request = getNetworkString(1);
+    request->setSynchronous(true);
+    request->addUInt8(LE_PLAYER_LIST_DIFF);
+    sendToServer(request, /*reliable*/true);
+    delete request;
+}   // requestFullPlayerList
+
+//-----------------------------------------------------------------------------
+/** Reads the players of a player list and updates the lobby with them.
+ *  \param data Message at the first player.
+ *  \param waiting True if a game is running on the server.
+ *  \param player_count Number of players in data.
+ */
+void ClientLobby::setPlayerList(const BareNetworkString& data, bool waiting,
+                                unsigned player_count)
+{
     if (m_waiting_for_game && !waiting)
     {
         // The waiting game finished
@@ -780,12 +885,13 @@ void ClientLobby::updatePlayerList(Event* event)
     }
 
     m_waiting_for_game = waiting;
-    unsigned player_count = data.getUInt8();
     core::stringw total_players;
     m_lobby_players.clear();
+    m_player_list_data.clear();
     bool client_server_owner = false;
     for (unsigned i = 0; i < player_count; i++)
     {
+        int entry_start = data.getCurrentOffset();
         LobbyPlayer lp = {};
         lp.m_host_id = data.getUInt32();
         lp.m_online_id = data.getUInt32();
@@ -827,6 +933,10 @@ void ClientLobby::updatePlayerList(Event* event)
         }
         data.decodeString(&lp.m_country_code);
         m_lobby_players.push_back(lp);
+        m_player_list_data.emplace_back(
+            ((uint64_t)lp.m_host_id << 8) | local_id,
+            std::string(data.getData() + entry_start,
+            data.getCurrentOffset() - entry_start));
     }
     STKHost::get()->setAuthorisedToControl(client_server_owner);
 
@@ -838,7 +948,7 @@ void ClientLobby::updatePlayerList(Event* event)
 
     if (!GUIEngine::isNoGraphics())
         NetworkingLobby::getInstance()->updatePlayers();
-}   // updatePlayerList
+}   // setPlayerList
 
 //-----------------------------------------------------------------------------
 void ClientLobby::handleBadTeam()
@@ -66,6 +66,10 @@ private:
     // race votes
     void receivePlayerVote(Event* event);
     void updatePlayerList(Event* event);
+    void updatePlayerListDiff(Event* event);
+    void requestFullPlayerList();
+    void setPlayerList(const BareNetworkString& data, bool waiting,
+                       unsigned player_count);
     void handleChat(Event* event);
     void handleServerInfo(Event* event);
     void reportSuccess(Event* event);
@@ -128,6 +132,14 @@ private:
 
     std::vector<LobbyPlayer> m_lobby_players;
 
+    /** Encoded players of the current list with their host and local player
+     *  id, so that diffs from the server can be applied. */
+    std::vector<std::pair<uint64_t, std::string> > m_player_list_data;
+
+    /** Version of the current player list, 0 if the server doesn't support
+     *  player list diffs. */
+    uint32_t m_player_list_version;
+
     std::vector<float> m_ranking_changes;
 
     irr::core::stringw m_total_players;
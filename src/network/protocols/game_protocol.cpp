@@ -25,12 +25,14 @@
 #include "network/event.hpp"
 #include "network/network_config.hpp"
 #include "network/game_setup.hpp"
+#include "network/interest_manager.hpp"
 #include "network/network.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
 #include "network/protocol_manager.hpp"
 #include "network/rewind_info.hpp"
 #include "network/rewind_manager.hpp"
+#include "network/server_config.hpp"
 #include "network/socket_address.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
@@ -63,6 +65,11 @@ GameProtocol::GameProtocol()
     m_network_item_manager = static_cast<NetworkItemManager*>
         (Track::getCurrentTrack()->getItemManager());
     m_data_to_send = getNetworkString();
+    m_state_ticks = 0;
+    if (NetworkConfig::get()->isServer() &&
+        (ServerConfig::m_state_relevance_filter ||
+        ServerConfig::m_state_rate_control))
+        m_interest_manager.reset(new InterestManager());
 }   // GameProtocol
 
 //-----------------------------------------------------------------------------
@@ -285,21 +292,26 @@ void GameProtocol::handleItemEventConfirmation(Event *event)
 void GameProtocol::startNewState()
 {
     assert(NetworkConfig::get()->isServer());
+    m_state_ticks = World::getWorld()->getTicksSinceStart();
     m_data_to_send->clear();
-    m_data_to_send->addUInt8(GP_STATE)
-        .addUInt32(World::getWorld()->getTicksSinceStart());
+    m_data_to_send->addUInt8(GP_STATE).addUInt32(m_state_ticks);
+    if (m_interest_manager)
+        m_interest_manager->startNewState(m_state_ticks);
 }   // startNewState
 
 // ----------------------------------------------------------------------------
 /** Called by a server to add data to the current state. The data in buffer
  *  is copied, so the data can be freed after this call/.
+ *  \param uid Unique identity of the rewinder which saved the data.
  *  \param buffer Adds the data in the buffer to the current state.
  */
-void GameProtocol::addState(BareNetworkString *buffer)
+void GameProtocol::addState(const std::string& uid, BareNetworkString *buffer)
 {
     assert(NetworkConfig::get()->isServer());
     m_data_to_send->addUInt16(buffer->size());
     (*m_data_to_send) += *buffer;
+    if (m_interest_manager)
+        m_interest_manager->addState(uid, *buffer);
 }   // addState
 
 // ----------------------------------------------------------------------------
@@ -328,11 +340,20 @@ void GameProtocol::finalizeState(std::vector<std::string>& cur_rewinder)
 
 // ----------------------------------------------------------------------------
 /** Called when the last state information has been added and the message
- *  can be sent to the clients.
+ *  can be sent to the clients. With relevance filtering each peer gets its
+ *  own state containing only the rewinders due for it.
  */
 void GameProtocol::sendState()
 {
     assert(NetworkConfig::get()->isServer());
+    if (m_interest_manager)
+    {
+        NetworkString* header = getNetworkString();
+        header->addUInt8(GP_STATE).addUInt32(m_state_ticks);
+        m_interest_manager->sendStates(header);
+        delete header;
+        return;
+    }
     sendMessageToPeers(m_data_to_send, /*reliable*/false);
 }   // sendState
 
@@ -27,11 +27,13 @@
 #include "utils/stk_process.hpp"
 
 #include <cstdlib>
+#include <memory>
 #include <mutex>
 #include <vector>
 #include <tuple>
 
 class BareNetworkString;
+class InterestManager;
 class NetworkItemManager;
 class NetworkString;
 class STKPeer;
@@ -44,6 +46,7 @@ private:
      * asynchronous event update. */
     mutable std::mutex m_world_deleting_mutex;
 
+public:
     /** The type of game events to be forwarded to the server. */
     enum { GP_CONTROLLER_ACTION,
            GP_STATE,
@@ -52,6 +55,8 @@ private:
            GP_ADJUST_TIME
     };
 
+private:
+
     /** A network string that collects all information from the server to be sent
      *  next. */
     NetworkString *m_data_to_send;
@@ -80,6 +85,12 @@ private:
     void handleItemEventConfirmation(Event *event);
     static std::weak_ptr<GameProtocol> m_game_protocol[PT_COUNT];
     NetworkItemManager* m_network_item_manager;
+
+    /** Filters the states for each peer if enabled in server config. */
+    std::unique_ptr<InterestManager> m_interest_manager;
+
+    /** Ticks of the state currently assembled. */
+    int m_state_ticks;
     // Maximum value of values are only 32768
     std::tuple<uint8_t, uint16_t, uint16_t, uint16_t>
                                                 compressAction(const Action& a)
@@ -112,7 +123,7 @@ public:
     void controllerAction(int kart_id, PlayerAction action,
                           int value, int val_l, int val_r);
     void startNewState();
-    void addState(BareNetworkString *buffer);
+    void addState(const std::string& uid, BareNetworkString *buffer);
     void sendState();
     void finalizeState(std::vector<std::string>& cur_rewinder);
     void sendItemEventConfirmation(int ticks);
@@ -81,6 +81,8 @@ public:
                          // (like abusive behaviour)
         LE_ASSETS_UPDATE, // Client tell server with updated assets
         LE_COMMAND, // Command
+        LE_PLAYER_LIST_DIFF, // Changed players since last player list, or
+                             // client asking for the full list
     };
 
     enum RejectReason : uint8_t
@@ -31,7 +31,9 @@
 #include "modes/linear_world.hpp"
 #include "network/crypto.hpp"
 #include "network/event.hpp"
+#include "network/game_events.hpp"
 #include "network/game_setup.hpp"
+#include "network/handshake_pipeline.hpp"
 #include "network/network.hpp"
 #include "network/network_config.hpp"
 #include "network/network_player_profile.hpp"
@@ -41,11 +43,14 @@
 #include "network/protocols/game_protocol.hpp"
 #include "network/protocols/game_events_protocol.hpp"
 #include "network/race_event_manager.hpp"
+#include "network/records_index.hpp"
 #include "network/server_config.hpp"
+#include "network/soccer_ranking.hpp"
 #include "network/socket_address.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_ipv6.hpp"
 #include "network/stk_peer.hpp"
+#include "network/team_balancer.hpp"
 #include "online/online_profile.hpp"
 #include "online/request_manager.hpp"
 #include "online/xml_request.hpp"
@@ -57,6 +62,7 @@
 #include "utils/random_generator.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/time.hpp"
+#include "utils/tls.hpp"
 #include "utils/translation.hpp"
 
 #include <algorithm>
@@ -130,6 +136,59 @@ sqlite3_extension_init(sqlite3* db, char** pzErrMsg,
 }   // sqlite3_extension_init
 */
 
+// ----------------------------------------------------------------------------
+/** Opens the server database with the busy handler and the IPv6 functions.
+ *  \param flags Flags for sqlite3_open_v2.
+ *  \return The connection, or NULL if the database can't be opened.
+ */
+static sqlite3* openDatabase(int flags)
+{
+    sqlite3* db = NULL;
+    const std::string& path = ServerConfig::getConfigDirectory() + "/" +
+        ServerConfig::m_database_file.c_str();
+    int ret = sqlite3_open_v2(path.c_str(), &db, flags, NULL);
+    if (ret != SQLITE_OK)
+    {
+        Log::error("ServerLobby", "Cannot open database: %s.",
+            sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return NULL;
+    }
+    sqlite3_busy_handler(db, [](void* data, int retry)
+    {
+        int retry_count = ServerConfig::m_database_timeout / 100;
+        if (retry < retry_count)
+        {
+            sqlite3_sleep(100);
+            // Return non-zero to let caller retry again
+            return 1;
+        }
+        // Return zero to let caller return SQLITE_BUSY immediately
+        return 0;
+    }, NULL);
+    sqlite3_create_function(db, "insideIPv6CIDR", 2, SQLITE_UTF8, NULL,
+        &insideIPv6CIDRSQL, NULL, NULL);
+    sqlite3_create_function(db, "upperIPv6", 1, SQLITE_UTF8, NULL,
+        &upperIPv6SQL, NULL, NULL);
+    return db;
+}   // openDatabase
+
+// ----------------------------------------------------------------------------
+/** Read only database connection of a handshake worker thread, closed when
+ *  the worker ends. The lobby connection is only used by the lobby thread.
+ */
+static thread_local sqlite3* g_worker_db = NULL;
+static thread_local bool g_worker_db_opened = false;
+
+// ----------------------------------------------------------------------------
+static void closeWorkerDatabase()
+{
+    if (g_worker_db)
+        sqlite3_close(g_worker_db);
+    g_worker_db = NULL;
+    g_worker_db_opened = false;
+}   // closeWorkerDatabase
+
 #endif
 
 /** This is the central game setup protocol running in the server. It is
@@ -188,11 +247,15 @@ ServerLobby::ServerLobby() : LobbyProtocol()
 
     m_client_server_host_id.store(0);
     m_lobby_players.store(0);
+    m_player_list_version = 0;
+    m_player_list_game_started = false;
+    m_player_list_pending.store(false);
+    m_player_list_pending_time.store(0);
     m_help_message = getGameSetup()->readOrLoadFromFile
     ((std::string) ServerConfig::m_help);
 
     m_available_commands = "help commands music kick to public "
-        "teamchat gnu nognu standings gnu2 gnu2addtrack record tell "
+        "teamchat gnu nognu standings gnu2 gnu2addtrack record records tell "
         "installaddon uninstalladdon liststkaddon listlocaladdon "
         "listserveraddon playerhasaddon playeraddonscore serverhasaddon "
         "setfield settrack setkart sethost mode vote";
@@ -260,6 +323,16 @@ ServerLobby::ServerLobby() : LobbyProtocol()
     m_default_vote = new PeerVote();
     m_player_reports_table_exists = false;
     initDatabase();
+    SoccerRanking::create();
+    GameEvents::create();
+#ifdef ENABLE_SQLITE3
+    HandshakePipeline::Action worker_exit = closeWorkerDatabase;
+#else
+    HandshakePipeline::Action worker_exit;
+#endif
+    m_handshake_pipeline.reset(new HandshakePipeline(
+        std::max((int)ServerConfig::m_handshake_threads, 0),
+        std::max((int)ServerConfig::m_handshake_queue_size, 1), worker_exit));
 
     if (ServerConfig::m_soccer_tournament)
     {
@@ -299,6 +372,8 @@ ServerLobby::ServerLobby() : LobbyProtocol()
  */
 ServerLobby::~ServerLobby()
 {
+    // The handshake jobs use the database and the lobby
+    m_handshake_pipeline.reset();
     if (m_server_id_online.load() != 0)
     {
         // For child process the request manager will keep on running
@@ -310,6 +385,8 @@ ServerLobby::~ServerLobby()
         ServerConfig::writeServerConfigToDisk();
     delete m_default_vote;
     destroyDatabase();
+    SoccerRanking::destroy();
+    GameEvents::destroy();
 }   // ~ServerLobby
 
 //-----------------------------------------------------------------------------
@@ -323,37 +400,14 @@ void ServerLobby::initDatabase()
     m_online_id_ban_table_exists = false;
     m_ip_geolocation_table_exists = false;
     m_ipv6_geolocation_table_exists = false;
+    m_records_index_disabled = false;
+    m_records_index_check_time = 0;
     if (!ServerConfig::m_sql_management)
         return;
-    const std::string& path = ServerConfig::getConfigDirectory() + "/" +
-        ServerConfig::m_database_file.c_str();
-    int ret = sqlite3_open_v2(path.c_str(), &m_db,
-        SQLITE_OPEN_SHAREDCACHE | SQLITE_OPEN_FULLMUTEX |
-        SQLITE_OPEN_READWRITE, NULL);
-    if (ret != SQLITE_OK)
-    {
-        Log::error("ServerLobby", "Cannot open database: %s.",
-            sqlite3_errmsg(m_db));
-        sqlite3_close(m_db);
-        m_db = NULL;
+    m_db = openDatabase(SQLITE_OPEN_SHAREDCACHE | SQLITE_OPEN_FULLMUTEX |
+        SQLITE_OPEN_READWRITE);
+    if (!m_db)
         return;
-    }
-    sqlite3_busy_handler(m_db, [](void* data, int retry)
-    {
-        int retry_count = ServerConfig::m_database_timeout / 100;
-        if (retry < retry_count)
-        {
-            sqlite3_sleep(100);
-            // Return non-zero to let caller retry again
-            return 1;
-        }
-        // Return zero to let caller return SQLITE_BUSY immediately
-        return 0;
-    }, NULL);
-    sqlite3_create_function(m_db, "insideIPv6CIDR", 2, SQLITE_UTF8, NULL,
-        &insideIPv6CIDRSQL, NULL, NULL);
-    sqlite3_create_function(m_db, "upperIPv6", 1, SQLITE_UTF8, NULL,
-        &upperIPv6SQL, NULL, NULL);
     checkTableExists(ServerConfig::m_ip_ban_table, m_ip_ban_table_exists);
     checkTableExists(ServerConfig::m_ipv6_ban_table, m_ipv6_ban_table_exists);
     checkTableExists(ServerConfig::m_online_id_ban_table,
@@ -397,7 +451,8 @@ void ServerLobby::initServerStatsTable()
         "    addon_karts_count INTEGER UNSIGNED NOT NULL DEFAULT 0, -- Number of addon karts of the host\n"
         "    addon_tracks_count INTEGER UNSIGNED NOT NULL DEFAULT 0, -- Number of addon tracks of the host\n"
         "    addon_arenas_count INTEGER UNSIGNED NOT NULL DEFAULT 0, -- Number of addon arenas of the host\n"
-        "    addon_soccers_count INTEGER UNSIGNED NOT NULL DEFAULT 0 -- Number of addon soccers of the host\n"
+        "    addon_soccers_count INTEGER UNSIGNED NOT NULL DEFAULT 0, -- Number of addon soccers of the host\n"
+        "    state_rate INTEGER UNSIGNED NOT NULL DEFAULT 0 -- Game state bandwidth in bytes per second chosen by state-rate-control (saved when disconnected)\n"
         ") WITHOUT ROWID;";
     std::string query = oss.str();
     sqlite3_stmt* stmt = NULL;
@@ -423,6 +478,20 @@ void ServerLobby::initServerStatsTable()
     if (m_server_stats_table.empty())
         return;
 
+    // Tables created before state-rate-control need the state_rate column
+    query = StringUtils::insertValues("SELECT state_rate FROM %s LIMIT 0;",
+        m_server_stats_table.c_str());
+    stmt = NULL;
+    if (sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, 0) == SQLITE_OK)
+        sqlite3_finalize(stmt);
+    else
+    {
+        query = StringUtils::insertValues("ALTER TABLE %s ADD COLUMN "
+            "state_rate INTEGER UNSIGNED NOT NULL DEFAULT 0;",
+            m_server_stats_table.c_str());
+        easySQLQuery(query);
+    }
+
     // Extra default table _countries:
     // Server owner need to initialise this table himself, check NETWORKING.md
     std::string country_table_name = std::string("v") + StringUtils::toString(
@@ -622,10 +691,10 @@ void ServerLobby::writeDisconnectInfoTable(STKPeer* peer)
         return;
     std::string query = StringUtils::insertValues(
         "UPDATE %s SET disconnected_time = datetime('now'), "
-        "ping = %d, packet_loss = %d "
+        "ping = %d, packet_loss = %d, state_rate = %u "
         "WHERE host_id = %u;", m_server_stats_table.c_str(),
         peer->getAveragePing(), peer->getPacketLoss(),
-        peer->getHostId());
+        peer->getStateRate(), peer->getHostId());
     easySQLQuery(query);
 #endif
 }   // writeDisconnectInfoTable
@@ -1125,6 +1194,15 @@ void ServerLobby::kickHost(Event* event)
             auto npp = peer->getPlayerProfiles()[0];
             std::string player_name = StringUtils::wideToUtf8(npp->getName());
             Log::info("ServerLobby", "Crown player %s kicks %s", peer_username.c_str(), player_name.c_str());
+            if (GameEvents::get())
+            {
+                auto crown = event->getPeer();
+                std::string crown_name = crown->hasPlayerProfiles() ?
+                    StringUtils::wideToUtf8(
+                    crown->getPlayerProfiles()[0]->getName()) : "";
+                GameEvents::get()->push(GameEvents::GE_KICK, player_name,
+                    crown_name);
+            }
         }
         peer->kick();
         if (ServerConfig::m_track_kicks) {
@@ -1165,6 +1243,7 @@ bool ServerLobby::notifyEventAsynchronous(Event* event)
             handleAssets(event->data(), event->getPeer());        break;
         case LE_COMMAND:
             handleServerCommand(event, event->getPeerSP());       break;
+        case LE_PLAYER_LIST_DIFF: requestFullPlayerList(event);   break;
         default:                                                  break;
         }   // switch
     } // if (event->getType() == EVENT_TYPE_MESSAGE)
@@ -1673,6 +1752,12 @@ void ServerLobby::asynchronousUpdate()
     // Check if server owner has left
     updateServerOwner();
 
+    if (m_player_list_pending.load() &&
+        (m_state.load() != WAITING_FOR_START_GAME ||
+        StkTime::getMonoTimeMs() >= m_player_list_pending_time.load() +
+        (uint64_t)ServerConfig::m_player_list_merge_time))
+        sendPlayerList(false/*update_when_reset_server*/);
+
     if (ServerConfig::m_ranked && m_state.load() == WAITING_FOR_START_GAME)
         clearDisconnectedRankedPlayer();
 
@@ -1685,6 +1770,7 @@ void ServerLobby::asynchronousUpdate()
             checkIncomingConnectionRequests();
         handlePendingConnection();
     }
+    m_handshake_pipeline->handleFinished();
 
     if (m_server_id_online.load() != 0 &&
         allowJoinedPlayersWaiting() &&
@@ -2136,8 +2222,8 @@ void rem_gamescore3(std::string player_name, double phase)
 {
     std::string ringdrossel;
     if (ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_1vs1_2 || ServerConfig::m_rank_1vs1_3) return;
-    else ringdrossel = "python3 update_list.py " + player_name + " leftgame " + std::to_string(phase) + " 3vs3 &";
-    system(ringdrossel.c_str());
+    else ringdrossel = "python3 update_list.py " + SoccerRanking::escapeArgument(player_name) + " leftgame " + std::to_string(phase) + " 3vs3";
+    SoccerRanking::get()->runCommand(ringdrossel);
 }
 
 void ServerLobby::liveJoinRequest(Event* event)
@@ -2243,9 +2329,10 @@ void ServerLobby::liveJoinRequest(Event* event)
 	            {
 		        if (name_team.first == username)
 			{
-		            fitis = "python3 add_ranked-soccer_live-joiner.py "+username+" "+name_team.second;
-		            if (ServerConfig::m_super_mp_quali) fitis = "python3 add_super_mp_quali_live-joiner.py "+username+" "+name_team.second;
-			    system(fitis.c_str());
+		            fitis = "python3 add_ranked-soccer_live-joiner.py "+SoccerRanking::escapeArgument(username)+" "+SoccerRanking::escapeArgument(name_team.second);
+		            if (ServerConfig::m_super_mp_quali) fitis = "python3 add_super_mp_quali_live-joiner.py "+SoccerRanking::escapeArgument(username)+" "+SoccerRanking::escapeArgument(name_team.second);
+			    if (ServerConfig::m_ranking_scripts)
+			        SoccerRanking::get()->runCommand(fitis);
 		        }
 		    }
 	        }
@@ -2297,46 +2384,34 @@ void ServerLobby::liveJoinRequest(Event* event)
             }
         }
 
-        for (int id : used_id)
+        for (unsigned i = 0; i < used_id.size(); i++)
         {
+            int id = used_id[i];
             Log::info("ServerLobby", "%s live joining with reserved kart id %d.",
                 peer->getAddress().toString().c_str(), id);
             peer->addAvailableKartID(id);
-            if (ServerConfig::m_save_goals)
+
+            auto& player = peer->getPlayerProfiles()[i];
+            std::string username = StringUtils::wideToUtf8(player->getName());
+            double phase = getSoccerMatchPhase();
+            KartTeam team = player->getTeam();
+            if (team != KART_TEAM_NONE && (!is1vs1 || is1vs1Player))
             {
-                std::string username = StringUtils::wideToUtf8(peer->getPlayerProfiles()[0]->getName());
-                double phase = 0.0;
-                if (RaceManager::get()->hasTimeTarget())
-                {
-                    phase = -1.0 + (RaceManager::get()->getTimeTarget() - World::getWorld()->getTime()) / RaceManager::get()->getTimeTarget();
-                }
-                else
-                {
-                    int red_scorers_count = 0; int blue_scorers_count = 0;
-                    SoccerWorld *sw = dynamic_cast<SoccerWorld*>(World::getWorld());
-                    if (sw)
-                    {
-                        red_scorers_count = sw->get_red_scorers_count();
-                        blue_scorers_count = sw->get_blue_scorers_count();
-                    }
-                    phase = -1.0 + 1.0*std::max(red_scorers_count, blue_scorers_count) / RaceManager::get()->getMaxGoal();
-                    std::string message = "red_scorers_cnt=" + std::to_string(red_scorers_count) + " / blue_scorers_cnt" + std::to_string(blue_scorers_count);
-                    message += " / max_goll=" + std::to_string(RaceManager::get()->getMaxGoal());
-                    Log::info("ServerLobby", message.c_str());
-                }
-                std::string message = "phase=" + std::to_string(phase);
-                Log::info("ServerLobby", message.c_str());
-                rem_gamescore3(username, phase);
+                SoccerRanking::get()->addPlayer(username,
+                    team == KART_TEAM_RED ? 0 : 1, phase);
             }
+            if (!ServerConfig::m_ranking_scripts)
+                continue;
+            if (ServerConfig::m_save_goals)
+                rem_gamescore3(username, phase - 1.0);
             if (ServerConfig::m_super_tournament && ServerConfig::m_count_supertournament_game)
             {
-                std::string username = StringUtils::wideToUtf8(peer->getPlayerProfiles()[0]->getName());
                 std::string singdrossel;
                 std::string redname = ServerConfig::m_red_team_name;
                 std::string bluename = ServerConfig::m_blue_team_name;
-                if (m_tournament_red_players.count(username) > 0) singdrossel = "python3 supertournament_addcurrentplayer.py " + username + " " + redname + " &";
-                else singdrossel = "python3 supertournament_addcurrentplayer.py " + username + " " + bluename + " &";
-                system(singdrossel.c_str());
+                if (m_tournament_red_players.count(username) > 0) singdrossel = "python3 supertournament_addcurrentplayer.py " + SoccerRanking::escapeArgument(username) + " " + SoccerRanking::escapeArgument(redname);
+                else singdrossel = "python3 supertournament_addcurrentplayer.py " + SoccerRanking::escapeArgument(username) + " " + SoccerRanking::escapeArgument(bluename);
+                SoccerRanking::get()->runCommand(singdrossel);
             }
         }
 
@@ -2734,6 +2809,7 @@ void ServerLobby::update(int ticks)
     case LOAD_WORLD:
         Log::info("ServerLobbyRoom", "Starting the race loading.");
         // This will create the world instance, i.e. load track and karts
+        initSoccerRanking();
         init1vs1Ranking();
         if (m_player_queue_limit > 0)
         {
@@ -2773,43 +2849,12 @@ void ServerLobby::update(int ticks)
         sendMessageToPeers(m_result_ns, /*reliable*/ true);
         //msg42=The match time is +std::to_string(ServerConfig::m_spielzeit);
         //sendStringToAllPeers(msg42);
-        if (ServerConfig::m_rank_1vs1)
-        {
-            system("python3 update_elo.py 1vs1 &");
-        }
-        if (ServerConfig::m_rank_1vs1_2)
-        {
-            system("python3 update_elo.py 1vs1_2 &");
-        }
-        if (ServerConfig::m_rank_1vs1_3)
-        {
-            system("python3 update_elo.py 1vs1_3 &");
-        }
-        if (ServerConfig::m_rank_soccer)
-        {
-            std::string singdrossel = "python3 update_elo_ranked-soccer-DB.py " + std::to_string(ServerConfig::m_spielzeit);
-            if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2 && !(ServerConfig::m_skip_end)) singdrossel = "python3 update_elo_super_mp_quali2.py " + std::to_string(ServerConfig::m_spielzeit);
-	    else if (ServerConfig::m_super_mp_quali && !(ServerConfig::m_skip_end)) singdrossel = "python3 update_elo_super_mp_quali.py " + std::to_string(ServerConfig::m_spielzeit);
-	    if (ServerConfig::m_super_mp_quali) ServerConfig::m_skip_end=false;
-            system(singdrossel.c_str());
-        }
-
-        if (ServerConfig::m_save_goals)
-        {
-            if (ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_1vs1_2 || ServerConfig::m_rank_1vs1_3) system("python3 update_wiki.py 1vs1 &");
-            else system("python3 update_wiki.py 3vs3 &");
-        }
-	if (ServerConfig::m_super_tournament && ServerConfig::m_count_supertournament_game)
-        {
-            std::string redname=ServerConfig::m_red_team_name;
-            std::string bluename=ServerConfig::m_blue_team_name;
-	    if (!(ServerConfig::m_skip_end))
-	    {
-                std::string singdrossel="python3 supertournament_gameresult.py "+redname+' '+bluename;
-                system(singdrossel.c_str());
-	    }
-	    ServerConfig::m_skip_end=false;
-        }
+        if (ServerConfig::m_ranking_scripts)
+            runRankingScripts();
+        if ((ServerConfig::m_rank_soccer && ServerConfig::m_super_mp_quali) ||
+            (ServerConfig::m_super_tournament &&
+            ServerConfig::m_count_supertournament_game))
+            ServerConfig::m_skip_end = false;
         if (ServerConfig::m_rank_soccer)
         {
             m_soccer_ranked_players.clear();
@@ -2995,43 +3040,29 @@ void ServerLobby::unregisterServer(bool now, std::weak_ptr<ServerLobby> sl)
 }   // unregisterServer
 
 //-----------------------------------------------------------------------------
-/** Instructs all clients to start the kart selection. If event is NULL,
- *  the command comes from the owner less server.
+/** Splits the ranked soccer players in two teams of the same size with the
+ *  closest Elo sums, see TeamBalancer.
+ *  \param handicap_players Players playing with a handicap.
  */
-std::pair<std::vector<std::string>, std::vector<std::string>> ServerLobby::createBalancedTeams(std::vector<std::pair<std::string, int>>& elo_players)
+std::pair<std::vector<std::string>, std::vector<std::string>> ServerLobby::createBalancedTeams(std::vector<std::pair<std::string, int>>& elo_players,
+    const std::set<std::string>& handicap_players)
 {
-    int num_players = elo_players.size();
-    int min_elo_diff = INT_MAX;
-    int optimal_teams = -1;
-
-    for (int teams = 0; teams < pow(2, num_players - 1); teams++)
+    std::vector<TeamBalancer::Player> players;
+    for (auto& elo_player : elo_players)
     {
-        int elo_red = 0, elo_blue = 0;
-        for (int player_idx = 0; player_idx < num_players; player_idx++)
-        {
-            if (teams & 1 << player_idx)
-                elo_red += elo_players[player_idx].second;
-            else
-                elo_blue += elo_players[player_idx].second;
-        }
-        int elo_diff = std::abs(elo_red - elo_blue);
-        if (elo_diff < min_elo_diff)
-        {
-            min_elo_diff = elo_diff;
-            optimal_teams = teams;
-        }
-        if (elo_diff == 0) break;
+        double form = 0.0;
+        SoccerRanking::PlayerStats stats;
+        if (!ServerConfig::m_ranking_scripts && SoccerRanking::get() &&
+            SoccerRanking::get()->getStats(SoccerRanking::getServerModes()[0],
+            elo_player.first, &stats))
+            form = stats.m_form;
+        players.emplace_back(elo_player.first, elo_player.second,
+            handicap_players.find(elo_player.first) != handicap_players.end(),
+            form);
     }
 
     std::vector<std::string> red_team, blue_team;
-
-    for (int player_idx = 0; player_idx < num_players; player_idx++)
-    {
-        if (optimal_teams & 1 << player_idx)
-            red_team.push_back(elo_players[player_idx].first);
-        else
-            blue_team.push_back(elo_players[player_idx].first);
-    }
+    TeamBalancer::createTeams(players, &red_team, &blue_team);
     return std::pair<std::vector<std::string>, std::vector<std::string>>(red_team, blue_team);
 }
 
@@ -3087,7 +3118,10 @@ void ServerLobby::soccer_ranked_make_teams(std::pair<std::vector<std::string>, s
     return;
 }
 
-
+//-----------------------------------------------------------------------------
+/** Instructs all clients to start the kart selection. If event is NULL,
+ *  the command comes from the owner less server.
+ */
 void ServerLobby::startSelection(const Event *event)
 {
     bool need_to_update = false;
@@ -3224,11 +3258,15 @@ void ServerLobby::startSelection(const Event *event)
 
     if (ServerConfig::m_rank_soccer)
     {
-        if(ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) system("cp empty_rsp.txt current_super_mp_quali_players2.txt");
-	else if(ServerConfig::m_super_mp_quali) system("cp empty_rsp.txt current_super_mp_quali_players.txt");
-	else system("cp empty_rsp.txt current_ranked-soccer_players.txt");
+        if (ServerConfig::m_ranking_scripts)
+        {
+            if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) SoccerRanking::get()->copyFile("empty_rsp.txt", "current_super_mp_quali_players2.txt");
+            else if (ServerConfig::m_super_mp_quali) SoccerRanking::get()->copyFile("empty_rsp.txt", "current_super_mp_quali_players.txt");
+            else SoccerRanking::get()->copyFile("empty_rsp.txt", "current_ranked-soccer_players.txt");
+        }
         int elo = 1500;
         std::string msg = "";
+        std::set<std::string> handicap_players;
         for (auto peer_rdy : m_peers_ready)
         {
             auto peer = peer_rdy.first.lock();
@@ -3253,6 +3291,8 @@ void ServerLobby::startSelection(const Event *event)
 		    }
                     elo = getPlayerElo(username);
                     m_soccer_ranked_players.push_back(std::pair<std::string, int>(username, elo));
+                    if (player->getHandicap() != HANDICAP_NONE)
+                        handicap_players.insert(username);
                     msg = "Player " + username + " is in the coming ranked soccer match.";
                     Log::info("ServerLobby", msg.c_str());
                 }
@@ -3274,7 +3314,7 @@ void ServerLobby::startSelection(const Event *event)
             msg = "Player " + m_soccer_ranked_players[min_idx].first + " has minimal ELO.";
             Log::info("ServerLobby", msg.c_str());
         }
-        auto teams = createBalancedTeams(player_copy);
+        auto teams = createBalancedTeams(player_copy, handicap_players);
         soccer_ranked_make_teams(teams, min);
     }
 
@@ -3819,6 +3859,19 @@ void ServerLobby::checkRaceFinished()
     assert(World::getWorld());
     std::string msg42;
     if (!RaceEventManager::get()->isRaceOver()) return;
+    finishSoccerRanking();
+    if (GameEvents::get())
+    {
+        int red_goals = 0, blue_goals = 0;
+        if (SoccerWorld* sw = dynamic_cast<SoccerWorld*>(World::getWorld()))
+        {
+            red_goals = sw->getTotalScore(KART_TEAM_RED);
+            blue_goals = sw->getTotalScore(KART_TEAM_BLUE);
+        }
+        GameEvents::get()->push(GameEvents::GE_MATCH_RESULT, "",
+            RaceManager::get()->getTrackName(), -1,
+            World::getWorld()->getTimeSinceStart(), red_goals, blue_goals);
+    }
     if (ServerConfig::m_soccer_tournament || ServerConfig::m_super_tournament_qualification)
     {
         World* w = World::getWorld();
@@ -4264,6 +4317,8 @@ void ServerLobby::clientDisconnected(Event* event)
         std::string name = StringUtils::wideToUtf8(p->getName());
         msg->encodeString(name);
         Log::info("ServerLobby", "%s disconnected", name.c_str());
+        if (GameEvents::get())
+            GameEvents::get()->push(GameEvents::GE_LEAVE, name);
 
         m_pending_live_joiners.erase(std::remove(m_pending_live_joiners.begin(), m_pending_live_joiners.end(), name), m_pending_live_joiners.end());
     }
@@ -4567,14 +4622,7 @@ void ServerLobby::connectionRequested(Event* event)
         (m_state.load() != WAITING_FOR_START_GAME /*||
         m_game_setup->isGrandPrixStarted()*/))
     {
-        NetworkString *message = getNetworkString(2);
-        message->setSynchronous(true);
-        message->addUInt8(LE_CONNECTION_REFUSED).addUInt8(RR_BUSY);
-        // send only to the peer that made the request and disconnect it now
-        peer->sendPacket(message, true/*reliable*/, false/*encrypted*/);
-        peer->reset();
-        delete message;
-        Log::verbose("ServerLobby", "Player refused: selection started");
+        refuseConnection(peer.get(), RR_BUSY, "selection started");
         return;
     }
 
@@ -4583,14 +4631,8 @@ void ServerLobby::connectionRequested(Event* event)
     if (version < stk_config->m_min_server_version ||
         version > stk_config->m_max_server_version)
     {
-        NetworkString *message = getNetworkString(2);
-        message->setSynchronous(true);
-        message->addUInt8(LE_CONNECTION_REFUSED)
-            .addUInt8(RR_INCOMPATIBLE_DATA);
-        peer->sendPacket(message, true/*reliable*/, false/*encrypted*/);
-        peer->reset();
-        delete message;
-        Log::verbose("ServerLobby", "Player refused: wrong server version");
+        refuseConnection(peer.get(), RR_INCOMPATIBLE_DATA,
+            "wrong server version");
         return;
     }
     std::string user_version;
@@ -4615,20 +4657,59 @@ void ServerLobby::connectionRequested(Event* event)
     online_id = data.getUInt32();
     encrypted_size = data.getUInt32();
 
-    // Will be disconnected if banned by IP
-    testBannedForIP(peer.get());
-    if (peer->isDisconnected())
-        return;
+    // The ban lists are checked by the handshake workers, the remaining
+    // checks use the lobby state and are done when the peer is accepted.
+    // The workers don't change the peer, a banned peer is kicked by the
+    // lobby thread.
+    BareNetworkString remaining(data.getCurrentData(), data.size());
+    auto job = [this, peer, player_count, online_id, encrypted_size,
+        remaining]()
+    {
+        std::string reason;
+        std::function<void()> count_trigger;
+        if (testBannedForIP(peer.get(), &reason, &count_trigger) ||
+            testBannedForIPv6(peer.get(), &reason, &count_trigger) ||
+            (online_id != 0 && testBannedForOnlineId(peer.get(), online_id,
+            &reason, &count_trigger)))
+        {
+            return HandshakePipeline::Result::reject([this, peer, reason,
+                count_trigger]()
+            {
+                if (count_trigger)
+                    count_trigger();
+                kickPlayerWithReason(peer.get(), reason.c_str());
+            });
+        }
+
+        return HandshakePipeline::Result::accept([this, peer, player_count,
+            online_id, encrypted_size, remaining]() mutable
+        {
+            acceptConnection(peer, remaining, player_count, online_id,
+                encrypted_size);
+        });
+    };
+    if (!m_handshake_pipeline->submit(job))
+        refuseConnection(peer.get(), RR_BUSY, "too many handshakes");
+}   // connectionRequested
 
-    testBannedForIPv6(peer.get());
+//-----------------------------------------------------------------------------
+/** Continues the connection request of a peer which is not banned, called
+ *  in the lobby thread by the handshake pipeline.
+ */
+void ServerLobby::acceptConnection(std::shared_ptr<STKPeer> peer,
+    BareNetworkString& data, unsigned player_count, uint32_t online_id,
+    uint32_t encrypted_size)
+{
     if (peer->isDisconnected())
         return;
 
-    if (online_id != 0)
-        testBannedForOnlineId(peer.get(), online_id);
-    // Will be disconnected if banned by online id
-    if (peer->isDisconnected())
+    // The lobby may have started a game while the request was checked
+    if (!allowJoinedPlayersWaiting() &&
+        m_state.load() != WAITING_FOR_START_GAME)
+    {
+        refuseConnection(peer.get(), RR_BUSY, "selection started");
         return;
+    }
 
     unsigned total_players = 0;
     STKHost::get()->updatePlayers(NULL, NULL, &total_players);
@@ -4645,13 +4726,7 @@ void ServerLobby::connectionRequested(Event* event)
     if (total_players + player_count + m_ai_profiles.size() >
         max_players_mode)
     {
-        NetworkString *message = getNetworkString(2);
-        message->setSynchronous(true);
-        message->addUInt8(LE_CONNECTION_REFUSED).addUInt8(RR_TOO_MANY_PLAYERS);
-        peer->sendPacket(message, true/*reliable*/, false/*encrypted*/);
-        peer->reset();
-        delete message;
-        Log::verbose("ServerLobby", "Player refused: too many players");
+        refuseConnection(peer.get(), RR_TOO_MANY_PLAYERS, "too many players");
         return;
     }
 
@@ -4676,13 +4751,7 @@ void ServerLobby::connectionRequested(Event* event)
             ServerConfig::m_ai_handling && !m_ai_peer.expired()) ||
             (peer->isAIPeer() && m_game_setup->isGrandPrix()))
     {
-        NetworkString* message = getNetworkString(2);
-        message->setSynchronous(true);
-        message->addUInt8(LE_CONNECTION_REFUSED).addUInt8(RR_INVALID_PLAYER);
-        peer->sendPacket(message, true/*reliable*/, false/*encrypted*/);
-        peer->reset();
-        delete message;
-        Log::verbose("ServerLobby", "Player refused: invalid player");
+        refuseConnection(peer.get(), RR_INVALID_PLAYER, "invalid player");
         return;
     }
 
@@ -4705,7 +4774,24 @@ void ServerLobby::connectionRequested(Event* event)
         handleUnencryptedConnection(peer, data, online_id, online_name,
             false/*is_pending_connection*/);
     }
-}   // connectionRequested
+}   // acceptConnection
+
+//-----------------------------------------------------------------------------
+/** Sends the reason of the refused connection to the peer and disconnects
+ *  it.
+ */
+void ServerLobby::refuseConnection(STKPeer* peer, RejectReason reason,
+                                   const char* log) const
+{
+    NetworkString* message = getNetworkString(2);
+    message->setSynchronous(true);
+    message->addUInt8(LE_CONNECTION_REFUSED).addUInt8(reason);
+    // send only to the peer that made the request and disconnect it now
+    peer->sendPacket(message, true/*reliable*/, false/*encrypted*/);
+    peer->reset();
+    delete message;
+    Log::verbose("ServerLobby", "Player refused: %s", log);
+}   // refuseConnection
 
 //-----------------------------------------------------------------------------
 void ServerLobby::handleUnencryptedConnection(std::shared_ptr<STKPeer> peer,
@@ -4922,6 +5008,14 @@ void ServerLobby::handleUnencryptedConnection(std::shared_ptr<STKPeer> peer,
     }
 
     peer->setValidated(true);
+    if (GameEvents::get())
+    {
+        for (auto player : peer->getPlayerProfiles())
+        {
+            GameEvents::get()->push(GameEvents::GE_JOIN,
+                StringUtils::wideToUtf8(player->getName()));
+        }
+    }
 
     if (m_player_queue_limit > 0)
         addDeletePlayersFromQueue(peer, true);
@@ -5131,9 +5225,6 @@ void ServerLobby::handleUnencryptedConnection(std::shared_ptr<STKPeer> peer,
  */
 void ServerLobby::updatePlayerList(bool update_when_reset_server)
 {
-    const bool game_started = m_state.load() != WAITING_FOR_START_GAME &&
-        !update_when_reset_server;
-
     if (update_when_reset_server)
     {
         if (!ServerConfig::m_soccer_tournament && !ServerConfig::m_race_tournament && !ServerConfig::m_rank_soccer && !ServerConfig::m_super_tournament_qualification)
@@ -5168,6 +5259,30 @@ void ServerLobby::updatePlayerList(bool update_when_reset_server)
         }
     }
 
+    // Merge the frequent changes in the lobby (players joining, changing
+    // team or getting ready) into one update
+    if (!update_when_reset_server &&
+        ServerConfig::m_player_list_merge_time > 0 &&
+        m_state.load() == WAITING_FOR_START_GAME)
+    {
+        if (!m_player_list_pending.exchange(true))
+            m_player_list_pending_time.store(StkTime::getMonoTimeMs());
+        return;
+    }
+    sendPlayerList(update_when_reset_server);
+}   // updatePlayerList
+
+//-----------------------------------------------------------------------------
+/** Builds the player list and sends it to all peers which don't have it yet.
+ *  Peers with the previous version only get the removed, added and changed
+ *  players.
+ */
+void ServerLobby::sendPlayerList(bool update_when_reset_server)
+{
+    m_player_list_pending.store(false);
+    const bool game_started = m_state.load() != WAITING_FOR_START_GAME &&
+        !update_when_reset_server;
+
     auto all_profiles = STKHost::get()->getAllPlayerProfiles();
     size_t all_profiles_size = all_profiles.size();
     for (auto& profile : all_profiles)
@@ -5214,11 +5329,7 @@ void ServerLobby::updatePlayerList(bool update_when_reset_server)
         m_state.load() > WAITING_FOR_START_GAME && !update_when_reset_server)
         return;
 
-    NetworkString* pl = getNetworkString();
-    pl->setSynchronous(true);
-    pl->addUInt8(LE_UPDATE_PLAYER_LIST)
-        .addUInt8((uint8_t)(game_started ? 1 : 0))
-        .addUInt8((uint8_t)all_profiles.size());
+    std::vector<std::pair<uint64_t, std::string> > player_list;
     for (auto profile : all_profiles)
     {
         std::shared_ptr<STKPeer> p = profile->getPeer();
@@ -5244,7 +5355,8 @@ void ServerLobby::updatePlayerList(bool update_when_reset_server)
         int elo = getPlayerElo(user_name);
         if (elo >= 0) profile_name = profile_name + L" [" + std::to_wstring(elo).c_str() + L"]";
 
-        pl->addUInt32(profile->getHostId()).addUInt32(profile->getOnlineId())
+        BareNetworkString entry;
+        entry.addUInt32(profile->getHostId()).addUInt32(profile->getOnlineId())
             .addUInt8(profile->getLocalPlayerId())
             .encodeString(profile_name);
 
@@ -5263,28 +5375,155 @@ void ServerLobby::updatePlayerList(bool update_when_reset_server)
             boolean_combine |= (1 << 3);
         if ((p && p->isAIPeer()) || isAIProfile(profile))
             boolean_combine |= (1 << 4);
-        pl->addUInt8(boolean_combine);
-        pl->addUInt8(profile->getHandicap());
+        entry.addUInt8(boolean_combine);
+        entry.addUInt8(profile->getHandicap());
         if (ServerConfig::m_team_choosing &&
             RaceManager::get()->teamEnabled())
-            pl->addUInt8(profile->getTeam());
+            entry.addUInt8(profile->getTeam());
         else
-            pl->addUInt8(KART_TEAM_NONE);
-        pl->encodeString(profile->getCountryCode());
+            entry.addUInt8(KART_TEAM_NONE);
+        entry.encodeString(profile->getCountryCode());
+        uint64_t key = ((uint64_t)profile->getHostId() << 8) |
+            profile->getLocalPlayerId();
+        player_list.emplace_back(key,
+            std::string(entry.getData(), entry.getTotalSize()));
     }
 
-    // Don't send this message to in-game players
-    STKHost::get()->sendPacketToAllPeersWith([game_started]
-    (STKPeer* p)
+    std::lock_guard<std::mutex> lock(m_player_list_mutex);
+    NetworkString* diff = NULL;
+    if (game_started != m_player_list_game_started ||
+        player_list != m_player_list)
     {
-        if (!p->isValidated())
-            return false;
-        if (!p->isWaitingForGame() && game_started)
-            return false;
-        return true;
-    }, pl);
+        if (ServerConfig::m_player_list_diff &&
+            game_started == m_player_list_game_started)
+            diff = getPlayerListDiff(player_list);
+        m_player_list_version++;
+        m_player_list.swap(player_list);
+        m_player_list_game_started = game_started;
+    }
+
+    NetworkString* pl = getNetworkString();
+    pl->setSynchronous(true);
+    pl->addUInt8(LE_UPDATE_PLAYER_LIST)
+        .addUInt8((uint8_t)(game_started ? 1 : 0))
+        .addUInt8((uint8_t)m_player_list.size());
+    for (auto& player : m_player_list)
+    {
+        *pl += BareNetworkString(player.second.c_str(),
+            (int)player.second.size());
+    }
+    pl->addUInt32(m_player_list_version);
+    if (diff && diff->getTotalSize() >= pl->getTotalSize())
+    {
+        delete diff;
+        diff = NULL;
+    }
+
+    std::set<uint32_t> host_ids;
+    for (auto& peer : STKHost::get()->getPeers())
+    {
+        // Don't send this message to in-game players
+        if (!peer->isValidated() ||
+            (!peer->isWaitingForGame() && game_started))
+            continue;
+        host_ids.insert(peer->getHostId());
+        uint32_t& version = m_peer_player_list_version[peer->getHostId()];
+        if (version == m_player_list_version)
+            continue;
+        if (diff && version != 0 && version + 1 == m_player_list_version)
+            peer->sendPacket(diff);
+        else
+            peer->sendPacket(pl);
+        version = m_player_list_version;
+    }
+    // Peers in game keep their version, so they get the list when back
+    for (auto it = m_peer_player_list_version.begin();
+        it != m_peer_player_list_version.end();)
+    {
+        if (host_ids.find(it->first) == host_ids.end() &&
+            !STKHost::get()->findPeerByHostId(it->first))
+            it = m_peer_player_list_version.erase(it);
+        else
+            it++;
+    }
     delete pl;
-}   // updatePlayerList
+    delete diff;
+}   // sendPlayerList
+
+//-----------------------------------------------------------------------------
+/** Creates the message with the changes from m_player_list to the new player
+ *  list, or returns NULL if the remaining players changed order or there
+ *  are duplicated entries, then the full list is needed.
+ *  The message holds the removed players (host and local player id) and the
+ *  added or changed players with their position in the new list.
+ */
+NetworkString* ServerLobby::getPlayerListDiff(
+    const std::vector<std::pair<uint64_t, std::string> >& player_list)
+{
+    std::map<uint64_t, const std::string*> old_players;
+    for (auto& player : m_player_list)
+        old_players[player.first] = &player.second;
+    std::set<uint64_t> new_keys;
+    std::vector<uint64_t> kept_new;
+    for (auto& player : player_list)
+    {
+        if (!new_keys.insert(player.first).second)
+            return NULL;
+        if (old_players.find(player.first) != old_players.end())
+            kept_new.push_back(player.first);
+    }
+    std::vector<uint64_t> kept_old, removed;
+    for (auto& player : m_player_list)
+    {
+        if (new_keys.find(player.first) != new_keys.end())
+            kept_old.push_back(player.first);
+        else
+            removed.push_back(player.first);
+    }
+    if (kept_old != kept_new || old_players.size() != m_player_list.size())
+        return NULL;
+
+    NetworkString* diff = getNetworkString();
+    diff->setSynchronous(true);
+    diff->addUInt8(LE_PLAYER_LIST_DIFF).addUInt32(m_player_list_version)
+        .addUInt32(m_player_list_version + 1)
+        .addUInt8((uint8_t)(m_player_list_game_started ? 1 : 0))
+        .addUInt8((uint8_t)removed.size());
+    for (uint64_t key : removed)
+        diff->addUInt32((uint32_t)(key >> 8)).addUInt8((uint8_t)(key & 0xff));
+    std::vector<unsigned> changed;
+    for (unsigned i = 0; i < player_list.size(); i++)
+    {
+        auto it = old_players.find(player_list[i].first);
+        if (it == old_players.end() || *it->second != player_list[i].second)
+            changed.push_back(i);
+    }
+    diff->addUInt8((uint8_t)changed.size());
+    for (unsigned i : changed)
+    {
+        diff->addUInt8((uint8_t)i)
+            .addUInt16((uint16_t)player_list[i].second.size());
+        *diff += BareNetworkString(player_list[i].second.c_str(),
+            (int)player_list[i].second.size());
+    }
+    return diff;
+}   // getPlayerListDiff
+
+//-----------------------------------------------------------------------------
+/** Called when a client got a player list diff for a version it doesn't
+ *  have, it gets the full list again.
+ */
+void ServerLobby::requestFullPlayerList(Event* event)
+{
+    std::shared_ptr<STKPeer> peer = event->getPeerSP();
+    if (!peer->isValidated())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_player_list_mutex);
+        m_peer_player_list_version[peer->getHostId()] = 0;
+    }
+    updatePlayerList();
+}   // requestFullPlayerList
 
 //-----------------------------------------------------------------------------
 void ServerLobby::updateServerOwner()
@@ -5663,6 +5902,123 @@ void ServerLobby::getHitCaptureLimit()
     m_battle_time_limit = time_limit;
 }   // getHitCaptureLimit
 
+// ----------------------------------------------------------------------------
+/** Starts tracking the coming match in the soccer rankings enabled in the
+ *  server config. Players are added when they have loaded the world. The
+ *  Elo is not rated natively when the ranking scripts rate it.
+ */
+void ServerLobby::initSoccerRanking()
+{
+    std::vector<SoccerRanking::RankingMode> modes;
+    if (!ServerConfig::m_ranking_scripts)
+        modes = SoccerRanking::getServerModes();
+    bool super = ServerConfig::m_super_tournament &&
+        ServerConfig::m_count_supertournament_game;
+    if (!RaceManager::get()->isSoccerMode() || (modes.empty() && !super))
+    {
+        SoccerRanking::get()->cancelMatch();
+        return;
+    }
+    if (super)
+    {
+        SoccerRanking::get()->startMatch(modes,
+            ServerConfig::m_red_team_name, ServerConfig::m_blue_team_name);
+    }
+    else
+        SoccerRanking::get()->startMatch(modes);
+}   // initSoccerRanking
+
+// ----------------------------------------------------------------------------
+/** Updates the soccer rankings with the result of the match which just
+ *  ended, the database is written in the background.
+ */
+void ServerLobby::finishSoccerRanking()
+{
+    SoccerRanking* sr = SoccerRanking::get();
+    if (!sr->isMatchRunning())
+        return;
+    SoccerWorld* sw = dynamic_cast<SoccerWorld*>(World::getWorld());
+    bool super = ServerConfig::m_super_tournament &&
+        ServerConfig::m_count_supertournament_game;
+    // The match is continued in another game
+    if (!sw || (ServerConfig::m_skip_end &&
+        (ServerConfig::m_super_mp_quali || super)))
+    {
+        sr->cancelMatch();
+        return;
+    }
+    std::vector<SoccerRanking::EloChange> changes =
+        sr->endMatch(sw->getTotalScore(KART_TEAM_RED),
+        sw->getTotalScore(KART_TEAM_BLUE));
+    for (const SoccerRanking::EloChange& change : changes)
+    {
+        Log::info("ServerLobby", "[Ranking] %s: %.1f -> %.1f",
+            change.m_name.c_str(), change.m_old_elo, change.m_new_elo);
+    }
+}   // finishSoccerRanking
+
+// ----------------------------------------------------------------------------
+/** Returns the part of the current soccer match already played, from the
+ *  time or from the goals of the leading team.
+ */
+double ServerLobby::getSoccerMatchPhase() const
+{
+    World* w = World::getWorld();
+    if (!w)
+        return 0.0;
+    double phase = 0.0;
+    if (RaceManager::get()->hasTimeTarget())
+    {
+        float target = RaceManager::get()->getTimeTarget();
+        if (target > 0.0f)
+            phase = (target - w->getTime()) / target;
+    }
+    else if (SoccerWorld* sw = dynamic_cast<SoccerWorld*>(w))
+    {
+        int max_goal = RaceManager::get()->getMaxGoal();
+        if (max_goal > 0)
+        {
+            phase = double(std::max(sw->get_red_scorers_count(),
+                sw->get_blue_scorers_count())) / max_goal;
+        }
+    }
+    return std::min(1.0, std::max(0.0, phase));
+}   // getSoccerMatchPhase
+
+// ----------------------------------------------------------------------------
+/** Runs the python ranking scripts of older versions after a match, on the
+ *  ranking worker thread.
+ */
+void ServerLobby::runRankingScripts()
+{
+    SoccerRanking* sr = SoccerRanking::get();
+    if (ServerConfig::m_rank_1vs1)
+        sr->runCommand("python3 update_elo.py 1vs1");
+    if (ServerConfig::m_rank_1vs1_2)
+        sr->runCommand("python3 update_elo.py 1vs1_2");
+    if (ServerConfig::m_rank_1vs1_3)
+        sr->runCommand("python3 update_elo.py 1vs1_3");
+    if (ServerConfig::m_rank_soccer)
+    {
+        std::string singdrossel = "python3 update_elo_ranked-soccer-DB.py " + std::to_string(ServerConfig::m_spielzeit);
+        if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2 && !(ServerConfig::m_skip_end)) singdrossel = "python3 update_elo_super_mp_quali2.py " + std::to_string(ServerConfig::m_spielzeit);
+        else if (ServerConfig::m_super_mp_quali && !(ServerConfig::m_skip_end)) singdrossel = "python3 update_elo_super_mp_quali.py " + std::to_string(ServerConfig::m_spielzeit);
+        sr->runCommand(singdrossel);
+    }
+    if (ServerConfig::m_save_goals)
+    {
+        if (ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_1vs1_2 || ServerConfig::m_rank_1vs1_3) sr->runCommand("python3 update_wiki.py 1vs1");
+        else sr->runCommand("python3 update_wiki.py 3vs3");
+    }
+    if (ServerConfig::m_super_tournament && ServerConfig::m_count_supertournament_game &&
+        !(ServerConfig::m_skip_end))
+    {
+        std::string redname = ServerConfig::m_red_team_name;
+        std::string bluename = ServerConfig::m_blue_team_name;
+        sr->runCommand("python3 supertournament_gameresult.py " + SoccerRanking::escapeArgument(redname) + " " + SoccerRanking::escapeArgument(bluename));
+    }
+}   // runRankingScripts
+
 // ----------------------------------------------------------------------------
 
 void ServerLobby::init1vs1Ranking()
@@ -5684,12 +6040,14 @@ void ServerLobby::init1vs1Ranking()
         if (usernames.size() == 2)
         {
             std::string suffix = ServerConfig::m_rank_1vs1 ? "1vs1" : (ServerConfig::m_rank_1vs1_2 ? "1vs1_2" : "1vs1_3");
-            std::string singdrossel = "python3 current_1vs1_players.py " + usernames[0] + " " + usernames[1] + " " + suffix + " &";
-            system(singdrossel.c_str());
+            std::string singdrossel = "python3 current_1vs1_players.py " + SoccerRanking::escapeArgument(usernames[0]) + " " + SoccerRanking::escapeArgument(usernames[1]) + " " + suffix;
+            if (ServerConfig::m_ranking_scripts)
+                SoccerRanking::get()->runCommand(singdrossel);
             m_1vs1_players.first = usernames[0]; m_1vs1_players.second = usernames[1];
         }
         else
         {
+            SoccerRanking::get()->cancelMatch();
             Log::warn("ServerLobby", "[1vs1] This game will not count for ranking since the number of players is %d (should be 2).", usernames.size());
             std::string users_str = "[1vs1] List of usernames:";
             for (auto &username : usernames) users_str += " " + username;
@@ -5719,16 +6077,16 @@ void add_gamescore2(std::string player_name)
 {
     std::string singdrossel;
     if (ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_1vs1_2 || ServerConfig::m_rank_1vs1_3) return;//singdrossel="python3 update_list.py "+player_name+" games 0 1vs1 &";
-    else singdrossel = "python3 update_list.py " + player_name + " games 0 3vs3 &";
-    system(singdrossel.c_str());
+    else singdrossel = "python3 update_list.py " + SoccerRanking::escapeArgument(player_name) + " games 0 3vs3";
+    SoccerRanking::get()->runCommand(singdrossel);
 }
 
 void rem_gamescore2(std::string player_name, double phase)
 {
     std::string ringdrossel;
     if (ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_1vs1_2 || ServerConfig::m_rank_1vs1_3) return;//ringdrossel="python3 update_list.py "+player_name+" leftgame "+std::to_string(phase)+" 1vs1 &";
-    else ringdrossel = "python3 update_list.py " + player_name + " leftgame " + std::to_string(phase) + " 3vs3 &";
-    system(ringdrossel.c_str());
+    else ringdrossel = "python3 update_list.py " + SoccerRanking::escapeArgument(player_name) + " leftgame " + std::to_string(phase) + " 3vs3";
+    SoccerRanking::get()->runCommand(ringdrossel);
 }
 
 /** Called when a client notifies the server that it has loaded the world.
@@ -5741,6 +6099,22 @@ void ServerLobby::finishedLoadingWorldClient(Event *event)
     m_peers_ready.at(peer) = true;
     Log::info("ServerLobby", "Peer %d has finished loading world at %lf",
         peer->getHostId(), StkTime::getRealTime());
+    bool is1vs1 = ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_1vs1_2 ||
+        ServerConfig::m_rank_1vs1_3;
+    for (auto& player : peer->getPlayerProfiles())
+    {
+        std::string username = StringUtils::wideToUtf8(player->getName());
+        KartTeam team = player->getTeam();
+        if (team == KART_TEAM_NONE || peer->isSpectator() || (is1vs1 &&
+            username != m_1vs1_players.first &&
+            username != m_1vs1_players.second))
+            continue;
+        SoccerRanking::get()->addPlayer(username,
+            team == KART_TEAM_RED ? 0 : 1);
+    }
+    if (!ServerConfig::m_ranking_scripts || !peer->hasPlayerProfiles())
+        return;
+
     if (ServerConfig::m_save_goals)
     {
         std::string username = StringUtils::wideToUtf8(peer->getPlayerProfiles()[0]->getName());
@@ -5756,31 +6130,28 @@ void ServerLobby::finishedLoadingWorldClient(Event *event)
         if (super) bluename = ServerConfig::m_blue_team_name;
 
         // Adding the current players to the database
-        if (peer->hasPlayerProfiles())
-        {
-            std::string singdrossel = "";
+        std::string singdrossel = "";
 
-            switch (peer->getPlayerProfiles()[0]->getTeam())
-            {
-            case KART_TEAM_RED:
-                if (super) singdrossel = "python3 supertournament_addcurrentplayer.py " + username + " " + redname + " &";
-                if (ServerConfig::m_rank_soccer) singdrossel = "python3 add_ranked-soccer_player.py " + username + " red" + " &";
-                if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel = "python3 add_super_mp_quali_player2.py " + username + " red" + " &";
-		else if (ServerConfig::m_super_mp_quali) singdrossel = "python3 add_super_mp_quali_player.py " + username + " red" + " &";
-                break;
-            case KART_TEAM_BLUE:
-                if (super) singdrossel = "python3 supertournament_addcurrentplayer.py " + username + " " + bluename + " &";
-                if (ServerConfig::m_rank_soccer) singdrossel = "python3 add_ranked-soccer_player.py " + username + " blue" + " &";
-                if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel = "python3 add_super_mp_quali_player2.py " + username + " blue" + " &";
-		else if (ServerConfig::m_super_mp_quali) singdrossel = "python3 add_super_mp_quali_player.py " + username + " blue" + " &";
-                break;
-            default:
-                break;
-            }
-
-            if (singdrossel != "")
-                system(singdrossel.c_str());
+        switch (peer->getPlayerProfiles()[0]->getTeam())
+        {
+        case KART_TEAM_RED:
+            if (super) singdrossel = "python3 supertournament_addcurrentplayer.py " + SoccerRanking::escapeArgument(username) + " " + SoccerRanking::escapeArgument(redname);
+            if (ServerConfig::m_rank_soccer) singdrossel = "python3 add_ranked-soccer_player.py " + SoccerRanking::escapeArgument(username) + " red";
+            if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel = "python3 add_super_mp_quali_player2.py " + SoccerRanking::escapeArgument(username) + " red";
+            else if (ServerConfig::m_super_mp_quali) singdrossel = "python3 add_super_mp_quali_player.py " + SoccerRanking::escapeArgument(username) + " red";
+            break;
+        case KART_TEAM_BLUE:
+            if (super) singdrossel = "python3 supertournament_addcurrentplayer.py " + SoccerRanking::escapeArgument(username) + " " + SoccerRanking::escapeArgument(bluename);
+            if (ServerConfig::m_rank_soccer) singdrossel = "python3 add_ranked-soccer_player.py " + SoccerRanking::escapeArgument(username) + " blue";
+            if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2) singdrossel = "python3 add_super_mp_quali_player2.py " + SoccerRanking::escapeArgument(username) + " blue";
+            else if (ServerConfig::m_super_mp_quali) singdrossel = "python3 add_super_mp_quali_player.py " + SoccerRanking::escapeArgument(username) + " blue";
+            break;
+        default:
+            break;
         }
+
+        if (singdrossel != "")
+            SoccerRanking::get()->runCommand(singdrossel);
     }
 }   // finishedLoadingWorldClient
 
@@ -5824,25 +6195,22 @@ void ServerLobby::handlePendingConnection()
             auto key = m_keys.find(online_id);
             if (key != m_keys.end() && key->second.m_tried == false)
             {
-                try
+                // Decrypted by the handshake workers, the connection stays
+                // pending until it is accepted. If the queue is full it is
+                // tried again in the next update.
+                const KeyData key_data = key->second;
+                const BareNetworkString encrypted = it->second.second;
+                auto job = [this, peer, key_data, encrypted, online_id]()
                 {
-                    if (decryptConnectionRequest(peer, it->second.second,
-                        key->second.m_aes_key, key->second.m_aes_iv, online_id,
-                        key->second.m_name, key->second.m_country_code))
-                    {
-                        it = m_pending_connection.erase(it);
-                        m_keys.erase(online_id);
-                        continue;
-                    }
-                    else
-                        key->second.m_tried = true;
-                }
-                catch (std::exception& e)
-                {
-                    Log::error("ServerLobby",
-                        "handlePendingConnection error: %s", e.what());
+                    BareNetworkString data = encrypted;
+                    auto accept = decryptConnectionRequest(peer, data,
+                        key_data.m_aes_key, key_data.m_aes_iv, online_id,
+                        key_data.m_name, key_data.m_country_code);
+                    return accept ? HandshakePipeline::Result::accept(accept) :
+                        HandshakePipeline::Result::reject();
+                };
+                if (m_handshake_pipeline->submit(job))
                     key->second.m_tried = true;
-                }
             }
             it++;
         }
@@ -5850,23 +6218,38 @@ void ServerLobby::handlePendingConnection()
 }   // handlePendingConnection
 
 //-----------------------------------------------------------------------------
-bool ServerLobby::decryptConnectionRequest(std::shared_ptr<STKPeer> peer,
-    BareNetworkString& data, const std::string& key, const std::string& iv,
-    uint32_t online_id, const core::stringw& online_name,
-    const std::string& country_code)
+/** Decrypts the connection request of a pending connection, called by the
+ *  handshake workers.
+ *  \return The function handling the decrypted request in the lobby thread,
+ *  or an empty function if it cannot be decrypted with the key.
+ */
+std::function<void()> ServerLobby::decryptConnectionRequest(
+    std::shared_ptr<STKPeer> peer, BareNetworkString& data,
+    const std::string& key, const std::string& iv, uint32_t online_id,
+    const core::stringw& online_name, const std::string& country_code)
 {
-    auto crypto = std::unique_ptr<Crypto>(new Crypto(
+    auto crypto = std::make_shared<std::unique_ptr<Crypto> >(new Crypto(
         Crypto::decode64(key), Crypto::decode64(iv)));
-    if (crypto->decryptConnectionRequest(data))
+    if (!(*crypto)->decryptConnectionRequest(data))
+        return std::function<void()>();
+
+    Log::info("ServerLobby", "%s validated",
+        StringUtils::wideToUtf8(online_name).c_str());
+    return [this, peer, crypto, data, online_id, online_name, country_code]()
+        mutable
     {
-        peer->setCrypto(std::move(crypto));
-        Log::info("ServerLobby", "%s validated",
-            StringUtils::wideToUtf8(online_name).c_str());
+        // Dropped if the lobby cleared the pending connections meanwhile
+        auto it = m_pending_connection.find(peer);
+        if (it == m_pending_connection.end() || peer->isDisconnected())
+            return;
+        m_pending_connection.erase(it);
+        std::unique_lock<std::mutex> ul(m_keys_mutex);
+        m_keys.erase(online_id);
+        ul.unlock();
+        peer->setCrypto(std::move(*crypto));
         handleUnencryptedConnection(peer, data, online_id,
             online_name, true/*is_pending_connection*/, country_code);
-        return true;
-    }
-    return false;
+    };
 }   // decryptConnectionRequest
 
 //-----------------------------------------------------------------------------
@@ -6115,15 +6498,23 @@ void ServerLobby::resetServer()
 }   // resetServer
 
 //-----------------------------------------------------------------------------
-void ServerLobby::testBannedForIP(STKPeer* peer) const
+/** Checks if the IPv4 address of a peer is banned, called by the handshake
+ *  workers.
+ *  \param ban_reason Set to the reason of the ban.
+ *  \param count_trigger Set to a function counting the ban trigger, which
+ *         must be run in the lobby thread.
+ */
+bool ServerLobby::testBannedForIP(const STKPeer* peer,
+    std::string* ban_reason, std::function<void()>* count_trigger) const
 {
 #ifdef ENABLE_SQLITE3
-    if (!m_db || !m_ip_ban_table_exists)
-        return;
+    sqlite3* db = getHandshakeDatabase();
+    if (!db || !m_ip_ban_table_exists)
+        return false;
 
     // Test for IPv4
     if (peer->getAddress().isIPv6())
-        return;
+        return false;
 
     int row_id = -1;
     unsigned ip_start = 0;
@@ -6139,7 +6530,7 @@ void ServerLobby::testBannedForIP(STKPeer* peer) const
         peer->getAddress().getIP(), peer->getAddress().getIP());
 
     sqlite3_stmt* stmt = NULL;
-    int ret = sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, 0);
+    int ret = sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0);
     if (ret == SQLITE_OK)
     {
         ret = sqlite3_step(stmt);
@@ -6153,21 +6544,21 @@ void ServerLobby::testBannedForIP(STKPeer* peer) const
             Log::info("ServerLobby", "%s banned by IP: %s "
                 "(rowid: %d, description: %s).",
                 peer->getAddress().toString().c_str(), reason, row_id, desc);
-            kickPlayerWithReason(peer, reason);
+            *ban_reason = reason;
         }
         ret = sqlite3_finalize(stmt);
         if (ret != SQLITE_OK)
         {
             Log::error("ServerLobby",
                 "Error finalize database for query %s: %s",
-                query.c_str(), sqlite3_errmsg(m_db));
+                query.c_str(), sqlite3_errmsg(db));
         }
     }
     else
     {
         Log::error("ServerLobby", "Error preparing database for query %s: %s",
-            query.c_str(), sqlite3_errmsg(m_db));
-        return;
+            query.c_str(), sqlite3_errmsg(db));
+        return false;
     }
     if (row_id != -1)
     {
@@ -6176,21 +6567,26 @@ void ServerLobby::testBannedForIP(STKPeer* peer) const
             "last_trigger = datetime('now') "
             "WHERE ip_start = %u AND ip_end = %u;",
             ServerConfig::m_ip_ban_table.c_str(), ip_start, ip_end);
-        easySQLQuery(query);
+        *count_trigger = [this, query]() { easySQLQuery(query); };
     }
+    return row_id != -1;
 #endif
+    return false;
 }   // testBannedForIP
 
 //-----------------------------------------------------------------------------
-void ServerLobby::testBannedForIPv6(STKPeer* peer) const
+/** Checks if the IPv6 address of a peer is banned, see testBannedForIP. */
+bool ServerLobby::testBannedForIPv6(const STKPeer* peer,
+    std::string* ban_reason, std::function<void()>* count_trigger) const
 {
 #ifdef ENABLE_SQLITE3
-    if (!m_db || !m_ipv6_ban_table_exists)
-        return;
+    sqlite3* db = getHandshakeDatabase();
+    if (!db || !m_ipv6_ban_table_exists)
+        return false;
 
     // Test for IPv6
     if (!peer->getAddress().isIPv6())
-        return;
+        return false;
 
     int row_id = -1;
     std::string ipv6_cidr;
@@ -6204,7 +6600,7 @@ void ServerLobby::testBannedForIPv6(STKPeer* peer) const
         ServerConfig::m_ipv6_ban_table.c_str());
 
     sqlite3_stmt* stmt = NULL;
-    int ret = sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, 0);
+    int ret = sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0);
     if (ret == SQLITE_OK)
     {
         if (sqlite3_bind_text(stmt, 1,
@@ -6212,7 +6608,7 @@ void ServerLobby::testBannedForIPv6(STKPeer* peer) const
             != SQLITE_OK)
         {
             Log::error("ServerLobby", "Error binding ipv6 addr for query: %s",
-                sqlite3_errmsg(m_db));
+                sqlite3_errmsg(db));
         }
 
         ret = sqlite3_step(stmt);
@@ -6225,21 +6621,21 @@ void ServerLobby::testBannedForIPv6(STKPeer* peer) const
             Log::info("ServerLobby", "%s banned by IP: %s "
                 "(rowid: %d, description: %s).",
                 peer->getAddress().toString().c_str(), reason, row_id, desc);
-            kickPlayerWithReason(peer, reason);
+            *ban_reason = reason;
         }
         ret = sqlite3_finalize(stmt);
         if (ret != SQLITE_OK)
         {
             Log::error("ServerLobby",
                 "Error finalize database for query %s: %s",
-                query.c_str(), sqlite3_errmsg(m_db));
+                query.c_str(), sqlite3_errmsg(db));
         }
     }
     else
     {
         Log::error("ServerLobby", "Error preparing database for query %s: %s",
-            query.c_str(), sqlite3_errmsg(m_db));
-        return;
+            query.c_str(), sqlite3_errmsg(db));
+        return false;
     }
     if (row_id != -1)
     {
@@ -6247,26 +6643,34 @@ void ServerLobby::testBannedForIPv6(STKPeer* peer) const
             "UPDATE %s SET trigger_count = trigger_count + 1, "
             "last_trigger = datetime('now') "
             "WHERE ipv6_cidr = ?;", ServerConfig::m_ipv6_ban_table.c_str());
-        easySQLQuery(query, [ipv6_cidr](sqlite3_stmt* stmt)
+        *count_trigger = [this, query, ipv6_cidr]()
         {
-            if (sqlite3_bind_text(stmt, 1, ipv6_cidr.c_str(),
-                -1, SQLITE_TRANSIENT) != SQLITE_OK)
+            easySQLQuery(query, [ipv6_cidr](sqlite3_stmt* stmt)
             {
-                Log::error("easySQLQuery", "Failed to bind %s.",
-                    ipv6_cidr.c_str());
-            }
-        });
+                if (sqlite3_bind_text(stmt, 1, ipv6_cidr.c_str(),
+                    -1, SQLITE_TRANSIENT) != SQLITE_OK)
+                {
+                    Log::error("easySQLQuery", "Failed to bind %s.",
+                        ipv6_cidr.c_str());
+                }
+            });
+        };
     }
+    return row_id != -1;
 #endif
+    return false;
 }   // testBannedForIPv6
 
 //-----------------------------------------------------------------------------
-void ServerLobby::testBannedForOnlineId(STKPeer* peer,
-    uint32_t online_id) const
+/** Checks if the online id of a peer is banned, see testBannedForIP. */
+bool ServerLobby::testBannedForOnlineId(const STKPeer* peer,
+    uint32_t online_id, std::string* ban_reason,
+    std::function<void()>* count_trigger) const
 {
 #ifdef ENABLE_SQLITE3
-    if (!m_db || !m_online_id_ban_table_exists)
-        return;
+    sqlite3* db = getHandshakeDatabase();
+    if (!db || !m_online_id_ban_table_exists)
+        return false;
 
     int row_id = -1;
     std::string query = StringUtils::insertValues(
@@ -6279,7 +6683,7 @@ void ServerLobby::testBannedForOnlineId(STKPeer* peer,
         ServerConfig::m_online_id_ban_table.c_str(), online_id);
 
     sqlite3_stmt* stmt = NULL;
-    int ret = sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, 0);
+    int ret = sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0);
     if (ret == SQLITE_OK)
     {
         ret = sqlite3_step(stmt);
@@ -6292,20 +6696,20 @@ void ServerLobby::testBannedForOnlineId(STKPeer* peer,
                 "(online id: %u rowid: %d, description: %s).",
                 peer->getAddress().toString().c_str(), reason, online_id,
                 row_id, desc);
-            kickPlayerWithReason(peer, reason);
+            *ban_reason = reason;
         }
         ret = sqlite3_finalize(stmt);
         if (ret != SQLITE_OK)
         {
             Log::error("ServerLobby", "Error finalize database: %s",
-                sqlite3_errmsg(m_db));
+                sqlite3_errmsg(db));
         }
     }
     else
     {
         Log::error("ServerLobby", "Error preparing database: %s",
-            sqlite3_errmsg(m_db));
-        return;
+            sqlite3_errmsg(db));
+        return false;
     }
     if (row_id != -1)
     {
@@ -6314,11 +6718,31 @@ void ServerLobby::testBannedForOnlineId(STKPeer* peer,
             "last_trigger = datetime('now') "
             "WHERE online_id = %u;",
             ServerConfig::m_online_id_ban_table.c_str(), online_id);
-        easySQLQuery(query);
+        *count_trigger = [this, query]() { easySQLQuery(query); };
     }
+    return row_id != -1;
 #endif
+    return false;
 }   // testBannedForOnlineId
 
+//-----------------------------------------------------------------------------
+/** Returns the database connection for the ban checks of the current
+ *  handshake worker, which is opened read only on first use. Without
+ *  workers the jobs run in the lobby thread, which uses its own connection.
+ */
+sqlite3* ServerLobby::getHandshakeDatabase() const
+{
+    if (!m_db || !m_handshake_pipeline->hasWorkers())
+        return m_db;
+    if (!g_worker_db_opened)
+    {
+        g_worker_db_opened = true;
+        g_worker_db = openDatabase(SQLITE_OPEN_FULLMUTEX |
+            SQLITE_OPEN_READONLY);
+    }
+    return g_worker_db;
+}   // getHandshakeDatabase
+
 //-----------------------------------------------------------------------------
 void ServerLobby::listBanTable()
 {
@@ -6806,32 +7230,11 @@ void ServerLobby::clientInGameWantsToBackLobby(Event* event)
                 peer->getAddress().toString().c_str(), id);
             rki.setNetworkPlayerProfile(
                 std::shared_ptr<NetworkPlayerProfile>());
-            if (ServerConfig::m_save_goals)
-            {
-                std::string username = StringUtils::wideToUtf8(peer->getPlayerProfiles()[0]->getName());
-                double phase = 0.0;
-                if (RaceManager::get()->hasTimeTarget())
-                {
-                    phase = (RaceManager::get()->getTimeTarget() - World::getWorld()->getTime()) / RaceManager::get()->getTimeTarget();
-                }
-                else
-                {
-                    int red_scorers_count = 0; int blue_scorers_count = 0;
-                    SoccerWorld *sw = dynamic_cast<SoccerWorld*>(World::getWorld());
-                    if (sw)
-                    {
-                        red_scorers_count = sw->get_red_scorers_count();
-                        blue_scorers_count = sw->get_blue_scorers_count();
-                    }
-                    phase = 1.0*std::max(red_scorers_count, blue_scorers_count) / RaceManager::get()->getMaxGoal();
-                    std::string message = "red_scorers_cnt=" + std::to_string(red_scorers_count) + " / blue_scorers_cnt" + std::to_string(blue_scorers_count);
-                    message += " / max_goll=" + std::to_string(RaceManager::get()->getMaxGoal());
-                    Log::info("ServerLobby", message.c_str());
-                }
-                std::string message = "phase=" + std::to_string(phase);
-                Log::info("ServerLobby", message.c_str());
+            std::string username = StringUtils::wideToUtf8(rki.getPlayerName());
+            double phase = getSoccerMatchPhase();
+            SoccerRanking::get()->removePlayer(username, phase);
+            if (ServerConfig::m_save_goals && ServerConfig::m_ranking_scripts)
                 rem_gamescore2(username, phase);
-            }
         }
         else
         {
@@ -7210,6 +7613,11 @@ void ServerLobby::handleServerCommand(Event* event,
 
             Log::info("ServerLobby", "Player %s kicks %s using /kick", peer_username.c_str(), player_name.c_str());
             player_peer->kick();
+            if (GameEvents::get())
+            {
+                GameEvents::get()->push(GameEvents::GE_KICK, player_name,
+                    peer_username);
+            }
             if (ServerConfig::m_track_kicks) {
                 std::string auto_report = "[ Auto report caused by kick ]";
                 writeOwnReport(player_peer.get(), peer.get(), auto_report);
@@ -7220,6 +7628,11 @@ void ServerLobby::handleServerCommand(Event* event,
                 {
                     Log::info("ServerLobby", "%s is now banned", player_name.c_str());
                     m_temp_banned.insert(player_name);
+                    if (GameEvents::get())
+                    {
+                        GameEvents::get()->push(GameEvents::GE_BAN,
+                            player_name, peer_username);
+                    }
                     std::string msg = StringUtils::insertValues(
                         "%s is now banned", player_name.c_str());
                     sendStringToPeer(msg, peer);
@@ -7292,6 +7705,11 @@ void ServerLobby::handleServerCommand(Event* event,
 
             Log::info("ServerLobby", "%s is now banned", player_name.c_str());
             m_temp_banned.insert(player_name);
+            if (GameEvents::get())
+            {
+                GameEvents::get()->push(GameEvents::GE_BAN, player_name,
+                    peer_username);
+            }
 
             std::string msg = StringUtils::insertValues(
                 "%s is now banned", player_name.c_str());
@@ -7708,9 +8126,11 @@ void ServerLobby::handleServerCommand(Event* event,
                 sendGrandPrixStandingsToPeer(peer);
             else if (argv[1] == "gnu")
                 sendGnuStandingsToPeer(peer);
+            else if (argv[1] == "teams")
+                sendTeamStandingsToPeer(peer);
             else
             {
-                std::string msg = "Usage: /standings [gp | gnu]";
+                std::string msg = "Usage: /standings [gp | gnu | teams]";
                 sendStringToPeer(msg, peer);
             }
             return;
@@ -7720,6 +8140,11 @@ void ServerLobby::handleServerCommand(Event* event,
             sendGrandPrixStandingsToPeer(peer);
             return;
         }
+        if (ServerConfig::m_super_tournament)
+        {
+            sendTeamStandingsToPeer(peer);
+            return;
+        }
         sendGnuStandingsToPeer(peer);
     }
     if (argv[0] == "teamchat")
@@ -7796,7 +8221,28 @@ void ServerLobby::handleServerCommand(Event* event,
             else
             {
                 std::string records_table_name = ServerConfig::m_records_table_name;
-                if (!records_table_name.empty())
+                RecordsIndex::Key key(track_name, reverse_name, mode_name,
+                    laps_count);
+                std::string best_user;
+                double best_result = 1e18;
+                if (!records_table_name.empty() && updateRecordsIndex())
+                {
+                    if (m_records_index->getBest(key, &best_user,
+                        &best_result))
+                    {
+                        std::string message = StringUtils::insertValues(
+                            "The record is %s by %s",
+                            StringUtils::timeToString(best_result),
+                            best_user);
+                        chat->encodeString16(
+                            StringUtils::utf8ToWide(message));
+                    }
+                    else
+                    {
+                        chat->encodeString16(L"No time set yet. Or there is a typo.");
+                    }
+                }
+                else if (!records_table_name.empty())
                 {
                     std::string get_query = StringUtils::insertValues("SELECT username, "
                         "result FROM %s LEFT JOIN "
@@ -7846,6 +8292,60 @@ void ServerLobby::handleServerCommand(Event* event,
         }
 #else
         chat->encodeString16(L"This command is not supported.");
+#endif
+        peer->sendPacket(chat, true/*reliable*/);
+        delete chat;
+    }
+    if (argv[0] == "records")
+    {
+        NetworkString* chat = getNetworkString();
+        chat->addUInt8(LE_CHAT);
+        chat->setSynchronous(true);
+#ifdef ENABLE_SQLITE3
+        int laps_count = -1;
+        int top_count = 5;
+        if (argv.size() < 5 ||
+            !StringUtils::parseString<int>(argv[4], &laps_count) ||
+            laps_count < 0 || (argv.size() > 5 &&
+            !StringUtils::parseString<int>(argv[5], &top_count)))
+        {
+            chat->encodeString16(L"Usage: /records (track id) "
+                "(normal/time-trial) (normal/reverse) (laps) [count]\n"
+                "Receives the best players for the race settings if any");
+        }
+        else if (!updateRecordsIndex())
+        {
+            chat->encodeString16(L"No table storing records!");
+        }
+        else
+        {
+            std::string mode_name = (argv[2] == "t" || argv[2] == "tt"
+                || argv[2] == "time-trial" || argv[2] == "timetrial" ?
+                "time-trial" : "normal");
+            std::string reverse_name = (argv[3] == "r" ||
+                argv[3] == "rev" || argv[3] == "reverse" ? "reverse" :
+                "normal");
+            top_count = std::max(1, std::min(top_count, 20));
+            auto top = m_records_index->getTop(RecordsIndex::Key(argv[1],
+                reverse_name, mode_name, laps_count), top_count);
+            if (top.empty())
+            {
+                chat->encodeString16(L"No time set yet. Or there is a typo.");
+            }
+            else
+            {
+                std::string message = "Best results:";
+                for (unsigned i = 0; i < top.size(); i++)
+                {
+                    message += StringUtils::insertValues("\n%d. %s %s",
+                        i + 1, top[i].first,
+                        StringUtils::timeToString(top[i].second));
+                }
+                chat->encodeString16(StringUtils::utf8ToWide(message));
+            }
+        }
+#else
+        chat->encodeString16(L"This command is not supported.");
 #endif
         peer->sendPacket(chat, true/*reliable*/);
         delete chat;
@@ -8223,8 +8723,8 @@ void ServerLobby::handleServerCommand(Event* event,
         std::string peer_username = StringUtils::wideToUtf8(peer->getPlayerProfiles()[0]->getName());
         if (argv[0] == "join")
         {
-            std::string kali = "python3 join.py " + peer_username;
-            system(kali.c_str());
+            std::string kali = "python3 join.py " + SoccerRanking::escapeArgument(peer_username);
+            SoccerRanking::get()->runCommand(kali);
             std::string msg = "Successfully joined the tournament.";
             sendStringToPeer(msg, peer);
         }
@@ -8239,8 +8739,8 @@ void ServerLobby::handleServerCommand(Event* event,
             bool valid_time = (argv[1] == "mo16" || argv[1] == "mo17" || argv[1] == "mo18" || argv[1] == "mo19" || argv[1] == "tu16" || argv[1] == "tu17" || argv[1] == "tu18" || argv[1] == "tu19" || argv[1] == "we16" || argv[1] == "we17" || argv[1] == "we18" || argv[1] == "we19" || argv[1] == "th16" || argv[1] == "th17" || argv[1] == "th18" || argv[1] == "th19" || argv[1] == "fr16" || argv[1] == "fr17" || argv[1] == "fr18" || argv[1] == "fr19" || argv[1] == "sa16" || argv[1] == "sa17" || argv[1] == "sa18" || argv[1] == "sa19" || argv[1] == "su16" || argv[1] == "su17" || argv[1] == "su18" || argv[1] == "su19" || argv[1] == "mo" || argv[1] == "tu" || argv[1] == "we" || argv[1] == "th" || argv[1] == "fr" || argv[1] == "sa" || argv[1] == "su" || argv[1] == "weekdays" || argv[1] == "weekends" || argv[1] == "weekdays16" || argv[1] == "weekends16" || argv[1] == "weekdays17" || argv[1] == "weekends17" || argv[1] == "weekdays18" || argv[1] == "weekends18" || argv[1] == "weekdays19" || argv[1] == "weekends19" || argv[1] == "16" || argv[1] == "17" || argv[1] == "18" || argv[1] == "19" || argv[1] == "all");
             if (valid_time)
             {
-                std::string kali = "python3 time_poll.py " + peer_username + " " + argv[1] + " " + argv[0];
-                system(kali.c_str());
+                std::string kali = "python3 time_poll.py " + SoccerRanking::escapeArgument(peer_username) + " " + SoccerRanking::escapeArgument(argv[1]) + " " + SoccerRanking::escapeArgument(argv[0]);
+                SoccerRanking::get()->runCommand(kali);
                 std::string msg = "Successfully edited timepoll.";
                 sendStringToPeer(msg, peer);
             }
@@ -8268,8 +8768,8 @@ void ServerLobby::handleServerCommand(Event* event,
                 v1++;
             }
             sendStringToAllPeers(msg);
-            std::string ringdrossel = "python3 supertournament_yellow.py " + argv[1] + " &";
-            system(ringdrossel.c_str());
+            std::string ringdrossel = "python3 supertournament_yellow.py " + SoccerRanking::escapeArgument(argv[1]);
+            SoccerRanking::get()->runCommand(ringdrossel);
         }
 
         // Following commands are SuperTournament only
@@ -8334,8 +8834,8 @@ void ServerLobby::handleServerCommand(Event* event,
                 }
                 std::string blau = ServerConfig::m_blue_team_name;
                 std::string rot = ServerConfig::m_red_team_name;
-                std::string ringdrossel = "python3 supertournament_match_info.py " + argv[1] + " Addon " + rot + " " + blau + " &";
-                system(ringdrossel.c_str());
+                std::string ringdrossel = "python3 supertournament_match_info.py " + SoccerRanking::escapeArgument(argv[1]) + " Addon " + SoccerRanking::escapeArgument(rot) + " " + SoccerRanking::escapeArgument(blau);
+                SoccerRanking::get()->runCommand(ringdrossel);
                 std::string msg = "Succesfully edited Addon.";
                 sendStringToPeer(msg, peer);
             }
@@ -8349,8 +8849,8 @@ void ServerLobby::handleServerCommand(Event* event,
                 }
                 std::string blau = ServerConfig::m_blue_team_name;
                 std::string rot = ServerConfig::m_red_team_name;
-                std::string ringdrossel = "python3 supertournament_match_info.py " + argv[1] + " Server " + rot + " " + blau + " &";
-                system(ringdrossel.c_str());
+                std::string ringdrossel = "python3 supertournament_match_info.py " + SoccerRanking::escapeArgument(argv[1]) + " Server " + SoccerRanking::escapeArgument(rot) + " " + SoccerRanking::escapeArgument(blau);
+                SoccerRanking::get()->runCommand(ringdrossel);
                 std::string msg = "Succesfully edited Server.";
                 sendStringToPeer(msg, peer);
             }
@@ -8364,8 +8864,8 @@ void ServerLobby::handleServerCommand(Event* event,
                 }
                 std::string blau = ServerConfig::m_blue_team_name;
                 std::string rot = ServerConfig::m_red_team_name;
-                std::string ringdrossel = "python3 supertournament_match_info.py " + argv[1] + " Referee " + rot + " " + blau + " &";
-                system(ringdrossel.c_str());
+                std::string ringdrossel = "python3 supertournament_match_info.py " + SoccerRanking::escapeArgument(argv[1]) + " Referee " + SoccerRanking::escapeArgument(rot) + " " + SoccerRanking::escapeArgument(blau);
+                SoccerRanking::get()->runCommand(ringdrossel);
                 std::string msg = "Succesfully edited Referee.";
                 sendStringToPeer(msg, peer);
             }
@@ -8379,8 +8879,8 @@ void ServerLobby::handleServerCommand(Event* event,
                 }
                 std::string blau = ServerConfig::m_blue_team_name;
                 std::string rot = ServerConfig::m_red_team_name;
-                std::string ringdrossel = "python3 supertournament_match_info.py " + argv[1] + " Video " + rot + " " + blau + " &";
-                system(ringdrossel.c_str());
+                std::string ringdrossel = "python3 supertournament_match_info.py " + SoccerRanking::escapeArgument(argv[1]) + " Video " + SoccerRanking::escapeArgument(rot) + " " + SoccerRanking::escapeArgument(blau);
+                SoccerRanking::get()->runCommand(ringdrossel);
                 std::string msg = "Succesfully edited video link.";
                 sendStringToPeer(msg, peer);
             }
@@ -8394,8 +8894,8 @@ void ServerLobby::handleServerCommand(Event* event,
                 }
                 std::string blau = ServerConfig::m_blue_team_name;
                 std::string rot = ServerConfig::m_red_team_name;
-                std::string ringdrossel = "python3 supertournament_match_info.py " + argv[1] + " Notes " + rot + " " + blau + " &";
-                system(ringdrossel.c_str());
+                std::string ringdrossel = "python3 supertournament_match_info.py " + SoccerRanking::escapeArgument(argv[1]) + " Notes " + SoccerRanking::escapeArgument(rot) + " " + SoccerRanking::escapeArgument(blau);
+                SoccerRanking::get()->runCommand(ringdrossel);
                 std::string msg = "Succesfully edited notes.";
                 sendStringToPeer(msg, peer);
             }
@@ -8455,7 +8955,6 @@ void ServerLobby::handleServerCommand(Event* event,
                     return;
                 }
 
-                m_super_tourn_quali.readElosFromFile();
                 m_super_tourn_quali.sortPlayersByElo();
 
                 std::string msg = "New teams created.";
@@ -9493,6 +9992,90 @@ std::string ServerLobby::serverModeToString(unsigned char game_mode, unsigned ch
     }
 } // serverModeToString
 //-----------------------------------------------------------------------------
+#ifdef ENABLE_SQLITE3
+/** Reads the rows of the records table added since the last call into the
+ *  records index, on first use the index is loaded from its snapshot (or
+ *  built from the whole table if there is none). At most once a minute the
+ *  rows up to the last indexed one are counted, if some were deleted the
+ *  index is rebuilt.
+ *  \return False if the index can't be used, callers then query the table.
+ */
+bool ServerLobby::updateRecordsIndex()
+{
+    std::string records_table_name = ServerConfig::m_records_table_name;
+    if (records_table_name.empty() || !m_db || m_records_index_disabled)
+        return false;
+    if (!m_records_index)
+    {
+        m_records_index.reset(new RecordsIndex(
+            ServerConfig::getConfigDirectory() + "/" + records_table_name +
+            "_records"));
+        if (!m_records_index->load())
+        {
+            Log::info("ServerLobby", "Building records index of %s.",
+                records_table_name.c_str());
+        }
+        m_records_index_check_time = 0;
+    }
+    uint64_t now = StkTime::getMonoTimeMs();
+    if (m_records_index->getLastRowId() > 0 &&
+        (m_records_index_check_time == 0 ||
+        now > m_records_index_check_time + 60000))
+    {
+        m_records_index_check_time = now;
+        std::string count_query = StringUtils::insertValues(
+            "SELECT COUNT(*) FROM %s WHERE rowid <= %s;",
+            records_table_name.c_str(),
+            StringUtils::toString(m_records_index->getLastRowId()).c_str());
+        auto count = vectorSQLQuery(count_query, 1);
+        uint64_t num_rows = 0;
+        if (count.first && !count.second[0].empty() &&
+            StringUtils::fromString(count.second[0][0], num_rows) &&
+            num_rows < m_records_index->getNumRows())
+        {
+            Log::info("ServerLobby", "Results were deleted from %s, "
+                "rebuilding records index.", records_table_name.c_str());
+            m_records_index->clear();
+        }
+    }
+    std::string query = StringUtils::insertValues(
+        "SELECT rowid, username, venue, reverse, mode, laps, result "
+        "FROM %s WHERE rowid > %s ORDER BY rowid;",
+        records_table_name.c_str(),
+        StringUtils::toString(m_records_index->getLastRowId()).c_str());
+    auto ret = vectorSQLQuery(query, 7);
+    if (!ret.first)
+    {
+        // Most likely a table without rowid, don't try again
+        Log::warn("ServerLobby", "Cannot index records of %s.",
+            records_table_name.c_str());
+        m_records_index.reset();
+        m_records_index_disabled = true;
+        return false;
+    }
+    const auto& rows = ret.second;
+    for (unsigned i = 0; i < rows[0].size(); i++)
+    {
+        int64_t rowid = 0;
+        int laps = 0;
+        double result = 0.0;
+        if (!StringUtils::fromString(rows[0][i], rowid))
+            continue;
+        if (!StringUtils::fromString(rows[5][i], laps) ||
+            !StringUtils::fromString(rows[6][i], result))
+        {
+            m_records_index->skipRow(rowid);
+            continue;
+        }
+        m_records_index->addResult(RecordsIndex::Key(rows[2][i],
+            rows[3][i], rows[4][i], laps), rows[1][i], result, rowid);
+    }
+    if (!rows[0].empty())
+        m_records_index->save();
+    return true;
+}   // updateRecordsIndex
+#endif
+//-----------------------------------------------------------------------------
 void ServerLobby::storeResults()
 {
 #ifdef ENABLE_SQLITE3
@@ -9511,7 +10094,14 @@ void ServerLobby::storeResults()
     double best_result = 0.0;
     std::string best_user = "";
 
-    if (!records_table_name.empty())
+    if (!records_table_name.empty() && updateRecordsIndex())
+    {
+        record_fetched = true;
+        record_exists = m_records_index->getBest(RecordsIndex::Key(
+            track_name, reverse_string, mode_name, laps_number), &best_user,
+            &best_result);
+    }
+    else if (!records_table_name.empty())
     {
         std::string get_query = StringUtils::insertValues("SELECT username, "
             "result FROM %s INNER JOIN "
@@ -9561,6 +10151,9 @@ void ServerLobby::storeResults()
         );
         easySQLQuery(query);
     }
+    // Pick up the new results now, so the next lookup has nothing to read
+    if (m_records_index)
+        updateRecordsIndex();
     if (record_fetched && best_cur_player_idx != -1)
     {
         NetworkString* chat = getNetworkString();
@@ -10237,35 +10830,23 @@ int ServerLobby::getPlayerElo(std::string username) const
     if (ServerConfig::m_super_tournament_qualification)
         return m_super_tourn_quali.getElo(username);
 
+    if ((ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_soccer) &&
+        !ServerConfig::m_ranking_scripts)
+    {
+        std::vector<SoccerRanking::RankingMode> modes =
+            SoccerRanking::getServerModes();
+        return (int)SoccerRanking::get()->getElo(modes[0], username);
+    }
+
     if (ServerConfig::m_rank_1vs1 || ServerConfig::m_rank_soccer)
     {
-        // TODO: It's nonsense to read the elos from the database right here.
-        //       Better read the elos after each game and store them in a global variable.
+        // The ranking scripts write the Elo in text files
         std::string fileName = "game_stat_1vs1.txt";
-	if (ServerConfig::m_rank_soccer) fileName="soccer_ranking.txt";
-	if (ServerConfig::m_super_mp_quali) fileName="supertournament_mp_quali_ranking.txt";
-        std::ifstream in_file(fileName);
-        int elo = 0;
-        std::string player = "";
-        std::vector<std::string> split;
-        if (in_file.is_open())
-        {
-            std::string line;
-            std::getline(in_file, line);
-            while (std::getline(in_file, line))
-            {
-                split = StringUtils::split(line, ' ');
-                if (split.size() < 4) continue;
-                if (split[1] == "Played_Games") continue;
-                if (ServerConfig::m_rank_1vs1) elo = int(stof(split[3]));
-                if (ServerConfig::m_rank_soccer) elo = int(stof(split[1]));
-                player = split[0];
-                if (player == username)
-                    return elo;
-            }
-        }
-        in_file.close();
-        return 1500;
+        if (ServerConfig::m_rank_soccer) fileName = "soccer_ranking.txt";
+        if (ServerConfig::m_super_mp_quali) fileName = "supertournament_mp_quali_ranking.txt";
+        unsigned column = ServerConfig::m_rank_soccer ? 1 : 3;
+        return (int)SoccerRanking::get()->getFileElo(fileName, column,
+            username);
     }
 
     return -1;
@@ -10307,7 +10888,7 @@ bool ServerLobby::teamsBalanced()
         }
     }
 
-    return (red > 0 && blue > 0) || (red + blue == 1);
+    return TeamBalancer::teamsBalanced(red, blue);
 }
 //-----------------------------------------------------------------------------
 void ServerLobby::loadTracksQueueFromConfig()
@@ -10358,6 +10939,32 @@ void ServerLobby::sendGrandPrixStandingsToPeer(std::shared_ptr<STKPeer> peer) co
     sendStringToPeer(answer, peer);
 }   // sendGnuStandingsToPeer
 //-----------------------------------------------------------------------------
+void ServerLobby::sendTeamStandingsToPeer(std::shared_ptr<STKPeer> peer) const
+{
+    std::shared_ptr<const SoccerRanking::Standings> standings =
+        SoccerRanking::get()->getStandings();
+    if (standings->empty())
+    {
+        std::string msg = "No supertournament game was played yet.";
+        sendStringToPeer(msg, peer);
+        return;
+    }
+    std::stringstream response;
+    response << "Supertournament standings\n";
+    for (unsigned i = 0; i < standings->size(); i++)
+    {
+        const SoccerRanking::TeamStats& ts = (*standings)[i].second;
+        response << (i + 1) << ". " << (*standings)[i].first;
+        response << "  " << ts.m_points << " pts";
+        response << "  " << ts.m_wins << "-" << ts.m_draws << "-"
+            << ts.m_losses;
+        response << "  " << ts.m_goals_for << ":" << ts.m_goals_against;
+        response << "\n";
+    }
+    std::string answer = response.str();
+    sendStringToPeer(answer, peer);
+}   // sendTeamStandingsToPeer
+//-----------------------------------------------------------------------------
 void ServerLobby::loadCustomScoring()
 {
     m_scoring_int_params.clear();
@@ -42,9 +42,11 @@
 #endif
 
 class BareNetworkString;
+class HandshakePipeline;
 class NetworkItemManager;
 class NetworkString;
 class NetworkPlayerProfile;
+class RecordsIndex;
 class STKPeer;
 class SocketAddress;
 
@@ -123,8 +125,19 @@ private:
 
     uint64_t m_last_poll_db_time;
 
+    /** Best results of the records table, see updateRecordsIndex. */
+    std::unique_ptr<RecordsIndex> m_records_index;
+
+    /** True if the records table can't be indexed (no rowid). */
+    bool m_records_index_disabled;
+
+    /** Last time the records index was checked for deleted rows. */
+    uint64_t m_records_index_check_time;
+
     void pollDatabase();
 
+    bool updateRecordsIndex();
+
     bool easySQLQuery(const std::string& query,
         std::function<void(sqlite3_stmt* stmt)> bind_function = nullptr) const;
 
@@ -134,6 +147,8 @@ private:
 
     void checkTableExists(const std::string& table, bool& result);
 
+    sqlite3* getHandshakeDatabase() const;
+
     std::string ip2Country(const SocketAddress& addr) const;
 
     std::string ipv62Country(const SocketAddress& addr) const;
@@ -215,6 +230,9 @@ private:
 
     std::map<std::string, uint64_t> m_pending_peer_connection;
 
+    /** Checks and decrypts the connection requests on worker threads. */
+    std::unique_ptr<HandshakePipeline> m_handshake_pipeline;
+
     /* Ranking related variables */
     // If updating the base points, update the base points distribution in DB
     const double BASE_RANKING_POINTS   = 4000.0;
@@ -250,6 +268,26 @@ private:
 
     std::atomic<int> m_lobby_players;
 
+    /** Player list last built by updatePlayerList, each entry is the
+     *  encoded player with its host and local player id as key. Clients
+     *  only get changes relative to the version they have. */
+    std::mutex m_player_list_mutex;
+
+    std::vector<std::pair<uint64_t, std::string> > m_player_list;
+
+    uint32_t m_player_list_version;
+
+    bool m_player_list_game_started;
+
+    /** Player list version each peer has, indexed by host id. */
+    std::map<uint32_t, uint32_t> m_peer_player_list_version;
+
+    /** Set when a player list update is delayed to merge it with following
+     *  ones, with the time of the first delayed update. */
+    std::atomic<bool> m_player_list_pending;
+
+    std::atomic<uint64_t> m_player_list_pending_time;
+
     std::atomic<uint64_t> m_last_success_poll_time;
 
     uint64_t m_last_unsuccess_poll_time, m_server_started_at, m_server_delay;
@@ -391,6 +429,11 @@ private:
     // connection management
     void clientDisconnected(Event* event);
     void connectionRequested(Event* event);
+    void acceptConnection(std::shared_ptr<STKPeer> peer,
+                          BareNetworkString& data, unsigned player_count,
+                          uint32_t online_id, uint32_t encrypted_size);
+    void refuseConnection(STKPeer* peer, RejectReason reason,
+                          const char* log) const;
     // kart selection
     void kartSelectionRequested(Event* event);
     // Track(s) votes
@@ -405,6 +448,10 @@ private:
     void unregisterServer(bool now,
         std::weak_ptr<ServerLobby> sl = std::weak_ptr<ServerLobby>());
     void updatePlayerList(bool update_when_reset_server = false);
+    void sendPlayerList(bool update_when_reset_server);
+    NetworkString* getPlayerListDiff(
+        const std::vector<std::pair<uint64_t, std::string> >& player_list);
+    void requestFullPlayerList(Event* event);
     void updateServerOwner();
     void handleServerConfiguration(Event* event);
     void updateTracksForMode();
@@ -453,7 +500,8 @@ private:
                                      const irr::core::stringw& online_name,
                                      bool is_pending_connection,
                                      std::string country_code = "");
-    bool decryptConnectionRequest(std::shared_ptr<STKPeer> peer,
+    std::function<void()> decryptConnectionRequest(
+                                  std::shared_ptr<STKPeer> peer,
                                   BareNetworkString& data,
                                   const std::string& key,
                                   const std::string& iv,
@@ -500,9 +548,13 @@ private:
     void clientInGameWantsToBackLobby(Event* event);
     void clientSelectingAssetsWantsToBackLobby(Event* event);
     void kickPlayerWithReason(STKPeer* peer, const char* reason) const;
-    void testBannedForIP(STKPeer* peer) const;
-    void testBannedForIPv6(STKPeer* peer) const;
-    void testBannedForOnlineId(STKPeer* peer, uint32_t online_id) const;
+    bool testBannedForIP(const STKPeer* peer, std::string* ban_reason,
+                         std::function<void()>* count_trigger) const;
+    bool testBannedForIPv6(const STKPeer* peer, std::string* ban_reason,
+                           std::function<void()>* count_trigger) const;
+    bool testBannedForOnlineId(const STKPeer* peer, uint32_t online_id,
+                               std::string* ban_reason,
+                               std::function<void()>* count_trigger) const;
     void writeDisconnectInfoTable(STKPeer* peer);
     void writePlayerReport(Event* event);
     bool supportsAI();
@@ -531,10 +583,15 @@ private:
 	void rotatePlayerQueue();
     int getPlayerElo(std::string username) const;
 	void init1vs1Ranking();
+    void initSoccerRanking();
+    void finishSoccerRanking();
+    double getSoccerMatchPhase() const;
+    void runRankingScripts();
 	bool teamsBalanced();
     void loadTracksQueueFromConfig();
     void sendGnuStandingsToPeer(std::shared_ptr<STKPeer> peer) const;
     void sendGrandPrixStandingsToPeer(std::shared_ptr<STKPeer> peer) const;
+    void sendTeamStandingsToPeer(std::shared_ptr<STKPeer> peer) const;
     void loadCustomScoring();
     void updateWorldSettings();
     void loadWhiteList();
@@ -565,7 +622,8 @@ public:
     virtual void update(int ticks) OVERRIDE;
     virtual void asynchronousUpdate() OVERRIDE;
 
-    std::pair<std::vector<std::string>, std::vector<std::string>> createBalancedTeams(std::vector<std::pair<std::string, int>>& elo_players);
+    std::pair<std::vector<std::string>, std::vector<std::string>> createBalancedTeams(std::vector<std::pair<std::string, int>>& elo_players,
+        const std::set<std::string>& handicap_players);
     void soccer_ranked_make_teams(std::pair<std::vector<std::string>, std::vector<std::string>> teams, int min);
     void startSelection(const Event *event=NULL);
     void checkIncomingConnectionRequests();
@@ -0,0 +1,444 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/records_index.hpp"
+
+#include "utils/file_utils.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/vs.hpp"
+
+#include <cassert>
+#include <cstdio>
+
+namespace
+{
+    /** Increase if the binary layout changes. */
+    const uint32_t RECORDS_MAGIC   = 0x52544b53; // "STKR"
+    const uint32_t RECORDS_VERSION = 2;
+
+    // ------------------------------------------------------------------------
+    void writeUInt32(std::string* s, uint32_t v)
+    {
+        s->append((const char*)&v, 4);
+    }   // writeUInt32
+    // ------------------------------------------------------------------------
+    void writeInt64(std::string* s, int64_t v)
+    {
+        writeUInt32(s, (uint32_t)((uint64_t)v & 0xffffffff));
+        writeUInt32(s, (uint32_t)((uint64_t)v >> 32));
+    }   // writeInt64
+    // ------------------------------------------------------------------------
+    void writeString(std::string* s, const std::string& str)
+    {
+        writeUInt32(s, (uint32_t)str.size());
+        s->append(str);
+    }   // writeString
+    // ------------------------------------------------------------------------
+    bool readUInt32(FILE* f, uint32_t* v)    { return fread(v, 4, 1, f) == 1; }
+    // ------------------------------------------------------------------------
+    bool readInt64(FILE* f, int64_t* v)
+    {
+        uint32_t low = 0, high = 0;
+        if (!readUInt32(f, &low) || !readUInt32(f, &high))
+            return false;
+        *v = (int64_t)(((uint64_t)high << 32) | low);
+        return true;
+    }   // readInt64
+    // ------------------------------------------------------------------------
+    bool readString(FILE* f, std::string* s)
+    {
+        uint32_t len;
+        if (!readUInt32(f, &len) || len > 65536)
+            return false;
+        s->resize(len);
+        return len == 0 || fread(&(*s)[0], 1, len, f) == len;
+    }   // readString
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+RecordsIndex::RecordsIndex(const std::string& file_prefix)
+            : m_file_prefix(file_prefix)
+{
+    m_stop.store(false);
+    m_write_failed.store(false);
+    clear();
+    if (!m_file_prefix.empty())
+    {
+        m_writer = std::thread([this]()
+            {
+                VS::setThreadName("RecordsIndex");
+                writerLoop();
+            });
+    }
+}   // RecordsIndex
+
+// ----------------------------------------------------------------------------
+/** Finishes writing the pending files before returning.
+ */
+RecordsIndex::~RecordsIndex()
+{
+    if (!m_writer.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_stop.store(true);
+    }
+    m_pending_cv.notify_one();
+    m_writer.join();
+}   // ~RecordsIndex
+
+// ----------------------------------------------------------------------------
+/** Empties the index, the next save writes all shards.
+ */
+void RecordsIndex::clear()
+{
+    m_records.clear();
+    m_dirty_shards.clear();
+    for (unsigned i = 0; i < SHARD_COUNT; i++)
+        m_dirty_shards.insert(i);
+    m_last_rowid = 0;
+    m_num_rows = 0;
+}   // clear
+
+// ----------------------------------------------------------------------------
+/** Adds a result, keeping only the best result of each player. Rows have to
+ *  be added in rowid order, rows already read are ignored.
+ *  \param key Race setting of the result.
+ *  \param username Player who set the result.
+ *  \param result Race time.
+ *  \param rowid Rowid of the result in the results table.
+ */
+void RecordsIndex::addResult(const Key& key, const std::string& username,
+                             double result, int64_t rowid)
+{
+    if (rowid <= m_last_rowid)
+        return;
+    m_last_rowid = rowid;
+    m_num_rows++;
+    insert(key, username, result, rowid);
+}   // addResult
+
+// ----------------------------------------------------------------------------
+/** Counts a row of the results table which can't be indexed (like one with
+ *  an invalid result), so it isn't mistaken for a deleted row.
+ */
+void RecordsIndex::skipRow(int64_t rowid)
+{
+    if (rowid <= m_last_rowid)
+        return;
+    m_last_rowid = rowid;
+    m_num_rows++;
+}   // skipRow
+
+// ----------------------------------------------------------------------------
+void RecordsIndex::insert(const Key& key, const std::string& username,
+                          double result, int64_t rowid)
+{
+    Entry& e = m_records[key];
+    auto it = e.m_user_best.find(username);
+    if (it != e.m_user_best.end())
+    {
+        if (it->second <= std::make_pair(result, rowid))
+            return;
+        e.m_ranking.erase(std::make_tuple(it->second.first,
+            it->second.second, username));
+        it->second = std::make_pair(result, rowid);
+    }
+    else
+        e.m_user_best[username] = std::make_pair(result, rowid);
+    e.m_ranking.insert(std::make_tuple(result, rowid, username));
+    m_dirty_shards.insert(getShard(key.m_venue));
+}   // insert
+
+// ----------------------------------------------------------------------------
+/** Returns the record of a race setting.
+ *  \return False if no result exists for it.
+ */
+bool RecordsIndex::getBest(const Key& key, std::string* username,
+                           double* result) const
+{
+    auto it = m_records.find(key);
+    if (it == m_records.end() || it->second.m_ranking.empty())
+        return false;
+    const auto& best = *it->second.m_ranking.begin();
+    *result = std::get<0>(best);
+    *username = std::get<2>(best);
+    return true;
+}   // getBest
+
+// ----------------------------------------------------------------------------
+/** Returns the best n players with their best result of a race setting.
+ */
+std::vector<std::pair<std::string, double> >
+    RecordsIndex::getTop(const Key& key, unsigned n) const
+{
+    std::vector<std::pair<std::string, double> > top;
+    auto it = m_records.find(key);
+    if (it == m_records.end())
+        return top;
+    for (const auto& r : it->second.m_ranking)
+    {
+        if (top.size() >= n)
+            break;
+        top.emplace_back(std::get<2>(r), std::get<0>(r));
+    }
+    return top;
+}   // getTop
+
+// ----------------------------------------------------------------------------
+unsigned RecordsIndex::getShard(const std::string& venue) const
+{
+    uint32_t hash = 2166136261u;
+    for (char c : venue)
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    return hash % SHARD_COUNT;
+}   // getShard
+
+// ----------------------------------------------------------------------------
+std::string RecordsIndex::getShardFile(unsigned shard) const
+{
+    return m_file_prefix + "." + StringUtils::toString(shard) + ".bin";
+}   // getShardFile
+
+// ----------------------------------------------------------------------------
+/** Loads the manifest and all shards.
+ *  \return False if any file is missing or incompatible, the index is then
+ *          empty and has to be rebuilt from the results table.
+ */
+bool RecordsIndex::load()
+{
+    clear();
+    if (m_file_prefix.empty())
+        return false;
+
+    FILE* f = FileUtils::fopenU8Path(m_file_prefix + ".manifest", "rb");
+    if (!f)
+        return false;
+    uint32_t magic = 0, version = 0, shards = 0;
+    int64_t last_rowid = 0, num_rows = 0;
+    bool ok = readUInt32(f, &magic) && readUInt32(f, &version) &&
+        readUInt32(f, &shards) && readInt64(f, &last_rowid) &&
+        readInt64(f, &num_rows);
+    fclose(f);
+    if (!ok || magic != RECORDS_MAGIC || version != RECORDS_VERSION ||
+        shards != SHARD_COUNT)
+        return false;
+
+    for (unsigned i = 0; i < SHARD_COUNT; i++)
+    {
+        if (!loadShard(i))
+        {
+            Log::warn("RecordsIndex", "Invalid shard %s, rebuilding index.",
+                getShardFile(i).c_str());
+            clear();
+            return false;
+        }
+    }
+    m_last_rowid = last_rowid;
+    m_num_rows = (uint64_t)num_rows;
+    m_dirty_shards.clear();
+    return true;
+}   // load
+
+// ----------------------------------------------------------------------------
+bool RecordsIndex::loadShard(unsigned shard)
+{
+    FILE* f = FileUtils::fopenU8Path(getShardFile(shard), "rb");
+    if (!f)
+        return false;
+    uint32_t magic = 0, version = 0, keys = 0;
+    bool ok = readUInt32(f, &magic) && readUInt32(f, &version) &&
+        readUInt32(f, &keys) && magic == RECORDS_MAGIC &&
+        version == RECORDS_VERSION;
+    for (uint32_t i = 0; ok && i < keys; i++)
+    {
+        Key key;
+        uint32_t laps = 0, users = 0;
+        ok = readString(f, &key.m_venue) && readString(f, &key.m_reverse) &&
+            readString(f, &key.m_mode) && readUInt32(f, &laps) &&
+            readUInt32(f, &users);
+        key.m_laps = (int)laps;
+        for (uint32_t j = 0; ok && j < users; j++)
+        {
+            std::string username;
+            double result;
+            int64_t rowid = 0;
+            ok = readString(f, &username) &&
+                fread(&result, sizeof(double), 1, f) == 1 &&
+                readInt64(f, &rowid);
+            if (ok)
+                insert(key, username, result, rowid);
+        }
+    }
+    fclose(f);
+    return ok;
+}   // loadShard
+
+// ----------------------------------------------------------------------------
+std::string RecordsIndex::serializeShard(unsigned shard) const
+{
+    std::vector<const std::pair<const Key, Entry>*> entries;
+    for (const auto& r : m_records)
+    {
+        if (getShard(r.first.m_venue) == shard)
+            entries.push_back(&r);
+    }
+    std::string data;
+    writeUInt32(&data, RECORDS_MAGIC);
+    writeUInt32(&data, RECORDS_VERSION);
+    writeUInt32(&data, (uint32_t)entries.size());
+    for (auto* e : entries)
+    {
+        writeString(&data, e->first.m_venue);
+        writeString(&data, e->first.m_reverse);
+        writeString(&data, e->first.m_mode);
+        writeUInt32(&data, (uint32_t)e->first.m_laps);
+        writeUInt32(&data, (uint32_t)e->second.m_user_best.size());
+        for (const auto& user : e->second.m_user_best)
+        {
+            writeString(&data, user.first);
+            data.append((const char*)&user.second.first, sizeof(double));
+            writeInt64(&data, user.second.second);
+        }
+    }
+    return data;
+}   // serializeShard
+
+// ----------------------------------------------------------------------------
+/** Hands all shards changed since the last save and the manifest with the
+ *  last rowid to the writer thread, so the caller never waits for the disk.
+ */
+void RecordsIndex::save()
+{
+    if (m_file_prefix.empty())
+        return;
+    if (m_write_failed.exchange(false))
+    {
+        for (unsigned i = 0; i < SHARD_COUNT; i++)
+            m_dirty_shards.insert(i);
+    }
+    std::map<std::string, std::string> shards;
+    for (unsigned shard : m_dirty_shards)
+        shards[getShardFile(shard)] = serializeShard(shard);
+    m_dirty_shards.clear();
+
+    std::string manifest;
+    writeUInt32(&manifest, RECORDS_MAGIC);
+    writeUInt32(&manifest, RECORDS_VERSION);
+    writeUInt32(&manifest, SHARD_COUNT);
+    writeInt64(&manifest, m_last_rowid);
+    writeInt64(&manifest, (int64_t)m_num_rows);
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        for (auto& s : shards)
+            m_pending_shards[s.first].swap(s.second);
+        m_pending_manifest.swap(manifest);
+    }
+    m_pending_cv.notify_one();
+}   // save
+
+// ----------------------------------------------------------------------------
+/** Writes the pending shards, then the manifest, so the manifest never
+ *  refers to rows missing in the shards.
+ */
+void RecordsIndex::writerLoop()
+{
+    while (true)
+    {
+        std::map<std::string, std::string> shards;
+        std::string manifest;
+        {
+            std::unique_lock<std::mutex> lock(m_pending_mutex);
+            m_pending_cv.wait(lock, [this]()
+                { return m_stop.load() || !m_pending_manifest.empty(); });
+            if (m_pending_manifest.empty())
+                return;
+            shards.swap(m_pending_shards);
+            manifest.swap(m_pending_manifest);
+        }
+        std::string manifest_file = m_file_prefix + ".manifest";
+        bool ok = true;
+        for (const auto& s : shards)
+        {
+            if (!FileUtils::writeFileAtomic(s.first, s.second))
+            {
+                Log::error("RecordsIndex", "Cannot write %s.",
+                    s.first.c_str());
+                ok = false;
+                break;
+            }
+        }
+        if (ok && !FileUtils::writeFileAtomic(manifest_file, manifest))
+        {
+            Log::error("RecordsIndex", "Cannot write %s.",
+                manifest_file.c_str());
+            ok = false;
+        }
+        if (!ok)
+        {
+            // Without a manifest the index is rebuilt on the next start
+            remove(FileUtils::getPortableWritingPath(manifest_file).c_str());
+            m_write_failed.store(true);
+        }
+    }
+}   // writerLoop
+
+// ----------------------------------------------------------------------------
+void RecordsIndex::unitTesting()
+{
+    RecordsIndex index("");
+    Key k1("lighthouse", "normal", "normal", 3);
+    Key k2("lighthouse", "reverse", "normal", 3);
+    std::string user;
+    double result = 0.0;
+    bool found = index.getBest(k1, &user, &result);
+    assert(!found);
+
+    index.addResult(k1, "alice", 60.5, 1);
+    index.addResult(k1, "bob", 58.0, 2);
+    index.addResult(k1, "alice", 59.0, 3);
+    index.addResult(k1, "alice", 70.0, 4);
+    index.addResult(k2, "carol", 40.0, 5);
+    // A tie keeps the earlier result first, like the results table
+    index.addResult(k1, "aaron", 58.0, 6);
+    index.skipRow(7);
+    assert(index.getLastRowId() == 7);
+    assert(index.getNumRows() == 7);
+    assert(index.getNumKeys() == 2);
+
+    found = index.getBest(k1, &user, &result);
+    assert(found && user == "bob" && result == 58.0);
+    auto top = index.getTop(k1, 5);
+    assert(top.size() == 3);
+    assert(top[0].first == "bob" && top[1].first == "aaron");
+    assert(top[2].first == "alice" && top[2].second == 59.0);
+    assert(index.getTop(k1, 1).size() == 1);
+
+    // Rows already read must not change anything
+    index.addResult(k1, "alice", 50.0, 3);
+    assert(index.getNumRows() == 7);
+    found = index.getBest(k1, &user, &result);
+    assert(found && user == "bob");
+    found = index.getBest(k2, &user, &result);
+    assert(found && user == "carol");
+
+    index.clear();
+    assert(index.getNumRows() == 0 && index.getNumKeys() == 0);
+    (void)found;
+}   // unitTesting
@@ -0,0 +1,166 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_RECORDS_INDEX_HPP
+#define HEADER_RECORDS_INDEX_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/** \ingroup network
+ *  In-memory index of the best result of each player for each race setting
+ *  (venue, direction, mode, laps) of a results table. It is filled
+ *  incrementally from the table using its rowid, so the best results and
+ *  top N of a race setting are found in O(log n) without scanning the
+ *  table. The index is persisted in binary shard files (one per group of
+ *  venues) plus a manifest holding the last rowid read, only changed
+ *  shards are rewritten by a writer thread. Adding a result is idempotent,
+ *  so after a crash re-reading rows which were already indexed is harmless.
+ *  The index also counts the rows read, so the caller can find out if rows
+ *  were deleted from the table and rebuild it.
+ */
+class RecordsIndex : public NoCopy
+{
+public:
+    struct Key
+    {
+        std::string m_venue;
+        std::string m_reverse;
+        std::string m_mode;
+        int         m_laps;
+        // --------------------------------------------------------------------
+        Key(const std::string& venue = "", const std::string& reverse = "",
+            const std::string& mode = "", int laps = 0)
+            : m_venue(venue), m_reverse(reverse), m_mode(mode), m_laps(laps)
+        {
+        }
+        // --------------------------------------------------------------------
+        bool operator<(const Key& other) const
+        {
+            if (m_venue != other.m_venue)
+                return m_venue < other.m_venue;
+            if (m_reverse != other.m_reverse)
+                return m_reverse < other.m_reverse;
+            if (m_mode != other.m_mode)
+                return m_mode < other.m_mode;
+            return m_laps < other.m_laps;
+        }
+    };
+
+private:
+    struct Entry
+    {
+        /** Best result of each player with the rowid of its row. */
+        std::map<std::string, std::pair<double, int64_t> > m_user_best;
+
+        /** All best results ordered by time, then rowid, so like in the
+         *  table the earliest result wins a tie. */
+        std::set<std::tuple<double, int64_t, std::string> > m_ranking;
+    };
+
+    static const unsigned SHARD_COUNT = 16;
+
+    std::map<Key, Entry> m_records;
+
+    /** Largest rowid of the results table included in the index. */
+    int64_t m_last_rowid;
+
+    /** Number of rows of the results table included in the index. */
+    uint64_t m_num_rows;
+
+    /** Shards changed since the last save. */
+    std::set<unsigned> m_dirty_shards;
+
+    /** Path prefix for the shard files and manifest, empty to disable
+     *  persistence. */
+    std::string m_file_prefix;
+
+    /** Shard files and manifest waiting for the writer thread, newer data
+     *  of a file replaces older one. */
+    std::map<std::string, std::string> m_pending_shards;
+
+    std::string m_pending_manifest;
+
+    std::mutex m_pending_mutex;
+
+    std::condition_variable m_pending_cv;
+
+    std::atomic_bool m_stop;
+
+    /** Set by the writer thread if a file can't be written, the next save
+     *  then writes all shards again. */
+    std::atomic_bool m_write_failed;
+
+    std::thread m_writer;
+
+    unsigned getShard(const std::string& venue) const;
+    std::string getShardFile(unsigned shard) const;
+    bool loadShard(unsigned shard);
+    std::string serializeShard(unsigned shard) const;
+    void insert(const Key& key, const std::string& username, double result,
+                int64_t rowid);
+    void writerLoop();
+
+public:
+    RecordsIndex(const std::string& file_prefix);
+    // ------------------------------------------------------------------------
+    ~RecordsIndex();
+    // ------------------------------------------------------------------------
+    bool load();
+    // ------------------------------------------------------------------------
+    void save();
+    // ------------------------------------------------------------------------
+    void clear();
+    // ------------------------------------------------------------------------
+    void addResult(const Key& key, const std::string& username, double result,
+                   int64_t rowid);
+    // ------------------------------------------------------------------------
+    void skipRow(int64_t rowid);
+    // ------------------------------------------------------------------------
+    bool getBest(const Key& key, std::string* username,
+                 double* result) const;
+    // ------------------------------------------------------------------------
+    std::vector<std::pair<std::string, double> > getTop(const Key& key,
+                                                        unsigned n) const;
+    // ------------------------------------------------------------------------
+    /** Returns the largest rowid included in the index, new rows of the
+     *  results table have to be read after it. */
+    int64_t getLastRowId() const                       { return m_last_rowid; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of rows up to the last rowid which were read, if
+     *  the table has less of them some were deleted. */
+    uint64_t getNumRows() const                          { return m_num_rows; }
+    // ------------------------------------------------------------------------
+    size_t getNumKeys() const                     { return m_records.size(); }
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class RecordsIndex
+
+#endif
@@ -114,6 +114,10 @@ public:
     /** Returns a pointer to the state buffer. */
     BareNetworkString *getBuffer() const { return m_buffer; }
     // ------------------------------------------------------------------------
+    /** Returns the unique identities of the rewinders in this state. */
+    const std::vector<std::string>& getRewinderUsing() const
+                                                  { return m_rewinder_using; }
+    // ------------------------------------------------------------------------
     virtual bool isState() const { return true; }
     // ------------------------------------------------------------------------
     /** Called when going back in time to undo any rewind information.
@@ -174,6 +178,9 @@ public:
     // ------------------------------------------------------------------------
     /** Returns the buffer with the event information in it. */
     BareNetworkString *getBuffer() { return m_buffer; }
+    // ------------------------------------------------------------------------
+    /** Returns the event rewinder responsible for this event. */
+    EventRewinder *getEventRewinder() const { return m_event_rewinder; }
 };   // class RewindIndoEvent
 
 
@@ -0,0 +1,449 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/rewind_islands.hpp"
+
+#include "config/stk_config.hpp"
+#include "items/attachment.hpp"
+#include "items/powerup.hpp"
+#include "karts/kart_properties.hpp"
+#include "karts/kart_rewinder.hpp"
+#include "modes/world.hpp"
+#include "network/network_string.hpp"
+#include "physics/physics.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    /** Differences between the predicted and the server state of a kart
+     *  which are still considered a correct prediction. */
+    const float MAX_POSITION_ERROR = 0.05f;
+    const float MAX_VELOCITY_ERROR = 0.25f;
+
+    // ------------------------------------------------------------------------
+    int findRoot(std::vector<int>* parent, int i)
+    {
+        while ((*parent)[i] != i)
+        {
+            (*parent)[i] = (*parent)[(*parent)[i]];
+            i = (*parent)[i];
+        }
+        return i;
+    }   // findRoot
+}   // namespace
+
+// ============================================================================
+RewindIslands::RewindIslands()
+{
+    reset();
+}   // RewindIslands
+
+// ----------------------------------------------------------------------------
+RewindIslands::~RewindIslands()
+{
+}   // ~RewindIslands
+
+// ----------------------------------------------------------------------------
+void RewindIslands::reset()
+{
+    m_interactions.clear();
+    m_predictions.clear();
+    m_snapshots.clear();
+    m_frozen.clear();
+    m_num_frozen = 0;
+    m_contactless_hit = false;
+}   // reset
+
+// ----------------------------------------------------------------------------
+/** Records that two karts touched each other in the specified time step.
+ *  \param other Id of the other kart, or -1 if the kart touched a shared
+ *         object (item, physical object, animation).
+ */
+void RewindIslands::addInteraction(int ticks, int kart, int other)
+{
+    m_interactions[ticks].m_pairs.emplace_back((uint8_t)kart,
+        other == -1 ? SHARED_OBJECTS : (uint8_t)other);
+}   // addInteraction
+
+// ----------------------------------------------------------------------------
+/** Records that something happened in this time step which can change karts
+ *  without a contact, no kart is frozen in a rewind over this time step.
+ */
+void RewindIslands::addUnknownInteraction(int ticks)
+{
+    m_interactions[ticks].m_unknown = true;
+}   // addUnknownInteraction
+
+// ----------------------------------------------------------------------------
+RewindIslands::Prediction RewindIslands::getPrediction(const AbstractKart* k)
+{
+    Prediction p;
+    p.m_xyz           = k->getXYZ();
+    p.m_velocity      = k->getVelocity();
+    p.m_powerup       = (int)k->getPowerup()->getType();
+    p.m_powerup_count = k->getPowerup()->getNum();
+    p.m_attachment    = (int)k->getAttachment()->getType();
+    p.m_animation     = k->getKartAnimation() != NULL;
+    p.m_eliminated    = k->isEliminated();
+    return p;
+}   // getPrediction
+
+// ----------------------------------------------------------------------------
+/** Saves the state of all karts at a state time step, it is compared with
+ *  the server state for this time step later. In a rewind the predictions
+ *  of frozen karts are kept, the karts are not simulated again.
+ */
+void RewindIslands::savePredictions(int ticks)
+{
+    World* world = World::getWorld();
+    std::vector<Prediction>& all = m_predictions[ticks];
+    const bool keep_frozen = all.size() == world->getNumKarts();
+    all.resize(world->getNumKarts());
+    for (unsigned i = 0; i < world->getNumKarts(); i++)
+    {
+        if (keep_frozen && isFrozen(i))
+            continue;
+        all[i] = getPrediction(world->getKart(i));
+    }
+}   // savePredictions
+
+// ----------------------------------------------------------------------------
+bool RewindIslands::isMispredicted(const Prediction& p,
+                                   const AbstractKart* kart)
+{
+    const Prediction s = getPrediction(kart);
+    return p.m_eliminated != s.m_eliminated ||
+           p.m_animation != s.m_animation ||
+           p.m_powerup != s.m_powerup ||
+           p.m_powerup_count != s.m_powerup_count ||
+           p.m_attachment != s.m_attachment ||
+           (p.m_xyz - s.m_xyz).length2() >
+               MAX_POSITION_ERROR * MAX_POSITION_ERROR ||
+           (p.m_velocity - s.m_velocity).length2() >
+               MAX_VELOCITY_ERROR * MAX_VELOCITY_ERROR;
+}   // isMispredicted
+
+// ----------------------------------------------------------------------------
+/** Returns if a kart can be kept out of a rewind. Karts in an animation
+ *  are moved by it and not by the physics.
+ */
+bool RewindIslands::canFreeze(const AbstractKart* kart)
+{
+    return !kart->isEliminated() && kart->getKartAnimation() == NULL;
+}   // canFreeze
+
+// ----------------------------------------------------------------------------
+/** Saves the state of all karts before a rewind, so that frozen karts can
+ *  get it back after the server state was restored. The karts are not
+ *  changed: the values saveState rounds are put back right away.
+ */
+void RewindIslands::saveCurrentState()
+{
+    m_snapshots.clear();
+    m_contactless_hit = false;
+    World* world = World::getWorld();
+    for (unsigned i = 0; i < world->getNumKarts(); i++)
+    {
+        const Attachment::AttachmentType a =
+            world->getKart(i)->getAttachment()->getType();
+        // Swatters and bombs hit other karts without a contact
+        if (a == Attachment::ATTACH_BOMB || a == Attachment::ATTACH_SWATTER ||
+            a == Attachment::ATTACH_NOLOKS_SWATTER ||
+            a == Attachment::ATTACH_SWATTER_ANIM)
+            m_contactless_hit = true;
+    }
+
+    m_snapshots.resize(world->getNumKarts());
+    for (unsigned i = 0; i < world->getNumKarts(); i++)
+    {
+        Snapshot& s = m_snapshots[i];
+        s.m_kart = dynamic_cast<KartRewinder*>(world->getKart(i));
+        if (!s.m_kart || !canFreeze(s.m_kart))
+        {
+            s.m_kart = NULL;
+            continue;
+        }
+        s.m_exact_state = s.m_kart->getExactStateRestoreFunction();
+        std::vector<std::string> ru;
+        s.m_state.reset(s.m_kart->saveState(&ru));
+        if (!s.m_state)
+        {
+            s.m_kart = NULL;
+            continue;
+        }
+        s.m_exact_state();
+        s.m_local_state = s.m_kart->getLocalStateRestoreFunction();
+        s.m_xyz = s.m_kart->getXYZ();
+        s.m_speed = s.m_kart->getVelocity().length();
+    }
+}   // saveCurrentState
+
+// ----------------------------------------------------------------------------
+void RewindIslands::restoreSnapshot(Snapshot* s)
+{
+    s->m_state->reset();
+    s->m_kart->restoreState(s->m_state.get(), s->m_state->size());
+    if (s->m_local_state)
+        s->m_local_state();
+    s->m_exact_state();
+}   // restoreSnapshot
+
+// ----------------------------------------------------------------------------
+/** Gives a kart back its state from before the rewind and removes it from
+ *  the physics.
+ */
+void RewindIslands::freeze(unsigned kart_id)
+{
+    restoreSnapshot(&m_snapshots[kart_id]);
+    Physics::get()->removeKart(m_snapshots[kart_id].m_kart);
+    m_frozen[kart_id] = true;
+    m_num_frozen++;
+}   // freeze
+
+// ----------------------------------------------------------------------------
+/** Called after the server state was restored, before freezeUnaffected.
+ *  Freezes the karts which are not in the server state.
+ *  \param in_state Unique identities of the rewinders in the server state.
+ *  \return Number of frozen karts.
+ */
+unsigned RewindIslands::freezeMissing(const std::set<std::string>& in_state)
+{
+    const unsigned num_karts = World::getWorld()->getNumKarts();
+    m_frozen.assign(num_karts, false);
+    m_num_frozen = 0;
+    if (m_snapshots.size() != num_karts)
+        return 0;
+    for (unsigned i = 0; i < num_karts; i++)
+    {
+        const KartRewinder* kart = m_snapshots[i].m_kart;
+        if (kart &&
+            in_state.find(kart->getUniqueIdentity()) == in_state.end())
+            freeze(i);
+    }
+    return m_num_frozen;
+}   // freezeMissing
+
+// ----------------------------------------------------------------------------
+/** Marks all karts connected to an affected kart by one of the interaction
+ *  pairs as affected. Every kart which touched a shared object is affected,
+ *  the shared objects are always restored and simulated again.
+ *  \param pairs The interactions of the rewind window.
+ *  \param affected On input the seeds, on output all affected karts.
+ */
+void RewindIslands::findAffected(
+                      const std::vector<std::pair<uint8_t, uint8_t> >& pairs,
+                      std::vector<bool>* affected)
+{
+    const int shared = (int)affected->size();
+    std::vector<int> parent(shared + 1);
+    std::iota(parent.begin(), parent.end(), 0);
+    for (auto& p : pairs)
+    {
+        int a = p.first;
+        int b = p.second == SHARED_OBJECTS ? shared : p.second;
+        if (a >= shared || b > shared)
+            continue;
+        a = findRoot(&parent, a);
+        b = findRoot(&parent, b);
+        if (a != b)
+            parent[a] = b;
+    }
+
+    std::vector<bool> affected_root(shared + 1, false);
+    affected_root[findRoot(&parent, shared)] = true;
+    for (int i = 0; i < shared; i++)
+    {
+        if ((*affected)[i])
+            affected_root[findRoot(&parent, i)] = true;
+    }
+    for (int i = 0; i < shared; i++)
+    {
+        if (affected_root[findRoot(&parent, i)])
+            (*affected)[i] = true;
+    }
+}   // findAffected
+
+// ----------------------------------------------------------------------------
+/** Called after the server state was restored. Finds the karts not affected
+ *  by a misprediction, gives them back their state from before the rewind
+ *  and removes them from the physics.
+ *  \param exact_ticks Time of the restored server state.
+ *  \param now_ticks Time the rewind simulates to.
+ *  \param seeds Karts which received network input in the rewind window.
+ *  \return Number of karts frozen in addition to the ones missing in the
+ *          server state, 0 if all others must be simulated.
+ */
+unsigned RewindIslands::freezeUnaffected(int exact_ticks, int now_ticks,
+                                         const std::set<int>& seeds)
+{
+    World* world = World::getWorld();
+    const unsigned num_karts = world->getNumKarts();
+
+    auto prediction = m_predictions.find(exact_ticks);
+    if (m_snapshots.size() != num_karts || prediction == m_predictions.end()
+        || prediction->second.size() != num_karts || m_contactless_hit ||
+        m_frozen.size() != num_karts)
+        return 0;
+
+    std::vector<std::pair<uint8_t, uint8_t> > pairs;
+    for (auto it = m_interactions.lower_bound(exact_ticks);
+         it != m_interactions.end() && it->first < now_ticks; it++)
+    {
+        if (it->second.m_unknown)
+            return 0;
+        pairs.insert(pairs.end(), it->second.m_pairs.begin(),
+                     it->second.m_pairs.end());
+    }
+
+    std::vector<bool> affected(num_karts, false);
+    for (unsigned i = 0; i < num_karts; i++)
+    {
+        const KartRewinder* kart = m_snapshots[i].m_kart;
+        if (m_frozen[i])
+            continue;
+        if (seeds.find(i) != seeds.end() || !kart || !canFreeze(kart) ||
+            !kart->hasServerState() ||
+            isMispredicted(prediction->second[i], kart))
+            affected[i] = true;
+    }
+    findAffected(pairs, &affected);
+
+    // Karts not connected by contacts can still influence each other if they
+    // come close (slipstream, and contacts in the new simulation)
+    const float window = stk_config->ticks2Time(now_ticks - exact_ticks);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (unsigned i = 0; i < num_karts; i++)
+        {
+            if (affected[i] || m_frozen[i])
+                continue;
+            const AbstractKart* ki = world->getKart(i);
+            const float speed_i = std::max(m_snapshots[i].m_speed,
+                                           ki->getVelocity().length());
+            for (unsigned j = 0; j < num_karts; j++)
+            {
+                const AbstractKart* kj = world->getKart(j);
+                if (!affected[j] || kj->isEliminated())
+                    continue;
+                float speed_j = kj->getVelocity().length();
+                Vec3 now_j = kj->getXYZ();
+                if (m_snapshots[j].m_kart)
+                {
+                    speed_j = std::max(speed_j, m_snapshots[j].m_speed);
+                    now_j = m_snapshots[j].m_xyz;
+                }
+                const float reach = (speed_i + speed_j) * window +
+                    std::max(ki->getKartProperties()->getSlipstreamLength(),
+                             kj->getKartProperties()->getSlipstreamLength()) +
+                    ki->getKartLength() + kj->getKartLength();
+                const float d2 = std::min(
+                    std::min((ki->getXYZ() - kj->getXYZ()).length2(),
+                             (ki->getXYZ() - now_j).length2()),
+                    std::min((m_snapshots[i].m_xyz - kj->getXYZ()).length2(),
+                             (m_snapshots[i].m_xyz - now_j).length2()));
+                if (d2 < reach * reach)
+                {
+                    affected[i] = true;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    const unsigned frozen_missing = m_num_frozen;
+    for (unsigned i = 0; i < num_karts; i++)
+    {
+        if (!affected[i] && !m_frozen[i])
+            freeze(i);
+    }
+    return m_num_frozen - frozen_missing;
+}   // freezeUnaffected
+
+// ----------------------------------------------------------------------------
+/** Called at the end of a rewind. Restores the frozen karts again (the
+ *  replayed events can have changed their controls) and adds them back to
+ *  the physics.
+ */
+void RewindIslands::unfreeze()
+{
+    for (unsigned i = 0; i < m_frozen.size(); i++)
+    {
+        if (!m_frozen[i])
+            continue;
+        restoreSnapshot(&m_snapshots[i]);
+        Physics::get()->addKart(m_snapshots[i].m_kart);
+    }
+    m_frozen.clear();
+    m_num_frozen = 0;
+    m_snapshots.clear();
+}   // unfreeze
+
+// ----------------------------------------------------------------------------
+/** Drops the data before the server state a rewind starts with, and all
+ *  interactions after it, they are recorded again while simulating. If the
+ *  rewind does not simulate the physics the interactions are unknown.
+ */
+void RewindIslands::startRewind(int exact_ticks, int now_ticks,
+                                bool fast_forward)
+{
+    m_interactions.clear();
+    if (fast_forward)
+    {
+        for (int t = exact_ticks; t < now_ticks; t++)
+            addUnknownInteraction(t);
+    }
+    m_predictions.erase(m_predictions.begin(),
+                        m_predictions.lower_bound(exact_ticks));
+}   // startRewind
+
+// ----------------------------------------------------------------------------
+void RewindIslands::unitTesting()
+{
+    // Karts 0-1-2 are connected, 3 and 4 touched, 5 touched an item
+    std::vector<std::pair<uint8_t, uint8_t> > pairs =
+    {
+        { 0, 1 }, { 2, 1 }, { 3, 4 }, { 5, SHARED_OBJECTS }, { 9, 0 }
+    };
+    std::vector<bool> affected(7, false);
+    affected[2] = true;
+    findAffected(pairs, &affected);
+    assert(affected[0] && affected[1] && affected[2]);
+    assert(!affected[3] && !affected[4]);
+    assert(affected[5]);
+    assert(!affected[6]);
+
+    std::fill(affected.begin(), affected.end(), false);
+    affected[4] = true;
+    findAffected(pairs, &affected);
+    assert(!affected[0] && !affected[1] && !affected[2]);
+    assert(affected[3] && affected[4] && affected[5]);
+    assert(!affected[6]);
+
+    // Without seeds only the shared objects are affected
+    std::fill(affected.begin(), affected.end(), false);
+    findAffected(std::vector<std::pair<uint8_t, uint8_t> >(), &affected);
+    assert(std::count(affected.begin(), affected.end(), true) == 0);
+    findAffected(pairs, &affected);
+    assert(std::count(affected.begin(), affected.end(), true) == 1);
+    assert(affected[5]);
+}   // unitTesting
@@ -0,0 +1,165 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_REWIND_ISLANDS_HPP
+#define HEADER_REWIND_ISLANDS_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/vec3.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class AbstractKart;
+class BareNetworkString;
+class KartRewinder;
+
+/** \ingroup network
+ *  Finds the karts a client does not need to re-simulate in a rewind.
+ *  During each world update the interactions of the karts are recorded:
+ *  the kart-kart contact pairs from the physics, and the contacts with
+ *  shared objects (items, physical objects, 3d animations). Anything whose
+ *  effect on the karts is not known from contacts (flyables in flight,
+ *  powerups being used) marks the time step as unknown.
+ *  When a server state arrives, the karts which were mispredicted (their
+ *  restored state differs from the prediction saved at that time) or which
+ *  received input from the network in the rewind window are the seeds. All
+ *  karts connected to a seed or to a shared object by contacts in the
+ *  window, or which could have come close to such a kart, are re-simulated.
+ *  The remaining karts are frozen: they keep the state they had before the
+ *  rewind, and are neither updated nor part of the physics while the
+ *  rewind re-simulates the other karts.
+ *  A frozen kart which was mispredicted in fact will be caught by the
+ *  comparison with the next server state, so a wrong guess only delays the
+ *  correction.
+ *  Karts the server left out of its state (see InterestManager) are always
+ *  frozen: without a server state for the rewind time, simulating them again
+ *  would start from their current state and move them too far.
+ */
+class RewindIslands : public NoCopy
+{
+public:
+    /** Pseudo kart id for the shared objects in the interactions. */
+    static const uint8_t SHARED_OBJECTS = 0xff;
+
+private:
+    /** All interactions of one time step. */
+    struct Interactions
+    {
+        /** Kart id pairs, the second one can be SHARED_OBJECTS. */
+        std::vector<std::pair<uint8_t, uint8_t> > m_pairs;
+        /** Set if something not tracked by contacts happened. */
+        bool m_unknown;
+        Interactions() : m_unknown(false) {}
+    };
+    std::map<int, Interactions> m_interactions;
+
+    /** The part of a kart state compared with the server state to detect
+     *  mispredictions. */
+    struct Prediction
+    {
+        Vec3 m_xyz;
+        Vec3 m_velocity;
+        int  m_powerup;
+        int  m_powerup_count;
+        int  m_attachment;
+        bool m_animation;
+        bool m_eliminated;
+    };
+    /** Predictions of all karts for each state time step. */
+    std::map<int, std::vector<Prediction> > m_predictions;
+
+    /** State of a kart before the rewind, restored if it is frozen. */
+    struct Snapshot
+    {
+        KartRewinder* m_kart;
+        std::unique_ptr<BareNetworkString> m_state;
+        std::function<void()> m_local_state;
+        /** Puts back the values rounded in m_state. */
+        std::function<void()> m_exact_state;
+        Vec3 m_xyz;
+        float m_speed;
+    };
+    std::vector<Snapshot> m_snapshots;
+
+    /** Indexed by world kart id, true if the kart is frozen. */
+    std::vector<bool> m_frozen;
+
+    unsigned m_num_frozen;
+
+    /** True if a kart had an attachment which hits other karts without a
+     *  contact when the snapshots were saved. */
+    bool m_contactless_hit;
+
+    // ------------------------------------------------------------------------
+    static Prediction getPrediction(const AbstractKart* kart);
+    // ------------------------------------------------------------------------
+    static bool isMispredicted(const Prediction& p, const AbstractKart* kart);
+    // ------------------------------------------------------------------------
+    static bool canFreeze(const AbstractKart* kart);
+    // ------------------------------------------------------------------------
+    void restoreSnapshot(Snapshot* s);
+    // ------------------------------------------------------------------------
+    void freeze(unsigned kart_id);
+
+public:
+    RewindIslands();
+    // ------------------------------------------------------------------------
+    ~RewindIslands();
+    // ------------------------------------------------------------------------
+    void reset();
+    // ------------------------------------------------------------------------
+    void addInteraction(int ticks, int kart, int other);
+    // ------------------------------------------------------------------------
+    void addUnknownInteraction(int ticks);
+    // ------------------------------------------------------------------------
+    void savePredictions(int ticks);
+    // ------------------------------------------------------------------------
+    void saveCurrentState();
+    // ------------------------------------------------------------------------
+    void startRewind(int exact_ticks, int now_ticks, bool fast_forward);
+    // ------------------------------------------------------------------------
+    unsigned freezeMissing(const std::set<std::string>& in_state);
+    // ------------------------------------------------------------------------
+    unsigned freezeUnaffected(int exact_ticks, int now_ticks,
+                              const std::set<int>& seeds);
+    // ------------------------------------------------------------------------
+    void unfreeze();
+    // ------------------------------------------------------------------------
+    static void findAffected(
+                     const std::vector<std::pair<uint8_t, uint8_t> >& pairs,
+                     std::vector<bool>* affected);
+    // ------------------------------------------------------------------------
+    /** Returns true if the kart is not updated in the current rewind. */
+    bool isFrozen(unsigned kart_id) const
+    {
+        return m_num_frozen > 0 && kart_id < m_frozen.size() &&
+               m_frozen[kart_id];
+    }   // isFrozen
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class RewindIslands
+
+#endif
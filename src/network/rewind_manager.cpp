@@ -18,7 +18,10 @@
 
 #include "network/rewind_manager.hpp"
 
+#include "config/user_config.hpp"
 #include "graphics/irr_driver.hpp"
+#include "karts/abstract_kart.hpp"
+#include "karts/controller/controller.hpp"
 #include "modes/world.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
@@ -28,13 +31,16 @@
 #include "network/smooth_network_body.hpp"
 #include "physics/physics.hpp"
 #include "race/history.hpp"
+#include "race/race_manager.hpp"
 #include "tracks/check_manager.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_object_manager.hpp"
 #include "utils/log.hpp"
 #include "utils/profiler.hpp"
+#include "utils/time.hpp"
 
 #include <algorithm>
+#include <chrono>
 
 RewindManager* RewindManager::m_rewind_manager[PT_COUNT];
 std::atomic_bool RewindManager::m_enable_rewind_manager(false);
@@ -63,6 +69,13 @@ void RewindManager::destroy()
  */
 RewindManager::RewindManager()
 {
+    m_full_rewinds = 0;
+    m_partial_rewinds = 0;
+    m_rewound_ticks = 0;
+    m_rewound_kart_ticks = 0;
+    m_frozen_kart_ticks = 0;
+    m_rewind_time_us = 0;
+    m_last_rewind_report = StkTime::getMonoTimeMs();
     reset();
 }   // RewindManager
 
@@ -87,6 +100,8 @@ void RewindManager::reset()
     m_overall_state_size = 0;
     m_state_frequency = stk_config->getPhysicsFPS() /
         NetworkConfig::get()->getStateFrequency();
+    m_islands.reset();
+    reportRewindCost(/*force*/true);
 
     if (!m_enable_rewind_manager) return;
 
@@ -165,16 +180,24 @@ void RewindManager::saveState()
         // TODO: check if it's worth passing in a sufficiently large buffer from
         // GameProtocol - this would save the copy operation.
         BareNetworkString* buffer = NULL;
+        auto start_time = std::chrono::steady_clock::now();
         if (auto r = p.second.lock())
             buffer = r->saveState(&rewinder_using);
         if (buffer != NULL)
         {
+            StateCost& cost = m_state_cost[p.first[0]];
+            cost.m_states++;
+            cost.m_bytes += buffer->size();
+            cost.m_encode_us +=
+                std::chrono::duration_cast<std::chrono::microseconds>
+                (std::chrono::steady_clock::now() - start_time).count();
             m_overall_state_size += buffer->size();
-            gp->addState(buffer);
+            gp->addState(p.first, buffer);
         }
         delete buffer;    // buffer can be freed
     }
     gp->finalizeState(rewinder_using);
+    reportRewindCost(/*force*/false);
     PROFILER_POP_CPU_MARKER();
 }   // saveState
 
@@ -187,10 +210,17 @@ void RewindManager::update(int ticks_not_used)
 {
     // FIXME: rename ticks_not_used
     if (!m_enable_rewind_manager ||
-        m_all_rewinder.size() == 0 ||
-        m_is_rewinding)  return;
+        m_all_rewinder.size() == 0)  return;
 
     int ticks = World::getWorld()->getTicksSinceStart();
+    if (m_is_rewinding)
+    {
+        // The kart states are compared with the server state for partial
+        // rewinds, they change when simulating again
+        if (shouldSaveState(ticks) && NetworkConfig::get()->isClient())
+            m_islands.savePredictions(ticks);
+        return;
+    }
 
     m_not_rewound_ticks.store(ticks, std::memory_order_relaxed);
 
@@ -207,6 +237,7 @@ void RewindManager::update(int ticks_not_used)
             if (auto r = p.second.lock())
                 ret.push_back(r->getLocalStateRestoreFunction());
         }
+        m_islands.savePredictions(ticks);
     }
     else
     {
@@ -294,6 +325,17 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks,
     assert(!m_is_rewinding);
     bool is_history = history->replayHistory();
     history->setReplayHistory(false);
+    auto start_time = std::chrono::steady_clock::now();
+
+    // Keep the current kart states, the karts which are not in the server
+    // state or not affected by a misprediction get them back after
+    // restoring the server state
+    const bool partial = canRewindPartially(fast_forward);
+    std::set<std::string> in_state;
+    m_rewind_queue.getRewindersInState(rewind_ticks, &in_state);
+    const bool missing_karts = !fast_forward && isKartMissing(in_state);
+    if (partial || missing_karts)
+        m_islands.saveCurrentState();
 
     // First save all current transforms so that the error
     // can be computed between the transforms before and after
@@ -311,6 +353,10 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks,
     // This will go back till the first confirmed state is found before
     // the specified rewind ticks.
     int exact_rewind_ticks = m_rewind_queue.undoUntil(rewind_ticks);
+    bool unknown_events = false;
+    std::set<int> seeds;
+    if (partial)
+        seeds = getKartsWithNetworkEvents(now_ticks, &unknown_events);
 
     // Rewind the required state(s)
     // ----------------------------
@@ -359,6 +405,16 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks,
         current = m_rewind_queue.getCurrent();
     }
 
+    unsigned frozen_karts = 0;
+    if (partial || missing_karts)
+        frozen_karts = m_islands.freezeMissing(in_state);
+    if (partial && !unknown_events)
+    {
+        frozen_karts += m_islands.freezeUnaffected(exact_rewind_ticks,
+                                                   now_ticks, seeds);
+    }
+    m_islands.startRewind(exact_rewind_ticks, now_ticks, fast_forward);
+
     // Update check line, so the cannon animation can be replayed correctly
     Track::getCurrentTrack()->getCheckManager()->resetAfterRewind();
 
@@ -391,6 +447,7 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks,
         world->updateTime(1);
 
     }   // while (world->getTicks() < current_ticks)
+    m_islands.unfreeze();
 
     // Now compute the errors which need to be visually smoothed
     for (auto& p : m_all_rewinder)
@@ -402,8 +459,176 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks,
     history->setReplayHistory(is_history);
     m_is_rewinding = false;
     mergeRewindInfoEventFunction();
+
+    const uint64_t rewound_ticks = now_ticks - exact_rewind_ticks;
+    if (frozen_karts > 0)
+        m_partial_rewinds++;
+    else
+        m_full_rewinds++;
+    m_rewound_ticks += rewound_ticks;
+    m_rewound_kart_ticks +=
+        rewound_ticks * (world->getNumKarts() - frozen_karts);
+    m_frozen_kart_ticks += rewound_ticks * frozen_karts;
+    m_rewind_time_us += std::chrono::duration_cast<std::chrono::microseconds>
+        (std::chrono::steady_clock::now() - start_time).count();
+    reportRewindCost(/*force*/false);
 }   // rewindTo
 
+// ----------------------------------------------------------------------------
+/** Partial rewinds are only done for races, in battle modes and soccer the
+ *  karts interact through the flags, the ball and the scores.
+ */
+bool RewindManager::canRewindPartially(bool fast_forward) const
+{
+    return !fast_forward && UserConfigParams::m_partial_rewind &&
+        RaceManager::get()->isLinearRaceMode();
+}   // canRewindPartially
+
+// ----------------------------------------------------------------------------
+/** Returns the karts which got input from other players in the rewind
+ *  window: their earlier prediction used the old input.
+ *  \param now_ticks Time the rewind simulates to.
+ *  \param unknown Set to true if there are other events in the window.
+ */
+std::set<int> RewindManager::getKartsWithNetworkEvents(int now_ticks,
+                                                       bool* unknown)
+{
+    std::set<int> karts;
+    std::vector<RewindInfo*> infos;
+    m_rewind_queue.getInfoAfterCurrent(now_ticks, &infos);
+    World* world = World::getWorld();
+    for (RewindInfo* ri : infos)
+    {
+        if (!ri->isEvent())
+            continue;
+        RewindInfoEvent* rie = dynamic_cast<RewindInfoEvent*>(ri);
+        if (!rie || !rie->getBuffer() ||
+            !dynamic_cast<GameProtocol*>(rie->getEventRewinder()))
+        {
+            *unknown = true;
+            continue;
+        }
+        // The first byte of a controller action is the kart id
+        BareNetworkString* buffer = rie->getBuffer();
+        buffer->reset();
+        const unsigned kart_id = buffer->getUInt8();
+        buffer->reset();
+        if (kart_id >= world->getNumKarts() ||
+            !world->getKart(kart_id)->getController()
+                                    ->isLocalPlayerController())
+            karts.insert(kart_id);
+    }
+    return karts;
+}   // getKartsWithNetworkEvents
+
+// ----------------------------------------------------------------------------
+/** Returns true if a kart which is still racing is not in the server state
+ *  a rewind starts with, the server left it out (see InterestManager).
+ *  \param in_state Unique identities of the rewinders in the server state.
+ */
+bool RewindManager::isKartMissing(const std::set<std::string>& in_state) const
+{
+    World* world = World::getWorld();
+    for (unsigned i = 0; i < world->getNumKarts(); i++)
+    {
+        AbstractKart* kart = world->getKart(i);
+        Rewinder* r = dynamic_cast<Rewinder*>(kart);
+        if (r && !kart->isEliminated() &&
+            in_state.find(r->getUniqueIdentity()) == in_state.end())
+            return true;
+    }
+    return false;
+}   // isKartMissing
+
+// ----------------------------------------------------------------------------
+/** Logs the number and cost of the rewinds, and the size and encoding time
+ *  of the saved states, about twice a minute.
+ *  \param force Log now (e.g. at the end of a race).
+ */
+void RewindManager::reportRewindCost(bool force)
+{
+    const uint64_t now = StkTime::getMonoTimeMs();
+    if (!force && now - m_last_rewind_report < 30000)
+        return;
+    const unsigned rewinds = m_full_rewinds + m_partial_rewinds;
+    if (rewinds > 0)
+    {
+        const uint64_t kart_ticks = m_rewound_kart_ticks + m_frozen_kart_ticks;
+        Log::info("RewindManager", "%u rewinds (%u partial), %.2f ms and "
+            "%.1f ticks on average, %.1f%% of the kart updates skipped.",
+            rewinds, m_partial_rewinds,
+            m_rewind_time_us / 1000.0 / rewinds,
+            (double)m_rewound_ticks / rewinds,
+            kart_ticks > 0 ? 100.0 * m_frozen_kart_ticks / kart_ticks : 0.0);
+    }
+    m_full_rewinds = 0;
+    m_partial_rewinds = 0;
+    m_rewound_ticks = 0;
+    m_rewound_kart_ticks = 0;
+    m_frozen_kart_ticks = 0;
+    m_rewind_time_us = 0;
+
+    for (auto& p : m_state_cost)
+    {
+        const StateCost& cost = p.second;
+        if (cost.m_states == 0)
+            continue;
+        Log::info("RewindManager", "%u %s states, %.1f bytes and %.2f us "
+            "encoding on average.", cost.m_states, getRewinderKind(p.first),
+            (double)cost.m_bytes / cost.m_states,
+            (double)cost.m_encode_us / cost.m_states);
+    }
+    m_state_cost.clear();
+    m_last_rewind_report = now;
+}   // reportRewindCost
+
+// ----------------------------------------------------------------------------
+/** Returns a readable name of the rewinders with the given name (first
+ *  character of their unique identity) for the reports. */
+const char* RewindManager::getRewinderKind(char name)
+{
+    switch (name)
+    {
+    case RN_ITEM_MANAGER:  return "item manager";
+    case RN_KART:          return "kart";
+    case RN_RED_FLAG:
+    case RN_BLUE_FLAG:     return "flag";
+    case RN_CAKE:
+    case RN_BOWLING:
+    case RN_PLUNGER:
+    case RN_RUBBERBALL:    return "flyable";
+    case RN_PHYSICAL_OBJ:  return "physical object";
+    default:               return "other";
+    }
+}   // getRewinderKind
+
+// ----------------------------------------------------------------------------
+/** Records a contact of a kart with another kart, or with a shared object
+ *  (item, physical object, animation) if other is NULL. Used on clients to
+ *  find the karts affected by a misprediction.
+ */
+void RewindManager::addInteraction(const AbstractKart* kart,
+                                   const AbstractKart* other)
+{
+    if (!m_enable_rewind_manager || !NetworkConfig::get()->isClient())
+        return;
+    m_islands.addInteraction(World::getWorld()->getTicksSinceStart(),
+                             kart->getWorldKartId(),
+                             other ? (int)other->getWorldKartId() : -1);
+}   // addInteraction
+
+// ----------------------------------------------------------------------------
+/** Records that karts can have been changed without a contact in the
+ *  current time step (flyables, powerups), so no partial rewind is done
+ *  over it.
+ */
+void RewindManager::addUnknownInteraction()
+{
+    if (!m_enable_rewind_manager || !NetworkConfig::get()->isClient())
+        return;
+    m_islands.addUnknownInteraction(World::getWorld()->getTicksSinceStart());
+}   // addUnknownInteraction
+
 // ----------------------------------------------------------------------------
 bool RewindManager::useLocalEvent() const
 {
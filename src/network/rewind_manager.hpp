@@ -19,11 +19,13 @@
 #ifndef HEADER_REWIND_MANAGER_HPP
 #define HEADER_REWIND_MANAGER_HPP
 
+#include "network/rewind_islands.hpp"
 #include "network/rewind_queue.hpp"
 #include "utils/stk_process.hpp"
 
 #include <assert.h>
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <map>
@@ -31,6 +33,7 @@
 #include <string>
 #include <vector>
 
+class AbstractKart;
 class Rewinder;
 class RewindInfo;
 class RewindInfoEventFunction;
@@ -115,6 +118,28 @@ private:
 
     std::vector<RewindInfoEventFunction*> m_pending_rief;
 
+    /** Finds the karts which can be left out of a rewind on clients. */
+    RewindIslands m_islands;
+
+    /** Cost of the rewinds since the last report. */
+    unsigned m_full_rewinds;
+    unsigned m_partial_rewinds;
+    uint64_t m_rewound_ticks;
+    uint64_t m_rewound_kart_ticks;
+    uint64_t m_frozen_kart_ticks;
+    uint64_t m_rewind_time_us;
+    uint64_t m_last_rewind_report;
+
+    /** Size and encoding time of the states saved since the last report,
+     *  indexed by the rewinder name (first character of the unique id). */
+    struct StateCost
+    {
+        unsigned m_states;
+        uint64_t m_bytes;
+        uint64_t m_encode_us;
+    };
+    std::map<char, StateCost> m_state_cost;
+
     RewindManager();
    ~RewindManager();
     // ------------------------------------------------------------------------
@@ -132,6 +157,16 @@ private:
     }
     // ------------------------------------------------------------------------
     void mergeRewindInfoEventFunction();
+    // ------------------------------------------------------------------------
+    bool canRewindPartially(bool fast_forward) const;
+    // ------------------------------------------------------------------------
+    std::set<int> getKartsWithNetworkEvents(int now_ticks, bool* unknown);
+    // ------------------------------------------------------------------------
+    bool isKartMissing(const std::set<std::string>& in_state) const;
+    // ------------------------------------------------------------------------
+    void reportRewindCost(bool force);
+    // ------------------------------------------------------------------------
+    static const char* getRewinderKind(char name);
 
 public:
     // First static functions to manage rewinding.
@@ -210,6 +245,15 @@ public:
     }
     // ------------------------------------------------------------------------
     void resetSmoothNetworkBody();
+    // ------------------------------------------------------------------------
+    void addInteraction(const AbstractKart* kart,
+                        const AbstractKart* other = NULL);
+    // ------------------------------------------------------------------------
+    void addUnknownInteraction();
+    // ------------------------------------------------------------------------
+    /** Returns true if the kart is left out of the current rewind. */
+    bool isKartFrozen(unsigned kart_id) const
+                                        { return m_islands.isFrozen(kart_id); }
 };   // RewindManager
 
 
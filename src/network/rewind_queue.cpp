@@ -390,6 +390,48 @@ int RewindQueue::undoUntil(int undo_ticks)
     return (*m_current)->getTicks();
 }   // undoUntil
 
+// ----------------------------------------------------------------------------
+/** Collects the rewind infos after the current one and before the specified
+ *  time, i.e. the ones which are replayed in a rewind.
+ *  \param ticks Time (in ticks) the rewind simulates to.
+ *  \param infos On return the rewind infos.
+ */
+void RewindQueue::getInfoAfterCurrent(int ticks,
+                                      std::vector<RewindInfo*>* infos) const
+{
+    if (m_current == m_all_rewind_info.end())
+        return;
+    AllRewindInfo::iterator i = m_current;
+    for (i++; i != m_all_rewind_info.end() && (*i)->getTicks() < ticks; i++)
+        infos->push_back(*i);
+}   // getInfoAfterCurrent
+
+// ----------------------------------------------------------------------------
+/** Collects the rewinders in the state a rewind to the specified time starts
+ *  with (the one undoUntil stops at), without undoing anything. The server
+ *  can leave rewinders out of a state (see InterestManager).
+ *  \param undo_ticks Time to rewind to.
+ *  \param rewinders On return the unique identities of the rewinders.
+ */
+void RewindQueue::getRewindersInState(int undo_ticks,
+                                      std::set<std::string>* rewinders) const
+{
+    for (AllRewindInfo::const_reverse_iterator i = m_all_rewind_info.rbegin();
+         i != m_all_rewind_info.rend(); i++)
+    {
+        if ((*i)->getTicks() > undo_ticks || (*i)->isEvent() ||
+            !(*i)->isConfirmed())
+            continue;
+        RewindInfoState* ris = dynamic_cast<RewindInfoState*>(*i);
+        if (ris)
+        {
+            rewinders->insert(ris->getRewinderUsing().begin(),
+                              ris->getRewinderUsing().end());
+        }
+        return;
+    }
+}   // getRewindersInState
+
 // ----------------------------------------------------------------------------
 /** Replays all events (not states) that happened at the specified time.
  *  \param ticks Time in ticks.
@@ -520,5 +562,26 @@ void RewindQueue::unitTesting()
     b2.mergeNetworkData(4, &needs_rewind, &rewind_ticks);
     assert((*b2.m_current)->getTicks() == 3);
 
+    // 4) A rewind to a state which leaves out a kart must report it as
+    //    missing, the client then does not simulate it again
+    RewindQueue b3;
+    std::vector<uint8_t> buffer;
+    std::vector<std::string> ru = { std::string(1, RN_ITEM_MANAGER),
+                                    std::string(1, RN_KART) + '\0' };
+    b3.addNetworkRewindInfo(new RewindInfoState(5, 0, ru, buffer));
+    b3.addLocalEvent(dummy_rewinder.get(), NULL, true, 6);
+    b3.mergeNetworkData(10, &needs_rewind, &rewind_ticks);
+    std::set<std::string> in_state;
+    b3.getRewindersInState(6, &in_state);
+    assert(in_state.size() == 2);
+    assert(in_state.count(std::string(1, RN_KART) + '\0') == 1);
+    assert(in_state.count(std::string(1, RN_KART) + '\1') == 0);
+    int exact_ticks = b3.undoUntil(6);
+    assert(exact_ticks == 5);
+    assert(b3.getCurrent()->isState());
+    in_state.clear();
+    b3.getRewindersInState(4, &in_state);
+    assert(in_state.empty());
+    (void)exact_ticks;
 
 }   // unitTesting
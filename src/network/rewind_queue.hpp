@@ -23,6 +23,8 @@
 
 #include <assert.h>
 #include <list>
+#include <set>
+#include <string>
 #include <vector>
 
 class BareNetworkString;
@@ -83,6 +85,9 @@ public:
     bool hasMoreRewindInfo() const;
     int  undoUntil(int undo_ticks);
     void insertRewindInfo(RewindInfo *ri);
+    void getInfoAfterCurrent(int ticks, std::vector<RewindInfo*>* infos) const;
+    void getRewindersInState(int undo_ticks,
+                             std::set<std::string>* rewinders) const;
 
     // ------------------------------------------------------------------------
     /** Returns the time of the latest confirmed state. */
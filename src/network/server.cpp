@@ -46,6 +46,7 @@ Server::Server(const XMLNode& server_info) : m_supports_encrytion(true)
     m_current_players = 0;
     m_max_players = 0;
     m_distance = 0.0f;
+    m_ping = -1;
     m_server_mode = 0;
     xml.get("game_mode", &m_server_mode);
     unsigned server_data = 0;
@@ -195,6 +196,7 @@ Server::Server(unsigned server_id, const core::stringw &name, int max_players,
     m_server_mode        = server_mode;
     m_password_protected = password_protected;
     m_distance = 0.0f;
+    m_ping = -1;
     m_official = false;
     m_game_started = game_started;
     m_current_track = current_track;
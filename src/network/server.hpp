@@ -29,6 +29,7 @@
 
 #include <irrString.h>
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <tuple>
@@ -91,6 +92,10 @@ protected:
     /* WAN server only, distance based on IP latitude and longitude. */
     float m_distance;
 
+    /* WAN server only, round trip time of a discovery request in ms, -1 if
+     * the server did not answer. Set by the ping thread. */
+    std::atomic<int> m_ping;
+
     /* WAN server only, true if hosted officially by stk team. */
     bool m_official;
 
@@ -160,6 +165,10 @@ public:
     // ------------------------------------------------------------------------
     float getDistance() const                            { return m_distance; }
     // ------------------------------------------------------------------------
+    int getPing() const                               { return m_ping.load(); }
+    // ------------------------------------------------------------------------
+    void setPing(int ping)                               { m_ping.store(ping); }
+    // ------------------------------------------------------------------------
     bool supportsEncryption() const            { return m_supports_encrytion; }
     // ------------------------------------------------------------------------
     bool isOfficial() const                              { return m_official; }
@@ -497,6 +497,85 @@ namespace ServerConfig
         "more rewind, which clients with slow device may have problem playing "
         "this server, use the default value is recommended."));
 
+    SERVER_CFG_PREFIX BoolServerConfigParam m_state_relevance_filter
+        SERVER_CFG_DEFAULT(BoolServerConfigParam(false,
+        "state-relevance-filter",
+        "Send the state of karts and physical objects far away from the "
+        "karts of a player less frequently to this player, which saves "
+        "bandwidth in big arenas. Items, flags and the soccer ball are always "
+        "sent."));
+
+    SERVER_CFG_PREFIX FloatServerConfigParam m_state_relevance_distance
+        SERVER_CFG_DEFAULT(FloatServerConfigParam(40.0f,
+        "state-relevance-distance",
+        "Objects closer than this distance (in meters) to a kart of a player "
+        "are always sent in each state when state-relevance-filter is on."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_state_relevance_max_interval
+        SERVER_CFG_DEFAULT(IntServerConfigParam(4,
+        "state-relevance-max-interval",
+        "Maximum number of states between two updates of the least relevant "
+        "objects when state-relevance-filter is on."));
+
+    SERVER_CFG_PREFIX BoolServerConfigParam m_state_rate_control
+        SERVER_CFG_DEFAULT(BoolServerConfigParam(false,
+        "state-rate-control",
+        "Adapt the bandwidth used for game states of each player to the "
+        "packet loss and ping of their connection. When the budget of a "
+        "player is used up, the states of the least relevant and most "
+        "recently sent karts and physical objects are left out. The karts of "
+        "the player, items, flags, projectiles and the soccer ball are always "
+        "sent."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_state_peer_max_rate
+        SERVER_CFG_DEFAULT(IntServerConfigParam(48,
+        "state-peer-max-rate",
+        "Maximum bandwidth (in KBps) for the game states of each player when "
+        "state-rate-control is on, the rate of a player with a good "
+        "connection grows up to this value."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_state_upload_limit
+        SERVER_CFG_DEFAULT(IntServerConfigParam(0,
+        "state-upload-limit",
+        "Maximum total bandwidth (in KBps) for the game states of all players "
+        "when state-rate-control is on, the rates of all players are reduced "
+        "by the same fraction when exceeded. 0 for no limit."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_max_ticks_per_frame
+        SERVER_CFG_DEFAULT(IntServerConfigParam(0,
+        "max-ticks-per-frame",
+        "Maximum number of physics ticks run in one frame of the server "
+        "loop when it falls behind real time (e.g. after a slow database "
+        "write), the missing ticks are spread over the next frames. "
+        "0 to run all missing ticks at once."));
+
+    SERVER_CFG_PREFIX BoolServerConfigParam m_tick_watchdog
+        SERVER_CFG_DEFAULT(BoolServerConfigParam(true,
+        "tick-watchdog",
+        "Log the server frames which took longer than the physics ticks they "
+        "ran are worth, with the part of the frame which took longest."));
+
+    SERVER_CFG_PREFIX StringServerConfigParam m_packet_capture
+        SERVER_CFG_DEFAULT(StringServerConfigParam("", "packet-capture",
+        "File next to the server config in which all game packets of the "
+        "players are recorded for offline replays with --replay-capture, "
+        "empty to disable. The file contains player names, addresses and "
+        "chat messages, and is overwritten when the server starts."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_handshake_threads
+        SERVER_CFG_DEFAULT(IntServerConfigParam(2,
+        "handshake-threads",
+        "Number of threads checking the ban lists and decrypting the "
+        "connection requests of new players, so many players joining at once "
+        "do not slow down the lobby. 0 to do it in the lobby thread."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_handshake_queue_size
+        SERVER_CFG_DEFAULT(IntServerConfigParam(64,
+        "handshake-queue-size",
+        "Maximum number of connection requests being checked at the same "
+        "time, further players are refused as the server is busy until some "
+        "are done."));
+
     SERVER_CFG_PREFIX BoolServerConfigParam m_sql_management
         SERVER_CFG_DEFAULT(BoolServerConfigParam(false,
         "sql-management",
@@ -608,7 +687,78 @@ namespace ServerConfig
         "When non-empty, server is telling whether a player has beaten "
         "a server record, records are taken from the table specified "
         "in this field. So it can be the results table for this server "
-        "or for all servers hosted on the machine."));
+        "or for all servers hosted on the machine. The best results are "
+        "indexed in memory and cached in <table>_records.* files next to "
+        "the server config, delete them to rebuild the index."));
+
+    SERVER_CFG_PREFIX StringServerConfigParam m_ranking_table
+        SERVER_CFG_DEFAULT(StringServerConfigParam("soccer_ranking",
+        "ranking-table",
+        "Table storing the Elo ranking and statistics of the ranked soccer "
+        "modes (rank-1vs1, rank-soccer, save-goals...) when sql-management "
+        "is on, <table>_teams and <table>_matches store the supertournament "
+        "standings and the played matches, <table>_games and <table>_goals "
+        "the supertournament games with their scorers. The tables are "
+        "created if needed. Without database the rankings are saved to "
+        "<table>.txt next to the server config instead, when empty they are "
+        "only kept in memory."));
+
+    SERVER_CFG_PREFIX FloatServerConfigParam m_ranking_k_factor
+        SERVER_CFG_DEFAULT(FloatServerConfigParam(32.0f,
+        "ranking-k-factor",
+        "Maximum Elo change of a ranked soccer match won by one goal, it is "
+        "multiplied for bigger goal differences."));
+
+    SERVER_CFG_PREFIX BoolServerConfigParam m_ranking_scripts
+        SERVER_CFG_DEFAULT(BoolServerConfigParam(false, "ranking-scripts",
+        "Run the python ranking scripts of older versions (update_elo.py, "
+        "update_list.py, update_wiki.py...) from the working directory "
+        "instead of the native Elo rating. They are run one after another in "
+        "a separate thread, so the game never waits for them. When on, the "
+        "Elo used for balancing teams is read from their ranking files."));
+
+    SERVER_CFG_PREFIX FloatServerConfigParam m_balance_handicap_elo
+        SERVER_CFG_DEFAULT(FloatServerConfigParam(0.0f,
+        "balance-handicap-elo",
+        "Elo removed from players with a handicap when balancing the teams "
+        "of ranked soccer."));
+
+    SERVER_CFG_PREFIX FloatServerConfigParam m_balance_form_weight
+        SERVER_CFG_DEFAULT(FloatServerConfigParam(0.0f,
+        "balance-form-weight",
+        "Elo added to a player when balancing the teams of ranked soccer "
+        "for each Elo point won on average in their recent matches since the "
+        "server started, 0 to balance on Elo only."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_balance_time_budget
+        SERVER_CFG_DEFAULT(IntServerConfigParam(50,
+        "balance-time-budget",
+        "Maximum time in milliseconds to search the most balanced teams of "
+        "ranked soccer, the best teams found so far are used after it."));
+
+    SERVER_CFG_PREFIX StringServerConfigParam m_game_events_file
+        SERVER_CFG_DEFAULT(StringServerConfigParam("", "game-events-file",
+        "File next to the server config receiving the game events (goals, "
+        "laps, finishes, item hits, kicks, bans, joins, leaves and match "
+        "results) as one JSON object per line, empty to disable. Events are "
+        "written in a separate thread."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_game_events_file_size
+        SERVER_CFG_DEFAULT(IntServerConfigParam(10240,
+        "game-events-file-size",
+        "Size in KB after which the game events file is renamed to "
+        "<file>.1 (up to <file>.3) and a new one is started, 0 to never "
+        "rotate it."));
+
+    SERVER_CFG_PREFIX StringServerConfigParam m_game_events_socket
+        SERVER_CFG_DEFAULT(StringServerConfigParam("", "game-events-socket",
+        "Path of a UNIX datagram socket receiving each game event as a JSON "
+        "object, empty to disable. Events are dropped when no one listens."));
+
+    SERVER_CFG_PREFIX StringServerConfigParam m_game_events_table
+        SERVER_CFG_DEFAULT(StringServerConfigParam("", "game-events-table",
+        "Table storing the game events when sql-management is on, it is "
+        "created if needed. Empty to disable."));
 
     SERVER_CFG_PREFIX BoolServerConfigParam m_track_kicks
         SERVER_CFG_DEFAULT(BoolServerConfigParam(false, "track-kicks",
@@ -705,6 +855,17 @@ namespace ServerConfig
         SERVER_CFG_DEFAULT(BoolServerConfigParam(true, "expose-mobile",
         "If true, all mobile peers get a corresponding icon into the name."));
 
+    SERVER_CFG_PREFIX BoolServerConfigParam m_player_list_diff
+        SERVER_CFG_DEFAULT(BoolServerConfigParam(true, "player-list-diff",
+        "If true, clients only receive the added, removed or changed players "
+        "when the lobby player list is updated."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_player_list_merge_time
+        SERVER_CFG_DEFAULT(IntServerConfigParam(100,
+        "player-list-merge-time",
+        "Time in milliseconds during which lobby player list changes are "
+        "merged into one update, 0 sends every change immediately."));
+
     SERVER_CFG_PREFIX StringServerConfigParam m_soccer_goals_policy
         SERVER_CFG_DEFAULT(StringServerConfigParam("standard",
         "soccer-goals-policy",
@@ -764,7 +925,7 @@ namespace ServerConfig
 
     // ========================================================================
     /** Server version, will be advanced if there are protocol changes. */
-    static const uint32_t m_server_version = 6;
+    static const uint32_t m_server_version = 7;
     // ========================================================================
     /** Server database version, will be advanced if there are protocol
      *  changes. */
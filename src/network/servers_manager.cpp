@@ -20,6 +20,7 @@
 
 #include "config/stk_config.hpp"
 #include "config/user_config.hpp"
+#include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
 #include "network/network.hpp"
 #include "network/network_config.hpp"
@@ -30,11 +31,15 @@
 #include "network/stk_ipv6.hpp"
 #include "online/xml_request.hpp"
 #include "online/request_manager.hpp"
+#include "utils/file_utils.hpp"
 #include "utils/translation.hpp"
 #include "utils/time.hpp"
+#include "utils/vs.hpp"
 
 #include <assert.h>
+#include <fstream>
 #include <functional>
+#include <iterator>
 #include <set>
 #include <string>
 #include <thread>
@@ -69,6 +74,7 @@ void ServersManager::deallocate()
 // ----------------------------------------------------------------------------
 ServersManager::ServersManager()
 {
+    m_wan_list_cache_read = false;
 }   // ServersManager
 
 // ----------------------------------------------------------------------------
@@ -106,9 +112,29 @@ std::shared_ptr<ServerList> ServersManager::getWANRefreshRequest() const
                 m_ip_detect_thread.join();
         }
         // --------------------------------------------------------------------
+        /** Publishes the previous server list so that it can be shown while
+         *  downloading, and only asks for the list if it changed since. */
+        virtual void prepareOperation() OVERRIDE
+        {
+            std::string etag;
+            auto servers = ServersManager::get()->getCachedWANServers(&etag);
+            auto server_list = m_server_list.lock();
+            if (server_list)
+            {
+                server_list->m_cached_servers = servers;
+                server_list->m_cached_list_ready = true;
+            }
+            setIfNoneMatch(etag);
+            Online::XMLRequest::prepareOperation();
+        }   // prepareOperation
+        // --------------------------------------------------------------------
         virtual void afterOperation() OVERRIDE
         {
-            Online::XMLRequest::afterOperation();
+            // Nothing to parse if the list did not change
+            if (isNotModified())
+                Online::HTTPRequest::afterOperation();
+            else
+                Online::XMLRequest::afterOperation();
             if (m_ip_detect_thread.joinable())
                 m_ip_detect_thread.join();
 
@@ -116,40 +142,35 @@ std::shared_ptr<ServerList> ServersManager::getWANRefreshRequest() const
             if (!server_list)
                 return;
 
-            if (!isSuccess())
+            std::vector<std::shared_ptr<Server> > servers;
+            if (isNotModified())
+            {
+                Log::info("ServersManager", "Server list not modified");
+                std::string etag;
+                servers = ServersManager::get()->getCachedWANServers(&etag);
+            }
+            else if (!isSuccess())
             {
                 Log::error("ServersManager", "Could not refresh server list");
                 server_list->m_list_updated = true;
                 return;
             }
-
-            const XMLNode *servers_xml = getXMLData()->getNode("servers");
-            for (unsigned int i = 0; i < servers_xml->getNumNodes(); i++)
+            else
             {
-                const XMLNode* s = servers_xml->getNode(i);
-                assert(s);
-                const XMLNode* si = s->getNode("server-info");
-                assert(si);
-                int version = 0;
-                si->get("version", &version);
-                assert(version != 0);
-                if (version < stk_config->m_max_server_version ||
-                    version > stk_config->m_max_server_version)
-                {
-                    Log::verbose("ServersManager", "Skipping a server");
-                    continue;
-                }
-                std::shared_ptr<Server> ser = std::make_shared<Server>(*s);
-                if (ser->getAddress().isUnset() &&
-                    NetworkConfig::get()->getIPType() == NetworkConfig::IP_V4)
-                {
-                    Log::verbose("ServersManager",
-                        "Skipping an IPv6 only server");
-                    continue;
-                }
-                server_list->m_servers.emplace_back(ser);
+                ServersManager::get()->setWANList(getData(), getETag());
+                servers = ServersManager::createWANServers(getXMLData());
             }
+            server_list->m_servers = servers;
             server_list->m_list_updated = true;
+            // Waiting for the answers would block the other requests, the
+            // list joins the thread before it is deleted
+            ServerList* list = server_list.get();
+            server_list->m_ping_thread = std::thread([list, servers]()
+                {
+                    VS::setThreadName("ServerPing");
+                    ServersManager::probeServers(servers, list->m_stop_ping);
+                    list->m_pings_updated.store(true);
+                });
         }   // afterOperation
         // --------------------------------------------------------------------
     };   // RefreshRequest
@@ -162,6 +183,165 @@ std::shared_ptr<ServerList> ServersManager::getWANRefreshRequest() const
     return server_list;
 }   // getWANRefreshRequest
 
+// ----------------------------------------------------------------------------
+/** Creates the servers of a WAN server list which can be joined: servers
+ *  with a different version are skipped, and IPv6 only servers if this host
+ *  has no IPv6.
+ *  \param list Root node of the server list.
+ */
+std::vector<std::shared_ptr<Server> >
+    ServersManager::createWANServers(const XMLNode* list)
+{
+    std::vector<std::shared_ptr<Server> > servers;
+    const XMLNode *servers_xml = list ? list->getNode("servers") : NULL;
+    if (!servers_xml)
+        return servers;
+    for (unsigned int i = 0; i < servers_xml->getNumNodes(); i++)
+    {
+        const XMLNode* s = servers_xml->getNode(i);
+        assert(s);
+        const XMLNode* si = s->getNode("server-info");
+        assert(si);
+        int version = 0;
+        si->get("version", &version);
+        assert(version != 0);
+        if (version < stk_config->m_max_server_version ||
+            version > stk_config->m_max_server_version)
+        {
+            Log::verbose("ServersManager", "Skipping a server");
+            continue;
+        }
+        std::shared_ptr<Server> ser = std::make_shared<Server>(*s);
+        if (ser->getAddress().isUnset() &&
+            NetworkConfig::get()->getIPType() == NetworkConfig::IP_V4)
+        {
+            Log::verbose("ServersManager", "Skipping an IPv6 only server");
+            continue;
+        }
+        servers.emplace_back(ser);
+    }
+    return servers;
+}   // createWANServers
+
+// ----------------------------------------------------------------------------
+/** Returns new server objects of the last WAN server list, which is read
+ *  from the server list cache on first use.
+ *  \param etag Returns the ETag of the list, empty if unknown.
+ */
+std::vector<std::shared_ptr<Server> >
+    ServersManager::getCachedWANServers(std::string* etag)
+{
+    std::lock_guard<std::mutex> lock(m_wan_list_mutex);
+    if (!m_wan_list_cache_read)
+    {
+        m_wan_list_cache_read = true;
+        // The first line is the ETag, followed by the server list
+        std::ifstream cache(FileUtils::getPortableReadingPath(
+            file_manager->getUserConfigFile("server_list.cache")),
+            std::ios::binary);
+        std::string cached_etag;
+        if (cache.good() && std::getline(cache, cached_etag))
+        {
+            std::string data((std::istreambuf_iterator<char>(cache)),
+                             std::istreambuf_iterator<char>());
+            m_wan_list.reset(file_manager->createXMLTreeFromString(data));
+            if (m_wan_list)
+                m_wan_list_etag = cached_etag;
+        }
+    }
+    *etag = m_wan_list_etag;
+    return createWANServers(m_wan_list.get());
+}   // getCachedWANServers
+
+// ----------------------------------------------------------------------------
+/** Keeps a newly downloaded WAN server list, and writes it into the server
+ *  list cache for the next start.
+ *  \param data The server list.
+ *  \param etag ETag of the list sent by the server, can be empty.
+ */
+void ServersManager::setWANList(const std::string& data,
+                                const std::string& etag)
+{
+    std::lock_guard<std::mutex> lock(m_wan_list_mutex);
+    m_wan_list.reset(file_manager->createXMLTreeFromString(data));
+    m_wan_list_etag = m_wan_list ? etag : "";
+    const std::string filename =
+        file_manager->getUserConfigFile("server_list.cache");
+    std::ofstream cache(FileUtils::getPortableWritingPath(filename),
+                        std::ios::binary);
+    cache << m_wan_list_etag << "\n" << data;
+    if (!cache.good())
+    {
+        Log::warn("ServersManager", "Can't write server list cache %s.",
+                  filename.c_str());
+    }
+}   // setWANList
+
+// ----------------------------------------------------------------------------
+/** Measures the round trip time to all servers at once: a discovery request
+ *  is sent to every server, and the answers are collected for up to half a
+ *  second. Servers answer only while they wait for players, so running games
+ *  keep an unknown ping. Runs in its own thread.
+ *  \param servers The servers to ping.
+ *  \param stop Set to end the probe early.
+ */
+void ServersManager::probeServers(
+                         const std::vector<std::shared_ptr<Server> >& servers,
+                         const std::atomic_bool& stop)
+{
+    // Only one server of a host can bind the discovery port, so there is at
+    // most one answer per address, and its round trip is used for all the
+    // servers there. The answers are matched by address only: the port in
+    // the answer is the private port, which differs behind a NAT.
+    std::map<uint32_t, std::vector<std::shared_ptr<Server> > > probed;
+    for (auto& server : servers)
+    {
+        const SocketAddress& addr = server->getAddress();
+        if (!addr.isUnset())
+            probed[addr.getIP()].push_back(server);
+    }
+    if (probed.empty())
+        return;
+
+    ENetAddress eaddr = {};
+    Network* probe = new Network(1, 1, 0, 0, &eaddr);
+    if (!probe->getENetHost())
+    {
+        delete probe;
+        return;
+    }
+    for (auto& p : probed)
+    {
+        probe->sendRawPacket(std::string("stk-server"),
+            SocketAddress(p.first, stk_config->m_server_discovery_port));
+    }
+
+    // Returns as soon as all addresses answered
+    const int LEN = 2048;
+    char buffer[LEN];
+    const uint64_t start_time = StkTime::getMonoTimeMs();
+    const uint64_t DURATION = 500;
+    unsigned answers = 0;
+    while (answers < probed.size() && !stop.load() &&
+           StkTime::getMonoTimeMs() - start_time < DURATION)
+    {
+        SocketAddress sender;
+        int len = probe->receiveRawPacket(buffer, LEN, &sender, 1);
+        if (len <= 0)
+            continue;
+        auto it = probed.find(sender.getIP());
+        if (it == probed.end() || it->second[0]->getPing() >= 0)
+            continue;
+        const int ping = (int)(StkTime::getMonoTimeMs() - start_time);
+        for (auto& server : it->second)
+            server->setPing(ping);
+        answers++;
+    }
+    delete probe;
+    Log::info("ServersManager", "%u of %u server addresses answered the "
+              "ping.", answers, (unsigned)probed.size());
+}   // probeServers
+
 // ----------------------------------------------------------------------------
 /** Returns a LAN update-list-of-servers request. It uses UDP broadcasts
  *  to find LAN servers, and waits for a certain amount of time fr 
@@ -199,6 +379,11 @@ std::shared_ptr<ServerList> ServersManager::getLANRefreshRequest() const
             return NULL;
         }   // getXMLData
         // --------------------------------------------------------------------
+        virtual bool allowConcurrentTransfer() const OVERRIDE
+        {
+            return false;
+        }   // allowConcurrentTransfer
+        // --------------------------------------------------------------------
         virtual void prepareOperation() OVERRIDE
         {
         }   // prepareOperation
@@ -24,7 +24,9 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace Online { class XMLRequest; }
@@ -40,8 +42,29 @@ struct ServerList
 {
     /** List of servers */
     std::vector<std::shared_ptr<Server> > m_servers;
+    /** Servers of the previous list, which can be shown until m_servers is
+     *  updated. Only valid once m_cached_list_ready is set. */
+    std::vector<std::shared_ptr<Server> > m_cached_servers;
+    std::atomic_bool m_cached_list_ready;
     std::atomic_bool m_list_updated;
-    ServerList() { m_list_updated.store(false); }
+    /** Set when the pings of m_servers were measured, which is done in
+     *  m_ping_thread after the list is updated. */
+    std::atomic_bool m_pings_updated;
+    std::atomic_bool m_stop_ping;
+    std::thread m_ping_thread;
+    ServerList()
+    {
+        m_cached_list_ready.store(false);
+        m_list_updated.store(false);
+        m_pings_updated.store(false);
+        m_stop_ping.store(false);
+    }
+    ~ServerList()
+    {
+        m_stop_ping.store(true);
+        if (m_ping_thread.joinable())
+            m_ping_thread.join();
+    }
 };
 
 class ServersManager
@@ -50,6 +73,19 @@ private:
     /** List of broadcast addresses to use. */
     std::vector<SocketAddress> m_broadcast_address;
 
+    /** The last WAN server list received, or read from the server list
+     *  cache. It is shown while a refresh is running, and used again if the
+     *  list did not change. */
+    std::unique_ptr<XMLNode> m_wan_list;
+
+    /** ETag of m_wan_list, empty if unknown. */
+    std::string m_wan_list_etag;
+
+    bool m_wan_list_cache_read;
+
+    /** Protects the WAN list, which is used by the request thread. */
+    std::mutex m_wan_list_mutex;
+
     // ------------------------------------------------------------------------
      ServersManager();
     // ------------------------------------------------------------------------
@@ -63,6 +99,18 @@ private:
     std::vector<SocketAddress> getDefaultBroadcastAddresses();
     void addAllBroadcastAddresses(const SocketAddress &a, int len,
                                   std::vector<SocketAddress>* result);
+    // ------------------------------------------------------------------------
+    std::vector<std::shared_ptr<Server> > getCachedWANServers(
+                                                         std::string* etag);
+    // ------------------------------------------------------------------------
+    void setWANList(const std::string& data, const std::string& etag);
+    // ------------------------------------------------------------------------
+    static std::vector<std::shared_ptr<Server> > createWANServers(
+                                                     const XMLNode* list);
+    // ------------------------------------------------------------------------
+    static void probeServers(
+                        const std::vector<std::shared_ptr<Server> >& servers,
+                        const std::atomic_bool& stop);
 public:
     // ------------------------------------------------------------------------
     // Singleton
@@ -0,0 +1,1260 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/soccer_ranking.hpp"
+
+#include "io/file_manager.hpp"
+#include "network/server_config.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/time.hpp"
+#include "utils/vs.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef ENABLE_SQLITE3
+#include <sqlite3.h>
+#endif
+
+SoccerRanking* SoccerRanking::m_soccer_ranking = NULL;
+
+namespace
+{
+    /** Ranking files written by the python scripts of older versions, they
+     *  are read once if the database has no ranking for a mode yet. */
+    struct LegacyFile
+    {
+        SoccerRanking::RankingMode m_mode;
+        const char* m_file;
+        unsigned m_elo_column;
+    };
+    const LegacyFile g_legacy_files[] =
+    {
+        { SoccerRanking::RM_1VS1, "game_stat_1vs1.txt", 3 },
+        { SoccerRanking::RM_SOCCER, "soccer_ranking.txt", 1 },
+        { SoccerRanking::RM_SUPER_MP_QUALI,
+          "supertournament_mp_quali_ranking.txt", 1 },
+        { SoccerRanking::RM_SUPER_1VS1_QUALI, "super1vs1quali_ranking.txt", 3 },
+        { SoccerRanking::RM_SUPER_2VS2_QUALI, "super2vs2quali_ranking.txt", 3 },
+    };
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Creates the ranking of the server and loads it from the database, or
+ *  from <ranking-table>.txt next to the server config without database.
+ */
+void SoccerRanking::create()
+{
+    assert(!m_soccer_ranking);
+    std::string db_path, file_path;
+    const std::string table = ServerConfig::m_ranking_table;
+    if (!table.empty())
+    {
+#ifdef ENABLE_SQLITE3
+        if (ServerConfig::m_sql_management)
+        {
+            db_path = ServerConfig::getConfigDirectory() + "/" +
+                ServerConfig::m_database_file.c_str();
+        }
+#endif
+        if (db_path.empty())
+            file_path = ServerConfig::getConfigDirectory() + "/" + table + ".txt";
+    }
+    m_soccer_ranking = new SoccerRanking(db_path, file_path);
+    m_soccer_ranking->load();
+}   // create
+
+// ----------------------------------------------------------------------------
+void SoccerRanking::destroy()
+{
+    delete m_soccer_ranking;
+    m_soccer_ranking = NULL;
+}   // destroy
+
+// ----------------------------------------------------------------------------
+SoccerRanking::SoccerRanking(const std::string& db_path,
+                             const std::string& file_path)
+             : m_db_path(db_path), m_file_path(file_path)
+{
+    m_file_check_interval = 1000;
+    m_file_save_queued.store(false);
+    m_standings.reset(new Standings());
+    m_stop.store(false);
+    m_worker = std::thread([this]()
+        {
+            VS::setThreadName("SoccerRanking");
+            workerLoop();
+        });
+}   // SoccerRanking
+
+// ----------------------------------------------------------------------------
+/** Finishes the pending database writes and commands before returning.
+ */
+SoccerRanking::~SoccerRanking()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        m_stop.store(true);
+    }
+    m_jobs_cv.notify_one();
+    m_worker.join();
+}   // ~SoccerRanking
+
+// ----------------------------------------------------------------------------
+void SoccerRanking::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobs_mutex);
+            m_jobs_cv.wait(lock, [this]()
+                { return m_stop.load() || !m_jobs.empty(); });
+            if (m_jobs.empty())
+                return;
+            job = m_jobs.front();
+        }
+        job();
+        {
+            // Only removed when done, so waitForJobs sees running jobs
+            std::lock_guard<std::mutex> lock(m_jobs_mutex);
+            m_jobs.pop_front();
+        }
+        m_jobs_cv.notify_all();
+    }
+}   // workerLoop
+
+// ----------------------------------------------------------------------------
+void SoccerRanking::addJob(const std::function<void()>& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        m_jobs.push_back(job);
+    }
+    m_jobs_cv.notify_all();
+}   // addJob
+
+// ----------------------------------------------------------------------------
+/** Blocks until all database writes and commands queued so far are done,
+ *  only for tests and shutdown.
+ */
+void SoccerRanking::waitForJobs()
+{
+    std::unique_lock<std::mutex> lock(m_jobs_mutex);
+    m_jobs_cv.wait(lock, [this]() { return m_jobs.empty(); });
+}   // waitForJobs
+
+// ----------------------------------------------------------------------------
+/** Runs an external command (like the python scripts of older versions)
+ *  on the worker thread, after the previous commands and database writes.
+ */
+void SoccerRanking::runCommand(const std::string& command)
+{
+    addJob([command]()
+        {
+            int ret = system(command.c_str());
+            if (ret != 0)
+            {
+                Log::warn("SoccerRanking", "\"%s\" returned %d.",
+                    command.c_str(), ret);
+            }
+        });
+}   // runCommand
+
+// ----------------------------------------------------------------------------
+/** Quotes a player name, team name or chat argument so that it reaches the
+ *  scripts started by runCommand as one argument, and can not run anything
+ *  else in the shell.
+ *  \param arg The argument to quote.
+ */
+std::string SoccerRanking::escapeArgument(const std::string& arg)
+{
+#ifdef WIN32
+    // cmd.exe has no way to escape these inside quotes, drop them.
+    std::string result = "\"";
+    for (char c : arg)
+    {
+        if (c != '"' && c != '%' && c != '!')
+            result += c;
+    }
+    return result + "\"";
+#else
+    std::string result = "'";
+    for (char c : arg)
+    {
+        if (c == '\'')
+            result += "'\\''";
+        else
+            result += c;
+    }
+    return result + "'";
+#endif
+}   // escapeArgument
+
+// ----------------------------------------------------------------------------
+/** Copies a file on the worker thread, after the previous commands, like
+ *  resetting the player lists of the python scripts from a template.
+ */
+void SoccerRanking::copyFile(const std::string& source,
+                             const std::string& dest)
+{
+    addJob([source, dest]()
+        {
+            if (!file_manager->copyFile(source, dest))
+            {
+                Log::warn("SoccerRanking", "Cannot copy %s to %s.",
+                    source.c_str(), dest.c_str());
+            }
+        });
+}   // copyFile
+
+// ----------------------------------------------------------------------------
+const char* SoccerRanking::getModeName(RankingMode mode)
+{
+    switch (mode)
+    {
+    case RM_1VS1:             return "1vs1";
+    case RM_1VS1_2:           return "1vs1_2";
+    case RM_1VS1_3:           return "1vs1_3";
+    case RM_3VS3:             return "3vs3";
+    case RM_SOCCER:           return "ranked-soccer";
+    case RM_SUPER_MP_QUALI:   return "super_mp_quali";
+    case RM_SUPER_MP_QUALI2:  return "super_mp_quali2";
+    case RM_SUPER_1VS1_QUALI: return "super1vs1quali";
+    case RM_SUPER_2VS2_QUALI: return "super2vs2quali";
+    default:                  break;
+    }
+    return "";
+}   // getModeName
+
+// ----------------------------------------------------------------------------
+/** Returns the rankings updated by a match with the current server config,
+ *  the first one is the main ranking of the server.
+ */
+std::vector<SoccerRanking::RankingMode> SoccerRanking::getServerModes()
+{
+    std::vector<RankingMode> modes;
+    if (ServerConfig::m_rank_1vs1)
+        modes.push_back(RM_1VS1);
+    else if (ServerConfig::m_rank_1vs1_2)
+        modes.push_back(RM_1VS1_2);
+    else if (ServerConfig::m_rank_1vs1_3)
+        modes.push_back(RM_1VS1_3);
+    if (!modes.empty())
+        return modes;
+
+    if (ServerConfig::m_rank_soccer)
+    {
+        if (ServerConfig::m_super_mp_quali && ServerConfig::m_mpq2)
+            modes.push_back(RM_SUPER_MP_QUALI2);
+        else if (ServerConfig::m_super_mp_quali)
+            modes.push_back(RM_SUPER_MP_QUALI);
+        else
+            modes.push_back(RM_SOCCER);
+    }
+    if (ServerConfig::m_rank_3vs3 || ServerConfig::m_save_goals)
+        modes.push_back(RM_3VS3);
+    return modes;
+}   // getServerModes
+
+// ----------------------------------------------------------------------------
+/** Probability to win against an opponent in the Elo system. */
+double SoccerRanking::getExpectedScore(double elo, double opponent_elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, (opponent_elo - elo) / 400.0));
+}   // getExpectedScore
+
+// ----------------------------------------------------------------------------
+/** Multiplier of the Elo change for clear wins, like in the football Elo
+ *  ratings. */
+double SoccerRanking::getGoalDifferenceFactor(int goal_difference)
+{
+    goal_difference = std::abs(goal_difference);
+    if (goal_difference <= 1)
+        return 1.0;
+    if (goal_difference == 2)
+        return 1.5;
+    return (11.0 + goal_difference) / 8.0;
+}   // getGoalDifferenceFactor
+
+// ----------------------------------------------------------------------------
+/** Starts tracking a match, the players are added with addPlayer.
+ *  \param modes Rankings updated when the match ends.
+ *  \param red_team_name, blue_team_name Team names of a supertournament game,
+ *         their standings are updated too if both are set.
+ */
+void SoccerRanking::startMatch(const std::vector<RankingMode>& modes,
+                               const std::string& red_team_name,
+                               const std::string& blue_team_name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_match = Match();
+    m_match.m_modes = modes;
+    m_match.m_team_names[0] = red_team_name;
+    m_match.m_team_names[1] = blue_team_name;
+    m_match.m_running = true;
+}   // startMatch
+
+// ----------------------------------------------------------------------------
+void SoccerRanking::cancelMatch()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_match = Match();
+}   // cancelMatch
+
+// ----------------------------------------------------------------------------
+bool SoccerRanking::isMatchRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_match.m_running;
+}   // isMatchRunning
+
+// ----------------------------------------------------------------------------
+/** Adds a player to the current match.
+ *  \param team 0 for red, 1 for blue.
+ *  \param phase Part of the match already played when joining, in [0, 1].
+ */
+void SoccerRanking::addPlayer(const std::string& name, int team, double phase)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_match.m_running || name.empty() || team < 0 || team > 1)
+        return;
+    phase = std::min(1.0, std::max(0.0, phase));
+    auto it = m_match.m_players.find(name);
+    if (it != m_match.m_players.end())
+    {
+        // Rejoined, count the time away as missed
+        MatchPlayer& mp = it->second;
+        mp.m_team = team;
+        if (mp.m_left < 1.0)
+            mp.m_joined += phase - mp.m_left;
+        mp.m_left = 1.0;
+        return;
+    }
+    MatchPlayer mp;
+    mp.m_team = team;
+    mp.m_joined = phase;
+    mp.m_left = 1.0;
+    mp.m_goals = 0;
+    mp.m_own_goals = 0;
+    m_match.m_players[name] = mp;
+}   // addPlayer
+
+// ----------------------------------------------------------------------------
+/** Called when a player leaves the current match.
+ *  \param phase Part of the match played when leaving, in [0, 1].
+ */
+void SoccerRanking::removePlayer(const std::string& name, double phase)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_match.m_players.find(name);
+    if (!m_match.m_running || it == m_match.m_players.end())
+        return;
+    it->second.m_left = std::min(1.0, std::max(it->second.m_joined, phase));
+}   // removePlayer
+
+// ----------------------------------------------------------------------------
+/** Adds a goal to the current match.
+ *  \param time Time since the start of the match in seconds.
+ */
+void SoccerRanking::addGoal(const std::string& name, bool own_goal,
+                            float time)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_match.m_players.find(name);
+    if (!m_match.m_running || it == m_match.m_players.end())
+        return;
+    if (own_goal)
+        it->second.m_own_goals++;
+    else
+        it->second.m_goals++;
+    Goal goal;
+    goal.m_scorer = name;
+    goal.m_team = it->second.m_team;
+    goal.m_own_goal = own_goal;
+    goal.m_time = time;
+    m_match.m_goals.push_back(goal);
+}   // addGoal
+
+// ----------------------------------------------------------------------------
+/** Ends the current match and updates the rankings.
+ *  \return The Elo changes in the main ranking of the match.
+ */
+std::vector<SoccerRanking::EloChange> SoccerRanking::endMatch(int red_goals,
+                                                              int blue_goals)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Match match = m_match;
+    m_match = Match();
+    if (!match.m_running)
+        return std::vector<EloChange>();
+    return applyResult(match, red_goals, blue_goals);
+}   // endMatch
+
+// ----------------------------------------------------------------------------
+/** Updates a ranking with the result of a match which was not tracked with
+ *  startMatch, all players played the whole match.
+ */
+std::vector<SoccerRanking::EloChange> SoccerRanking::rateMatch(
+    RankingMode mode, const std::vector<std::string>& red_players,
+    const std::vector<std::string>& blue_players, int red_goals,
+    int blue_goals)
+{
+    Match match;
+    match.m_modes.push_back(mode);
+    MatchPlayer mp;
+    mp.m_joined = 0.0;
+    mp.m_left = 1.0;
+    mp.m_goals = 0;
+    mp.m_own_goals = 0;
+    for (int team = 0; team < 2; team++)
+    {
+        mp.m_team = team;
+        for (const std::string& name : team == 0 ? red_players : blue_players)
+            match.m_players[name] = mp;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return applyResult(match, red_goals, blue_goals);
+}   // rateMatch
+
+// ----------------------------------------------------------------------------
+/** Applies the result of a match to its rankings, m_mutex must be locked.
+ *  The Elo of a team is the average Elo of its players weighted by the part
+ *  of the match they played, and each player gets the Elo change of the team
+ *  scaled by the same part. The database or the ranking file is updated on
+ *  the worker thread.
+ */
+std::vector<SoccerRanking::EloChange> SoccerRanking::applyResult(
+    const Match& match, int red_goals, int blue_goals)
+{
+    std::vector<EloChange> changes;
+    bool has_team[2] = { false, false };
+    for (const auto& p : match.m_players)
+    {
+        if (p.second.m_left > p.second.m_joined)
+            has_team[p.second.m_team] = true;
+    }
+    if (!has_team[0] || !has_team[1])
+    {
+        Log::info("SoccerRanking", "Match not ranked, a team has no player.");
+        return changes;
+    }
+
+    const double red_score = red_goals > blue_goals ? 1.0 :
+        red_goals == blue_goals ? 0.5 : 0.0;
+    const double k = std::max(0.0f, (float)ServerConfig::m_ranking_k_factor) *
+        getGoalDifferenceFactor(red_goals - blue_goals);
+    std::string match_info = StringUtils::toString(red_goals) + "-" +
+        StringUtils::toString(blue_goals);
+
+    for (unsigned i = 0; i < match.m_modes.size(); i++)
+    {
+        RankingMode mode = match.m_modes[i];
+        if (mode >= RM_COUNT)
+            continue;
+        std::unordered_map<std::string, PlayerStats>& ranking = m_players[mode];
+        double elo_sum[2] = { 0.0, 0.0 };
+        double weight_sum[2] = { 0.0, 0.0 };
+        for (const auto& p : match.m_players)
+        {
+            double weight = p.second.m_left - p.second.m_joined;
+            if (weight <= 0.0)
+                continue;
+            elo_sum[p.second.m_team] += ranking[p.first].m_elo * weight;
+            weight_sum[p.second.m_team] += weight;
+        }
+        const double red_elo = elo_sum[0] / weight_sum[0];
+        const double blue_elo = elo_sum[1] / weight_sum[1];
+        const double red_change =
+            k * (red_score - getExpectedScore(red_elo, blue_elo));
+
+        std::vector<std::pair<std::string, PlayerStats> > updated;
+        for (const auto& p : match.m_players)
+        {
+            const MatchPlayer& mp = p.second;
+            double weight = mp.m_left - mp.m_joined;
+            if (weight <= 0.0)
+                continue;
+            PlayerStats& ps = ranking[p.first];
+            double score = mp.m_team == 0 ? red_score : 1.0 - red_score;
+            EloChange change;
+            change.m_name = p.first;
+            change.m_old_elo = ps.m_elo;
+            ps.m_elo += (mp.m_team == 0 ? red_change : -red_change) * weight;
+            change.m_new_elo = ps.m_elo;
+            ps.m_form += (change.m_new_elo - change.m_old_elo - ps.m_form) /
+                3.0;
+            ps.m_games++;
+            if (score == 1.0)
+                ps.m_wins++;
+            else if (score == 0.5)
+                ps.m_draws++;
+            else
+                ps.m_losses++;
+            ps.m_goals += mp.m_goals;
+            ps.m_own_goals += mp.m_own_goals;
+            ps.m_missed_games += 1.0 - weight;
+            updated.emplace_back(p.first, ps);
+            if (i == 0)
+                changes.push_back(change);
+        }
+        if (!m_db_path.empty())
+        {
+            addJob([this, updated, mode, match_info]()
+                { save(updated, mode, match_info); });
+        }
+    }
+
+    if (!match.m_team_names[0].empty() && !match.m_team_names[1].empty())
+    {
+        std::vector<std::pair<std::string, TeamStats> > updated;
+        for (int team = 0; team < 2; team++)
+        {
+            TeamStats& ts = m_teams[match.m_team_names[team]];
+            int goals_for = team == 0 ? red_goals : blue_goals;
+            int goals_against = team == 0 ? blue_goals : red_goals;
+            ts.m_games++;
+            ts.m_goals_for += goals_for;
+            ts.m_goals_against += goals_against;
+            if (goals_for > goals_against)
+            {
+                ts.m_wins++;
+                ts.m_points += 3;
+            }
+            else if (goals_for == goals_against)
+            {
+                ts.m_draws++;
+                ts.m_points += 1;
+            }
+            else
+                ts.m_losses++;
+            updated.emplace_back(match.m_team_names[team], ts);
+        }
+        updateStandings();
+        if (!m_db_path.empty())
+        {
+            addJob([this, updated, match, red_goals, blue_goals]()
+                { saveGame(updated, match, red_goals, blue_goals); });
+        }
+    }
+    if (!m_file_path.empty() && !m_file_save_queued.exchange(true))
+        addJob([this]() { saveFile(); });
+    return changes;
+}   // applyResult
+
+// ----------------------------------------------------------------------------
+/** Returns the Elo of a player, 1500 for new players. */
+double SoccerRanking::getElo(RankingMode mode, const std::string& name) const
+{
+    PlayerStats stats;
+    getStats(mode, name, &stats);
+    return stats.m_elo;
+}   // getElo
+
+// ----------------------------------------------------------------------------
+/** \return False if the player has no ranking yet, stats are then the
+ *          ones of a new player. */
+bool SoccerRanking::getStats(RankingMode mode, const std::string& name,
+                             PlayerStats* stats) const
+{
+    *stats = PlayerStats();
+    if (mode >= RM_COUNT)
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_players[mode].find(name);
+    if (it == m_players[mode].end())
+        return false;
+    *stats = it->second;
+    return true;
+}   // getStats
+
+// ----------------------------------------------------------------------------
+bool SoccerRanking::getTeamStats(const std::string& name,
+                                 TeamStats* stats) const
+{
+    *stats = TeamStats();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_teams.find(name);
+    if (it == m_teams.end())
+        return false;
+    *stats = it->second;
+    return true;
+}   // getTeamStats
+
+// ----------------------------------------------------------------------------
+/** Returns the supertournament standings, which are only sorted again when
+ *  a game ends. */
+std::shared_ptr<const SoccerRanking::Standings>
+    SoccerRanking::getStandings() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_standings;
+}   // getStandings
+
+// ----------------------------------------------------------------------------
+/** Sorts the teams by points, goal difference, goals scored and name for
+ *  getStandings, m_mutex must be locked. */
+void SoccerRanking::updateStandings()
+{
+    Standings* standings = new Standings(m_teams.begin(), m_teams.end());
+    std::sort(standings->begin(), standings->end(),
+        [](const std::pair<std::string, TeamStats>& a,
+           const std::pair<std::string, TeamStats>& b)
+        {
+            const TeamStats& ta = a.second;
+            const TeamStats& tb = b.second;
+            if (ta.m_points != tb.m_points)
+                return ta.m_points > tb.m_points;
+            int difference_a = (int)ta.m_goals_for - (int)ta.m_goals_against;
+            int difference_b = (int)tb.m_goals_for - (int)tb.m_goals_against;
+            if (difference_a != difference_b)
+                return difference_a > difference_b;
+            if (ta.m_goals_for != tb.m_goals_for)
+                return ta.m_goals_for > tb.m_goals_for;
+            return a.first < b.first;
+        });
+    m_standings.reset(standings);
+}   // updateStandings
+
+// ----------------------------------------------------------------------------
+/** Reads the Elo of all players from a ranking file of the python scripts.
+ *  The first line is a header, then each line starts with the player name.
+ *  \param column Column of the Elo.
+ *  \return False if the file cannot be opened.
+ */
+bool SoccerRanking::readRankingFile(const std::string& file, unsigned column,
+                              std::unordered_map<std::string, double>* elo)
+{
+    std::ifstream in_file(FileUtils::getPortableReadingPath(file));
+    if (!in_file.is_open())
+        return false;
+    std::string line;
+    // Header
+    std::getline(in_file, line);
+    while (std::getline(in_file, line))
+    {
+        std::vector<std::string> split = StringUtils::split(line, ' ');
+        if (split.size() < 4 || split.size() <= column ||
+            split[1] == "Played_Games")
+            continue;
+        (*elo)[split[0]] = atof(split[column].c_str());
+    }
+    return true;
+}   // readRankingFile
+
+// ----------------------------------------------------------------------------
+/** Imports the Elo of a mode from the ranking file of the python scripts. */
+void SoccerRanking::loadLegacyFile(RankingMode mode)
+{
+    for (const LegacyFile& lf : g_legacy_files)
+    {
+        std::unordered_map<std::string, double> elo;
+        if (lf.m_mode != mode ||
+            !readRankingFile(lf.m_file, lf.m_elo_column, &elo))
+            continue;
+        for (auto& e : elo)
+            m_players[mode][e.first].m_elo = e.second;
+        Log::info("SoccerRanking", "Imported %d %s Elo from %s.",
+            (int)elo.size(), getModeName(mode), lf.m_file);
+    }
+}   // loadLegacyFile
+
+// ----------------------------------------------------------------------------
+/** Returns the Elo of a player from a ranking file written by the python
+ *  scripts when ranking-scripts is on. The file is cached in memory and
+ *  only read again when its modification time or size changed, which is
+ *  checked at most once per second.
+ *  \param column Column of the Elo in the file.
+ */
+double SoccerRanking::getFileElo(const std::string& file, unsigned column,
+                                 const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RankingFile& rf = m_ranking_files[file];
+    uint64_t now = StkTime::getMonoTimeMs();
+    if (rf.m_column != column || rf.m_last_check == 0 ||
+        now - rf.m_last_check >= m_file_check_interval)
+    {
+        rf.m_last_check = std::max<uint64_t>(now, 1);
+        struct stat st;
+        int64_t mtime = -1, size = -1;
+        if (FileUtils::statU8Path(file, &st) == 0)
+        {
+            mtime = (int64_t)st.st_mtime;
+            size = (int64_t)st.st_size;
+        }
+        if (rf.m_column != column || mtime != rf.m_mtime ||
+            size != rf.m_size)
+        {
+            rf.m_column = column;
+            rf.m_mtime = mtime;
+            rf.m_size = size;
+            rf.m_elo.clear();
+            readRankingFile(file, column, &rf.m_elo);
+        }
+    }
+    auto it = rf.m_elo.find(name);
+    return it == rf.m_elo.end() ? 1500.0 : it->second;
+}   // getFileElo
+
+// ----------------------------------------------------------------------------
+/** Loads the rankings from the database, or from the files of the python
+ *  scripts for rankings not in the database yet. Only called on startup.
+ */
+void SoccerRanking::load()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+#ifdef ENABLE_SQLITE3
+    sqlite3* db = NULL;
+    if (!m_db_path.empty() &&
+        sqlite3_open_v2(m_db_path.c_str(), &db, SQLITE_OPEN_READONLY, NULL) ==
+        SQLITE_OK)
+    {
+        const std::string table = ServerConfig::m_ranking_table;
+        std::string query = StringUtils::insertValues(
+            "SELECT mode, username, elo, games, wins, draws, losses, goals, "
+            "own_goals, missed_games FROM %s;", table.c_str());
+        sqlite3_stmt* stmt = NULL;
+        if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) == SQLITE_OK)
+        {
+            while (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                const char* mode_name =
+                    (const char*)sqlite3_column_text(stmt, 0);
+                const char* name = (const char*)sqlite3_column_text(stmt, 1);
+                if (!mode_name || !name)
+                    continue;
+                for (unsigned i = 0; i < RM_COUNT; i++)
+                {
+                    if (std::string(getModeName((RankingMode)i)) != mode_name)
+                        continue;
+                    PlayerStats& ps = m_players[i][name];
+                    ps.m_elo = sqlite3_column_double(stmt, 2);
+                    ps.m_games = sqlite3_column_int(stmt, 3);
+                    ps.m_wins = sqlite3_column_int(stmt, 4);
+                    ps.m_draws = sqlite3_column_int(stmt, 5);
+                    ps.m_losses = sqlite3_column_int(stmt, 6);
+                    ps.m_goals = sqlite3_column_int(stmt, 7);
+                    ps.m_own_goals = sqlite3_column_int(stmt, 8);
+                    ps.m_missed_games = sqlite3_column_double(stmt, 9);
+                }
+            }
+            sqlite3_finalize(stmt);
+        }
+        query = StringUtils::insertValues(
+            "SELECT name, games, wins, draws, losses, goals_for, "
+            "goals_against, points FROM %s_teams;", table.c_str());
+        if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) == SQLITE_OK)
+        {
+            while (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                const char* name = (const char*)sqlite3_column_text(stmt, 0);
+                if (!name)
+                    continue;
+                TeamStats& ts = m_teams[name];
+                ts.m_games = sqlite3_column_int(stmt, 1);
+                ts.m_wins = sqlite3_column_int(stmt, 2);
+                ts.m_draws = sqlite3_column_int(stmt, 3);
+                ts.m_losses = sqlite3_column_int(stmt, 4);
+                ts.m_goals_for = sqlite3_column_int(stmt, 5);
+                ts.m_goals_against = sqlite3_column_int(stmt, 6);
+                ts.m_points = sqlite3_column_int(stmt, 7);
+            }
+            sqlite3_finalize(stmt);
+        }
+    }
+    if (db)
+        sqlite3_close(db);
+#endif
+    if (!m_file_path.empty())
+        loadFile();
+    updateStandings();
+    for (unsigned i = 0; i < RM_COUNT; i++)
+    {
+        if (m_players[i].empty())
+            loadLegacyFile((RankingMode)i);
+    }
+}   // load
+
+// ----------------------------------------------------------------------------
+/** Loads the rankings written by saveFile, m_mutex must be locked. Each line
+ *  is "player", the mode and the statistics, or "team" and the standing,
+ *  separated by tabs and followed by the name.
+ */
+void SoccerRanking::loadFile()
+{
+    std::ifstream in_file(FileUtils::getPortableReadingPath(m_file_path));
+    if (!in_file.is_open())
+        return;
+    std::string line;
+    while (std::getline(in_file, line))
+    {
+        std::vector<std::string> split = StringUtils::split(line, '\t');
+        if (split.size() == 11 && split[0] == "player")
+        {
+            for (unsigned i = 0; i < RM_COUNT; i++)
+            {
+                if (split[1] != getModeName((RankingMode)i))
+                    continue;
+                PlayerStats& ps = m_players[i][split[10]];
+                ps.m_elo = atof(split[2].c_str());
+                ps.m_games = atoi(split[3].c_str());
+                ps.m_wins = atoi(split[4].c_str());
+                ps.m_draws = atoi(split[5].c_str());
+                ps.m_losses = atoi(split[6].c_str());
+                ps.m_goals = atoi(split[7].c_str());
+                ps.m_own_goals = atoi(split[8].c_str());
+                ps.m_missed_games = atof(split[9].c_str());
+            }
+        }
+        else if (split.size() == 9 && split[0] == "team")
+        {
+            TeamStats& ts = m_teams[split[8]];
+            ts.m_games = atoi(split[1].c_str());
+            ts.m_wins = atoi(split[2].c_str());
+            ts.m_draws = atoi(split[3].c_str());
+            ts.m_losses = atoi(split[4].c_str());
+            ts.m_goals_for = atoi(split[5].c_str());
+            ts.m_goals_against = atoi(split[6].c_str());
+            ts.m_points = atoi(split[7].c_str());
+        }
+    }
+}   // loadFile
+
+// ----------------------------------------------------------------------------
+/** Writes all rankings to m_file_path, called by the worker thread. The
+ *  file is replaced at once, so a crash keeps the previous rankings.
+ */
+void SoccerRanking::saveFile()
+{
+    m_file_save_queued.store(false);
+    std::string data;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        char buffer[256];
+        for (unsigned i = 0; i < RM_COUNT; i++)
+        {
+            for (const auto& p : m_players[i])
+            {
+                // Names with a tab or new line cannot be read back
+                if (p.first.find_first_of("\t\r\n") != std::string::npos)
+                    continue;
+                const PlayerStats& ps = p.second;
+                snprintf(buffer, sizeof(buffer),
+                    "player\t%s\t%.17g\t%u\t%u\t%u\t%u\t%u\t%u\t%.17g\t",
+                    getModeName((RankingMode)i), ps.m_elo, ps.m_games,
+                    ps.m_wins, ps.m_draws, ps.m_losses, ps.m_goals,
+                    ps.m_own_goals, ps.m_missed_games);
+                data += buffer + p.first + "\n";
+            }
+        }
+        for (const auto& t : m_teams)
+        {
+            if (t.first.find_first_of("\t\r\n") != std::string::npos)
+                continue;
+            const TeamStats& ts = t.second;
+            snprintf(buffer, sizeof(buffer),
+                "team\t%u\t%u\t%u\t%u\t%u\t%u\t%u\t", ts.m_games,
+                ts.m_wins, ts.m_draws, ts.m_losses, ts.m_goals_for,
+                ts.m_goals_against, ts.m_points);
+            data += buffer + t.first + "\n";
+        }
+    }
+    if (!FileUtils::writeFileAtomic(m_file_path, data))
+    {
+        Log::error("SoccerRanking", "Cannot write %s.",
+            m_file_path.c_str());
+    }
+}   // saveFile
+
+// ----------------------------------------------------------------------------
+#ifdef ENABLE_SQLITE3
+namespace
+{
+    /** Opens the database for the worker thread and creates the ranking
+     *  tables if needed. */
+    sqlite3* openRankingDatabase(const std::string& path)
+    {
+        sqlite3* db = NULL;
+        if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE, NULL) !=
+            SQLITE_OK)
+        {
+            Log::error("SoccerRanking", "Cannot open database: %s.",
+                sqlite3_errmsg(db));
+            sqlite3_close(db);
+            return NULL;
+        }
+        sqlite3_busy_timeout(db, std::max(100,
+            (int)ServerConfig::m_database_timeout));
+        const std::string table = ServerConfig::m_ranking_table;
+        std::string query = StringUtils::insertValues(
+            "CREATE TABLE IF NOT EXISTS %s ("
+            "mode TEXT NOT NULL, username TEXT NOT NULL, elo REAL NOT NULL, "
+            "games INTEGER, wins INTEGER, draws INTEGER, losses INTEGER, "
+            "goals INTEGER, own_goals INTEGER, missed_games REAL, "
+            "PRIMARY KEY (mode, username));"
+            "CREATE TABLE IF NOT EXISTS %s_teams ("
+            "name TEXT NOT NULL PRIMARY KEY, games INTEGER, wins INTEGER, "
+            "draws INTEGER, losses INTEGER, goals_for INTEGER, "
+            "goals_against INTEGER, points INTEGER);"
+            "CREATE TABLE IF NOT EXISTS %s_matches ("
+            "time TIMESTAMP NOT NULL DEFAULT (datetime('now')), "
+            "mode TEXT NOT NULL, result TEXT NOT NULL, players TEXT);"
+            "CREATE TABLE IF NOT EXISTS %s_games ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "time TIMESTAMP NOT NULL DEFAULT (datetime('now')), "
+            "red_team TEXT NOT NULL, blue_team TEXT NOT NULL, "
+            "red_goals INTEGER, blue_goals INTEGER);"
+            "CREATE TABLE IF NOT EXISTS %s_goals ("
+            "game INTEGER NOT NULL, scorer TEXT NOT NULL, team INTEGER, "
+            "own_goal INTEGER, time REAL);",
+            table.c_str(), table.c_str(), table.c_str(), table.c_str(),
+            table.c_str());
+        char* error = NULL;
+        if (sqlite3_exec(db, query.c_str(), NULL, NULL, &error) != SQLITE_OK)
+        {
+            Log::error("SoccerRanking", "Cannot create ranking tables: %s.",
+                error);
+            sqlite3_free(error);
+        }
+        return db;
+    }   // openRankingDatabase
+}   // anonymous namespace
+#endif
+
+// ----------------------------------------------------------------------------
+/** Writes the rankings of the players of a match, called by the worker
+ *  thread. */
+void SoccerRanking::save(
+    const std::vector<std::pair<std::string, PlayerStats> >& players,
+    RankingMode mode, const std::string& match_info)
+{
+#ifdef ENABLE_SQLITE3
+    sqlite3* db = openRankingDatabase(m_db_path);
+    if (!db)
+        return;
+    const std::string table = ServerConfig::m_ranking_table;
+    sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL);
+    std::string query = StringUtils::insertValues(
+        "INSERT OR REPLACE INTO %s (mode, username, elo, games, wins, draws, "
+        "losses, goals, own_goals, missed_games) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", table.c_str());
+    sqlite3_stmt* stmt = NULL;
+    std::string player_list;
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) == SQLITE_OK)
+    {
+        for (auto& p : players)
+        {
+            const PlayerStats& ps = p.second;
+            sqlite3_bind_text(stmt, 1, getModeName(mode), -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 2, p.first.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_double(stmt, 3, ps.m_elo);
+            sqlite3_bind_int(stmt, 4, ps.m_games);
+            sqlite3_bind_int(stmt, 5, ps.m_wins);
+            sqlite3_bind_int(stmt, 6, ps.m_draws);
+            sqlite3_bind_int(stmt, 7, ps.m_losses);
+            sqlite3_bind_int(stmt, 8, ps.m_goals);
+            sqlite3_bind_int(stmt, 9, ps.m_own_goals);
+            sqlite3_bind_double(stmt, 10, ps.m_missed_games);
+            if (sqlite3_step(stmt) != SQLITE_DONE)
+            {
+                Log::error("SoccerRanking", "Cannot save %s: %s.",
+                    p.first.c_str(), sqlite3_errmsg(db));
+            }
+            sqlite3_reset(stmt);
+            if (!player_list.empty())
+                player_list += " ";
+            player_list += p.first;
+        }
+        sqlite3_finalize(stmt);
+    }
+    query = StringUtils::insertValues("INSERT INTO %s_matches "
+        "(mode, result, players) VALUES (?, ?, ?);", table.c_str());
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) == SQLITE_OK)
+    {
+        sqlite3_bind_text(stmt, 1, getModeName(mode), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, match_info.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, player_list.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
+    sqlite3_close(db);
+#endif
+}   // save
+
+// ----------------------------------------------------------------------------
+/** Writes a supertournament game with its goals and the new standings of
+ *  both teams in one transaction, called by the worker thread. */
+void SoccerRanking::saveGame(
+    const std::vector<std::pair<std::string, TeamStats> >& teams,
+    const Match& match, int red_goals, int blue_goals)
+{
+#ifdef ENABLE_SQLITE3
+    sqlite3* db = openRankingDatabase(m_db_path);
+    if (!db)
+        return;
+    const std::string table = ServerConfig::m_ranking_table;
+    bool ok = sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK;
+    std::string query = StringUtils::insertValues(
+        "INSERT OR REPLACE INTO %s_teams (name, games, wins, draws, losses, "
+        "goals_for, goals_against, points) VALUES (?, ?, ?, ?, ?, ?, ?, ?);",
+        table.c_str());
+    sqlite3_stmt* stmt = NULL;
+    if (ok && sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) ==
+        SQLITE_OK)
+    {
+        for (auto& t : teams)
+        {
+            const TeamStats& ts = t.second;
+            sqlite3_bind_text(stmt, 1, t.first.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 2, ts.m_games);
+            sqlite3_bind_int(stmt, 3, ts.m_wins);
+            sqlite3_bind_int(stmt, 4, ts.m_draws);
+            sqlite3_bind_int(stmt, 5, ts.m_losses);
+            sqlite3_bind_int(stmt, 6, ts.m_goals_for);
+            sqlite3_bind_int(stmt, 7, ts.m_goals_against);
+            sqlite3_bind_int(stmt, 8, ts.m_points);
+            ok = ok && sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+    }
+    else
+        ok = false;
+
+    query = StringUtils::insertValues("INSERT INTO %s_games (red_team, "
+        "blue_team, red_goals, blue_goals) VALUES (?, ?, ?, ?);",
+        table.c_str());
+    if (ok && sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) ==
+        SQLITE_OK)
+    {
+        sqlite3_bind_text(stmt, 1, match.m_team_names[0].c_str(), -1,
+            SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, match.m_team_names[1].c_str(), -1,
+            SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, red_goals);
+        sqlite3_bind_int(stmt, 4, blue_goals);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+    }
+    else
+        ok = false;
+
+    const sqlite3_int64 game = sqlite3_last_insert_rowid(db);
+    query = StringUtils::insertValues("INSERT INTO %s_goals (game, scorer, "
+        "team, own_goal, time) VALUES (?, ?, ?, ?, ?);", table.c_str());
+    if (ok && sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) ==
+        SQLITE_OK)
+    {
+        for (const Goal& goal : match.m_goals)
+        {
+            sqlite3_bind_int64(stmt, 1, game);
+            sqlite3_bind_text(stmt, 2, goal.m_scorer.c_str(), -1,
+                SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 3, goal.m_team);
+            sqlite3_bind_int(stmt, 4, goal.m_own_goal ? 1 : 0);
+            sqlite3_bind_double(stmt, 5, goal.m_time);
+            ok = ok && sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+    }
+    else
+        ok = false;
+
+    if (ok)
+        ok = sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL) == SQLITE_OK;
+    if (!ok)
+    {
+        Log::error("SoccerRanking", "Cannot save game %s - %s: %s.",
+            match.m_team_names[0].c_str(), match.m_team_names[1].c_str(),
+            sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+    }
+    sqlite3_close(db);
+#endif
+}   // saveGame
+
+// ----------------------------------------------------------------------------
+void SoccerRanking::unitTesting()
+{
+    assert(getExpectedScore(1500.0, 1500.0) == 0.5);
+    assert(std::fabs(getExpectedScore(1900.0, 1500.0) - 0.909) < 0.001);
+    assert(getGoalDifferenceFactor(-1) == 1.0);
+    assert(getGoalDifferenceFactor(2) == 1.5);
+    assert(getGoalDifferenceFactor(5) == 2.0);
+#ifndef WIN32
+    assert(escapeArgument("player") == "'player'");
+    assert(escapeArgument("a b;rm -rf ~") == "'a b;rm -rf ~'");
+    assert(escapeArgument("it's") == "'it'\\''s'");
+#endif
+
+    SoccerRanking* ranking = new SoccerRanking("");
+    std::vector<RankingMode> modes;
+    modes.push_back(RM_1VS1);
+
+    // 1vs1 between new players, the winner gets half of the k factor
+    ranking->startMatch(modes);
+    ranking->addPlayer("alice", 0);
+    ranking->addPlayer("bob", 1);
+    ranking->addGoal("alice", false);
+    ranking->addGoal("bob", true);
+    std::vector<EloChange> changes = ranking->endMatch(2, 1);
+    assert(changes.size() == 2);
+    assert(!ranking->isMatchRunning());
+    assert(std::fabs(ranking->getElo(RM_1VS1, "alice") - 1500.0 -
+        (float)ServerConfig::m_ranking_k_factor / 2.0) < 1e-9);
+    assert(std::fabs(ranking->getElo(RM_1VS1, "bob") - 1500.0 +
+        (float)ServerConfig::m_ranking_k_factor / 2.0) < 1e-9);
+    PlayerStats stats;
+    assert(ranking->getStats(RM_1VS1, "alice", &stats));
+    assert(stats.m_games == 1 && stats.m_wins == 1 && stats.m_goals == 1);
+    assert(ranking->getStats(RM_1VS1, "bob", &stats));
+    assert(stats.m_losses == 1 && stats.m_own_goals == 1);
+    assert(std::fabs(stats.m_form * 3.0 - stats.m_elo + 1500.0) < 1e-9);
+    assert(!ranking->getStats(RM_1VS1_2, "alice", &stats));
+
+    // Elo is zero sum in a team match, a player who played half of the
+    // match gets half of the change
+    modes.clear();
+    modes.push_back(RM_SOCCER);
+    modes.push_back(RM_3VS3);
+    ranking->startMatch(modes, "Reds", "Blues");
+    ranking->addPlayer("alice", 0);
+    ranking->addPlayer("bob", 0);
+    ranking->addPlayer("carol", 1);
+    ranking->addPlayer("dave", 1, 0.5);
+    ranking->removePlayer("bob", 0.5);
+    changes = ranking->endMatch(0, 3);
+    assert(changes.size() == 4);
+    double sum = 0.0;
+    for (const EloChange& c : changes)
+        sum += c.m_new_elo - 1500.0;
+    assert(std::fabs(sum) < 1e-9);
+    assert(ranking->getElo(RM_SOCCER, "alice") < 1500.0);
+    assert(std::fabs(ranking->getElo(RM_SOCCER, "bob") * 2.0 -
+        ranking->getElo(RM_SOCCER, "alice") - 1500.0) < 1e-9);
+    assert(ranking->getStats(RM_3VS3, "dave", &stats));
+    assert(stats.m_wins == 1 && stats.m_missed_games == 0.5);
+    // The 1vs1 ranking is not changed by other modes
+    assert(std::fabs(ranking->getElo(RM_1VS1, "alice") - 1500.0 -
+        (float)ServerConfig::m_ranking_k_factor / 2.0) < 1e-9);
+
+    TeamStats team;
+    assert(ranking->getTeamStats("Blues", &team));
+    assert(team.m_wins == 1 && team.m_points == 3 && team.m_goals_for == 3);
+    assert(ranking->getTeamStats("Reds", &team));
+    assert(team.m_losses == 1 && team.m_points == 0);
+
+    // The standings are sorted once per game and kept by readers
+    std::shared_ptr<const Standings> standings = ranking->getStandings();
+    assert(standings->size() == 2 && (*standings)[0].first == "Blues");
+    ranking->startMatch(modes, "Greens", "Reds");
+    ranking->addPlayer("alice", 0);
+    ranking->addPlayer("carol", 1);
+    ranking->addGoal("alice", false, 10.0f);
+    ranking->endMatch(1, 1);
+    assert(standings->size() == 2);
+    standings = ranking->getStandings();
+    assert(standings->size() == 3);
+    assert((*standings)[0].first == "Blues");
+    assert((*standings)[1].first == "Greens");
+    assert((*standings)[2].first == "Reds");
+
+    // Matches rated directly don't change the current match
+    ranking->startMatch(modes);
+    std::vector<std::string> red, blue;
+    red.push_back("erin");
+    blue.push_back("frank");
+    changes = ranking->rateMatch(RM_SUPER_1VS1_QUALI, red, blue, 0, 0);
+    assert(changes.size() == 2 && changes[0].m_new_elo == 1500.0);
+    assert(ranking->isMatchRunning());
+    assert(ranking->getStats(RM_SUPER_1VS1_QUALI, "frank", &stats));
+    assert(stats.m_draws == 1);
+
+    // Not ranked without an opponent
+    ranking->startMatch(modes);
+    ranking->addPlayer("alice", 0);
+    assert(ranking->endMatch(1, 0).empty());
+
+    // Commands run in order on the worker thread
+    std::vector<int>* order = new std::vector<int>();
+    for (int i = 0; i < 10; i++)
+        ranking->addJob([order, i]() { order->push_back(i); });
+    ranking->waitForJobs();
+    for (int i = 0; i < 10; i++)
+        assert((*order)[i] == i);
+    delete order;
+
+    // Ranking files are cached until they change
+    ranking->m_file_check_interval = 0;
+    const std::string file =
+        file_manager->getUserConfigFile("soccer_ranking_test.txt");
+    std::ofstream out(file);
+    out << "Name Elo Played_Games Wins\n";
+    out << "alice 1600 10 5\n";
+    out << "bob 1450.5 3 1\n";
+    out.close();
+    assert(ranking->getFileElo(file, 1, "alice") == 1600.0);
+    assert(ranking->getFileElo(file, 1, "bob") == 1450.5);
+    assert(ranking->getFileElo(file, 1, "carol") == 1500.0);
+    assert(ranking->getFileElo(file, 3, "alice") == 5.0);
+    out.open(file);
+    out << "Name Elo Played_Games Wins\n";
+    out << "alice 1700 11 6\n";
+    // Different size, the file may be written in the same second
+    out << "carol 1400 10 0\n";
+    out.close();
+    assert(ranking->getFileElo(file, 1, "alice") == 1700.0);
+    assert(ranking->getFileElo(file, 1, "bob") == 1500.0);
+    assert(ranking->getFileElo(file, 1, "carol") == 1400.0);
+    remove(file.c_str());
+    delete ranking;
+
+    // Without database the rankings are saved to a file and loaded back
+    ranking = new SoccerRanking("", file);
+    ranking->rateMatch(RM_3VS3, { "alice", "bob" }, { "carol" }, 2, 1);
+    ranking->startMatch(modes, "Red Team", "Blue Team");
+    ranking->addPlayer("alice", 0);
+    ranking->addPlayer("carol", 1);
+    ranking->endMatch(0, 0);
+    ranking->waitForJobs();
+    PlayerStats saved;
+    ranking->getStats(RM_3VS3, "alice", &saved);
+    delete ranking;
+    ranking = new SoccerRanking("", file);
+    ranking->load();
+    PlayerStats loaded;
+    assert(ranking->getStats(RM_3VS3, "alice", &loaded));
+    assert(loaded.m_elo == saved.m_elo && loaded.m_games == 1 &&
+           loaded.m_wins == 1);
+    assert(ranking->getStats(RM_1VS1, "carol", &loaded) &&
+           loaded.m_draws == 1);
+    TeamStats team_stats;
+    assert(ranking->getTeamStats("Red Team", &team_stats) &&
+           team_stats.m_points == 1);
+    remove(file.c_str());
+    delete ranking;
+}   // unitTesting
@@ -0,0 +1,296 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_SOCCER_RANKING_HPP
+#define HEADER_SOCCER_RANKING_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/** \ingroup network
+ *  Elo ranking and statistics of the ranked soccer modes (1vs1, 3vs3, ranked
+ *  soccer, supertournament qualifications and games). The rankings are kept
+ *  in memory and updated right when a match ends, writing them to the
+ *  database (or to a file without database) and running external scripts
+ *  is done in order on a worker thread, so the game and lobby threads never
+ *  wait for the disk or a child process.
+ *  Supertournament games are also stored with their goals and scorers, and
+ *  the sorted team standings are cached until the next game ends.
+ */
+class SoccerRanking : public NoCopy
+{
+public:
+    enum RankingMode : unsigned
+    {
+        RM_1VS1 = 0,
+        RM_1VS1_2,
+        RM_1VS1_3,
+        RM_3VS3,
+        RM_SOCCER,
+        RM_SUPER_MP_QUALI,
+        RM_SUPER_MP_QUALI2,
+        RM_SUPER_1VS1_QUALI,
+        RM_SUPER_2VS2_QUALI,
+        RM_COUNT
+    };
+
+    struct PlayerStats
+    {
+        double   m_elo;
+        unsigned m_games;
+        unsigned m_wins;
+        unsigned m_draws;
+        unsigned m_losses;
+        unsigned m_goals;
+        unsigned m_own_goals;
+        /** Sum of the part of the matches missed by leaving or live
+         *  joining. */
+        double   m_missed_games;
+        /** Moving average of the Elo changes of the recent matches, only
+         *  kept in memory. */
+        double   m_form;
+        // --------------------------------------------------------------------
+        PlayerStats() : m_elo(1500.0), m_games(0), m_wins(0), m_draws(0),
+                        m_losses(0), m_goals(0), m_own_goals(0),
+                        m_missed_games(0.0), m_form(0.0) {}
+    };
+
+    struct TeamStats
+    {
+        unsigned m_games;
+        unsigned m_wins;
+        unsigned m_draws;
+        unsigned m_losses;
+        unsigned m_goals_for;
+        unsigned m_goals_against;
+        unsigned m_points;
+        // --------------------------------------------------------------------
+        TeamStats() : m_games(0), m_wins(0), m_draws(0), m_losses(0),
+                      m_goals_for(0), m_goals_against(0), m_points(0) {}
+    };
+
+    /** Teams sorted by points, goal difference and goals scored. */
+    typedef std::vector<std::pair<std::string, TeamStats> > Standings;
+
+    /** Elo of a player before and after a match. */
+    struct EloChange
+    {
+        std::string m_name;
+        double      m_old_elo;
+        double      m_new_elo;
+    };
+
+private:
+    struct MatchPlayer
+    {
+        /** 0 for red, 1 for blue. */
+        int      m_team;
+        /** Part of the match played before joining, in [0, 1]. */
+        double   m_joined;
+        /** Part of the match played when leaving, 1 if not left. */
+        double   m_left;
+        unsigned m_goals;
+        unsigned m_own_goals;
+    };
+
+    struct Goal
+    {
+        std::string m_scorer;
+        /** Team of the scorer, 0 for red, 1 for blue. */
+        int         m_team;
+        bool        m_own_goal;
+        /** Time since the start of the match in seconds. */
+        float       m_time;
+    };
+
+    struct Match
+    {
+        std::vector<RankingMode>           m_modes;
+        std::map<std::string, MatchPlayer> m_players;
+        std::vector<Goal>                  m_goals;
+        /** Team names for supertournament games, empty otherwise. */
+        std::string                        m_team_names[2];
+        bool                               m_running;
+        // --------------------------------------------------------------------
+        Match() : m_running(false) {}
+    };
+
+    /** Elo read from a ranking file of the python scripts. */
+    struct RankingFile
+    {
+        unsigned m_column;
+        int64_t  m_mtime;
+        int64_t  m_size;
+        /** Time of the last modification check, 0 if never checked. */
+        uint64_t m_last_check;
+        std::unordered_map<std::string, double> m_elo;
+        // --------------------------------------------------------------------
+        RankingFile() : m_column(0), m_mtime(-1), m_size(-1),
+                        m_last_check(0) {}
+    };
+
+    static SoccerRanking* m_soccer_ranking;
+
+    /** Protects the rankings and the current match, which are used from
+     *  the main thread (goals) and the lobby thread. */
+    mutable std::mutex m_mutex;
+
+    std::unordered_map<std::string, PlayerStats> m_players[RM_COUNT];
+
+    std::unordered_map<std::string, TeamStats> m_teams;
+
+    /** Sorted m_teams, replaced (not changed) when a game ends so readers
+     *  can keep it without locking. */
+    std::shared_ptr<const Standings> m_standings;
+
+    /** Ranking files indexed by their name. */
+    std::map<std::string, RankingFile> m_ranking_files;
+
+    /** Minimum time between two checks if a ranking file changed. */
+    uint64_t m_file_check_interval;
+
+    Match m_match;
+
+    /** Jobs (database writes and external commands) run in order by the
+     *  worker thread. */
+    std::deque<std::function<void()> > m_jobs;
+
+    std::mutex m_jobs_mutex;
+
+    std::condition_variable m_jobs_cv;
+
+    std::atomic_bool m_stop;
+
+    std::thread m_worker;
+
+    /** Path to the sqlite database, empty without sql-management. */
+    std::string m_db_path;
+
+    /** File storing the rankings when there is no database, empty if they
+     *  are only kept in memory. */
+    std::string m_file_path;
+
+    /** True if saveFile is queued and not started yet, so a single write
+     *  covers the matches ended meanwhile. */
+    std::atomic_bool m_file_save_queued;
+
+    SoccerRanking(const std::string& db_path,
+                  const std::string& file_path = "");
+    // ------------------------------------------------------------------------
+    ~SoccerRanking();
+    // ------------------------------------------------------------------------
+    void workerLoop();
+    // ------------------------------------------------------------------------
+    void addJob(const std::function<void()>& job);
+    // ------------------------------------------------------------------------
+    void load();
+    // ------------------------------------------------------------------------
+    void loadLegacyFile(RankingMode mode);
+    // ------------------------------------------------------------------------
+    void loadFile();
+    // ------------------------------------------------------------------------
+    void saveFile();
+    // ------------------------------------------------------------------------
+    static bool readRankingFile(const std::string& file, unsigned column,
+                                std::unordered_map<std::string, double>* elo);
+    // ------------------------------------------------------------------------
+    void save(const std::vector<std::pair<std::string, PlayerStats> >& players,
+              RankingMode mode, const std::string& match_info);
+    // ------------------------------------------------------------------------
+    void saveGame(const std::vector<std::pair<std::string, TeamStats> >& teams,
+                  const Match& match, int red_goals, int blue_goals);
+    // ------------------------------------------------------------------------
+    void updateStandings();
+    // ------------------------------------------------------------------------
+    std::vector<EloChange> applyResult(const Match& match, int red_goals,
+                                       int blue_goals);
+
+public:
+    static double getExpectedScore(double elo, double opponent_elo);
+    // ------------------------------------------------------------------------
+    static double getGoalDifferenceFactor(int goal_difference);
+    // ------------------------------------------------------------------------
+    static const char* getModeName(RankingMode mode);
+    // ------------------------------------------------------------------------
+    static std::vector<RankingMode> getServerModes();
+    // ------------------------------------------------------------------------
+    static void create();
+    // ------------------------------------------------------------------------
+    static void destroy();
+    // ------------------------------------------------------------------------
+    /** Returns the ranking, NULL if it is not created (not a server). */
+    static SoccerRanking* get()                     { return m_soccer_ranking; }
+    // ------------------------------------------------------------------------
+    static std::string escapeArgument(const std::string& arg);
+    // ------------------------------------------------------------------------
+    void runCommand(const std::string& command);
+    // ------------------------------------------------------------------------
+    void copyFile(const std::string& source, const std::string& dest);
+    // ------------------------------------------------------------------------
+    void startMatch(const std::vector<RankingMode>& modes,
+                    const std::string& red_team_name = "",
+                    const std::string& blue_team_name = "");
+    // ------------------------------------------------------------------------
+    void addPlayer(const std::string& name, int team, double phase = 0.0);
+    // ------------------------------------------------------------------------
+    void removePlayer(const std::string& name, double phase);
+    // ------------------------------------------------------------------------
+    void addGoal(const std::string& name, bool own_goal, float time = 0.0f);
+    // ------------------------------------------------------------------------
+    std::vector<EloChange> endMatch(int red_goals, int blue_goals);
+    // ------------------------------------------------------------------------
+    void cancelMatch();
+    // ------------------------------------------------------------------------
+    std::vector<EloChange> rateMatch(RankingMode mode,
+                                     const std::vector<std::string>& red_players,
+                                     const std::vector<std::string>& blue_players,
+                                     int red_goals, int blue_goals);
+    // ------------------------------------------------------------------------
+    bool isMatchRunning() const;
+    // ------------------------------------------------------------------------
+    double getElo(RankingMode mode, const std::string& name) const;
+    // ------------------------------------------------------------------------
+    bool getStats(RankingMode mode, const std::string& name,
+                  PlayerStats* stats) const;
+    // ------------------------------------------------------------------------
+    bool getTeamStats(const std::string& name, TeamStats* stats) const;
+    // ------------------------------------------------------------------------
+    std::shared_ptr<const Standings> getStandings() const;
+    // ------------------------------------------------------------------------
+    double getFileElo(const std::string& file, unsigned column,
+                      const std::string& name);
+    // ------------------------------------------------------------------------
+    void waitForJobs();
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class SoccerRanking
+
+#endif
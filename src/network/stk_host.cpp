@@ -29,6 +29,7 @@
 #include "network/network_player_profile.hpp"
 #include "network/network_string.hpp"
 #include "network/network_timer_synchronizer.hpp"
+#include "network/packet_capture.hpp"
 #include "network/protocols/connect_to_peer.hpp"
 #include "network/protocols/server_lobby.hpp"
 #include "network/protocol_manager.hpp"
@@ -73,6 +74,7 @@
 
 STKHost *STKHost::m_stk_host[PT_COUNT];
 bool     STKHost::m_enable_console = false;
+bool     STKHost::m_packet_replay = false;
 
 std::shared_ptr<LobbyProtocol> STKHost::create(ChildLoop* cl)
 {
@@ -98,7 +100,7 @@ std::shared_ptr<LobbyProtocol> STKHost::create(ChildLoop* cl)
         m_stk_host[pt]->m_client_loop_thread = std::thread(
             std::bind(&ChildLoop::run, cl));
     }
-    if (!m_stk_host[pt]->m_network)
+    if (!m_stk_host[pt]->m_network && !m_packet_replay)
     {
         delete m_stk_host[pt];
         m_stk_host[pt] = NULL;
@@ -262,6 +264,21 @@ STKHost::STKHost(bool server)
     init();
     m_host_id = std::numeric_limits<uint32_t>::max();
 
+    if (server && m_packet_replay)
+    {
+        Log::info("STKHost", "Server is driven by a packet replay, no socket "
+            "is opened.");
+        return;
+    }
+    if (server && !std::string(ServerConfig::m_packet_capture).empty())
+    {
+        m_packet_capture.reset(new PacketCapture(
+            ServerConfig::getConfigDirectory() + "/" +
+            std::string(ServerConfig::m_packet_capture)));
+        if (!m_packet_capture->isOpen())
+            m_packet_capture.reset();
+    }
+
     ENetAddress addr = {};
     if (server)
     {
@@ -332,7 +349,7 @@ void STKHost::init()
 
     Log::info("STKHost", "Host initialized.");
     Network::openLog();  // Open packet log file
-    ProtocolManager::createInstance();
+    ProtocolManager::createInstance(/*use_threads*/!m_packet_replay);
 
     // Optional: start the network console
     if (m_enable_console)
@@ -766,6 +783,8 @@ void STKHost::setErrorMessage(const irr::core::stringw &message)
  */
 void STKHost::startListening()
 {
+    if (m_packet_replay)
+        return;
     m_exit_timeout.store(std::numeric_limits<uint64_t>::max());
     m_listening_thread = std::thread(std::bind(&STKHost::mainLoop, this,
         STKProcess::getType()));
@@ -886,6 +905,11 @@ void STKHost::mainLoop(ProcessType pt)
                     // Set packet loss before enet command, so if the peer is
                     // disconnected later the loss won't be cleared
                     p.second->setPacketLoss(p.first->packetLoss);
+                    if (m_packet_capture)
+                    {
+                        m_packet_capture->addPeerStats(p.second.get(),
+                            p.first->roundTripTime, p.first->packetLoss);
+                    }
                     const unsigned ap = p.second->getAveragePing();
                     const unsigned max_ping = ServerConfig::m_max_ping;
                     if (p.second->isValidated() &&
@@ -1092,7 +1116,7 @@ void STKHost::mainLoop(ProcessType pt)
             }   // ENET_EVENT_TYPE_CONNECT
             else if (event.type == ENET_EVENT_TYPE_DISCONNECT)
             {
-                Log::flushBuffers();
+                Log::requestFlush();
 
                 // If used a timeout waiting disconnect, exit now
                 if (m_exit_timeout.load() !=
@@ -1211,6 +1235,9 @@ void STKHost::mainLoop(ProcessType pt)
 #endif
             }   // if message event
 
+            if (m_packet_capture)
+                m_packet_capture->addEvent(stk_event, event.channelID);
+
             // notify for the event now.
             auto pm = ProtocolManager::lock();
             if (pm && !pm->isExiting())
@@ -1630,5 +1657,5 @@ void STKHost::sendRawPacket(const BareNetworkString &buffer,
 // ----------------------------------------------------------------------------
 uint16_t STKHost::getPrivatePort() const
 {
-    return m_network->getPort();
+    return m_network ? m_network->getPort() : 0;
 }  // getPrivatePort
@@ -57,6 +57,7 @@ class NetworkTimerSynchronizer;
 class Server;
 class ServerLobby;
 class ChildLoop;
+class PacketCapture;
 class SocketAddress;
 class STKPeer;
 
@@ -157,6 +158,13 @@ private:
 
     std::unique_ptr<NetworkTimerSynchronizer> m_nts;
 
+    /** Records the game packets if enabled in the server config. */
+    std::unique_ptr<PacketCapture> m_packet_capture;
+
+    /** Feeds the events of a capture and handles the enet commands instead
+     *  of the listening thread. */
+    friend class PacketReplay;
+
     // ------------------------------------------------------------------------
     STKHost(bool server);
     // ------------------------------------------------------------------------
@@ -176,6 +184,10 @@ public:
     /** If a network console should be started. */
     static bool m_enable_console;
 
+    /** If the server is driven by a PacketReplay: no socket is opened and
+     *  the listening and protocol manager threads are not started. */
+    static bool m_packet_replay;
+
     /** Creates the STKHost. It takes all confifguration parameters from
      *  NetworkConfig. This STKHost can either be a client or a server.
      */
@@ -286,6 +298,8 @@ public:
     // ------------------------------------------------------------------------
     void setErrorMessage(const irr::core::stringw &message);
     // ------------------------------------------------------------------------
+    PacketCapture* getPacketCapture() const { return m_packet_capture.get(); }
+    // ------------------------------------------------------------------------
     void addEnetCommand(ENetPeer* peer, ENetPacket* packet, uint32_t i,
                         ENetCommandType ect, ENetAddress ea)
     {
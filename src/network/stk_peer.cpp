@@ -24,6 +24,7 @@
 #include "network/network.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
+#include "network/packet_capture.hpp"
 #include "network/socket_address.hpp"
 #include "network/stk_ipv6.hpp"
 #include "network/stk_host.hpp"
@@ -54,6 +55,9 @@ STKPeer::STKPeer(ENetPeer *enet_peer, STKHost* host, uint32_t host_id)
     m_last_activity.store((int64_t)StkTime::getMonoTimeMs());
     m_last_message.store(0);
     m_angry_host.store(false);
+    m_state_bytes_sent.store(0);
+    m_state_bytes_full.store(0);
+    m_state_rate.store(0);
     m_consecutive_messages = 0;
 }   // STKPeer
 
@@ -106,6 +110,9 @@ void STKPeer::sendPacket(NetworkString *data, bool reliable, bool encrypted)
     if (m_disconnected.load())
         return;
 
+    if (PacketCapture* capture = m_host->getPacketCapture())
+        capture->addSent(this, data, reliable);
+
     ENetPacket* packet = NULL;
     if (m_crypto && encrypted)
     {
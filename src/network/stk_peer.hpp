@@ -126,6 +126,16 @@ protected:
     std::array<int, AS_TOTAL> m_addons_scores;
 
     std::atomic_bool m_angry_host;
+
+    /** Bytes of game states sent to this peer, and the bytes the full
+     *  unfiltered states would have used. */
+    std::atomic<uint64_t> m_state_bytes_sent;
+
+    std::atomic<uint64_t> m_state_bytes_full;
+
+    /** Bandwidth in bytes per second for game states chosen by the rate
+     *  control, 0 if it is not used. */
+    std::atomic<uint32_t> m_state_rate;
 public:
     STKPeer(ENetPeer *enet_peer, STKHost* host, uint32_t host_id);
     // ------------------------------------------------------------------------
@@ -270,6 +280,20 @@ public:
     // ------------------------------------------------------------------------
     int getPacketLoss() const                  { return m_packet_loss.load(); }
     // ------------------------------------------------------------------------
+    void addStateBytes(uint64_t sent, uint64_t full)
+    {
+        m_state_bytes_sent.fetch_add(sent);
+        m_state_bytes_full.fetch_add(full);
+    }
+    // ------------------------------------------------------------------------
+    uint64_t getStateBytesSent() const    { return m_state_bytes_sent.load(); }
+    // ------------------------------------------------------------------------
+    uint64_t getStateBytesFull() const    { return m_state_bytes_full.load(); }
+    // ------------------------------------------------------------------------
+    void setStateRate(uint32_t rate)               { m_state_rate.store(rate); }
+    // ------------------------------------------------------------------------
+    uint32_t getStateRate() const                { return m_state_rate.load(); }
+    // ------------------------------------------------------------------------
     // next four lines are kimden's part, delete them when it's possible
     // to limit players by addon number
     int addon_karts_count = 0;
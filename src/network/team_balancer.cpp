@@ -0,0 +1,344 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/team_balancer.hpp"
+
+#include "network/server_config.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+namespace
+{
+    /** Fills the sums and numbers of players of all subsets of values. */
+    void getSubsetSums(const double* values, unsigned count,
+                       std::vector<double>* sums,
+                       std::vector<uint8_t>* sizes)
+    {
+        const uint32_t subsets = 1u << count;
+        sums->resize(subsets);
+        sizes->resize(subsets);
+        (*sums)[0] = 0.0;
+        (*sizes)[0] = 0;
+        for (uint32_t mask = 1; mask < subsets; mask++)
+        {
+            unsigned lowest = 0;
+            while ((mask & (1u << lowest)) == 0)
+                lowest++;
+            const uint32_t rest = mask & (mask - 1);
+            (*sums)[mask] = (*sums)[rest] + values[lowest];
+            (*sizes)[mask] = (*sizes)[rest] + 1;
+        }
+    }   // getSubsetSums
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Returns the rating used to balance a player, the Elo lowered for a
+ *  handicap and adjusted by the recent form as set in the server config. */
+double TeamBalancer::getRating(const Player& player)
+{
+    double rating = player.m_elo;
+    if (player.m_handicap)
+        rating -= (float)ServerConfig::m_balance_handicap_elo;
+    rating += player.m_form * (float)ServerConfig::m_balance_form_weight;
+    return rating;
+}   // getRating
+
+// ----------------------------------------------------------------------------
+/** Returns the absolute difference of the rating sums of both teams. */
+double TeamBalancer::getDifference(const std::vector<double>& ratings,
+                                   const std::vector<bool>& red)
+{
+    double difference = 0.0;
+    for (unsigned i = 0; i < ratings.size(); i++)
+        difference += red[i] ? ratings[i] : -ratings[i];
+    return std::abs(difference);
+}   // getDifference
+
+// ----------------------------------------------------------------------------
+/** Puts the strongest remaining player in the weaker team as long as it is
+ *  not full, then swaps the two players which balance the teams most until
+ *  no swap helps or the deadline is reached.
+ */
+std::vector<bool> TeamBalancer::splitGreedy(const std::vector<double>& ratings,
+                                            uint64_t deadline)
+{
+    const unsigned n = (unsigned)ratings.size();
+    const unsigned red_size = n / 2;
+    std::vector<unsigned> order(n);
+    for (unsigned i = 0; i < n; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+        [&ratings](unsigned a, unsigned b) { return ratings[a] > ratings[b]; });
+
+    std::vector<bool> red(n, false);
+    std::vector<unsigned> red_players, blue_players;
+    double red_sum = 0.0, blue_sum = 0.0;
+    for (unsigned i : order)
+    {
+        bool to_red = red_players.size() < red_size &&
+            (red_sum < blue_sum || blue_players.size() >= n - red_size);
+        if (to_red)
+        {
+            red[i] = true;
+            red_players.push_back(i);
+            red_sum += ratings[i];
+        }
+        else
+        {
+            blue_players.push_back(i);
+            blue_sum += ratings[i];
+        }
+    }
+
+    while (StkTime::getMonoTimeMs() < deadline)
+    {
+        const double difference = red_sum - blue_sum;
+        double best = std::abs(difference);
+        unsigned best_red = 0, best_blue = 0;
+        for (unsigned r = 0; r < red_players.size(); r++)
+        {
+            for (unsigned b = 0; b < blue_players.size(); b++)
+            {
+                double change = ratings[red_players[r]] -
+                    ratings[blue_players[b]];
+                double swapped = std::abs(difference - 2.0 * change);
+                if (swapped < best)
+                {
+                    best = swapped;
+                    best_red = r;
+                    best_blue = b;
+                }
+            }
+        }
+        if (best >= std::abs(difference))
+            break;
+        unsigned r = red_players[best_red];
+        unsigned b = blue_players[best_blue];
+        red[r] = false;
+        red[b] = true;
+        red_sum += ratings[b] - ratings[r];
+        blue_sum += ratings[r] - ratings[b];
+        red_players[best_red] = b;
+        blue_players[best_blue] = r;
+    }
+    return red;
+}   // splitGreedy
+
+// ----------------------------------------------------------------------------
+/** Finds the best split by meet-in-the-middle: the sums of all subsets of
+ *  the second half of the players are sorted by size and sum, then for each
+ *  subset of the first half a binary search finds the subset of the second
+ *  half completing the red team closest to half of the total.
+ *  \param red The split to improve, replaced if a better one is found.
+ *  \return False if the deadline was reached before searching all splits.
+ */
+bool TeamBalancer::splitExact(const std::vector<double>& ratings,
+                              uint64_t deadline, std::vector<bool>* red)
+{
+    const unsigned n = (unsigned)ratings.size();
+    assert(n <= MAX_EXACT_PLAYERS);
+    const unsigned red_size = n / 2;
+    const unsigned left_count = n / 2;
+    const unsigned right_count = n - left_count;
+
+    std::vector<double> left_sums, right_sums;
+    std::vector<uint8_t> left_sizes, right_sizes;
+    getSubsetSums(ratings.data(), left_count, &left_sums, &left_sizes);
+    getSubsetSums(ratings.data() + left_count, right_count, &right_sums,
+        &right_sizes);
+
+    std::vector<std::vector<std::pair<double, uint32_t> > >
+        right_by_size(right_count + 1);
+    for (uint32_t mask = 0; mask < right_sums.size(); mask++)
+    {
+        right_by_size[right_sizes[mask]].emplace_back(right_sums[mask],
+            mask);
+    }
+    for (auto& subsets : right_by_size)
+        std::sort(subsets.begin(), subsets.end());
+
+    double total = 0.0;
+    for (double rating : ratings)
+        total += rating;
+    const double half = total / 2.0;
+
+    double best = getDifference(ratings, *red);
+    uint32_t best_left = 0, best_right = 0;
+    bool found = false, finished = true;
+    for (uint32_t mask = 0; mask < left_sums.size(); mask++)
+    {
+        if ((mask & 1023) == 1023 && StkTime::getMonoTimeMs() >= deadline)
+        {
+            finished = false;
+            break;
+        }
+        if (left_sizes[mask] > red_size ||
+            red_size - left_sizes[mask] > right_count)
+            continue;
+        const auto& subsets = right_by_size[red_size - left_sizes[mask]];
+        const double wanted = half - left_sums[mask];
+        auto it = std::lower_bound(subsets.begin(), subsets.end(),
+            std::make_pair(wanted, (uint32_t)0));
+        // Check the closest sums below and above the wanted one
+        for (int j = 0; j < 2; j++)
+        {
+            if (j == 0 && it == subsets.end())
+                continue;
+            if (j == 1 && it == subsets.begin())
+                continue;
+            const auto& subset = j == 0 ? *it : *(it - 1);
+            double difference =
+                std::abs(2.0 * (left_sums[mask] + subset.first) - total);
+            if (difference < best)
+            {
+                best = difference;
+                best_left = mask;
+                best_right = subset.second;
+                found = true;
+            }
+        }
+        if (best == 0.0)
+            break;
+    }
+
+    if (found)
+    {
+        for (unsigned i = 0; i < left_count; i++)
+            (*red)[i] = (best_left & (1u << i)) != 0;
+        for (unsigned i = 0; i < right_count; i++)
+            (*red)[left_count + i] = (best_right & (1u << i)) != 0;
+    }
+    return finished;
+}   // splitExact
+
+// ----------------------------------------------------------------------------
+/** Splits players in two teams with the closest rating sums.
+ *  \param ratings Rating of each player.
+ *  \param time_budget_ms Maximum time of the search, the best split found
+ *         so far is used when it is reached.
+ *  \return For each player true if they are in the red team, which has n / 2
+ *          players.
+ */
+std::vector<bool> TeamBalancer::split(const std::vector<double>& ratings,
+                                      unsigned time_budget_ms)
+{
+    const uint64_t deadline = StkTime::getMonoTimeMs() + time_budget_ms;
+    std::vector<bool> red = splitGreedy(ratings, deadline);
+    if (ratings.size() <= MAX_EXACT_PLAYERS &&
+        getDifference(ratings, red) > 0.0 &&
+        !splitExact(ratings, deadline, &red))
+    {
+        Log::warn("TeamBalancer", "Balancing %d players took longer than "
+            "%dms, teams may not be the most balanced.", (int)ratings.size(),
+            time_budget_ms);
+    }
+    return red;
+}   // split
+
+// ----------------------------------------------------------------------------
+/** Creates the most balanced teams of players, using the rating of
+ *  getRating and the time budget of the server config.
+ */
+void TeamBalancer::createTeams(const std::vector<Player>& players,
+                               std::vector<std::string>* red_team,
+                               std::vector<std::string>* blue_team)
+{
+    std::vector<double> ratings;
+    for (const Player& player : players)
+        ratings.push_back(getRating(player));
+    int budget = ServerConfig::m_balance_time_budget;
+    std::vector<bool> red = split(ratings, (unsigned)std::max(budget, 0));
+    for (unsigned i = 0; i < players.size(); i++)
+    {
+        if (red[i])
+            red_team->push_back(players[i].m_name);
+        else
+            blue_team->push_back(players[i].m_name);
+    }
+}   // createTeams
+
+// ----------------------------------------------------------------------------
+void TeamBalancer::unitTesting()
+{
+    srand(1234);
+    // Compare with all possible splits for small teams
+    for (unsigned n = 0; n <= 14; n++)
+    {
+        std::vector<double> ratings;
+        for (unsigned i = 0; i < n; i++)
+            ratings.push_back(1000.0 + rand() % 1000);
+        double best = n == 0 ? 0.0 : 1e30;
+        for (uint32_t mask = 0; mask < (1u << n); mask++)
+        {
+            std::vector<bool> red(n);
+            unsigned red_size = 0;
+            for (unsigned i = 0; i < n; i++)
+            {
+                red[i] = (mask & (1u << i)) != 0;
+                red_size += red[i] ? 1 : 0;
+            }
+            if (red_size == n / 2)
+                best = std::min(best, getDifference(ratings, red));
+        }
+        std::vector<bool> red = split(ratings, 10000);
+        assert(red.size() == n);
+        assert((unsigned)std::count(red.begin(), red.end(), true) == n / 2);
+        assert(getDifference(ratings, red) == best);
+    }
+
+    // The sizes are kept even if it is less balanced
+    std::vector<double> ratings = { 3000.0, 1000.0, 1000.0, 1000.0 };
+    std::vector<bool> red = split(ratings, 10000);
+    assert(std::count(red.begin(), red.end(), true) == 2);
+    assert(getDifference(ratings, red) == 2000.0);
+
+    // Too many players for the exact search
+    ratings.clear();
+    for (unsigned i = 0; i < 64; i++)
+        ratings.push_back(1000.0 + rand() % 1000);
+    red = split(ratings, 10000);
+    assert(std::count(red.begin(), red.end(), true) == 32);
+    assert(getDifference(ratings, red) < 1000.0);
+
+    assert(teamsBalanced(1, 0));
+    assert(teamsBalanced(2, 3));
+    assert(!teamsBalanced(2, 0));
+
+    // Benchmark
+    for (unsigned n = 6; n <= 32; n += 2)
+    {
+        ratings.clear();
+        for (unsigned i = 0; i < n; i++)
+            ratings.push_back(1000.0 + (rand() % 100000) / 100.0);
+        auto start = std::chrono::steady_clock::now();
+        red = split(ratings, 10000);
+        auto duration = std::chrono::duration_cast<
+            std::chrono::microseconds>(std::chrono::steady_clock::now() -
+            start).count();
+        Log::info("TeamBalancer", "Balanced %d players in %.3fms, "
+            "difference %.2f.", n, duration / 1000.0,
+            getDifference(ratings, red));
+    }
+}   // unitTesting
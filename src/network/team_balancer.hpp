@@ -0,0 +1,83 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_TEAM_BALANCER_HPP
+#define HEADER_TEAM_BALANCER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** \ingroup network
+ *  Splits players in two teams of the same size (one more player in the
+ *  blue team for an odd number) so that the sums of their ratings are as
+ *  close as possible. Up to MAX_EXACT_PLAYERS the best split is found with
+ *  a meet-in-the-middle search over both halves of the players, which takes
+ *  a few milliseconds for 32 players instead of the seconds of trying all
+ *  splits. Bigger lobbies, or a search running out of its time budget, use
+ *  the best split found by a greedy assignment improved with swaps.
+ */
+class TeamBalancer
+{
+public:
+    /** Number of players up to which the best split is searched. */
+    static const unsigned MAX_EXACT_PLAYERS = 36;
+
+    struct Player
+    {
+        std::string m_name;
+        double      m_elo;
+        /** True if the player plays with a handicap. */
+        bool        m_handicap;
+        /** Average Elo change of the recent matches. */
+        double      m_form;
+        // --------------------------------------------------------------------
+        Player(const std::string& name, double elo, bool handicap = false,
+               double form = 0.0)
+            : m_name(name), m_elo(elo), m_handicap(handicap), m_form(form) {}
+    };
+
+private:
+    static double getDifference(const std::vector<double>& ratings,
+                                const std::vector<bool>& red);
+    // ------------------------------------------------------------------------
+    static std::vector<bool> splitGreedy(const std::vector<double>& ratings,
+                                         uint64_t deadline);
+    // ------------------------------------------------------------------------
+    static bool splitExact(const std::vector<double>& ratings,
+                           uint64_t deadline, std::vector<bool>* red);
+
+public:
+    static double getRating(const Player& player);
+    // ------------------------------------------------------------------------
+    static std::vector<bool> split(const std::vector<double>& ratings,
+                                   unsigned time_budget_ms);
+    // ------------------------------------------------------------------------
+    static void createTeams(const std::vector<Player>& players,
+                            std::vector<std::string>* red_team,
+                            std::vector<std::string>* blue_team);
+    // ------------------------------------------------------------------------
+    /** Returns true if a team game can start with these team sizes. */
+    static bool teamsBalanced(unsigned red, unsigned blue)
+                    { return (red > 0 && blue > 0) || red + blue == 1; }
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class TeamBalancer
+
+#endif
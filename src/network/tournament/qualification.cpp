@@ -20,6 +20,8 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include "network/server_config.hpp"
+#include "network/soccer_ranking.hpp"
 #include "utils/string_utils.hpp"
 
 SuperTournamentQualification::SuperTournamentQualification()
@@ -32,7 +34,6 @@ SuperTournamentQualification::SuperTournamentQualification(std::string config_pl
     gameState = STQualiGameState();
     
     m_team_size = std::max(team_size, 1); // number of players per team cannot be smaller than 1
-    readElosFromFile();
 
     std::vector<std::string> splits = StringUtils::split(config_player_list, ' ');
     for (auto &split : splits)
@@ -119,7 +120,6 @@ void SuperTournamentQualification::resetSubstitutions()
     }
 
     m_substitutions.clear();
-    readElosFromFile();
 }
 
 void SuperTournamentQualification::removeAllPlayers()
@@ -128,7 +128,6 @@ void SuperTournamentQualification::removeAllPlayers()
     m_player_elos.clear();
     m_substitutions.clear();
     m_match_index = -1;
-    readElosFromFile();
 }
 
 bool SuperTournamentQualification::canPlay(std::string player_name) const
@@ -180,7 +179,18 @@ KartTeam SuperTournamentQualification::getKartTeam(std::string player_name) cons
 
 int SuperTournamentQualification::getElo(std::string player_name) const
 {
-    return m_player_elos.count(player_name) ? m_player_elos.at(player_name) : 1500;
+    if (m_player_elos.count(player_name))
+        return m_player_elos.at(player_name);
+    if (!SoccerRanking::get())
+        return 1500;
+    if (ServerConfig::m_ranking_scripts)
+    {
+        // The ranking scripts write the Elo in text files
+        std::string file = m_team_size == 1 ? "super1vs1quali_ranking.txt" :
+            "super2vs2quali_ranking.txt";
+        return (int)SoccerRanking::get()->getFileElo(file, 3, player_name);
+    }
+    return (int)SoccerRanking::get()->getElo(getRankingMode(), player_name);
 }
 
 void SuperTournamentQualification::updateElos(int red_goals, int blue_goals)
@@ -208,14 +218,27 @@ void SuperTournamentQualification::updateElos(int red_goals, int blue_goals)
         std::string message = "Match result: " + red_player_str + " " + std::to_string(red_goals) + "-" + std::to_string(blue_goals) + " " + blue_player_str;
         Log::info("SuperTournamentQualification", message.c_str());
 
-        if (m_team_size == 1)
+        // In 2vs2 the Elo belongs to the team, substitutes play for the
+        // original player and keep the Elo of the team
+        std::vector<std::string> rated[2] = { red_players, blue_players };
+        for (auto& team : rated)
+        {
+            for (auto& player : team)
+            {
+                if (m_team_size > 1 && m_substitutions.count(player))
+                    player = m_substitutions[player];
+            }
+        }
+
+        if (ServerConfig::m_ranking_scripts && m_team_size == 1)
         {
-            std::string fitis = "python3 super1vs1quali_update_elo.py " + red_player_str + " " + blue_player_str + " " + std::to_string(getElo(red_player_str)) + " " + std::to_string(getElo(blue_player_str)) + " " + std::to_string(red_goals) + " " + std::to_string(blue_goals);
-            system(fitis.c_str());
+            std::string fitis = "python3 super1vs1quali_update_elo.py " + SoccerRanking::escapeArgument(red_player_str) + " " + SoccerRanking::escapeArgument(blue_player_str) + " " + std::to_string(getElo(red_player_str)) + " " + std::to_string(getElo(blue_player_str)) + " " + std::to_string(red_goals) + " " + std::to_string(blue_goals);
+            SoccerRanking::get()->runCommand(fitis);
         }
 
-        if (m_team_size == 2)
+        if (ServerConfig::m_ranking_scripts && m_team_size == 2)
         {
+            std::string red_team_str = red_player_str, blue_team_str = blue_player_str;
             if (!m_substitutions.empty())
             {
 		auto red_players_new = red_players; auto blue_players_new = blue_players;
@@ -223,40 +246,42 @@ void SuperTournamentQualification::updateElos(int red_goals, int blue_goals)
                     if (m_substitutions.count(red_players[i])) red_players_new[i] = m_substitutions[red_players[i]] + "#" + red_players[i];
                 for (int i = 0; i < blue_players.size(); i++)
                     if (m_substitutions.count(blue_players[i])) blue_players_new[i] = m_substitutions[blue_players[i]] + "#" + blue_players[i];
-                red_player_str = StringUtils::join(red_players_new, " ");
-                blue_player_str = StringUtils::join(blue_players_new, " ");
+                red_team_str = StringUtils::join(red_players_new, " ");
+                blue_team_str = StringUtils::join(blue_players_new, " ");
             }
-            std::string fitis = "python3 super2vs2quali_update_elo.py \"" + red_player_str + "\" \"" + blue_player_str + "\" " + std::to_string(getElo(red_players[0])) + " " + std::to_string(getElo(blue_players[0])) + " " + std::to_string(red_goals) + " " + std::to_string(blue_goals);
-            system(fitis.c_str());
+            std::string fitis = "python3 super2vs2quali_update_elo.py " + SoccerRanking::escapeArgument(red_team_str) + " " + SoccerRanking::escapeArgument(blue_team_str) + " " + std::to_string(getElo(red_players[0])) + " " + std::to_string(getElo(blue_players[0])) + " " + std::to_string(red_goals) + " " + std::to_string(blue_goals);
+            SoccerRanking::get()->runCommand(fitis);
         }
 
-        readElosFromFile();
+        if (ServerConfig::m_ranking_scripts)
+        {
+            // The scripts update their ranking files, read by getElo
+            for (auto& team : rated)
+            {
+                for (auto& player : team)
+                    m_player_elos.erase(player);
+            }
+        }
+        else
+        {
+            std::vector<SoccerRanking::EloChange> changes =
+                SoccerRanking::get()->rateMatch(getRankingMode(), rated[0],
+                rated[1], red_goals, blue_goals);
+            for (auto& change : changes)
+                m_player_elos.erase(change.m_name);
+        }
+        for (auto& sub : m_substitutions)
+        {
+            if (m_team_size > 1)
+                m_player_elos[sub.first] = getElo(sub.second);
+        }
     }
 }
 
-void SuperTournamentQualification::readElosFromFile()
+SoccerRanking::RankingMode SuperTournamentQualification::getRankingMode() const
 {
-    std::ifstream in_file;
-    if (m_team_size == 1) in_file = std::ifstream("super1vs1quali_ranking.txt");
-    if (m_team_size == 2) in_file = std::ifstream("super2vs2quali_ranking.txt");
-    int elo = 0;
-    std::string player = "";
-    std::vector<std::string> split;
-    if (in_file.is_open())
-    {
-        std::string line;
-        std::getline(in_file, line);
-        while (std::getline(in_file, line))
-        {
-            split = StringUtils::split(line, ' ');
-            if (split.size() < 4) continue;
-            if (split[1] == "Played_Games") continue;
-            elo = int(stof(split[3]));
-            player = split[0];
-            m_player_elos[player] = elo;
-        }
-    }
-    in_file.close();
+    return m_team_size == 1 ? SoccerRanking::RM_SUPER_1VS1_QUALI :
+        SoccerRanking::RM_SUPER_2VS2_QUALI;
 }
 
 void SuperTournamentQualification::sortPlayersByElo()
@@ -20,6 +20,7 @@
 #define QUALIFICATION_HPP
 
 #include "network/remote_kart_info.hpp"
+#include "network/soccer_ranking.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
 #include "network/network_player_profile.hpp"
@@ -123,7 +124,7 @@ public:
 
     int getElo(std::string player_name) const;
     void updateElos(int red_goals, int blue_goals);
-    void readElosFromFile();
+    SoccerRanking::RankingMode getRankingMode() const;
     void sortPlayersByElo();
 };
 
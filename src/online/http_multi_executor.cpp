@@ -0,0 +1,363 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "online/http_multi_executor.hpp"
+
+#include "online/http_request.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#ifndef WIN32
+#  include <arpa/inet.h>
+#  include <atomic>
+#  include <mutex>
+#  include <netinet/in.h>
+#  include <sys/select.h>
+#  include <sys/socket.h>
+#  include <thread>
+#  include <unistd.h>
+#endif
+
+namespace Online
+{
+    // ------------------------------------------------------------------------
+    /** Creates the multi handle.
+     *  \param max_requests Maximum number of requests running at the same
+     *         time, which is also the number of connections kept open.
+     */
+    HTTPMultiExecutor::HTTPMultiExecutor(unsigned max_requests)
+    {
+        m_max_requests = std::max(1u, max_requests);
+        m_multi = curl_multi_init();
+        curl_multi_setopt(m_multi, CURLMOPT_MAXCONNECTS, (long)m_max_requests);
+        curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                          (long)m_max_requests);
+#ifdef CURLPIPE_MULTIPLEX
+        // Use HTTP/2 streams on one connection when the server supports it
+        curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+    }   // HTTPMultiExecutor
+
+    // ------------------------------------------------------------------------
+    HTTPMultiExecutor::~HTTPMultiExecutor()
+    {
+        // Running requests were aborted, they must be removed from the multi
+        // handle before their curl handle is freed
+        for (auto& r : m_running)
+            curl_multi_remove_handle(m_multi, r.first);
+        m_running.clear();
+        curl_multi_cleanup(m_multi);
+    }   // ~HTTPMultiExecutor
+
+    // ------------------------------------------------------------------------
+    /** Starts a request.
+     *  \return True if the request is running and will be returned by
+     *          perform() later, false if it was executed (or aborted)
+     *          immediately.
+     */
+    bool HTTPMultiExecutor::start(std::shared_ptr<HTTPRequest> request)
+    {
+        if (!request->startTransfer(m_multi))
+            return false;
+        m_running[request->getCurlSession()] = request;
+        return true;
+    }   // start
+
+    // ------------------------------------------------------------------------
+    /** Transfers data of all running requests, waiting for up to timeout_ms
+     *  for network activity or a wakeup().
+     *  \param finished Requests which finished are added to this vector,
+     *         they are executed (including afterOperation) unless aborted.
+     */
+    void HTTPMultiExecutor::perform(int timeout_ms,
+                          std::vector<std::shared_ptr<HTTPRequest> >* finished)
+    {
+        int running = 0;
+        curl_multi_perform(m_multi, &running);
+        if (running > 0)
+        {
+#if LIBCURL_VERSION_NUM >= 0x074200
+            curl_multi_poll(m_multi, NULL, 0, timeout_ms, NULL);
+#else
+            curl_multi_wait(m_multi, NULL, 0, timeout_ms, NULL);
+#endif
+            curl_multi_perform(m_multi, &running);
+        }
+
+        CURLMsg* msg;
+        int left = 0;
+        while ((msg = curl_multi_info_read(m_multi, &left)) != NULL)
+        {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+            // msg is freed when the handle is removed
+            CURL* handle = msg->easy_handle;
+            CURLcode code = msg->data.result;
+            auto it = m_running.find(handle);
+            if (it == m_running.end())
+                continue;
+            std::shared_ptr<HTTPRequest> request = it->second;
+            m_running.erase(it);
+            request->finishTransfer(m_multi, code);
+            finished->push_back(request);
+        }
+    }   // perform
+
+    // ------------------------------------------------------------------------
+    /** Wakes up perform() if it is waiting, can be called from any thread.
+     */
+    void HTTPMultiExecutor::wakeup()
+    {
+#if LIBCURL_VERSION_NUM >= 0x074400
+        curl_multi_wakeup(m_multi);
+#endif
+    }   // wakeup
+
+    // ========================================================================
+#ifndef WIN32
+    namespace
+    {
+        /** A minimal HTTP/1.1 server on localhost standing in for the stk
+         *  server: it answers every request with its path and keeps the
+         *  connection open. /slow answers after 400ms and /hang never. */
+        class StandInServer
+        {
+        private:
+            int m_socket;
+            int m_port;
+            std::atomic<bool> m_stop;
+            std::atomic<int> m_connections;
+            std::thread m_accept_thread;
+            std::mutex m_clients_mutex;
+            std::vector<std::pair<int, std::thread> > m_clients;
+            // ----------------------------------------------------------------
+            void handleClient(int fd)
+            {
+                std::string buffer;
+                char data[1024];
+                while (!m_stop.load())
+                {
+                    size_t header_end = buffer.find("\r\n\r\n");
+                    if (header_end == std::string::npos)
+                    {
+                        ssize_t len = recv(fd, data, sizeof(data), 0);
+                        if (len <= 0)
+                            return;
+                        buffer.append(data, len);
+                        continue;
+                    }
+                    size_t body = 0;
+                    std::string header = buffer.substr(0, header_end);
+                    size_t cl = header.find("Content-Length: ");
+                    if (cl != std::string::npos)
+                        body = atoi(header.c_str() + cl + 16);
+                    if (buffer.size() < header_end + 4 + body)
+                    {
+                        ssize_t len = recv(fd, data, sizeof(data), 0);
+                        if (len <= 0)
+                            return;
+                        buffer.append(data, len);
+                        continue;
+                    }
+                    buffer.erase(0, header_end + 4 + body);
+                    size_t path_start = header.find(' ') + 1;
+                    std::string path = header.substr(path_start,
+                        header.find(' ', path_start) - path_start);
+
+                    uint64_t wait = path == "/slow" ? 400 :
+                                    path == "/hang" ? 5000 : 0;
+                    uint64_t end = StkTime::getMonoTimeMs() + wait;
+                    while (!m_stop.load() && StkTime::getMonoTimeMs() < end)
+                        StkTime::sleep(10);
+                    std::string reply = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                        StringUtils::toString(path.size()) +
+                        "\r\nConnection: keep-alive\r\n\r\n" + path;
+                    if (send(fd, reply.c_str(), reply.size(), 0) < 0)
+                        return;
+                }
+            }   // handleClient
+            // ----------------------------------------------------------------
+            void acceptLoop()
+            {
+                while (!m_stop.load())
+                {
+                    fd_set set;
+                    FD_ZERO(&set);
+                    FD_SET(m_socket, &set);
+                    struct timeval tv = { 0, 50000 };
+                    if (select(m_socket + 1, &set, NULL, NULL, &tv) <= 0)
+                        continue;
+                    int fd = accept(m_socket, NULL, NULL);
+                    if (fd < 0)
+                        continue;
+                    m_connections++;
+                    std::lock_guard<std::mutex> lock(m_clients_mutex);
+                    m_clients.emplace_back(fd,
+                        std::thread(&StandInServer::handleClient, this, fd));
+                }
+            }   // acceptLoop
+
+        public:
+            StandInServer()
+            {
+                m_stop.store(false);
+                m_connections.store(0);
+                m_port = 0;
+                m_socket = socket(AF_INET, SOCK_STREAM, 0);
+                struct sockaddr_in addr = {};
+                addr.sin_family = AF_INET;
+                addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                socklen_t len = sizeof(addr);
+                if (m_socket < 0 ||
+                    bind(m_socket, (struct sockaddr*)&addr, len) != 0 ||
+                    listen(m_socket, 16) != 0 ||
+                    getsockname(m_socket, (struct sockaddr*)&addr, &len) != 0)
+                    return;
+                m_port = ntohs(addr.sin_port);
+                m_accept_thread = std::thread(&StandInServer::acceptLoop, this);
+            }   // StandInServer
+            // ----------------------------------------------------------------
+            ~StandInServer()
+            {
+                m_stop.store(true);
+                if (m_accept_thread.joinable())
+                    m_accept_thread.join();
+                for (auto& client : m_clients)
+                {
+                    shutdown(client.first, SHUT_RDWR);
+                    client.second.join();
+                    close(client.first);
+                }
+                if (m_socket >= 0)
+                    close(m_socket);
+            }   // ~StandInServer
+            // ----------------------------------------------------------------
+            std::string getURL(const std::string& path) const
+            {
+                return "http://127.0.0.1:" + StringUtils::toString(m_port) +
+                    path;
+            }   // getURL
+            // ----------------------------------------------------------------
+            int getPort() const                            { return m_port; }
+            // ----------------------------------------------------------------
+            int getConnections() const       { return m_connections.load(); }
+        };   // class StandInServer
+
+        // --------------------------------------------------------------------
+        /** Runs all requests on the executor and waits until they are done.
+         *  \return The time it took in milliseconds.
+         */
+        uint64_t runAll(HTTPMultiExecutor* executor,
+                        std::vector<std::shared_ptr<HTTPRequest> >& requests)
+        {
+            uint64_t start = StkTime::getMonoTimeMs();
+            std::vector<std::shared_ptr<HTTPRequest> > finished;
+            size_t next = 0;
+            while (finished.size() < requests.size())
+            {
+                while (next < requests.size() && executor->canStart())
+                {
+                    requests[next]->setBusy();
+                    if (!executor->start(requests[next]))
+                        finished.push_back(requests[next]);
+                    next++;
+                }
+                executor->perform(50, &finished);
+            }
+            return StkTime::getMonoTimeMs() - start;
+        }   // runAll
+    }   // anonymous namespace
+#endif
+
+    // ------------------------------------------------------------------------
+    void HTTPMultiExecutor::unitTesting()
+    {
+#ifdef WIN32
+        Log::info("HTTPMultiExecutor", "Test skipped on Windows.");
+#else
+        StandInServer server;
+        assert(server.getPort() != 0);
+
+        // Requests are answered and connections are reused
+        {
+            HTTPMultiExecutor executor(2);
+            std::vector<std::shared_ptr<HTTPRequest> > requests;
+            for (unsigned i = 0; i < 8; i++)
+            {
+                auto r = std::make_shared<HTTPRequest>();
+                r->setURL(server.getURL("/r" + StringUtils::toString(i)));
+                requests.push_back(r);
+            }
+            runAll(&executor, requests);
+            for (unsigned i = 0; i < requests.size(); i++)
+            {
+                assert(!requests[i]->hadDownloadError());
+                assert(requests[i]->getData() ==
+                    "/r" + StringUtils::toString(i));
+            }
+            assert(server.getConnections() <= 2);
+        }
+
+        // A slow request doesn't hold back the others
+        {
+            HTTPMultiExecutor executor(4);
+            std::vector<std::shared_ptr<HTTPRequest> > requests;
+            for (unsigned i = 0; i < 4; i++)
+            {
+                auto r = std::make_shared<HTTPRequest>();
+                r->setURL(server.getURL("/slow"));
+                requests.push_back(r);
+            }
+            uint64_t time = runAll(&executor, requests);
+            for (unsigned i = 0; i < requests.size(); i++)
+            {
+                assert(!requests[i]->hadDownloadError() &&
+                    requests[i]->getData() == "/slow");
+            }
+            // One after the other it would take 1600ms
+            assert(time < 1200);
+            Log::info("HTTPMultiExecutor", "4 slow requests took %dms.",
+                (int)time);
+        }
+
+        // Requests time out
+        {
+            HTTPMultiExecutor executor(2);
+            std::vector<std::shared_ptr<HTTPRequest> > requests;
+            auto hang = std::make_shared<HTTPRequest>();
+            hang->setURL(server.getURL("/hang"));
+            hang->setTimeout(200);
+            auto ok = std::make_shared<HTTPRequest>();
+            ok->setURL(server.getURL("/ok"));
+            requests.push_back(hang);
+            requests.push_back(ok);
+            uint64_t time = runAll(&executor, requests);
+            assert(hang->hadDownloadError());
+            assert(!ok->hadDownloadError() && ok->getData() == "/ok");
+            assert(time < 2000);
+            Log::info("HTTPMultiExecutor", "Timed out request took %dms.",
+                (int)time);
+        }
+#endif
+    }   // unitTesting
+
+}   // namespace Online
@@ -0,0 +1,75 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_HTTP_MULTI_EXECUTOR_HPP
+#define HEADER_HTTP_MULTI_EXECUTOR_HPP
+
+#include "utils/no_copy.hpp"
+
+#ifdef WIN32
+#  include <winsock2.h>
+#endif
+#include <curl/curl.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Online
+{
+    class HTTPRequest;
+
+    /** Runs several HTTP requests at the same time on a curl multi handle.
+     *  The multi handle keeps a cache of open connections, so consecutive
+     *  requests to the same host (like the stk server) reuse the connection
+     *  instead of doing a new TCP and TLS handshake each time. It is only
+     *  used by the RequestManager thread.
+     * \ingroup online
+     */
+    class HTTPMultiExecutor : public NoCopy
+    {
+    private:
+        CURLM* m_multi;
+
+        /** The running requests indexed by their curl handle. */
+        std::map<CURL*, std::shared_ptr<HTTPRequest> > m_running;
+
+        /** Maximum number of requests running at the same time. */
+        unsigned m_max_requests;
+
+    public:
+        HTTPMultiExecutor(unsigned max_requests);
+        // --------------------------------------------------------------------
+        ~HTTPMultiExecutor();
+        // --------------------------------------------------------------------
+        bool start(std::shared_ptr<HTTPRequest> request);
+        // --------------------------------------------------------------------
+        void perform(int timeout_ms,
+                     std::vector<std::shared_ptr<HTTPRequest> >* finished);
+        // --------------------------------------------------------------------
+        void wakeup();
+        // --------------------------------------------------------------------
+        /** Returns true if another request can be started. */
+        bool canStart() const     { return m_running.size() < m_max_requests; }
+        // --------------------------------------------------------------------
+        unsigned getNumRunning() const     { return (unsigned)m_running.size(); }
+        // --------------------------------------------------------------------
+        static void unitTesting();
+    };   // class HTTPMultiExecutor
+} // namespace Online
+
+#endif // HEADER_HTTP_MULTI_EXECUTOR_HPP
@@ -185,7 +185,16 @@ namespace Online
         std::string host = "Host: " + StringUtils::getHostNameFromURL(m_url);
         m_http_header = curl_slist_append(m_http_header, host.c_str());
         assert(m_http_header != nullptr);
+        if (!m_if_none_match.empty())
+        {
+            std::string if_none_match = "If-None-Match: " + m_if_none_match;
+            m_http_header = curl_slist_append(m_http_header,
+                                              if_none_match.c_str());
+        }
         curl_easy_setopt(m_curl_session, CURLOPT_HTTPHEADER, m_http_header);
+        curl_easy_setopt(m_curl_session, CURLOPT_HEADERDATA, &m_etag);
+        curl_easy_setopt(m_curl_session, CURLOPT_HEADERFUNCTION,
+                                         &HTTPRequest::headerCallback);
         curl_easy_setopt(m_curl_session, CURLOPT_SSL_VERIFYPEER, 1L);
         curl_easy_setopt(m_curl_session, CURLOPT_SSL_VERIFYHOST, 2L);
     }   // prepareOperation
@@ -195,22 +204,32 @@ namespace Online
      */
     void HTTPRequest::operation()
     {
-        if (!m_curl_session)
+        if (!startOperation())
             return;
+        finishOperation(curl_easy_perform(m_curl_session));
+    }   // operation
+
+    // ------------------------------------------------------------------------
+    /** Sets up where the downloaded data goes and the parameters to send.
+     *  \return False if the request can't be started.
+     */
+    bool HTTPRequest::startOperation()
+    {
+        if (!m_curl_session)
+            return false;
 
-        FILE *fout = NULL;
         if (m_filename.size() > 0)
         {
-            fout = FileUtils::fopenU8Path(m_filename + ".part", "wb");
+            m_part_file = FileUtils::fopenU8Path(m_filename + ".part", "wb");
 
-            if (!fout)
+            if (!m_part_file)
             {
                 Log::error("HTTPRequest",
                            "Can't open '%s' for writing, ignored.",
                            (m_filename+".part").c_str());
-                return;
+                return false;
             }
-            curl_easy_setopt(m_curl_session,  CURLOPT_WRITEDATA,     fout  );
+            curl_easy_setopt(m_curl_session,  CURLOPT_WRITEDATA,  m_part_file);
             curl_easy_setopt(m_curl_session,  CURLOPT_WRITEFUNCTION, fwrite);
         }
         else
@@ -269,12 +288,37 @@ namespace Online
         const std::string& uagent = StringUtils::getUserAgentString();
         curl_easy_setopt(m_curl_session, CURLOPT_USERAGENT, uagent.c_str());
 
-        m_curl_code = curl_easy_perform(m_curl_session);
+        long timeout = m_timeout;
+        if (timeout < 0)
+        {
+            // Downloads of big files are only limited by their speed
+            timeout = m_filename.empty() ?
+                UserConfigParams::m_http_request_timeout * 1000 : 0;
+        }
+        if (timeout > 0)
+            curl_easy_setopt(m_curl_session, CURLOPT_TIMEOUT_MS, timeout);
+        return true;
+    }   // startOperation
+
+    // ------------------------------------------------------------------------
+    /** Called when the transfer is finished, moves a downloaded file to its
+     *  final name.
+     *  \param code Result of the transfer.
+     */
+    void HTTPRequest::finishOperation(CURLcode code)
+    {
+        m_curl_code = code;
+        if (m_curl_session)
+        {
+            curl_easy_getinfo(m_curl_session, CURLINFO_RESPONSE_CODE,
+                              &m_response_code);
+        }
         Request::operation();
 
-        if (fout)
+        if (m_part_file)
         {
-            fclose(fout);
+            fclose(m_part_file);
+            m_part_file = NULL;
             if (m_curl_code == CURLE_OK)
             {
                 if(UserConfigParams::logAddons())
@@ -299,7 +343,56 @@ namespace Online
                 }
             }   // m_curl_code ==CURLE_OK
         }   // if fout
-    }   // operation
+    }   // finishOperation
+
+    // ------------------------------------------------------------------------
+    /** Starts this request on a curl multi handle, so that it runs together
+     *  with other requests. This does the same as execute(), finishTransfer()
+     *  has to be called once curl reports the transfer as done.
+     *  \param multi The multi handle to add the request to.
+     *  \return False if nothing is transferred, the request is then already
+     *          executed (or aborted).
+     */
+    bool HTTPRequest::startTransfer(CURLM* multi)
+    {
+        assert(isBusy());
+        if (isAborted())
+            return false;
+        prepareOperation();
+        if (isAborted())
+            return false;
+        if (startOperation())
+        {
+            if (curl_multi_add_handle(multi, m_curl_session) == CURLM_OK)
+                return true;
+            finishOperation(CURLE_FAILED_INIT);
+        }
+        completeTransfer();
+        return false;
+    }   // startTransfer
+
+    // ------------------------------------------------------------------------
+    /** Finishes a request started with startTransfer().
+     *  \param multi The multi handle the request was added to.
+     *  \param code Result of the transfer.
+     */
+    void HTTPRequest::finishTransfer(CURLM* multi, CURLcode code)
+    {
+        curl_multi_remove_handle(multi, m_curl_session);
+        finishOperation(code);
+        completeTransfer();
+    }   // finishTransfer
+
+    // ------------------------------------------------------------------------
+    void HTTPRequest::completeTransfer()
+    {
+        if (isAborted())
+            return;
+        setExecuted();
+        if (isAborted())
+            return;
+        afterOperation();
+    }   // completeTransfer
 
     // ------------------------------------------------------------------------
     /** Cleanup once the download is finished. The value of progress is
@@ -341,6 +434,27 @@ namespace Online
         return size * nmemb;
     }   // writeCallback
 
+    // ------------------------------------------------------------------------
+    /** Callback from curl for each header line of the response, stores the
+     *  value of the ETag header.
+     *  \param buffer The header line, not null terminated.
+     *  \param size Always 1.
+     *  \param nitems Length of the line.
+     *  \param userp Pointer to the string for the ETag.
+     */
+    size_t HTTPRequest::headerCallback(char *buffer, size_t size,
+                                       size_t nitems, void *userp)
+    {
+        const size_t len = size * nitems;
+        std::string line(buffer, len);
+        if (StringUtils::toLowerCase(line.substr(0, 5)) == "etag:")
+        {
+            *(std::string*)userp =
+                StringUtils::removeWhitespaces(line.substr(5));
+        }
+        return len;
+    }   // headerCallback
+
     // ----------------------------------------------------------------------------
     /** Callback function from curl: inform about progress. It makes sure that
      *  the value reported by getProgress () is <1 while the download is still
@@ -29,6 +29,7 @@
 #include <atomic>
 #include <curl/curl.h>
 #include <assert.h>
+#include <cstdio>
 #include <string>
 
 namespace Online
@@ -70,6 +71,26 @@ namespace Online
         std::string m_string_buffer;
 
         struct curl_slist* m_http_header = NULL;
+
+        /** ETag sent in a If-None-Match header, empty for none. */
+        std::string m_if_none_match;
+
+        /** ETag header of the response, empty if there was none. */
+        std::string m_etag;
+
+        /** HTTP response code, 0 if no response was received. */
+        long m_response_code = 0;
+
+        /** File the data is written to while downloading into m_filename. */
+        FILE *m_part_file = NULL;
+
+        /** Timeout of the whole request in milliseconds, 0 for no limit and
+         *  -1 to use the default. */
+        long m_timeout = -1;
+
+        bool startOperation();
+        void finishOperation(CURLcode code);
+        void completeTransfer();
     protected:
         /** Contains a filename if the data should be saved into a file
          *  instead of being kept in in memory. Otherwise this is "". */
@@ -90,6 +111,9 @@ namespace Online
 
         static size_t writeCallback(void *contents, size_t size,
                                     size_t nmemb,   void *userp);
+
+        static size_t headerCallback(char *buffer, size_t size,
+                                     size_t nitems, void *userp);
         void init();
 
     public :
@@ -100,6 +124,8 @@ namespace Online
         {
             if (m_http_header)
                 curl_slist_free_all(m_http_header);
+            if (m_part_file)
+                fclose(m_part_file);
             if (m_curl_session)
             {
                 curl_easy_cleanup(m_curl_session);
@@ -109,7 +135,38 @@ namespace Online
         virtual bool       isAllowedToAdd() const OVERRIDE;
         void               setApiURL(const std::string& url, const std::string &action);
         void               setAddonsURL(const std::string& path);
+        bool               startTransfer(CURLM* multi);
+        void               finishTransfer(CURLM* multi, CURLcode code);
+
+        // ------------------------------------------------------------------------
+        /** Returns true if this request can run on a curl multi handle next to
+         *  other requests. Requests which replace operation() must return
+         *  false, they are executed on their own with execute(). */
+        virtual bool allowConcurrentTransfer() const              { return true; }
+        // ------------------------------------------------------------------------
+        CURL* getCurlSession() const                  { return m_curl_session; }
+        // ------------------------------------------------------------------------
+        /** Sets the timeout of this request in milliseconds, 0 for no limit. */
+        void setTimeout(long ms)           { assert(isPreparing()); m_timeout = ms; }
 
+        // ------------------------------------------------------------------------
+        /** Only downloads the data if its ETag differs from the given one
+         *  (which is ignored if empty), otherwise isNotModified() returns
+         *  true and nothing is received. Must be called before
+         *  prepareOperation(). */
+        void setIfNoneMatch(const std::string& etag) { m_if_none_match = etag; }
+        // ------------------------------------------------------------------------
+        /** Returns true if the data was not downloaded because it still
+         *  matches the ETag given to setIfNoneMatch(). */
+        bool isNotModified() const { return m_response_code == 304; }
+        // ------------------------------------------------------------------------
+        /** Returns the ETag of the downloaded data, or "" if the server
+         *  sent none. */
+        const std::string& getETag() const
+        {
+            assert(hasBeenExecuted());
+            return m_etag;
+        }   // getETag
         // ------------------------------------------------------------------------
         /** Returns true if there was an error downloading the file. */
         bool hadDownloadError() const { return m_curl_code != CURLE_OK; }
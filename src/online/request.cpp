@@ -59,17 +59,13 @@ namespace Online
     {
         assert(isBusy());
         // Abort as early as possible if abort is requested
-        if (RequestManager::isRunning() &&
-            RequestManager::get()->getAbort() && isAbortable()) return;
+        if (isAborted()) return;
         prepareOperation();
-        if (RequestManager::isRunning() &&
-            RequestManager::get()->getAbort() && isAbortable()) return;
+        if (isAborted()) return;
         operation();
-        if (RequestManager::isRunning() &&
-            RequestManager::get()->getAbort() && isAbortable()) return;
+        if (isAborted()) return;
         setExecuted();
-        if (RequestManager::isRunning() &&
-            RequestManager::get()->getAbort() && isAbortable()) return;
+        if (isAborted()) return;
         afterOperation();
     }   // execute
 
@@ -83,12 +79,19 @@ namespace Online
         assert(isPreparing());
         setBusy();
         execute();
-        if (RequestManager::isRunning() &&
-            RequestManager::get()->getAbort() && isAbortable()) return;
+        if (isAborted()) return;
         callback();
-        if (RequestManager::isRunning() &&
-            RequestManager::get()->getAbort() && isAbortable()) return;
+        if (isAborted()) return;
         setDone();
     }   // executeNow
 
+    // ------------------------------------------------------------------------
+    /** Returns true if STK is quitting and this request can be aborted.
+     */
+    bool Request::isAborted() const
+    {
+        return RequestManager::isRunning() &&
+            RequestManager::get()->getAbort() && isAbortable();
+    }   // isAborted
+
 } // namespace Online
@@ -118,6 +118,9 @@ namespace Online
         /** Virtual function to be called after an operation. */
         virtual void afterOperation()   {}
 
+        // --------------------------------------------------------------------
+        bool isAborted() const;
+
     public:
         enum RequestType
         {
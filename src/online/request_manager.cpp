@@ -22,9 +22,12 @@
 
 #include "config/player_manager.hpp"
 #include "config/user_config.hpp"
+#include "online/http_multi_executor.hpp"
+#include "online/http_request.hpp"
 #include "states_screens/state_manager.hpp"
 #include "utils/vs.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <stdio.h>
@@ -71,6 +74,7 @@ namespace Online
     RequestManager::RequestManager()
     {
         m_paused.store(false);
+        m_executor = NULL;
         m_menu_polling_interval = 60;  // Default polling: every 60 seconds.
         m_game_polling_interval = 60;  // same for game polling
         m_time_since_poll       = m_menu_polling_interval;
@@ -161,6 +165,8 @@ namespace Online
 
         // Wake up the network http thread
         m_condition_variable.notify_one();
+        if (m_executor)
+            m_executor->wakeup();
         m_request_queue.unlock();
     }   // addRequest
 
@@ -168,6 +174,8 @@ namespace Online
     /** The actual main loop, which is started as a separate thread from the
      *  constructor. After testing for a new server, fetching news, the list
      *  of packages to download, it will wait for commands to be issued.
+     *  HTTP requests are started on the multi executor as long as it has
+     *  free slots, other requests are executed directly in this thread.
      *  \param obj: A pointer to this object, passed on by pthread_create
      */
     void RequestManager::mainLoop(void *obj)
@@ -175,41 +183,68 @@ namespace Online
         VS::setThreadName("RequestManager");
         RequestManager *me = (RequestManager*) obj;
 
-        me->m_current_request = nullptr;
+        HTTPMultiExecutor* executor = new HTTPMultiExecutor(
+            std::max(1, (int)UserConfigParams::m_http_max_connections));
+        std::vector<std::shared_ptr<HTTPRequest> > finished;
         std::unique_lock<std::mutex> ul = me->m_request_queue.acquireMutex();
-        while (me->m_request_queue.getData().empty() ||
-               me->m_request_queue.getData().top()->getType() != Request::RT_QUIT)
+        me->m_executor = executor;
+        while (true)
         {
-            bool empty = me->m_request_queue.getData().empty();
+            auto& queue = me->m_request_queue.getData();
+            // A quit request is only handled after all running requests
+            // (e.g. the sign-out) have finished
+            bool quit = !queue.empty() &&
+                queue.top()->getType() == Request::RT_QUIT;
+            if (quit && executor->getNumRunning() == 0)
+                break;
 
-            // Wait in cond_wait for a request to arrive. The 'while' is necessary
+            // Wait in cond_wait for a request to arrive. The loop is necessary
             // since "spurious wakeups from the pthread_cond_wait ... may occur"
             // (pthread_cond_wait man page)!
-            while (empty)
+            if (queue.empty() && executor->getNumRunning() == 0)
             {
                 me->m_condition_variable.wait(ul);
-                empty = me->m_request_queue.getData().empty();
+                continue;
             }
             // We pause the request manager thread when going into background in iOS
             // So this will only be evaluated a while
             if (me->m_paused.load())
                 StkTime::sleep(1);
-            me->m_current_request = me->m_request_queue.getData().top();
-            me->m_request_queue.getData().pop();
 
-            if (me->m_current_request->getType() == Request::RT_QUIT)
+            while (!quit && !queue.empty() && executor->canStart())
             {
-                break;
+                std::shared_ptr<Request> request = queue.top();
+                if (request->getType() == Request::RT_QUIT)
+                    break;
+                queue.pop();
+                ul.unlock();
+
+                std::shared_ptr<HTTPRequest> http =
+                    std::dynamic_pointer_cast<HTTPRequest>(request);
+                bool running = false;
+                if (http && http->allowConcurrentTransfer())
+                    running = executor->start(http);
+                else
+                    request->execute();
+                // This test is necessary in case that execute() was aborted
+                // (otherwise the assert in addResult will be triggered).
+                if (!running && !me->getAbort())
+                    me->addResult(request);
+                ul = me->m_request_queue.acquireMutex();
             }
 
-            ul.unlock();
-            me->m_current_request->execute();
-            // This test is necessary in case that execute() was aborted
-            // (otherwise the assert in addResult will be triggered).
-            if (!me->getAbort())
-                me->addResult(me->m_current_request);
-            me->m_current_request = nullptr;
-            ul = me->m_request_queue.acquireMutex();
+            if (executor->getNumRunning() > 0)
+            {
+                ul.unlock();
+                executor->perform(100, &finished);
+                for (auto& request : finished)
+                {
+                    if (!me->getAbort())
+                        me->addResult(request);
+                }
+                finished.clear();
+                ul = me->m_request_queue.acquireMutex();
+            }
         } // while handle all requests
 
         // Signal that the request manager can now be deleted.
@@ -218,6 +253,8 @@ namespace Online
         me->setCanBeDeleted();
 
         // At this stage we have the lock for m_request_queue
+        me->m_executor = NULL;
+        delete executor;
         while (!me->m_request_queue.getData().empty())
         {
             me->m_request_queue.getData().pop();
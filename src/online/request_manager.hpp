@@ -42,6 +42,8 @@
 
 namespace Online
 {
+    class HTTPMultiExecutor;
+
     /** A class to execute requests in a separate thread. Typically the
      *  requests involve a http(s) requests to be sent to the stk server, and
      *  receive an answer (e.g. to sign in; or to download an addon). The
@@ -74,6 +76,11 @@ namespace Online
      *  on first start of stk (which will trigger downloading of all addon
      *  icons) is it possible that actually a download request is running,
      *  which might take a bit before it can be deleted.
+     *  HTTP requests are run concurrently with an HTTPMultiExecutor (up to
+     *  UserConfigParams::m_http_max_connections at a time), so that a slow
+     *  request (like an addon download) doesn't hold back others (like
+     *  ranking requests of a server). The priority decides which requests
+     *  are started first.
      * \ingroup online
      */
     class RequestManager : public CanBeDeleted
@@ -96,8 +103,8 @@ namespace Online
             /** Time passed since the last poll request. */
             float                     m_time_since_poll;
 
-            /** The current requested being worked on. */
-            std::shared_ptr<Online::Request> m_current_request;
+            /** Runs the HTTP requests, only set while the thread runs. */
+            HTTPMultiExecutor*        m_executor;
 
             /** A conditional variable to wake up the main loop. */
             std::condition_variable   m_condition_variable;
@@ -0,0 +1,571 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "physics/collision_mesh.hpp"
+
+#include "graphics/irr_driver.hpp"
+#include "graphics/material.hpp"
+#include "graphics/material_manager.hpp"
+#include "io/file_manager.hpp"
+#include "physics/triangle_mesh.hpp"
+#include "utils/constants.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/log.hpp"
+#include "utils/mapped_file.hpp"
+#include "utils/mini_glm.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/vec3.hpp"
+
+#include <IFileSystem.h>
+#include <IMesh.h>
+#include <IMeshBuffer.h>
+#include <IReadFile.h>
+#include <plane3d.h>
+
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#ifdef WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace
+{
+    /** Increase if the layout of the cache files changes. */
+    const uint32_t CACHE_MAGIC   = 0x4d435453; // "STCM"
+    const uint32_t CACHE_VERSION = 1;
+
+    // ------------------------------------------------------------------------
+    void writeUInt32(FILE* f, uint32_t v)        { fwrite(&v, 4, 1, f); }
+    // ------------------------------------------------------------------------
+    void writeString(FILE* f, const std::string& s)
+    {
+        writeUInt32(f, (uint32_t)s.size());
+        if (!s.empty())
+            fwrite(s.data(), 1, s.size(), f);
+    }   // writeString
+    // ------------------------------------------------------------------------
+    /** Pads the file so that the next data is 4 bytes aligned. */
+    void writePadding(FILE* f)
+    {
+        const char zero[4] = {};
+        long pos = ftell(f);
+        if (pos % 4 != 0)
+            fwrite(zero, 1, 4 - pos % 4, f);
+    }   // writePadding
+
+    // ------------------------------------------------------------------------
+    /** Reads data in place from a mapped cache file. */
+    struct CacheReader
+    {
+        const uint8_t* m_start;
+        const uint8_t* m_pos;
+        const uint8_t* m_end;
+        // --------------------------------------------------------------------
+        /** Returns the next size bytes, NULL if the file is too short. */
+        const uint8_t* get(size_t size)
+        {
+            if ((size_t)(m_end - m_pos) < size)
+                return NULL;
+            const uint8_t* data = m_pos;
+            m_pos += size;
+            return data;
+        }
+        // --------------------------------------------------------------------
+        bool getUInt32(uint32_t* v)
+        {
+            const uint8_t* data = get(4);
+            if (data)
+                memcpy(v, data, 4);
+            return data != NULL;
+        }
+        // --------------------------------------------------------------------
+        bool getUInt64(uint64_t* v)
+        {
+            const uint8_t* data = get(8);
+            if (data)
+                memcpy(v, data, 8);
+            return data != NULL;
+        }
+        // --------------------------------------------------------------------
+        bool getString(std::string* s)
+        {
+            uint32_t len = 0;
+            if (!getUInt32(&len))
+                return false;
+            const uint8_t* data = get(len);
+            if (data)
+                s->assign((const char*)data, len);
+            return data != NULL;
+        }
+        // --------------------------------------------------------------------
+        bool skipPadding()
+        {
+            size_t pos = m_pos - m_start;
+            return pos % 4 == 0 || get(4 - pos % 4) != NULL;
+        }
+    };   // CacheReader
+
+    // ------------------------------------------------------------------------
+    std::string getCacheFile(const std::string& path)
+    {
+        std::string dir = file_manager->getCachedAssetsDir();
+        if (dir.empty())
+            return "";
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : path)
+            hash = (hash ^ (uint8_t)c) * 1099511628211ull;
+        char name[64];
+        snprintf(name, sizeof(name), "collision-%016llx.bin",
+            (unsigned long long)hash);
+        return dir + name;
+    }   // getCacheFile
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+CollisionMesh::CollisionMesh()
+{
+}   // CollisionMesh
+
+// ----------------------------------------------------------------------------
+CollisionMesh::~CollisionMesh()
+{
+}   // ~CollisionMesh
+
+// ----------------------------------------------------------------------------
+/** Loads the triangles of a model, from the cache if it is up to date.
+ *  \param full_path Full path of the model.
+ *  \return False if the model cannot be loaded.
+ */
+bool CollisionMesh::load(const std::string& full_path)
+{
+    m_buffers.clear();
+    m_parse_cache.reset();
+    io::IFileSystem* fs = file_manager->getFileSystem();
+    io::IReadFile* file = fs->createAndOpenFile(full_path.c_str());
+    if (!file)
+        return false;
+
+    // The cache is only used for files on disk, identified by their path,
+    // size and modification time
+    std::string path = file->getFileName().c_str();
+    std::string cache_file;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    struct stat st;
+    if (IS_LITTLE_ENDIAN && FileUtils::statU8Path(path, &st) == 0)
+    {
+        cache_file = getCacheFile(path);
+        size = (uint64_t)st.st_size;
+        mtime = (int64_t)st.st_mtime;
+    }
+    if (!cache_file.empty() && loadParseCache(cache_file, path, size, mtime))
+    {
+        file->drop();
+        return true;
+    }
+
+    bool loaded = false;
+    if (IS_LITTLE_ENDIAN &&
+        StringUtils::getExtension(full_path) == "spm")
+    {
+        loaded = loadSPM(file, fs->getFileDir(file->getFileName()).c_str());
+        if (!loaded)
+            m_buffers.clear();
+    }
+    file->drop();
+    if (!loaded && !loadIrrlichtMesh(full_path))
+        return false;
+
+    for (Buffer& b : m_buffers)
+    {
+        b.m_vertex_count = (uint32_t)b.m_own_positions.size();
+        b.m_index_count = (uint32_t)b.m_own_indices.size();
+        b.m_positions = b.m_own_positions.data();
+        b.m_normals = b.m_own_normals.data();
+        b.m_indices = b.m_own_indices.data();
+    }
+    if (!cache_file.empty())
+        saveParseCache(cache_file, path, size, mtime);
+    return true;
+}   // load
+
+// ----------------------------------------------------------------------------
+/** Maps the triangles from a cache file.
+ *  \return False if the cache file is missing, invalid or older than the
+ *          model.
+ */
+bool CollisionMesh::loadParseCache(const std::string& cache_file,
+                                   const std::string& path, uint64_t size,
+                                   int64_t mtime)
+{
+    std::unique_ptr<MappedFile> mapped(new MappedFile());
+    if (!mapped->open(cache_file))
+        return false;
+    CacheReader r;
+    r.m_start = r.m_pos = mapped->getData();
+    r.m_end = r.m_start + mapped->getSize();
+
+    uint32_t magic = 0, version = 0, count = 0;
+    uint64_t cached_size = 0, cached_mtime = 0;
+    std::string cached_path;
+    if (!r.getUInt32(&magic) || !r.getUInt32(&version) ||
+        magic != CACHE_MAGIC || version != CACHE_VERSION ||
+        !r.getUInt64(&cached_size) || !r.getUInt64(&cached_mtime) ||
+        cached_size != size || (int64_t)cached_mtime != mtime ||
+        !r.getString(&cached_path) || cached_path != path ||
+        !r.skipPadding() || !r.getUInt32(&count))
+        return false;
+
+    std::vector<Buffer> buffers(count);
+    for (Buffer& b : buffers)
+    {
+        if (!r.getString(&b.m_textures[0]) ||
+            !r.getString(&b.m_textures[1]) || !r.skipPadding() ||
+            !r.getUInt32(&b.m_vertex_count) ||
+            !r.getUInt32(&b.m_index_count) || b.m_vertex_count > 65536)
+            return false;
+        b.m_positions = (const core::vector3df*)r.get(b.m_vertex_count * 12);
+        b.m_normals = (const core::vector3df*)r.get(b.m_vertex_count * 12);
+        b.m_indices = (const uint16_t*)r.get(b.m_index_count * 2);
+        if (!b.m_positions || !b.m_normals || !b.m_indices ||
+            !r.skipPadding())
+            return false;
+        for (uint32_t i = 0; i < b.m_index_count; i++)
+        {
+            if (b.m_indices[i] >= b.m_vertex_count)
+                return false;
+        }
+        b.m_material = material_manager->getMaterialSPM(b.m_textures[0],
+            b.m_textures[1]);
+    }
+    m_buffers.swap(buffers);
+    m_parse_cache = std::move(mapped);
+    return true;
+}   // loadParseCache
+
+// ----------------------------------------------------------------------------
+/** Writes the triangles to a cache file. A temporary file is renamed at the
+ *  end, so other processes never map a half written file.
+ */
+void CollisionMesh::saveParseCache(const std::string& cache_file,
+                                   const std::string& path, uint64_t size,
+                                   int64_t mtime) const
+{
+#ifdef WIN32
+    int pid = _getpid();
+#else
+    int pid = getpid();
+#endif
+    std::string tmp = cache_file + "." + StringUtils::toString(pid) + ".tmp";
+    FILE* f = FileUtils::fopenU8Path(tmp, "wb");
+    if (!f)
+        return;
+    writeUInt32(f, CACHE_MAGIC);
+    writeUInt32(f, CACHE_VERSION);
+    fwrite(&size, 8, 1, f);
+    fwrite(&mtime, 8, 1, f);
+    writeString(f, path);
+    writePadding(f);
+    writeUInt32(f, (uint32_t)m_buffers.size());
+    for (const Buffer& b : m_buffers)
+    {
+        writeString(f, b.m_textures[0]);
+        writeString(f, b.m_textures[1]);
+        writePadding(f);
+        writeUInt32(f, b.m_vertex_count);
+        writeUInt32(f, b.m_index_count);
+        fwrite(b.m_positions, 12, b.m_vertex_count, f);
+        fwrite(b.m_normals, 12, b.m_vertex_count, f);
+        fwrite(b.m_indices, 2, b.m_index_count, f);
+        writePadding(f);
+    }
+    bool ok = ferror(f) == 0;
+    fclose(f);
+    if (ok)
+    {
+        remove(FileUtils::getPortableWritingPath(cache_file).c_str());
+        ok = FileUtils::renameU8Path(tmp, cache_file) == 0;
+    }
+    if (!ok)
+    {
+        Log::warn("CollisionMesh", "Cannot write cache %s of %s.",
+            cache_file.c_str(), path.c_str());
+        remove(FileUtils::getPortableWritingPath(tmp).c_str());
+    }
+}   // saveParseCache
+
+// ----------------------------------------------------------------------------
+/** Reads a static spm file, skipping everything only used for rendering.
+ *  The layout is the one read by SPMeshLoader::createMesh.
+ *  \return False if the file is not a static spm file.
+ */
+bool CollisionMesh::loadSPM(io::IReadFile* f, const std::string& base_path)
+{
+    char header[2];
+    if (f->read(header, 2) != 2 || header[0] != 'S' || header[1] != 'P')
+        return false;
+    uint8_t byte = 0;
+    f->read(&byte, 1);
+    // Version 1, and not SPMS (space partitioned) or SPMA (armature)
+    if ((byte >> 3) != 1 || (byte & ~0x08) <= 1)
+        return false;
+    f->read(&byte, 1);
+    const bool read_normal = byte & 0x01;
+    const bool read_vcolor = byte >> 1 & 0x01;
+    const bool read_tangent = byte >> 2 & 0x01;
+    // Bounding box
+    f->seek(24, true);
+
+    struct SPMMaterial
+    {
+        const Material* m_material;
+        std::string m_textures[2];
+        bool m_uv_one;
+        bool m_uv_two;
+    };
+    std::vector<SPMMaterial> materials;
+    io::IFileSystem* fs = file_manager->getFileSystem();
+    uint16_t size_num = 0;
+    f->read(&size_num, 2);
+    for (; size_num != 0; size_num--)
+    {
+        std::string tex_name[2];
+        for (int i = 0; i < 2; i++)
+        {
+            uint8_t tex_size = 0;
+            f->read(&tex_size, 1);
+            if (tex_size > 0)
+            {
+                tex_name[i].resize(tex_size);
+                f->read(&tex_name[i][0], tex_size);
+            }
+        }
+        SPMMaterial m;
+        m.m_uv_one = !tex_name[0].empty();
+        m.m_uv_two = !tex_name[1].empty();
+        // Same lookup as SPMeshLoader for real spm, so materials are the
+        // same as the ones of the clients
+        if (!tex_name[0].empty())
+        {
+            std::string full_path = base_path + "/" + tex_name[0];
+            if (fs->existFile(full_path.c_str()))
+                tex_name[0] = full_path;
+        }
+        m.m_material = material_manager->getMaterialSPM(tex_name[0],
+            tex_name[1]);
+        m.m_textures[0] = tex_name[0];
+        m.m_textures[1] = tex_name[1];
+        materials.push_back(m);
+    }
+
+    f->read(&size_num, 2);
+    for (; size_num != 0; size_num--)
+    {
+        uint16_t mat_size = 0;
+        f->read(&mat_size, 2);
+        for (; mat_size != 0; mat_size--)
+        {
+            uint32_t vertices_count = 0, indices_count = 0;
+            uint16_t mat_id = 0;
+            f->read(&vertices_count, 4);
+            f->read(&indices_count, 4);
+            f->read(&mat_id, 2);
+            if (vertices_count > 65535 || mat_id >= materials.size() ||
+                indices_count % 3 != 0)
+                return false;
+            const SPMMaterial& m = materials[mat_id];
+            m_buffers.push_back(Buffer());
+            Buffer& b = m_buffers.back();
+            b.m_material = m.m_material;
+            b.m_textures[0] = m.m_textures[0];
+            b.m_textures[1] = m.m_textures[1];
+            std::vector<core::vector3df>& positions = b.m_own_positions;
+            std::vector<core::vector3df>& normals = b.m_own_normals;
+            std::vector<uint16_t>& indices = b.m_own_indices;
+            positions.resize(vertices_count);
+            normals.resize(vertices_count);
+            for (unsigned i = 0; i < vertices_count; i++)
+            {
+                f->read(&positions[i], 12);
+                if (read_normal)
+                {
+                    uint32_t packed;
+                    f->read(&packed, 4);
+                    normals[i] = MiniGLM::decompressVector3(packed);
+                }
+                if (read_vcolor)
+                {
+                    // 128 is all white, else followed by rgb
+                    uint8_t ci = 0;
+                    f->read(&ci, 1);
+                    if (ci != 128)
+                        f->seek(3, true);
+                }
+                if (m.m_uv_one)
+                {
+                    long skip = 4;
+                    if (m.m_uv_two)
+                        skip += 4;
+                    if (read_tangent)
+                        skip += 4;
+                    f->seek(skip, true);
+                }
+            }
+            indices.resize(indices_count);
+            if (vertices_count > 255)
+            {
+                f->read(indices.data(), indices_count * 2);
+            }
+            else
+            {
+                std::vector<uint8_t> tmp_idx(indices_count);
+                f->read(tmp_idx.data(), indices_count);
+                for (unsigned i = 0; i < indices_count; i++)
+                    indices[i] = tmp_idx[i];
+            }
+            for (uint16_t idx : indices)
+            {
+                if (idx >= vertices_count)
+                    return false;
+            }
+            if (!read_normal)
+            {
+                for (unsigned i = 0; i < indices_count; i += 3)
+                {
+                    core::plane3df p(positions[indices[i]],
+                        positions[indices[i + 1]], positions[indices[i + 2]]);
+                    for (unsigned k = 0; k < 3; k++)
+                        normals[indices[i + k]] += p.Normal;
+                }
+                for (core::vector3df& n : normals)
+                    n.normalize();
+            }
+        }
+    }
+    return f->getPos() <= f->getSize();
+}   // loadSPM
+
+// ----------------------------------------------------------------------------
+/** Loads a model with irrlicht and copies its triangles, the same way as
+ *  Track::convertTrackToBullet does for non-spm mesh buffers.
+ */
+bool CollisionMesh::loadIrrlichtMesh(const std::string& full_path)
+{
+    scene::IMesh* mesh = irr_driver->getMesh(full_path);
+    if (!mesh)
+        return false;
+    for (unsigned i = 0; i < mesh->getMeshBufferCount(); i++)
+    {
+        scene::IMeshBuffer* mb = mesh->getMeshBuffer(i);
+        if (mb->getVertexType() != video::EVT_STANDARD &&
+            mb->getVertexType() != video::EVT_2TCOORDS &&
+            mb->getVertexType() != video::EVT_TANGENTS)
+        {
+            Log::warn("CollisionMesh", "Ignoring vertex type '%d' in %s.",
+                mb->getVertexType(), full_path.c_str());
+            continue;
+        }
+        const video::SMaterial& irr_material = mb->getMaterial();
+        std::string t_full_path[2];
+        for (unsigned t = 0; t < 2; t++)
+        {
+            video::ITexture* texture = irr_material.getTexture(t);
+            if (!texture)
+                continue;
+            t_full_path[t] = texture->getName().getPtr();
+            t_full_path[t] = file_manager->getFileSystem()->getAbsolutePath(
+                t_full_path[t].c_str()).c_str();
+        }
+        m_buffers.push_back(Buffer());
+        Buffer& b = m_buffers.back();
+        b.m_material = material_manager->getMaterialSPM(t_full_path[0],
+            t_full_path[1]);
+        b.m_textures[0] = t_full_path[0];
+        b.m_textures[1] = t_full_path[1];
+        for (unsigned j = 0; j < mb->getVertexCount(); j++)
+        {
+            b.m_own_positions.push_back(mb->getPosition(j));
+            b.m_own_normals.push_back(mb->getNormal(j));
+        }
+        // Complete triangles only
+        b.m_own_indices.assign(mb->getIndices(),
+            mb->getIndices() + mb->getIndexCount() / 3 * 3);
+    }
+    // Only the cache holds it, so the triangles are the only copy left
+    if (mesh->getReferenceCount() == 1)
+        irr_driver->removeMeshFromCache(mesh);
+    return true;
+}   // loadIrrlichtMesh
+
+// ----------------------------------------------------------------------------
+/** Returns the bounding box of all used vertices, untransformed. */
+void CollisionMesh::minMax3D(Vec3* min, Vec3* max) const
+{
+    *min = Vec3( 999999.9f);
+    *max = Vec3(-999999.9f);
+    for (const Buffer& b : m_buffers)
+    {
+        for (uint32_t i = 0; i < b.m_index_count; i++)
+        {
+            Vec3 c(b.m_positions[b.m_indices[i]]);
+            min->min(c);
+            max->max(c);
+        }
+    }
+}   // minMax3D
+
+// ----------------------------------------------------------------------------
+/** Adds the triangles to the physics meshes of the track.
+ *  \param transform Transformation of the model in the track.
+ *  \param track_mesh Mesh of the normal materials.
+ *  \param gfx_effect_mesh Mesh of the surface materials, which only
+ *         get a collision shape for raycasts.
+ */
+void CollisionMesh::addTriangles(const core::matrix4& transform,
+                                 TriangleMesh* track_mesh,
+                                 TriangleMesh* gfx_effect_mesh) const
+{
+    for (const Buffer& b : m_buffers)
+    {
+        TriangleMesh* tmesh = track_mesh;
+        // A material which is a surface must be converted, even if it's
+        // marked as ignore. So only ignore non-surface materials.
+        if (b.m_material->isSurface())
+            tmesh = gfx_effect_mesh;
+        else if (b.m_material->isIgnore())
+            continue;
+        Vec3 vertices[3];
+        Vec3 normals[3];
+        for (unsigned j = 0; j + 2 < b.m_index_count; j += 3)
+        {
+            for (unsigned k = 0; k < 3; k++)
+            {
+                uint16_t idx = b.m_indices[j + k];
+                core::vector3df v = b.m_positions[idx];
+                transform.transformVect(v);
+                vertices[k] = v;
+                normals[k] = b.m_normals[idx];
+            }
+            tmesh->addTriangle(vertices[0], vertices[1], vertices[2],
+                normals[0], normals[1], normals[2], b.m_material);
+        }
+    }
+}   // addTriangles
@@ -0,0 +1,120 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_COLLISION_MESH_HPP
+#define HEADER_COLLISION_MESH_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <matrix4.h>
+#include <vector3d.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace irr
+{
+    namespace io { class IReadFile; }
+}
+using namespace irr;
+
+class MappedFile;
+class Material;
+class TriangleMesh;
+class Vec3;
+
+/**
+ * \brief The triangles of a model needed for the physics only.
+ *  Used by servers without graphics instead of loading the model into an
+ *  irrlicht mesh and scene node: static spm files are read directly, keeping
+ *  only positions, normals, indices and the material of each mesh buffer.
+ *  No texture is loaded. Other formats (b3d, animated spm) are loaded by
+ *  irrlicht and removed from its cache right after copying the triangles.
+ *
+ *  The triangles are then written to a parse cache file in the cached
+ *  assets directory, which is mapped read-only the next time the model is
+ *  loaded (until the model file changes). This only skips parsing the model:
+ *  the mesh is kept while loading the track, the triangles are copied into
+ *  the TriangleMesh of the track (transformed, and Bullet needs its own
+ *  copy), so each process still has its own memory for them.
+ * \ingroup physics
+ */
+class CollisionMesh : public NoCopy
+{
+private:
+    struct Buffer
+    {
+        const Material*              m_material;
+        /** Textures given to MaterialManager::getMaterialSPM. */
+        std::string                  m_textures[2];
+        uint32_t                     m_vertex_count;
+        uint32_t                     m_index_count;
+        /** Either the data below or mapped from the cache file. */
+        const core::vector3df*       m_positions;
+        const core::vector3df*       m_normals;
+        const uint16_t*              m_indices;
+        std::vector<core::vector3df> m_own_positions;
+        std::vector<core::vector3df> m_own_normals;
+        std::vector<uint16_t>        m_own_indices;
+    };
+
+    std::vector<Buffer> m_buffers;
+
+    /** The parse cache file the buffers are mapped from, if any. */
+    std::unique_ptr<MappedFile> m_parse_cache;
+
+    bool loadSPM(io::IReadFile* file, const std::string& base_path);
+    // ------------------------------------------------------------------------
+    bool loadIrrlichtMesh(const std::string& full_path);
+    // ------------------------------------------------------------------------
+    bool loadParseCache(const std::string& cache_file,
+                        const std::string& path, uint64_t size, int64_t mtime);
+    // ------------------------------------------------------------------------
+    void saveParseCache(const std::string& cache_file,
+                        const std::string& path, uint64_t size,
+                        int64_t mtime) const;
+
+public:
+    CollisionMesh();
+    // ------------------------------------------------------------------------
+    ~CollisionMesh();
+    // ------------------------------------------------------------------------
+    bool load(const std::string& full_path);
+    // ------------------------------------------------------------------------
+    void minMax3D(Vec3* min, Vec3* max) const;
+    // ------------------------------------------------------------------------
+    void addTriangles(const core::matrix4& transform,
+                      TriangleMesh* track_mesh,
+                      TriangleMesh* gfx_effect_mesh) const;
+    // ------------------------------------------------------------------------
+    /** Returns true if the triangles are mapped from the parse cache. */
+    bool isFromParseCache() const          { return m_parse_cache != NULL; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of triangles. */
+    unsigned getNumTriangles() const
+    {
+        unsigned count = 0;
+        for (const Buffer& b : m_buffers)
+            count += b.m_index_count / 3;
+        return count;
+    }
+};   // class CollisionMesh
+
+#endif
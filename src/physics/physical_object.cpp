@@ -31,6 +31,7 @@
 #include "physics/triangle_mesh.hpp"
 #include "network/compress_network_body.hpp"
 #include "network/network_config.hpp"
+#include "network/network_string.hpp"
 #include "network/protocols/lobby_protocol.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_object.hpp"
@@ -31,7 +31,9 @@
 #include "karts/controller/local_player_controller.hpp"
 #include "modes/soccer_world.hpp"
 #include "modes/world.hpp"
+#include "network/compress_network_body.hpp"
 #include "network/network_config.hpp"
+#include "network/rewind_manager.hpp"
 #include "karts/explosion_animation.hpp"
 #include "physics/btKart.hpp"
 #include "physics/irr_debug_drawer.hpp"
@@ -93,6 +95,7 @@ void Physics::init(const Vec3 &world_min, const Vec3 &world_max)
                                                  this,
                                                  m_collision_conf);
     m_karts_to_delete.clear();
+    CompressNetworkBody::setPositionBounds(world_min, world_max);
     m_dynamics_world->setGravity(
         btVector3(0.0f,
                   -Track::getCurrentTrack()->getGravity(),
@@ -215,6 +218,9 @@ void Physics::update(int ticks)
         // --------------------
         if(p->getUserPointer(0)->is(UserPointer::UP_KART))
         {
+            RewindManager::get()->addInteraction(
+                p->getUserPointer(0)->getPointerKart(),
+                p->getUserPointer(1)->getPointerKart());
             KartKartCollision(p->getUserPointer(0)->getPointerKart(),
                               p->getContactPointCS(0),
                               p->getUserPointer(1)->getPointerKart(),
@@ -239,6 +245,7 @@ void Physics::update(int ticks)
             // Kart hits physical object
             // -------------------------
             AbstractKart *kart = p->getUserPointer(1)->getPointerKart();
+            RewindManager::get()->addInteraction(kart);
             int kartId = kart->getWorldKartId();
             PhysicalObject* obj = p->getUserPointer(0)->getPointerPhysicalObject();
             std::string obj_id = obj->getID();
@@ -298,6 +305,8 @@ void Physics::update(int ticks)
         {
             // Kart hits animation
             ThreeDAnimation *anim=p->getUserPointer(0)->getPointerAnimation();
+            RewindManager::get()->addInteraction(
+                p->getUserPointer(1)->getPointerKart());
             if(anim->isCrashReset())
             {
                 AbstractKart *kart = p->getUserPointer(1)->getPointerKart();
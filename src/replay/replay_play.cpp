@@ -20,6 +20,8 @@
 
 #include "config/stk_config.hpp"
 #include "io/file_manager.hpp"
+#include "io/utf_writer.hpp"
+#include "io/xml_node.hpp"
 #include "karts/ghost_kart.hpp"
 #include "karts/controller/ghost_controller.hpp"
 #include "modes/world.hpp"
@@ -45,6 +47,8 @@ ReplayPlay::ReplayPlay()
     m_current_replay_file   = 0;
     m_second_replay_file    = 0;
     m_second_replay_enabled = false;
+    m_replay_index_loaded   = false;
+    m_replay_index_changed  = false;
 }   // ReplayPlay
 
 //-----------------------------------------------------------------------------
@@ -65,9 +69,15 @@ void ReplayPlay::reset()
 }   // reset
 
 //-----------------------------------------------------------------------------
+/** Lists the stock and user recorded replays. Only the headers of files not
+ *  in the replay index, or changed since they were indexed, are parsed.
+ */
 void ReplayPlay::loadAllReplayFile()
 {
     m_replay_file_list.clear();
+    loadReplayIndex();
+    for (auto& entry : m_replay_index)
+        entry.second.m_used = false;
 
     // Load stock replay first
     std::set<std::string> pre_record;
@@ -101,22 +111,250 @@ void ReplayPlay::loadAllReplayFile()
         j++;
     }
 
+    // Forget deleted replays
+    for (auto it = m_replay_index.begin(); it != m_replay_index.end();)
+    {
+        if (it->second.m_used)
+        {
+            it++;
+            continue;
+        }
+        it = m_replay_index.erase(it);
+        m_replay_index_changed = true;
+    }
+    if (m_replay_index_changed)
+        saveReplayIndex();
 }   // loadAllReplayFile
 
 //-----------------------------------------------------------------------------
-bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int call_index)
+/** Reads the replay index once, an outdated or broken index is ignored and
+ *  rebuilt.
+ */
+void ReplayPlay::loadReplayIndex()
 {
+    if (m_replay_index_loaded)
+        return;
+    m_replay_index_loaded = true;
+    m_replay_index_changed = false;
+    m_replay_index.clear();
 
-    char s[1024], s1[1024];
+    const std::string filename =
+        file_manager->getUserConfigFile("replay_index.xml");
+    if (!file_manager->fileExists(filename))
+        return;
+    XMLNode* root = file_manager->createXMLTree(filename);
+    if (!root)
+        return;
+    unsigned int version = 0;
+    root->get("replay-version", &version);
+    if (root->getName() != "replay-index" ||
+        version != getCurrentReplayVersion())
+    {
+        delete root;
+        return;
+    }
+
+    for (unsigned int i = 0; i < root->getNumNodes(); i++)
+    {
+        const XMLNode* node = root->getNode(i);
+        core::stringw path;
+        std::string mtime, size;
+        IndexEntry entry;
+        if (node->getName() != "replay" || !node->get("path", &path) ||
+            !node->get("mtime", &mtime) ||
+            !StringUtils::fromString(mtime, entry.m_mtime) ||
+            !node->get("size", &size) ||
+            !StringUtils::fromString(size, entry.m_size))
+            continue;
+        entry.m_valid = false;
+        node->get("valid", &entry.m_valid);
+        entry.m_used = false;
+        if (entry.m_valid)
+        {
+            ReplayData& rd = entry.m_data;
+            std::string uid;
+            if (!node->get("version", &rd.m_replay_version) ||
+                !node->get("track", &rd.m_track_name) ||
+                !node->get("mode", &rd.m_minor_mode) ||
+                !node->get("reverse", &rd.m_reverse) ||
+                !node->get("difficulty", &rd.m_difficulty) ||
+                !node->get("laps", &rd.m_laps) ||
+                !node->get("min-time", &rd.m_min_time) ||
+                !node->get("uid", &uid) ||
+                !StringUtils::fromString(uid, rd.m_replay_uid))
+                continue;
+            node->get("stk-version", &rd.m_stk_version);
+            node->get("user", &rd.m_user_name);
+            for (unsigned int k = 0; k < node->getNumNodes(); k++)
+            {
+                const XMLNode* kart = node->getNode(k);
+                std::string ident;
+                core::stringw name;
+                float color = 0.0f;
+                kart->get("ident", &ident);
+                kart->get("name", &name);
+                kart->get("color", &color);
+                rd.m_kart_list.push_back(ident);
+                rd.m_name_list.push_back(name);
+                rd.m_kart_color.push_back(color);
+            }
+        }
+        m_replay_index[StringUtils::wideToUtf8(path)] = entry;
+    }
+    delete root;
+}   // loadReplayIndex
+
+//-----------------------------------------------------------------------------
+/** Writes a float with enough digits to read back the same value, so the
+ *  replay index gives the same result as reading the replay file.
+ */
+static std::string exactFloat(float f)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", f);
+    return buffer;
+}   // exactFloat
+
+//-----------------------------------------------------------------------------
+/** Writes the headers of all known replay files, so that they don't need to
+ *  be parsed next time.
+ */
+void ReplayPlay::saveReplayIndex()
+{
+    const std::string filename =
+        file_manager->getUserConfigFile("replay_index.xml");
+    try
+    {
+        UTFWriter index_file(filename.c_str(), false);
+        index_file << "<?xml version=\"1.0\"?>\n";
+        index_file << "<replay-index replay-version=\""
+                   << getCurrentReplayVersion() << "\">\n";
+        for (auto& p : m_replay_index)
+        {
+            const IndexEntry& entry = p.second;
+            index_file << "    <replay path=\""
+                << StringUtils::xmlEncode(StringUtils::utf8ToWide(p.first))
+                << "\" mtime=\"" << entry.m_mtime
+                << "\" size=\"" << entry.m_size
+                << "\" valid=\"" << entry.m_valid << "\"";
+            if (!entry.m_valid)
+            {
+                index_file << "/>\n";
+                continue;
+            }
+            const ReplayData& rd = entry.m_data;
+            index_file << "\n            version=\"" << rd.m_replay_version
+                << "\" stk-version=\"" << StringUtils::xmlEncode(rd.m_stk_version)
+                << "\" mode=\"" << rd.m_minor_mode
+                << "\" track=\"" << rd.m_track_name
+                << "\" reverse=\"" << rd.m_reverse
+                << "\" difficulty=\"" << rd.m_difficulty
+                << "\" laps=\"" << rd.m_laps
+                << "\" min-time=\"" << exactFloat(rd.m_min_time)
+                << "\" uid=\"" << rd.m_replay_uid
+                << "\" user=\"" << StringUtils::xmlEncode(rd.m_user_name)
+                << "\">\n";
+            for (unsigned int i = 0; i < rd.m_kart_list.size(); i++)
+            {
+                index_file << "        <kart ident=\"" << rd.m_kart_list[i]
+                    << "\" name=\"" << StringUtils::xmlEncode(rd.m_name_list[i])
+                    << "\" color=\"" << exactFloat(rd.m_kart_color[i])
+                    << "\"/>\n";
+            }
+            index_file << "    </replay>\n";
+        }
+        index_file << "</replay-index>\n";
+        index_file.close();
+        m_replay_index_changed = false;
+    }
+    catch (std::runtime_error& e)
+    {
+        Log::error("Replay", "Failed to write replay index to %s.",
+                   filename.c_str());
+        Log::error("Replay", "Error: %s", e.what());
+    }
+}   // saveReplayIndex
+
+//-----------------------------------------------------------------------------
+/** Adds a replay file to the list of replays, using the header data from the
+ *  replay index if the file did not change since it was indexed.
+ *  \param fn File name in the replay directory, or full path if
+ *         custom_replay is set.
+ *  \param call_index Used as UID of replays older than version 4.
+ */
+bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int call_index)
+{
     if (StringUtils::getExtension(fn) != "replay") return false;
-    FILE* fd = FileUtils::fopenU8Path(custom_replay ? fn :
-        file_manager->getReplayDir() + fn, "r");
-    if (fd == NULL) return false;
-    ReplayData rd;
+    const std::string path = custom_replay ? fn :
+        file_manager->getReplayDir() + fn;
+    struct stat st;
+    if (FileUtils::statU8Path(path, &st) != 0) return false;
+
+    loadReplayIndex();
+    auto it = m_replay_index.find(path);
+    if (it == m_replay_index.end() ||
+        it->second.m_mtime != (uint64_t)st.st_mtime ||
+        it->second.m_size != (uint64_t)st.st_size)
+    {
+        IndexEntry& entry = m_replay_index[path];
+        entry.m_mtime = (uint64_t)st.st_mtime;
+        entry.m_size = (uint64_t)st.st_size;
+        entry.m_data = ReplayData();
+        entry.m_valid = readReplayHeader(path, &entry.m_data);
+        m_replay_index_changed = true;
+        it = m_replay_index.find(path);
+    }
+    it->second.m_used = true;
+    if (!it->second.m_valid)
+        return false;
 
+    ReplayData rd = it->second.m_data;
     // custom_replay is true when full path of filename is given
     rd.m_custom_replay_file = custom_replay;
     rd.m_filename = fn;
+    // No UID in old replay format
+    if (rd.m_replay_version < 4)
+        rd.m_replay_uid = call_index;
+
+    // If former official tracks are present as addons, show the matching replays.
+    if (rd.m_track_name.compare("greenvalley") == 0)
+        rd.m_track_name = std::string("addon_green-valley");
+    if (rd.m_track_name.compare("mansion") == 0)
+        rd.m_track_name = std::string("addon_blackhill-mansion");
+
+    Track* t = track_manager->getTrack(rd.m_track_name);
+    if (t == NULL)
+    {
+        Log::warn("Replay", "Track '%s' used in replay '%s' not found in STK!",
+        rd.m_track_name.c_str(), fn.c_str());
+        return false;
+    }
+
+    rd.m_track = t;
+    m_replay_file_list.push_back(rd);
+
+    assert(m_replay_file_list.size() > 0);
+    // Force to use custom replay file immediately
+    if (custom_replay)
+        m_current_replay_file = (unsigned int)m_replay_file_list.size() - 1;
+
+    return true;
+
+}   // addReplayFile
+
+//-----------------------------------------------------------------------------
+/** Parses the header of a replay file, without checking if its track is
+ *  available. The replay UID of replays older than version 4 is left at 0.
+ *  \param path Full path of the replay file.
+ *  \param rd Returns the header data.
+ *  \return False if it is no valid replay file.
+ */
+bool ReplayPlay::readReplayHeader(const std::string& path,
+                                  ReplayData* rd) const
+{
+    char s[1024], s1[1024];
+    FILE* fd = FileUtils::fopenU8Path(path, "r");
+    if (fd == NULL) return false;
 
     fgets(s, 1023, fd);
     unsigned int version;
@@ -133,25 +371,25 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int ca
         Log::warn("Replay", "Replay is version '%d'", version);
         Log::warn("Replay", "STK replay version is '%d'", getCurrentReplayVersion());
         Log::warn("Replay", "Minimum supported replay version is '%d'", getMinSupportedReplayVersion());
-        Log::warn("Replay", "Skipped '%s'", fn.c_str());
+        Log::warn("Replay", "Skipped '%s'", path.c_str());
         fclose(fd);
         return false;
     }
-        rd.m_replay_version = version;
+    rd->m_replay_version = version;
 
     if (version >= 4)
     {
         fgets(s, 1023, fd);
         if(sscanf(s, "stk_version: %1023s", s1) != 1)
         {
-            Log::warn("Replay", "No STK release version found in replay file, '%s'.", fn.c_str());
+            Log::warn("Replay", "No STK release version found in replay file, '%s'.", path.c_str());
             fclose(fd);
             return false;
         }
-        rd.m_stk_version = s1;
+        rd->m_stk_version = s1;
     }
     else
-        rd.m_stk_version = "";
+        rd->m_stk_version = "";
 
     while(true)
     {
@@ -169,21 +407,21 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int ca
             break;
         }
 
-        rd.m_kart_list.push_back(std::string(s1));
+        rd->m_kart_list.push_back(std::string(s1));
         if (scanned == 2)
         {
             // If username of kart is present, use it
-            rd.m_name_list.push_back(StringUtils::xmlDecode(std::string(display_name_encoded)));
-            if (rd.m_name_list.size() == 1)
+            rd->m_name_list.push_back(StringUtils::xmlDecode(std::string(display_name_encoded)));
+            if (rd->m_name_list.size() == 1)
             {
                 // First user is the game master and the "owner" of this replay file
-                rd.m_user_name = rd.m_name_list[0];
+                rd->m_user_name = rd->m_name_list[0];
             }
         } else
         { // scanned == 1
             // If username is not present, kart display name will default to kart name
             // (see GhostController::getName)
-            rd.m_name_list.push_back("");
+            rd->m_name_list.push_back("");
         }
 
         // Read kart color data
@@ -193,30 +431,30 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int ca
             fgets(s, 1023, fd);
             if(sscanf(s, "kart_color: %f", &f) != 1)
             {
-                Log::warn("Replay", "Kart color missing in replay file, '%s'.", fn.c_str());
+                Log::warn("Replay", "Kart color missing in replay file, '%s'.", path.c_str());
                 fclose(fd);
                 return false;
             }
-            rd.m_kart_color.push_back(f);
+            rd->m_kart_color.push_back(f);
         }
         else
-            rd.m_kart_color.push_back(0.0f); // Use default kart color
+            rd->m_kart_color.push_back(0.0f); // Use default kart color
     }
 
     int reverse = 0;
     fgets(s, 1023, fd);
     if(sscanf(s, "reverse: %d", &reverse) != 1)
     {
-        Log::warn("Replay", "No reverse info found in replay file, '%s'.", fn.c_str());
+        Log::warn("Replay", "No reverse info found in replay file, '%s'.", path.c_str());
         fclose(fd);
         return false;
     }
-    rd.m_reverse = reverse != 0;
+    rd->m_reverse = reverse != 0;
 
     fgets(s, 1023, fd);
-    if (sscanf(s, "difficulty: %u", &rd.m_difficulty) != 1)
+    if (sscanf(s, "difficulty: %u", &rd->m_difficulty) != 1)
     {
-        Log::warn("Replay", " No difficulty found in replay file, '%s'.", fn.c_str());
+        Log::warn("Replay", " No difficulty found in replay file, '%s'.", path.c_str());
         fclose(fd);
         return false;
     }
@@ -226,55 +464,38 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int ca
         fgets(s, 1023, fd);
         if (sscanf(s, "mode: %1023s", s1) != 1)
         {
-            Log::warn("Replay", "Replay mode not found in replay file, '%s'.", fn.c_str());
+            Log::warn("Replay", "Replay mode not found in replay file, '%s'.", path.c_str());
             fclose(fd);
             return false;
         }
-        rd.m_minor_mode = s1;
+        rd->m_minor_mode = s1;
     }
     // Assume time-trial mode for old replays
     else
-        rd.m_minor_mode = "time-trial";
+        rd->m_minor_mode = "time-trial";
 
 
     fgets(s, 1023, fd);
     if (sscanf(s, "track: %1023s", s1) != 1)
     {
-        Log::warn("Replay", "Track info not found in replay file, '%s'.", fn.c_str());
+        Log::warn("Replay", "Track info not found in replay file, '%s'.", path.c_str());
         fclose(fd);
         return false;
     }
-    rd.m_track_name = std::string(s1);
-
-    // If former official tracks are present as addons, show the matching replays.
-    if (rd.m_track_name.compare("greenvalley") == 0)
-        rd.m_track_name = std::string("addon_green-valley");
-    if (rd.m_track_name.compare("mansion") == 0)
-        rd.m_track_name = std::string("addon_blackhill-mansion");
-
-    Track* t = track_manager->getTrack(rd.m_track_name);
-    if (t == NULL)
-    {
-        Log::warn("Replay", "Track '%s' used in replay '%s' not found in STK!",
-        rd.m_track_name.c_str(), fn.c_str());
-        fclose(fd);
-        return false;
-    }
-
-    rd.m_track = t;
+    rd->m_track_name = std::string(s1);
 
     fgets(s, 1023, fd);
-    if (sscanf(s, "laps: %u", &rd.m_laps) != 1)
+    if (sscanf(s, "laps: %u", &rd->m_laps) != 1)
     {
-        Log::warn("Replay", "No number of laps found in replay file, '%s'.", fn.c_str());
+        Log::warn("Replay", "No number of laps found in replay file, '%s'.", path.c_str());
         fclose(fd);
         return false;
     }
 
     fgets(s, 1023, fd);
-    if (sscanf(s, "min_time: %f", &rd.m_min_time) != 1)
+    if (sscanf(s, "min_time: %f", &rd->m_min_time) != 1)
     {
-        Log::warn("Replay", "Finish time not found in replay file, '%s'.", fn.c_str());
+        Log::warn("Replay", "Finish time not found in replay file, '%s'.", path.c_str());
         fclose(fd);
         return false;
     }
@@ -282,28 +503,20 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int ca
     if (version >= 4)
     {
         fgets(s, 1023, fd);
-        if (sscanf(s, "replay_uid: %" PRIu64, &rd.m_replay_uid) != 1)
+        if (sscanf(s, "replay_uid: %" PRIu64, &rd->m_replay_uid) != 1)
         {
-            Log::warn("Replay", "Replay UID not found in replay file, '%s'.", fn.c_str());
+            Log::warn("Replay", "Replay UID not found in replay file, '%s'.", path.c_str());
             fclose(fd);
             return false;
         }
     }
     // No UID in old replay format
     else
-        rd.m_replay_uid = call_index;
+        rd->m_replay_uid = 0;
 
     fclose(fd);
-    m_replay_file_list.push_back(rd);
-
-    assert(m_replay_file_list.size() > 0);
-    // Force to use custom replay file immediately
-    if (custom_replay)
-        m_current_replay_file = (unsigned int)m_replay_file_list.size() - 1;
-
     return true;
-
-}   // addReplayFile
+}   // readReplayHeader
 
 //-----------------------------------------------------------------------------
 void ReplayPlay::load()
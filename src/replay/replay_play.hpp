@@ -24,6 +24,7 @@
 
 #include "irrString.h"
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -122,9 +123,32 @@ private:
     /** All ghost karts. */
     std::vector<std::shared_ptr<GhostKart> > m_ghost_karts;
 
+    /** Header of a replay file in the replay index, valid as long as the
+     *  file keeps its modification time and size. */
+    struct IndexEntry
+    {
+        uint64_t   m_mtime;
+        uint64_t   m_size;
+        /** False if the file is no valid replay. */
+        bool       m_valid;
+        /** Set if the file was found in the last loadAllReplayFile(). */
+        bool       m_used;
+        ReplayData m_data;
+    };
+
+    /** Replay index, indexed by the full path of the replay files. */
+    std::map<std::string, IndexEntry> m_replay_index;
+
+    bool                     m_replay_index_loaded;
+
+    bool                     m_replay_index_changed;
+
           ReplayPlay();
          ~ReplayPlay();
     void  readKartData(FILE *fd, char *next_line, bool second_replay);
+    bool  readReplayHeader(const std::string& path, ReplayData* rd) const;
+    void  loadReplayIndex();
+    void  saveReplayIndex();
 public:
     void  reset();
     void  load();
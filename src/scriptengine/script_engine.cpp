@@ -42,12 +42,76 @@ extern "C"
 #include "tracks/track_object_manager.hpp"
 #include "tracks/track.hpp"
 #include "utils/file_utils.hpp"
+#include "utils/mapped_file.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/profiler.hpp"
+#include "utils/time.hpp"
+
+#include <cstdio>
+#ifdef WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
 
 
 using namespace Scripting;
 
+namespace
+{
+    /** Increase if the layout of the bytecode files changes. */
+    const uint32_t BYTECODE_MAGIC   = 0x42435453; // "STCB"
+    const uint32_t BYTECODE_VERSION = 1;
+
+    // ------------------------------------------------------------------------
+    void hashString(uint64_t* hash, const char* s)
+    {
+        if (!s)
+            s = "";
+        // Include the terminating 0 so that "ab" "c" differs from "a" "bc"
+        do
+        {
+            *hash = (*hash ^ (uint8_t)*s) * 1099511628211ull;
+        } while (*s++);
+    }   // hashString
+
+    // ------------------------------------------------------------------------
+    /** Writes bytecode to memory. */
+    class ByteCodeWriter : public asIBinaryStream
+    {
+    public:
+        std::string m_data;
+        // --------------------------------------------------------------------
+        virtual int Read(void* ptr, asUINT size)               { return -1; }
+        // --------------------------------------------------------------------
+        virtual int Write(const void* ptr, asUINT size)
+        {
+            m_data.append((const char*)ptr, size);
+            return 0;
+        }
+    };   // ByteCodeWriter
+
+    // ------------------------------------------------------------------------
+    /** Reads bytecode from a mapped file. */
+    class ByteCodeReader : public asIBinaryStream
+    {
+    public:
+        const uint8_t* m_pos;
+        const uint8_t* m_end;
+        // --------------------------------------------------------------------
+        virtual int Read(void* ptr, asUINT size)
+        {
+            if ((size_t)(m_end - m_pos) < size)
+                return -1;
+            memcpy(ptr, m_pos, size);
+            m_pos += size;
+            return 0;
+        }
+        // --------------------------------------------------------------------
+        virtual int Write(const void* ptr, asUINT size)        { return -1; }
+    };   // ByteCodeReader
+}   // anonymous namespace
+
 namespace Scripting
 {
     const char* MODULE_ID_MAIN_SCRIPT_FILE = "main";
@@ -80,12 +144,15 @@ namespace Scripting
         // Configure the script engine with all the functions, 
         // and variables that the script should be able to use.
         configureEngine(m_engine);
+        computeApiHash();
     }
 
     ScriptEngine::~ScriptEngine()
     {
         // Release the engine
         m_pending_timeouts.clearAndDeleteAll();
+        for (auto& f : m_eval_cache)
+            f.second->Release();
         m_engine->DiscardModule(MODULE_ID_MAIN_SCRIPT_FILE);
         m_engine->Release();
     }
@@ -174,18 +241,37 @@ namespace Scripting
 
     //-----------------------------------------------------------------------------
 
+    /** Compiles and runs a fragment of script. Compiled fragments are kept
+     *  until the module is discarded, so running the same fragment again
+     *  does not compile it again.
+     */
     void ScriptEngine::evalScript(std::string script_fragment)
     {
         script_fragment = "void evalScript_main() { \n" + script_fragment + "\n}";
 
         asIScriptModule* mod = m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE, asGM_ONLY_IF_EXISTS);
+        if (mod == NULL)
+        {
+            Log::error("Scripting", "evalScript: No script is loaded.");
+            return;
+        }
 
         asIScriptFunction* func;
-        int r = mod->CompileFunction("eval", script_fragment.c_str(), 0, 0, &func);
-        if (r < 0)
+        auto cached = m_eval_cache.find(script_fragment);
+        if (cached != m_eval_cache.end())
         {
-            Log::error("Scripting", "evalScript: CompileFunction() failed");
-            return;
+            func = cached->second;
+        }
+        else
+        {
+            int r = mod->CompileFunction("eval", script_fragment.c_str(), 0, 0,
+                &func);
+            if (r < 0)
+            {
+                Log::error("Scripting", "evalScript: CompileFunction() failed");
+                return;
+            }
+            m_eval_cache[script_fragment] = func;
         }
 
         asIScriptContext *ctx = m_engine->CreateContext();
@@ -196,7 +282,7 @@ namespace Scripting
             return;
         }
 
-        r = ctx->Prepare(func);
+        int r = ctx->Prepare(func);
         if (r < 0)
         {
             Log::error("Scripting", "evalScript: Failed to prepare the context.");
@@ -224,7 +310,6 @@ namespace Scripting
         }
 
         ctx->Release();
-        func->Release();
     }
 
     //-----------------------------------------------------------------------------
@@ -486,6 +571,10 @@ namespace Scripting
                 curr.second->Release();
         }
         m_functions_cache.clear();
+        for (auto& f : m_eval_cache)
+            f.second->Release();
+        m_eval_cache.clear();
+        m_script_sections.clear();
         m_engine->DiscardModule(MODULE_ID_MAIN_SCRIPT_FILE);
     }
 
@@ -522,8 +611,6 @@ namespace Scripting
 
     bool ScriptEngine::loadScript(std::string script_path, bool clear_previous)
     {
-        int r;
-
         std::string script = getScript(script_path);
         if (script.size() == 0)
         {
@@ -531,30 +618,58 @@ namespace Scripting
             return false;
         }
 
-        // Add the script sections that will be compiled into executable code.
-        // If we want to combine more than one file into the same script, then 
-        // we can call AddScriptSection() several times for the same module and
-        // the script engine will treat them all as if they were one. The script
-        // section name, will allow us to localize any errors in the script code.
-        asIScriptModule *mod = m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE,
-            clear_previous ? asGM_ALWAYS_CREATE : asGM_CREATE_IF_NOT_EXISTS);
-        r = mod->AddScriptSection("script", &script[0], script.size());
-        if (r < 0)
+        // The script sections are only added to the module in
+        // compileLoadedScripts, if there is no cached bytecode for them.
+        if (clear_previous)
         {
-            Log::error("Scripting", "AddScriptSection() failed");
-            return false;
+            m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE, asGM_ALWAYS_CREATE);
+            m_script_sections.clear();
         }
-    
+        m_script_sections.push_back(script);
         return true;
     }
 
     //-----------------------------------------------------------------------------
 
+    /** Compiles all scripts loaded with loadScript, or loads their bytecode
+     *  from the cache if they were compiled before with the same engine.
+     */
     bool ScriptEngine::compileLoadedScripts()
     {
         int r;
+        uint64_t start = StkTime::getMonoTimeMs();
+        std::string bytecode_file;
+        if (!m_script_sections.empty())
+            bytecode_file = getByteCodeFile();
+        if (!bytecode_file.empty() && loadByteCode(bytecode_file))
+        {
+            Log::info("Scripting", "Loaded cached bytecode of %d scripts in "
+                "%dms.", (int)m_script_sections.size(),
+                (int)(StkTime::getMonoTimeMs() - start));
+            m_script_sections.clear();
+            return true;
+        }
+
         asIScriptModule *mod = m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE, asGM_CREATE_IF_NOT_EXISTS);
 
+        // Add the script sections that will be compiled into executable code.
+        // If we want to combine more than one file into the same script, then 
+        // we can call AddScriptSection() several times for the same module and
+        // the script engine will treat them all as if they were one. The script
+        // section name, will allow us to localize any errors in the script code.
+        for (const std::string& script : m_script_sections)
+        {
+            r = mod->AddScriptSection("script", script.data(), script.size());
+            if (r < 0)
+            {
+                Log::error("Scripting", "AddScriptSection() failed");
+                m_script_sections.clear();
+                return false;
+            }
+        }
+        const int section_count = (int)m_script_sections.size();
+        m_script_sections.clear();
+
         // Compile the script. If there are any compiler messages they will
         // be written to the message stream that we set right after creating the 
         // script engine. If there are no errors, and no warnings, nothing will
@@ -565,6 +680,13 @@ namespace Scripting
             Log::error("Scripting", "Build() failed");
             return false;
         }
+        if (section_count > 0)
+        {
+            Log::info("Scripting", "Compiled %d scripts in %dms.",
+                section_count, (int)(StkTime::getMonoTimeMs() - start));
+        }
+        if (!bytecode_file.empty())
+            saveByteCode(bytecode_file);
 
         // The engine doesn't keep a copy of the script sections after Build() has
         // returned. So if the script needs to be recompiled, then all the script
@@ -579,6 +701,161 @@ namespace Scripting
         return true;
     }
 
+    //-----------------------------------------------------------------------------
+    /** Hashes the declarations of all functions, types, properties and enums
+     *  registered by configureEngine, so that cached bytecode is not used
+     *  after the script API changed.
+     */
+    void ScriptEngine::computeApiHash()
+    {
+        uint64_t hash = 14695981039346656037ull;
+        hashString(&hash, ANGELSCRIPT_VERSION_STRING);
+        hashString(&hash, asGetLibraryOptions());
+        hashString(&hash, STK_VERSION);
+        hashString(&hash, sizeof(void*) == 8 ? "64" : "32");
+        for (asUINT i = 0; i < m_engine->GetGlobalFunctionCount(); i++)
+        {
+            hashString(&hash, m_engine->GetGlobalFunctionByIndex(i)
+                ->GetDeclaration(true, true, true));
+        }
+        for (asUINT i = 0; i < m_engine->GetGlobalPropertyCount(); i++)
+        {
+            const char *name = NULL, *name_space = NULL;
+            int type_id = 0;
+            m_engine->GetGlobalPropertyByIndex(i, &name, &name_space, &type_id);
+            hashString(&hash, name_space);
+            hashString(&hash, name);
+            hashString(&hash, m_engine->GetTypeDeclaration(type_id, true));
+        }
+        for (asUINT i = 0; i < m_engine->GetObjectTypeCount(); i++)
+        {
+            asITypeInfo* type = m_engine->GetObjectTypeByIndex(i);
+            hashString(&hash, type->GetName());
+            for (asUINT j = 0; j < type->GetFactoryCount(); j++)
+                hashString(&hash, type->GetFactoryByIndex(j)->GetDeclaration());
+            for (asUINT j = 0; j < type->GetBehaviourCount(); j++)
+            {
+                asEBehaviours behaviour;
+                hashString(&hash, type->GetBehaviourByIndex(j, &behaviour)
+                    ->GetDeclaration());
+            }
+            for (asUINT j = 0; j < type->GetMethodCount(); j++)
+                hashString(&hash, type->GetMethodByIndex(j)->GetDeclaration());
+            for (asUINT j = 0; j < type->GetPropertyCount(); j++)
+                hashString(&hash, type->GetPropertyDeclaration(j, true));
+        }
+        for (asUINT i = 0; i < m_engine->GetEnumCount(); i++)
+        {
+            asITypeInfo* type = m_engine->GetEnumByIndex(i);
+            hashString(&hash, type->GetName());
+            for (asUINT j = 0; j < type->GetEnumValueCount(); j++)
+            {
+                int value = 0;
+                hashString(&hash, type->GetEnumValueByIndex(j, &value));
+                hashString(&hash, StringUtils::toString(value).c_str());
+            }
+        }
+        for (asUINT i = 0; i < m_engine->GetFuncdefCount(); i++)
+        {
+            hashString(&hash, m_engine->GetFuncdefByIndex(i)->GetFuncdefSignature()
+                ->GetDeclaration(true, true, true));
+        }
+        m_api_hash = hash;
+    }   // computeApiHash
+
+    //-----------------------------------------------------------------------------
+    /** Returns the bytecode file for the loaded scripts in the cache
+     *  directory, named after the hash of the scripts and of the API. Empty
+     *  if there is no cache directory.
+     */
+    std::string ScriptEngine::getByteCodeFile() const
+    {
+        std::string dir = file_manager->getCachedAssetsDir();
+        if (dir.empty())
+            return "";
+        uint64_t hash = m_api_hash;
+        for (const std::string& script : m_script_sections)
+            hashString(&hash, script.c_str());
+        char name[64];
+        snprintf(name, sizeof(name), "script-%016llx.bin",
+            (unsigned long long)hash);
+        return dir + name;
+    }   // getByteCodeFile
+
+    //-----------------------------------------------------------------------------
+    /** Replaces the module with the bytecode from a file.
+     *  \return False if the file is missing or cannot be loaded.
+     */
+    bool ScriptEngine::loadByteCode(const std::string &filename)
+    {
+        MappedFile file;
+        if (!file.open(filename) || file.getSize() < 16)
+            return false;
+        uint32_t magic, version;
+        uint64_t api_hash;
+        memcpy(&magic, file.getData(), 4);
+        memcpy(&version, file.getData() + 4, 4);
+        memcpy(&api_hash, file.getData() + 8, 8);
+        if (magic != BYTECODE_MAGIC || version != BYTECODE_VERSION ||
+            api_hash != m_api_hash)
+            return false;
+
+        ByteCodeReader reader;
+        reader.m_pos = file.getData() + 16;
+        reader.m_end = file.getData() + file.getSize();
+        asIScriptModule *mod = m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE,
+            asGM_ALWAYS_CREATE);
+        if (mod->LoadByteCode(&reader) < 0)
+        {
+            Log::warn("Scripting", "Cannot load bytecode %s, compiling the "
+                "scripts.", filename.c_str());
+            m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE, asGM_ALWAYS_CREATE);
+            return false;
+        }
+        return true;
+    }   // loadByteCode
+
+    //-----------------------------------------------------------------------------
+    /** Writes the bytecode of the compiled module. A temporary file is
+     *  renamed at the end, so other processes never read a half written
+     *  file.
+     */
+    void ScriptEngine::saveByteCode(const std::string &filename) const
+    {
+        asIScriptModule *mod = m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE,
+            asGM_ONLY_IF_EXISTS);
+        ByteCodeWriter writer;
+        writer.Write(&BYTECODE_MAGIC, 4);
+        writer.Write(&BYTECODE_VERSION, 4);
+        writer.Write(&m_api_hash, 8);
+        if (mod == NULL || mod->SaveByteCode(&writer) < 0)
+            return;
+
+#ifdef WIN32
+        int pid = _getpid();
+#else
+        int pid = getpid();
+#endif
+        std::string tmp = filename + "." + StringUtils::toString(pid) + ".tmp";
+        FILE* f = FileUtils::fopenU8Path(tmp, "wb");
+        if (!f)
+            return;
+        bool ok = fwrite(writer.m_data.data(), 1, writer.m_data.size(), f) ==
+            writer.m_data.size();
+        ok = fclose(f) == 0 && ok;
+        if (ok)
+        {
+            remove(FileUtils::getPortableWritingPath(filename).c_str());
+            ok = FileUtils::renameU8Path(tmp, filename) == 0;
+        }
+        if (!ok)
+        {
+            Log::warn("Scripting", "Cannot write bytecode %s.",
+                filename.c_str());
+            remove(FileUtils::getPortableWritingPath(tmp).c_str());
+        }
+    }   // saveByteCode
+
     //-----------------------------------------------------------------------------
 
     PendingTimeout::PendingTimeout(double time, asIScriptFunction* callback_delegate) 
@@ -25,9 +25,11 @@
 #include "utils/singleton.hpp"
 
 #include <angelscript.h>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <string>
+#include <vector>
 
 class TrackObjectPresentation;
 
@@ -89,9 +91,23 @@ namespace Scripting
     private:
         asIScriptEngine *m_engine;
         std::map<std::string, asIScriptFunction*> m_functions_cache;
+        /** Compiled fragments of evalScript, released with the module. */
+        std::map<std::string, asIScriptFunction*> m_eval_cache;
         PtrVector<PendingTimeout> m_pending_timeouts;
 
+        /** Preprocessed scripts loaded since the module was cleared, built
+         *  in compileLoadedScripts. */
+        std::vector<std::string> m_script_sections;
+
+        /** Hash of the angelscript version and of everything registered in
+         *  the engine. Cached bytecode is only used if it is the same. */
+        uint64_t m_api_hash;
+
         void configureEngine(asIScriptEngine *engine);
+        void computeApiHash();
+        std::string getByteCodeFile() const;
+        bool loadByteCode(const std::string &filename);
+        void saveByteCode(const std::string &filename) const;
     };   // class ScriptEngine
 
 }
@@ -25,6 +25,7 @@
 #include "guiengine/widgets/label_widget.hpp"
 #include "guiengine/message_queue.hpp"
 #include "guiengine/modaldialog.hpp"
+#include "guiengine/thumbnail_cache.hpp"
 #include "io/file_manager.hpp"
 #include "network/network_config.hpp"
 #include "network/server.hpp"
@@ -34,7 +35,6 @@
 #include "states_screens/dialogs/server_info_dialog.hpp"
 #include "states_screens/state_manager.hpp"
 #include "tracks/track.hpp"
-#include "tracks/track_manager.hpp"
 #include "utils/translation.hpp"
 #include "utils/string_utils.hpp"
 
@@ -49,6 +49,7 @@ using namespace Online;
 ServerSelection::ServerSelection() : Screen("online/server_selection.stkgui")
 {
     m_refreshing_server = false;
+    m_cached_list_shown = false;
     m_refresh_timer = 0.0f;
     m_ipv6_only_without_nat64 = false;
     m_ip_warning_shown = false;
@@ -67,8 +68,10 @@ ServerSelection::~ServerSelection()
 void ServerSelection::tearDown()
 {
     m_servers.clear();
+    m_row_icons.clear();
     m_server_list_widget->clear();
     m_server_list = nullptr;
+    m_thumbnails.reset();
 }   // tearDown
 
 // ----------------------------------------------------------------------------
@@ -83,6 +86,9 @@ void ServerSelection::refresh()
         return;
 
     m_ip_warning_shown = false;
+    m_cached_list_shown = false;
+    m_servers.clear();
+    m_row_icons.clear();
     m_server_list_widget->clear();
     m_reload_widget->setActive(false);
     m_refreshing_server = true;
@@ -119,6 +125,8 @@ void ServerSelection::loadedFromFile()
  */
 void ServerSelection::beforeAddingWidget()
 {
+    // Its icons are in the bank
+    m_thumbnails.reset();
     m_icon_bank->clear();
     m_server_list_widget->clearColumns();
     m_server_list_widget->addColumn( _C("column_name", "Name"), 7);
@@ -169,27 +177,13 @@ void ServerSelection::init()
         file_manager->getAsset(FileManager::GUI_ICON, "hourglass.png"));
     m_icon_bank->addTextureAsSprite(icon1);
     m_icon_bank->addTextureAsSprite(icon2);
-    for (unsigned i = 0; i < track_manager->getNumberOfTracks(); i++)
-    {
-        Track* t = track_manager->getTrack(i);
-        video::ITexture* tex = NULL;
-        if (t->isInternal())
-        {
-            tex = irr_driver->getTexture(file_manager
-                ->getAsset(FileManager::GUI_ICON, "main_help.png"));
-        }
-        else
-        {
-            tex = irr_driver->getTexture(t->getScreenshotFile());
-        }
-        if (!tex)
-        {
-            tex = irr_driver->getTexture(file_manager
-                ->getAsset(FileManager::GUI_ICON, "main_help.png"));
-        }
-        assert(tex);
-        m_icon_bank->addTextureAsSprite(tex);
-    }
+    video::ITexture* icon3 = irr_driver->getTexture(
+        file_manager->getAsset(FileManager::GUI_ICON, "main_help.png"));
+    m_icon_bank->addTextureAsSprite(icon3);
+    // Track screenshots are only loaded for the servers in view, up to
+    // 16 MB of 256x256 thumbnails
+    m_thumbnails.reset(new GUIEngine::ThumbnailCache(m_icon_bank,
+        2/*placeholder_sprite*/, 16 * 1024 * 1024, 256/*max_size*/));
 
     int row_height = GUIEngine::getFontHeight() * 2;
     
@@ -206,6 +200,7 @@ void ServerSelection::init()
  */
 void ServerSelection::loadList()
 {
+    m_row_icons.clear();
     m_server_list_widget->clear();
     std::stable_sort(m_servers.begin(), m_servers.end(), [this]
         (const std::shared_ptr<Server> a,
@@ -240,10 +235,11 @@ void ServerSelection::loadList()
         });
     for (auto& server : m_servers)
     {
+        // Track screenshots are set by updateVisibleIcons
         int icon = server->isGameStarted() ? 1 : 0;
-        Track* t = server->getCurrentTrack();
-        if (t)
-            icon = track_manager->getTrackIndexByIdent(t->getIdent()) + 2;
+        if (server->getCurrentTrack())
+            icon = m_thumbnails->getPlaceholder();
+        m_row_icons.push_back(icon);
         core::stringw num_players;
         num_players.append(StringUtils::toWString(server->getCurrentPlayers()));
         num_players.append("/");
@@ -272,6 +268,12 @@ void ServerSelection::loadList()
             core::stringw distance = _("Unknown");
             if (!(server->getDistance() < 0.0f))
                 distance = StringUtils::toWString(server->getDistance());
+            if (server->getPing() >= 0)
+            {
+                // I18N: In server selection screen, ping to the server
+                distance += L" ";
+                distance += _("(%dms)", server->getPing());
+            }
             const core::stringw& flag = StringUtils::getCountryFlag(
                 server->getCountryCode());
             if (!flag.empty())
@@ -284,8 +286,36 @@ void ServerSelection::loadList()
         }
         m_server_list_widget->addItem("server", row);
     }
+    updateVisibleIcons();
 }   // loadList
 
+// ----------------------------------------------------------------------------
+/** Shows the screenshot of the current track of the servers in view, which
+ *  are requested from the thumbnail cache if they are not loaded yet.
+ */
+void ServerSelection::updateVisibleIcons()
+{
+    if (m_row_icons.size() != m_servers.size() ||
+        (int)m_row_icons.size() != m_server_list_widget->getItemCount())
+        return;
+
+    int first, last;
+    m_server_list_widget->getVisibleRange(&first, &last);
+    for (int i = first; i <= last; i++)
+    {
+        Track* t = m_servers[i]->getCurrentTrack();
+        if (!t || t->isInternal())
+            continue;
+        const int icon = m_thumbnails->getIcon(t->getScreenshotFile());
+        if (icon != m_row_icons[i])
+        {
+            m_row_icons[i] = icon;
+            m_server_list_widget->renameCell(i, 0, m_servers[i]->getName(),
+                                             icon);
+        }
+    }
+}   // updateVisibleIcons
+
 // ----------------------------------------------------------------------------
 /** Change the sort order if a column was clicked.
  *  \param column_id ID of the column that was clicked.
@@ -394,6 +424,22 @@ void ServerSelection::onUpdate(float dt)
         m_ipv6->setState(true);
     }
 
+    if (m_thumbnails)
+    {
+        updateVisibleIcons();
+        m_thumbnails->update();
+    }
+
+    // The pings are measured after the list is shown
+    if (!m_refreshing_server && m_server_list &&
+        m_server_list->m_pings_updated.exchange(false))
+    {
+        int selection = m_server_list_widget->getSelectionID();
+        copyFromServerList();
+        if (selection != -1)
+            m_server_list_widget->setSelectionID(selection);
+    }
+
     if (!m_refreshing_server) return;
 
     if (m_server_list && m_server_list->m_list_updated)
@@ -418,6 +464,16 @@ void ServerSelection::onUpdate(float dt)
         }
         m_reload_widget->setActive(true);
     }
+    else if (m_server_list && m_server_list->m_cached_list_ready &&
+             !m_server_list->m_cached_servers.empty())
+    {
+        // Show the previous list until the new one arrives
+        if (!m_cached_list_shown)
+        {
+            m_cached_list_shown = true;
+            copyFromServerList();
+        }
+    }
     else
     {
         m_server_list_widget->clear();
@@ -432,7 +488,12 @@ void ServerSelection::copyFromServerList()
 {
     if (!m_server_list)
         return;
-    m_servers = m_server_list->m_servers;
+    if (m_server_list->m_list_updated)
+        m_servers = m_server_list->m_servers;
+    else if (m_server_list->m_cached_list_ready)
+        m_servers = m_server_list->m_cached_servers;
+    else
+        return;
     if (m_servers.empty())
         return;
     m_servers.erase(std::remove_if(m_servers.begin(), m_servers.end(),
@@ -466,6 +527,7 @@ void ServerSelection::copyFromServerList()
 // ----------------------------------------------------------------------------
 void ServerSelection::unloaded()
 {
+    m_thumbnails.reset();
     delete m_icon_bank;
     m_icon_bank = NULL;
 }   // unloaded
@@ -31,6 +31,7 @@ namespace GUIEngine
     class CheckBoxWidget;
     class IconButtonWidget;
     class LabelWidget;
+    class ThumbnailCache;
 }
 
 namespace irr
@@ -69,12 +70,23 @@ private:
     GUIEngine::TextBoxWidget* m_searcher;
     irr::gui::STKModifiedSpriteBank* m_icon_bank;
 
+    /** Track screenshots of the servers, loaded when they are scrolled into
+     *  view. */
+    std::unique_ptr<GUIEngine::ThumbnailCache> m_thumbnails;
+
+    /** Icon currently shown in each row of the list. */
+    std::vector<int> m_row_icons;
+
     /** \brief To check (and set) if sort order is descending **/
     bool m_sort_desc;
 
     int m_current_column;
 
     bool m_refreshing_server;
+
+    /** True if the servers of the previous refresh are shown while
+     *  refreshing. */
+    bool m_cached_list_shown;
     
     float m_refresh_timer;
 
@@ -83,6 +95,8 @@ private:
 
     void copyFromServerList();
 
+    void updateVisibleIcons();
+
     void refresh();
 
     bool m_ipv6_only_without_nat64;
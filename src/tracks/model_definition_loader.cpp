@@ -187,6 +187,17 @@ scene::IMesh* ModelDefinitionLoader::getFirstMeshFor(const std::string& name)
     return NULL;
 }   // getFirstMeshFor
 
+// ----------------------------------------------------------------------------
+/** Returns the model file of the highest level of detail of a LOD group,
+ *  empty if the group does not exist. */
+std::string ModelDefinitionLoader::getFirstModelFor(const std::string& name)
+{
+    auto it = m_lod_groups.find(name);
+    if (it == m_lod_groups.end() || it->second.empty())
+        return "";
+    return it->second[0].m_model_file;
+}   // getFirstModelFor
+
 // ----------------------------------------------------------------------------
 
 void ModelDefinitionLoader::cleanLibraryNodesAfterLoad()
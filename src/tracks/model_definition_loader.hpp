@@ -98,6 +98,8 @@ public:
 
     scene::IMesh* getFirstMeshFor(const std::string& name);
 
+    std::string getFirstModelFor(const std::string& name);
+
     std::map<std::string, XMLNode*>& getLibraryNodes()
     {
         return m_library_nodes;
@@ -62,6 +62,7 @@
 #include "network/network_config.hpp"
 #include "network/protocols/game_protocol.hpp"
 #include "network/protocols/server_lobby.hpp"
+#include "physics/collision_mesh.hpp"
 #include "physics/physical_object.hpp"
 #include "physics/physics.hpp"
 #include "physics/triangle_mesh.hpp"
@@ -103,7 +104,7 @@ bool        Track::m_dont_load_navmesh = false;
 std::atomic<Track*> Track::m_current_track[PT_COUNT];
 
 // ----------------------------------------------------------------------------
-Track::Track(const std::string &filename)
+Track::Track(const std::string &filename, const XMLNode *xml)
 {
 #ifdef DEBUG
     m_magic_number          = 0x17AC3802;
@@ -177,7 +178,7 @@ Track::Track(const std::string &filename)
     m_all_nodes.clear();
     m_static_physics_only_nodes.clear();
     m_all_cached_meshes.clear();
-    loadTrackInfo();
+    loadTrackInfo(xml);
 }   // Track
 
 //-----------------------------------------------------------------------------
@@ -510,7 +511,10 @@ void Track::cleanup()
 }   // cleanup
 
 //-----------------------------------------------------------------------------
-void Track::loadTrackInfo()
+/** Reads the information shown before loading the track from track.xml.
+ *  \param xml The track.xml file if it was already read, or NULL.
+ */
+void Track::loadTrackInfo(const XMLNode *xml)
 {
     // Default values
     m_use_fog               = false;
@@ -534,11 +538,13 @@ void Track::loadTrackInfo()
     irr_driver->setSSAORadius(1.);
     irr_driver->setSSAOK(1.5);
     irr_driver->setSSAOSigma(1.);
-    XMLNode *root           = file_manager->createXMLTree(m_filename);
+    const XMLNode *root     = xml ? xml
+                                  : file_manager->createXMLTree(m_filename);
 
     if(!root || root->getName()!="track")
     {
-        delete root;
+        if (root != xml)
+            delete root;
         std::ostringstream o;
         o<<"Can't load track '"<<m_filename<<"', no track element.";
         throw std::runtime_error(o.str());
@@ -617,7 +623,8 @@ void Track::loadTrackInfo()
     {
         m_screenshot = m_root+m_screenshot;
     }
-    delete root;
+    if (root != xml)
+        delete root;
 
     std::string dir = StringUtils::getPath(m_filename);
     std::string easter_name = dir + "/easter_eggs.xml";
@@ -1208,6 +1215,10 @@ bool Track::loadMainTrack(const XMLNode &root)
     m_track_mesh      = new TriangleMesh(/*can_be_transformed*/false);
     m_gfx_effect_mesh = new TriangleMesh(/*can_be_transformed*/false);
 
+    // Without graphics only the physics of the models is needed
+    if (GUIEngine::isNoGraphics())
+        return loadMainTrackCollision(root);
+
     const XMLNode *track_node = root.getNode("track");
     std::string model_name;
     track_node->get("model", &model_name);
@@ -1502,6 +1513,134 @@ bool Track::loadMainTrack(const XMLNode &root)
     return true;
 }   // loadMainTrack
 
+// ----------------------------------------------------------------------------
+/** Loads only the triangles of the main track model and its static objects
+ *  into the physics meshes, without creating scene nodes or loading any
+ *  texture, see CollisionMesh. Used instead of loadMainTrack without
+ *  graphics, e.g. by servers. The triangles are added in the same order as
+ *  loadMainTrack and createPhysicsModel, so the physics is the same.
+ */
+bool Track::loadMainTrackCollision(const XMLNode &root)
+{
+    const XMLNode *track_node = root.getNode("track");
+    std::string model_name;
+    track_node->get("model", &model_name);
+    CollisionMesh main_mesh;
+    if (!main_mesh.load(m_root+model_name))
+    {
+        Log::fatal("track",
+                   "Main track model '%s' in '%s' not found, aborting.\n",
+                   track_node->getName().c_str(), model_name.c_str());
+    }
+    unsigned triangles = main_mesh.getNumTriangles();
+    unsigned cached = main_mesh.isFromParseCache() ? 1 : 0;
+
+    core::vector3df xyz(0,0,0);
+    track_node->getXYZ(&xyz);
+    core::vector3df hpr(0,0,0);
+    track_node->getHPR(&hpr);
+    core::matrix4 transform;
+    transform.setRotationDegrees(hpr);
+    transform.setTranslation(xyz);
+
+    main_mesh.minMax3D(&m_aabb_min, &m_aabb_max);
+    // See loadMainTrack
+    m_aabb_max.setY(m_aabb_max.getY()+30.0f);
+    Physics::get()->init(m_aabb_min, m_aabb_max);
+    main_mesh.addTriangles(transform, m_track_mesh, m_gfx_effect_mesh);
+
+    ModelDefinitionLoader lodLoader(this);
+    const XMLNode *lod_xml_node = root.getNode("lod");
+    if (lod_xml_node != NULL)
+    {
+        for (unsigned int i = 0; i < lod_xml_node->getNumNodes(); i++)
+        {
+            const XMLNode* lod_group_xml = lod_xml_node->getNode(i);
+            for (unsigned int j = 0; j < lod_group_xml->getNumNodes(); j++)
+                lodLoader.addModelDefinition(lod_group_xml->getNode(j));
+        }
+    }
+
+    // Physics only objects are converted last in createPhysicsModel
+    std::vector<std::pair<std::string, core::matrix4> > models,
+        physics_only_models;
+    for (unsigned int i=0; i<track_node->getNumNodes(); i++)
+    {
+        const XMLNode *n=track_node->getNode(i);
+        if(n->getName()=="animated-texture") continue;
+        if(n->getName()!="static-object")
+        {
+            Log::error("track",
+                "Incorrect tag '%s' inside <model> of scene file - ignored\n",
+                    n->getName().c_str());
+            continue;
+        }
+        // Challenge orbs of the overworld are only shown
+        std::string challenge;
+        n->get("challenge", &challenge);
+        if (!challenge.empty())
+            continue;
+
+        core::vector3df xyz(0,0,0);
+        n->get("xyz", &xyz);
+        core::vector3df hpr(0,0,0);
+        n->get("hpr", &hpr);
+        core::vector3df scale(1.0f, 1.0f, 1.0f);
+        n->get("scale", &scale);
+        core::matrix4 transform;
+        transform.setRotationDegrees(hpr);
+        transform.setTranslation(xyz);
+        if (scale != core::vector3df(1.0f, 1.0f, 1.0f))
+        {
+            core::matrix4 mat_scale;
+            mat_scale.setScale(scale);
+            transform *= mat_scale;
+        }
+
+        bool lod_instance = false;
+        n->get("lod_instance", &lod_instance);
+        std::string interaction;
+        n->get("interaction", &interaction);
+        if (lod_instance)
+        {
+            std::string group;
+            n->get("lod_group", &group);
+            std::string model = lodLoader.getFirstModelFor(group);
+            if (!model.empty())
+                models.emplace_back(model, transform);
+            continue;
+        }
+        model_name="";
+        n->get("model", &model_name);
+        if (interaction=="physics-only")
+            physics_only_models.emplace_back(m_root+model_name, transform);
+        else
+            models.emplace_back(m_root+model_name, transform);
+    }
+
+    models.insert(models.end(), physics_only_models.begin(),
+        physics_only_models.end());
+    for (auto& model : models)
+    {
+        CollisionMesh mesh;
+        if (!mesh.load(model.first))
+        {
+            Log::error("track", "Object model '%s' not found, ignored.\n",
+                       model.first.c_str());
+            continue;
+        }
+        mesh.addTriangles(model.second, m_track_mesh, m_gfx_effect_mesh);
+        triangles += mesh.getNumTriangles();
+        cached += mesh.isFromParseCache() ? 1 : 0;
+    }
+
+    m_gfx_effect_mesh->createCollisionShape();
+    Log::debug("track", "Loaded %d triangles of %d models for the physics, "
+        "%d models read from the parse cache.", triangles,
+        (int)models.size() + 1, cached);
+    return true;
+}   // loadMainTrackCollision
+
 // ----------------------------------------------------------------------------
 void Track::freeCachedMeshVertexBuffer()
 {
@@ -164,16 +164,25 @@ void TrackManager::loadTrackList()
         // ----------------------------------------------------
         if(loadTrack(dir)) continue;  // track found, no more tests
 
-        // Then see if a subdir of this dir contains tracks
+        // Then see if a subdir of this dir contains tracks. All track.xml
+        // files are read in parallel first, the tracks are then loaded in
+        // order.
         // ------------------------------------------------
         std::set<std::string> dirs;
         file_manager->listFiles(dirs, dir);
+        std::vector<std::string> subdirs;
+        std::vector<std::string> track_files;
         for(std::set<std::string>::iterator subdir = dirs.begin();
             subdir != dirs.end(); subdir++)
         {
             if(*subdir=="." || *subdir=="..") continue;
-            loadTrack(dir+*subdir+"/");
+            subdirs.push_back(dir+*subdir+"/");
+            track_files.push_back(subdirs.back()+"track.xml");
         }   // for dir in dirs
+        std::vector<std::unique_ptr<XMLNode> > xml =
+            file_manager->createXMLTrees(track_files);
+        for(unsigned int j=0; j<subdirs.size(); j++)
+            loadTrack(subdirs[j], xml[j].get());
     }   // for i <m_track_search_path.size()
 }  // loadTrackList
 
@@ -181,8 +190,9 @@ void TrackManager::loadTrackList()
 /** Tries to load a track from a single directory. Returns true if a track was
  *  successfully loaded.
  *  \param dirname Name of the directory to load the track from.
+ *  \param xml The track.xml file if it was already read, or NULL.
  */
-bool TrackManager::loadTrack(const std::string& dirname)
+bool TrackManager::loadTrack(const std::string& dirname, const XMLNode *xml)
 {
     std::string config_file = dirname+"track.xml";
     if(!file_manager->fileExists(config_file))
@@ -192,7 +202,7 @@ bool TrackManager::loadTrack(const std::string& dirname)
 
     try
     {
-        track = new Track(config_file);
+        track = new Track(config_file, xml);
     }
     catch (std::exception& e)
     {
@@ -22,6 +22,11 @@
 #include <stdio.h>
 #include <string>
 #include <sys/stat.h>
+#ifdef WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
 
 // ----------------------------------------------------------------------------
 #if defined(WIN32)
@@ -166,3 +171,32 @@ int FileUtils::renameU8Path(const std::string& u8_path_old,
     return rename(u8_path_old.c_str(), u8_path_new.c_str());
 #endif
 }   // renameU8Path
+
+// ----------------------------------------------------------------------------
+/** Writes a file through a temporary file, so a crash never leaves a half
+ *  written file behind. The temporary name contains the process id, as
+ *  servers sharing a config directory may write the same file.
+ *  \return True if the file was written.
+ */
+bool FileUtils::writeFileAtomic(const std::string& u8_path,
+                                const std::string& data)
+{
+#ifdef WIN32
+    int pid = _getpid();
+#else
+    int pid = getpid();
+#endif
+    std::string tmp = u8_path + "." + StringUtils::toString(pid) + ".tmp";
+    FILE* f = fopenU8Path(tmp, "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = fclose(f) == 0 && ok;
+    if (!ok)
+    {
+        remove(getPortableWritingPath(tmp).c_str());
+        return false;
+    }
+    remove(getPortableWritingPath(u8_path).c_str());
+    return renameU8Path(tmp, u8_path) == 0;
+}   // writeFileAtomic
@@ -21,11 +21,17 @@
 #include "config/user_config.hpp"
 #include "network/network_config.hpp"
 #include "utils/file_utils.hpp"
+#include "utils/mpsc_ring_buffer.hpp"
+#include "utils/time.hpp"
 #include "utils/tls.hpp"
+#include "utils/vs.hpp"
 
+#include <condition_variable>
 #include <cstdio>
 #include <ctime>
+#include <mutex>
 #include <stdio.h>
+#include <thread>
 
 #ifdef ANDROID
 #  include <android/log.h>
@@ -46,7 +52,57 @@ FILE*         Log::m_file_stdout   = NULL;
 size_t        Log::m_buffer_size = 1;
 bool          Log::m_console_log = true;
 Synchronised<std::vector<struct Log::LineInfo> > Log::m_line_buffer;
+std::atomic<bool> Log::m_async(false);
+bool          Log::m_async_requested = false;
+unsigned      Log::m_rate_limit    = 0;
+size_t        Log::m_rotate_size   = 0;
+unsigned      Log::m_rotate_count  = 3;
+std::string   Log::m_file_name;
 thread_local  char g_prefix[11] = {};
+thread_local  time_t g_log_time = 0;
+thread_local  char g_log_time_string[64] = {};
+
+namespace
+{
+    /** A preformatted line in the asynchronous ring buffer. Lines longer
+     *  than the record are truncated, which only affects very long chat
+     *  or debug dumps. */
+    struct LogRecord
+    {
+        int  m_level;
+        char m_line[1024];
+    };
+    /** Only allocated when the asynchronous writer is started, and never
+     *  freed since other threads can still log while it is stopped. */
+    MPSCRingBuffer<LogRecord, 4096>* g_log_ring = NULL;
+
+    std::thread             g_writer_thread;
+    std::mutex              g_writer_mutex;
+    std::condition_variable g_writer_cv;
+    std::condition_variable g_drained_cv;
+    std::atomic<bool>       g_writer_sleeping(false);
+    std::atomic<bool>       g_writer_stop(false);
+    std::atomic<bool>       g_flush_requested(false);
+    /** Number of lines dropped because the ring was full. */
+    std::atomic<uint32_t>   g_dropped_lines(0);
+    /** Bytes written to the current log file, used for rotation. */
+    size_t                  g_file_bytes = 0;
+
+    /** Rate limiting per component and format string. They are hashed into
+     *  a small table, a bucket is taken over by a colliding message after
+     *  its suppressed lines are reported. */
+    struct RateBucket
+    {
+        std::mutex  m_mutex;
+        uint64_t    m_second;
+        uint32_t    m_count;
+        uint32_t    m_suppressed;
+        std::string m_component;
+        std::string m_format;
+        RateBucket() : m_second(0), m_count(0), m_suppressed(0) {}
+    };
+    RateBucket g_rate_buckets[128];
+}   // anonymous namespace
 
 // ----------------------------------------------------------------------------
 void Log::setPrefix(const char* prefix)
@@ -159,6 +215,8 @@ void Log::printMessage(int level, const char *component, const char *format,
     assert(level >= 0 && level <= LL_FATAL);
 
     if (level < m_min_log_level) return;
+    if (m_rate_limit > 0 && isRateLimited(level, component, format))
+        return;
 
     static const char *names[] = { "debug", "verbose  ", "info   ",
                                   "warn   ", "error  ", "fatal  " };
@@ -173,18 +231,25 @@ void Log::printMessage(int level, const char *component, const char *format,
         remaining = MAX_LENGTH - index > 0 ? MAX_LENGTH - index : 0;
     }
 
-#ifdef MOBILE_STK
-    // Mobile STK already has timestamp logging in console
-    std::string server_prefix = "Server";
-#else
-    std::string server_prefix = StkTime::getLogTime();
-#endif
     if (NetworkConfig::get()->isNetworking() &&
         NetworkConfig::get()->isServer())
     {
+#ifdef MOBILE_STK
+        // Mobile STK already has timestamp logging in console
+        const char* server_prefix = "Server";
+#else
+        // Formatting the time is only needed once per second and thread
+        const char* server_prefix = g_log_time_string;
+        time_t time_now = time(NULL);
+        if (time_now != g_log_time)
+        {
+            g_log_time = time_now;
+            snprintf(g_log_time_string, 64, "%s",
+                StkTime::getLogTime().c_str());
+        }
+#endif
         index += snprintf (line + index, remaining,
-            "%s [%s] %s: ", server_prefix.c_str(),
-            names[level], component);
+            "%s [%s] %s: ", server_prefix, names[level], component);
     }
     else
     {
@@ -199,6 +264,38 @@ void Log::printMessage(int level, const char *component, const char *format,
     index = index > MAX_LENGTH - 1 ? MAX_LENGTH - 1 : index;
     sprintf(line + index, "\n");
 
+    // The background writer owns all output, the ring buffer never blocks
+    if (m_async.load())
+    {
+        const std::string text(line);
+        bool pushed = g_log_ring->tryPushWith([&text, level](LogRecord& r)
+            {
+                r.m_level = level;
+                size_t len = text.size();
+                if (len > sizeof(r.m_line) - 1)
+                {
+                    // Keep the new line for truncated lines
+                    len = sizeof(r.m_line) - 1;
+                    memcpy(r.m_line, text.c_str(), len);
+                    r.m_line[len - 1] = '\n';
+                }
+                else
+                    memcpy(r.m_line, text.c_str(), len);
+                r.m_line[len] = 0;
+            });
+        if (!pushed)
+            g_dropped_lines.fetch_add(1);
+        if (level == LL_FATAL)
+        {
+            flushBuffers();
+            if (!pushed)
+                writeLine(line, level);
+        }
+        else if (g_writer_sleeping.load())
+            g_writer_cv.notify_one();
+        return;
+    }
+
     // If the data is not buffered, immediately print it:
     if (m_buffer_size <= 1)
     {
@@ -277,7 +374,12 @@ void Log::writeLine(const char *line, int level)
     if (m_buffer_size <= 1) OutputDebugStringA(line);
 #endif
 
-    if (m_file_stdout) fprintf(m_file_stdout, "%s", line);
+    if (m_file_stdout)
+    {
+        int written = fprintf(m_file_stdout, "%s", line);
+        if (written > 0)
+            g_file_bytes += written;
+    }
 
 #ifdef WIN32
     if (level >= LL_FATAL)
@@ -295,9 +397,26 @@ void Log::toggleConsoleLog(bool val)
 
 // ----------------------------------------------------------------------------
 /** Flushes all stored log messages to the various output devices (thread safe).
+ *  With the asynchronous writer this waits until all lines logged so far
+ *  are written, so it should only be used on shutdown or fatal errors.
  */
 void Log::flushBuffers()
 {
+    if (m_async.load())
+    {
+        if (g_writer_thread.get_id() == std::this_thread::get_id())
+            return;
+        size_t target = g_log_ring->getPushCount();
+        g_flush_requested.store(true);
+        std::unique_lock<std::mutex> ul(g_writer_mutex);
+        g_writer_cv.notify_one();
+        g_drained_cv.wait(ul, [target]()
+            {
+                return g_log_ring->getPopCount() >= target ||
+                    !m_async.load();
+            });
+        return;
+    }
     m_line_buffer.lock();
     for (unsigned int i = 0; i < m_line_buffer.getData().size(); i++)
     {
@@ -308,6 +427,216 @@ void Log::flushBuffers()
     m_line_buffer.unlock();
 }   // flushBuffers
 
+// ----------------------------------------------------------------------------
+/** Asks for all stored log messages to be written soon, without waiting for
+ *  it. The asynchronous writer is woken up, otherwise this is the same as
+ *  flushBuffers().
+ */
+void Log::requestFlush()
+{
+    if (m_async.load())
+    {
+        g_flush_requested.store(true);
+        g_writer_cv.notify_one();
+        return;
+    }
+    flushBuffers();
+}   // requestFlush
+
+// ----------------------------------------------------------------------------
+/** Checks if a message of a component is above its per second budget, each
+ *  format string of a component has its own budget. Only messages below
+ *  warning level are limited. When a new second starts, or another message
+ *  takes over the bucket, the number of suppressed messages is logged.
+ *  \param level Log level of the message.
+ *  \param component Component of the message.
+ *  \param format Format string of the message.
+ *  \return True if the message must be dropped.
+ */
+bool Log::isRateLimited(int level, const char *component, const char *format)
+{
+    if (level >= LL_WARN)
+        return false;
+
+    uint32_t hash = 2166136261u;
+    for (const char* c = component; *c; c++)
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    for (const char* c = format; *c; c++)
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    RateBucket& b = g_rate_buckets[hash % 128];
+
+    uint64_t now = StkTime::getMonoTimeMs() / 1000;
+    uint32_t suppressed = 0;
+    std::string last_component, last_format;
+    bool limited = false;
+    {
+        std::lock_guard<std::mutex> lock(b.m_mutex);
+        bool same_message = b.m_component == component &&
+            b.m_format == format;
+        if (b.m_second != now || !same_message)
+        {
+            suppressed = b.m_suppressed;
+            if (suppressed > 0)
+            {
+                last_component = b.m_component;
+                last_format = b.m_format;
+            }
+            b.m_second = now;
+            b.m_count = 0;
+            b.m_suppressed = 0;
+            if (!same_message)
+            {
+                b.m_component = component;
+                b.m_format = format;
+            }
+        }
+        if (b.m_count < m_rate_limit)
+            b.m_count++;
+        else
+        {
+            b.m_suppressed++;
+            limited = true;
+        }
+    }
+    if (suppressed > 0)
+    {
+        // Warning level bypasses the limit, so this can't recurse
+        warn("Log", "%u messages from %s (\"%s\") suppressed by rate limit.",
+            suppressed, last_component.c_str(), last_format.c_str());
+    }
+    return limited;
+}   // isRateLimited
+
+// ----------------------------------------------------------------------------
+/** Starts the background thread which writes all log lines. After this no
+ *  logging thread does any terminal or file I/O anymore.
+ */
+void Log::startAsyncWriter()
+{
+    if (m_async.load())
+        return;
+    // Write out anything buffered by the old synchronous buffering
+    flushBuffers();
+    if (!g_log_ring)
+        g_log_ring = new MPSCRingBuffer<LogRecord, 4096>();
+    g_writer_stop.store(false);
+    g_writer_thread = std::thread(&Log::asyncWriterLoop);
+    m_async.store(true);
+}   // startAsyncWriter
+
+// ----------------------------------------------------------------------------
+/** Writes all pending lines and stops the background writer. Logging after
+ *  this is synchronous again.
+ */
+void Log::stopAsyncWriter()
+{
+    if (!m_async.load())
+        return;
+    g_writer_stop.store(true);
+    g_writer_cv.notify_one();
+    g_writer_thread.join();
+    m_async.store(false);
+    // Write the lines of threads which saw the writer as running, but
+    // pushed them after it drained the ring for the last time
+    while (g_log_ring->tryPopWith([](LogRecord& r)
+        {
+            writeLine(r.m_line, r.m_level);
+        }))
+    {
+    }
+    if (m_file_stdout)
+        fflush(m_file_stdout);
+    g_drained_cv.notify_all();
+}   // stopAsyncWriter
+
+// ----------------------------------------------------------------------------
+/** The main loop of the background writer. It drains the ring buffer, then
+ *  flushes the (fully buffered) log file once per batch and rotates it if
+ *  necessary.
+ */
+void Log::asyncWriterLoop()
+{
+    VS::setThreadName("LogWriter");
+    while (true)
+    {
+        bool wrote = false;
+        // Limit the batch size, so a flood of messages can't delay the
+        // file flush forever
+        for (unsigned i = 0; i < 1024; i++)
+        {
+            if (!g_log_ring->tryPopWith([](LogRecord& r)
+                {
+                    writeLine(r.m_line, r.m_level);
+                }))
+                break;
+            wrote = true;
+        }
+        uint32_t dropped = g_dropped_lines.exchange(0);
+        if (dropped > 0)
+        {
+            char line[128];
+            snprintf(line, 128, "[warn   ] Log: %u lines dropped, log "
+                "buffer was full.\n", dropped);
+            writeLine(line, LL_WARN);
+            wrote = true;
+        }
+        if (wrote)
+        {
+            if (m_file_stdout)
+                fflush(m_file_stdout);
+            if (m_console_log)
+                fflush(stdout);
+            if (m_rotate_size > 0 && g_file_bytes > m_rotate_size)
+                rotateOutputFile();
+            std::lock_guard<std::mutex> lock(g_writer_mutex);
+            g_drained_cv.notify_all();
+            continue;
+        }
+
+        if (g_writer_stop.load())
+            break;
+
+        std::unique_lock<std::mutex> ul(g_writer_mutex);
+        g_drained_cv.notify_all();
+        g_writer_sleeping.store(true);
+        // Producers only notify when this thread is sleeping, a missed
+        // notification is picked up by the timeout
+        g_writer_cv.wait_for(ul, std::chrono::milliseconds(50), []()
+            {
+                return !g_log_ring->empty() || g_writer_stop.load() ||
+                    g_flush_requested.load();
+            });
+        g_writer_sleeping.store(false);
+        g_flush_requested.store(false);
+    }
+}   // asyncWriterLoop
+
+// ----------------------------------------------------------------------------
+/** Rotates the log file: file.log.(n-1) becomes file.log.n etc, the current
+ *  file becomes file.log.1 and a new file is opened. Only called from the
+ *  writer thread.
+ */
+void Log::rotateOutputFile()
+{
+    if (!m_file_stdout || m_file_name.empty())
+        return;
+    fclose(m_file_stdout);
+    m_file_stdout = NULL;
+    for (unsigned i = m_rotate_count; i > 1; i--)
+    {
+        std::string older = m_file_name + "." + std::to_string(i);
+        std::string newer = m_file_name + "." + std::to_string(i - 1);
+        remove(FileUtils::getPortableWritingPath(older).c_str());
+        FileUtils::renameU8Path(newer, older);
+    }
+    if (m_rotate_count > 0)
+    {
+        FileUtils::renameU8Path(m_file_name, m_file_name + ".1");
+    }
+    m_file_stdout = FileUtils::fopenU8Path(m_file_name, "w");
+    g_file_bytes = 0;
+}   // rotateOutputFile
+
 // ----------------------------------------------------------------------------
 /** This function opens the files that will contain the output.
  *  \param logout : name of the file that will contain stdout output
@@ -323,15 +652,26 @@ void Log::openOutputFiles(const std::string &logout)
     }
     else
     {
-        // Disable buffering so that messages are seen asap
-        setvbuf(m_file_stdout, NULL, _IONBF, 0);
+        m_file_name = logout;
+        g_file_bytes = 0;
+        // The asynchronous writer flushes after each batch, otherwise
+        // disable buffering so that messages are seen asap
+        if (m_async_requested)
+            setvbuf(m_file_stdout, NULL, _IOFBF, 64 * 1024);
+        else
+            setvbuf(m_file_stdout, NULL, _IONBF, 0);
     }
-} // closeOutputFiles
+    if (m_async_requested)
+        startAsyncWriter();
+} // openOutputFiles
 
 // ----------------------------------------------------------------------------
 /** Function to close output files */
 void Log::closeOutputFiles()
 {
-    fclose(m_file_stdout);
+    stopAsyncWriter();
+    if (m_file_stdout)
+        fclose(m_file_stdout);
+    m_file_stdout = NULL;
 } // closeOutputFiles
 
@@ -23,6 +23,7 @@
 #include "utils/synchronised.hpp"
 
 #include <assert.h>
+#include <atomic>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -78,9 +79,35 @@ private:
      ** the maximum number of lines the buffer should hold. */
     static size_t m_buffer_size;
 
+    /** True if lines are handed to the background writer thread instead
+     *  of being written by the thread which logs them. */
+    static std::atomic<bool> m_async;
+
+    /** True if the asynchronous writer should be started as soon as the
+     *  output file is opened. */
+    static bool m_async_requested;
+
+    /** Maximum number of lines below warning level a component can log per
+     *  second with the same format string, 0 means no limit. */
+    static unsigned m_rate_limit;
+
+    /** The log file is rotated once it reaches this size in bytes, 0
+     *  means no rotation. */
+    static size_t m_rotate_size;
+
+    /** Number of rotated log files to keep. */
+    static unsigned m_rotate_count;
+
+    /** Name of the log file, needed for rotation. */
+    static std::string m_file_name;
+
     static void setTerminalColor(LogLevel level);
     static void resetTerminalColor();
     static void writeLine(const char *line, int level);
+    static bool isRateLimited(int level, const char *component,
+                              const char *format);
+    static void asyncWriterLoop();
+    static void rotateOutputFile();
 
     static void printMessage(int level, const char *component,
                              const char *format, VALIST va_list);
@@ -117,7 +144,30 @@ public:
 
     static void closeOutputFiles();
     static void flushBuffers();
+    static void requestFlush();
     static void toggleConsoleLog(bool val);
+    static void startAsyncWriter();
+    static void stopAsyncWriter();
+
+    // ------------------------------------------------------------------------
+    /** Requests that all lines are written by a background thread, which
+     *  is started when the output file is opened. */
+    static void setAsync(bool async)          { m_async_requested = async; }
+    // ------------------------------------------------------------------------
+    /** Returns if lines are currently written by the background thread. */
+    static bool isAsync()                       { return m_async.load(); }
+    // ------------------------------------------------------------------------
+    /** Limits the number of debug, verbose and info lines each component
+     *  can log per second with the same format, 0 disables the limit. */
+    static void setRateLimit(unsigned n)                 { m_rate_limit = n; }
+    // ------------------------------------------------------------------------
+    /** Rotates the log file once it is larger than max_bytes, keeping
+     *  count old files (only used by the asynchronous writer). */
+    static void setRotation(size_t max_bytes, unsigned count)
+    {
+        m_rotate_size = max_bytes;
+        m_rotate_count = count;
+    }   // setRotation
 
     // ------------------------------------------------------------------------
     /** Sets the number of lines to buffer. Setting the buffer size to a 
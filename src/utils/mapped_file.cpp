@@ -0,0 +1,114 @@
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/mapped_file.hpp"
+
+#include "utils/file_utils.hpp"
+#include "utils/string_utils.hpp"
+
+#ifdef WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------
+MappedFile::MappedFile()
+{
+    m_data = NULL;
+    m_size = 0;
+#ifdef WIN32
+    m_mapping = NULL;
+#endif
+}   // MappedFile
+
+// ----------------------------------------------------------------------------
+/** Maps a file read-only, closing the previous one.
+ *  \return False if the file cannot be mapped or is empty.
+ */
+bool MappedFile::open(const std::string& u8_path)
+{
+    close();
+#ifdef WIN32
+    irr::core::stringw w_path = StringUtils::utf8ToWide(u8_path);
+    HANDLE file = CreateFileW(w_path.c_str(), GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    // The mapping keeps the file open
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0,
+        NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+        return false;
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = (const uint8_t*)data;
+    m_size = (size_t)size.QuadPart;
+#else
+    int fd = ::open(FileUtils::getPortableReadingPath(u8_path).c_str(),
+        O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    // The mapping stays valid after closing the file
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd,
+        0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    m_data = (const uint8_t*)data;
+    m_size = (size_t)st.st_size;
+#endif
+    return true;
+}   // open
+
+// ----------------------------------------------------------------------------
+void MappedFile::close()
+{
+    if (m_data == NULL)
+        return;
+#ifdef WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    m_mapping = NULL;
+#else
+    munmap((void*)m_data, m_size);
+#endif
+    m_data = NULL;
+    m_size = 0;
+}   // close
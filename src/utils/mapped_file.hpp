@@ -0,0 +1,57 @@
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_MAPPED_FILE_HPP
+#define HEADER_MAPPED_FILE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** A file mapped read-only into memory, used to read files cached in a
+ *  binary layout (like the collision meshes of CollisionMesh) without
+ *  parsing or copying them.
+ */
+class MappedFile : public NoCopy
+{
+private:
+    const uint8_t* m_data;
+
+    size_t m_size;
+
+#ifdef WIN32
+    void* m_mapping;
+#endif
+
+public:
+    MappedFile();
+    // ------------------------------------------------------------------------
+    ~MappedFile()                                                { close(); }
+    // ------------------------------------------------------------------------
+    bool open(const std::string& u8_path);
+    // ------------------------------------------------------------------------
+    void close();
+    // ------------------------------------------------------------------------
+    /** Returns the content of the file, NULL if not opened. */
+    const uint8_t* getData() const                          { return m_data; }
+    // ------------------------------------------------------------------------
+    size_t getSize() const                                  { return m_size; }
+};   // class MappedFile
+
+#endif
@@ -0,0 +1,147 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_MPSC_RING_BUFFER_HPP
+#define HEADER_MPSC_RING_BUFFER_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/** A bounded lock-free queue for many producer threads and one consumer
+ *  thread. Each slot carries a sequence number which tells producers and
+ *  the consumer whether the slot is free or filled (Vyukov's bounded
+ *  queue). Producers never wait: if the ring is full, tryPush() returns
+ *  false and the caller decides what to do with the element.
+ *  \param T Element type, it is copied into and out of the ring.
+ *  \param SIZE Number of slots, must be a power of two.
+ */
+template<typename T, size_t SIZE>
+class MPSCRingBuffer : public NoCopy
+{
+private:
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0,
+                  "Ring buffer size must be a power of two.");
+
+    struct Slot
+    {
+        std::atomic<size_t> m_sequence;
+        T m_data;
+    };
+
+    Slot m_slots[SIZE];
+
+    /** Next position to be written by a producer. Padded to its own cache
+     *  line so that producers and the consumer don't share it (the ring
+     *  is heap allocated, so alignas can't be relied upon). */
+    char m_pad0[64];
+    std::atomic<size_t> m_enqueue_pos;
+    char m_pad1[64];
+
+    /** Next position to be read by the consumer. */
+    std::atomic<size_t> m_dequeue_pos;
+
+public:
+    // ------------------------------------------------------------------------
+    MPSCRingBuffer()
+    {
+        for (size_t i = 0; i < SIZE; i++)
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        m_enqueue_pos.store(0, std::memory_order_relaxed);
+        m_dequeue_pos.store(0, std::memory_order_relaxed);
+    }   // MPSCRingBuffer
+    // ------------------------------------------------------------------------
+    /** Adds an element to the ring, can be called from any thread.
+     *  \param fill Functor called with a reference to the slot data, so
+     *         that big elements can be filled in place without a copy.
+     *  \return False if the ring is full, the element is not added then.
+     */
+    template<typename F> bool tryPushWith(F fill)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true)
+        {
+            slot = &m_slots[pos & (SIZE - 1)];
+            size_t seq = slot->m_sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                    std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+        fill(slot->m_data);
+        slot->m_sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }   // tryPushWith
+    // ------------------------------------------------------------------------
+    bool tryPush(const T& data)
+    {
+        return tryPushWith([&data](T& slot) { slot = data; });
+    }   // tryPush
+    // ------------------------------------------------------------------------
+    /** Removes the oldest element from the ring. Must only be called from
+     *  the single consumer thread.
+     *  \param consume Functor called with a reference to the slot data
+     *         before the slot is handed back to producers.
+     *  \return False if the ring is empty.
+     */
+    template<typename F> bool tryPopWith(F consume)
+    {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        Slot* slot = &m_slots[pos & (SIZE - 1)];
+        size_t seq = slot->m_sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+            return false;
+        consume(slot->m_data);
+        slot->m_sequence.store(pos + SIZE, std::memory_order_release);
+        // Only the consumer writes this, updating it after consume() means
+        // a position is fully processed once getPopCount() is past it
+        m_dequeue_pos.store(pos + 1, std::memory_order_release);
+        return true;
+    }   // tryPopWith
+    // ------------------------------------------------------------------------
+    bool tryPop(T* data)
+    {
+        return tryPopWith([data](T& slot) { *data = slot; });
+    }   // tryPop
+    // ------------------------------------------------------------------------
+    /** Returns the number of elements reserved by producers so far, it can
+     *  be compared with getPopCount() to wait until a position is
+     *  consumed. */
+    size_t getPushCount() const
+                     { return m_enqueue_pos.load(std::memory_order_acquire); }
+    // ------------------------------------------------------------------------
+    size_t getPopCount() const
+                     { return m_dequeue_pos.load(std::memory_order_acquire); }
+    // ------------------------------------------------------------------------
+    bool empty() const          { return getPushCount() == getPopCount(); }
+    // ------------------------------------------------------------------------
+    static constexpr size_t capacity()                        { return SIZE; }
+
+};   // MPSCRingBuffer
+
+#endif
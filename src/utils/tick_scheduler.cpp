@@ -0,0 +1,339 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/tick_scheduler.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+// ----------------------------------------------------------------------------
+TickScheduler::Section::Section(TickScheduler* scheduler, const char* name)
+                     : m_scheduler(scheduler), m_name(name)
+{
+    m_start = m_scheduler ? StkTime::getMonoTimeUs() : 0;
+}   // Section
+
+// ----------------------------------------------------------------------------
+TickScheduler::Section::~Section()
+{
+    if (m_scheduler)
+    {
+        m_scheduler->addSectionTime(m_name,
+                                    StkTime::getMonoTimeUs() - m_start);
+    }
+}   // ~Section
+
+// ============================================================================
+/** Creates a scheduler which starts counting ticks now.
+ *  \param name Name of the loop in the logs.
+ *  \param ticks_per_second Physics ticks per second.
+ *  \param max_ticks_per_frame Maximum ticks returned by waitForTicks, the
+ *         remaining ones are returned in the next frames. 0 for no limit.
+ *  \param watchdog If frames taking longer than their ticks are logged.
+ */
+TickScheduler::TickScheduler(const std::string& name, int ticks_per_second,
+                             int max_ticks_per_frame, bool watchdog)
+             : m_name(name)
+{
+    m_ticks_per_second = std::max(1, ticks_per_second);
+    m_max_ticks_per_frame = std::max(0, max_ticks_per_frame);
+    m_min_frame_time = 0;
+    m_watchdog = watchdog;
+    m_num_ticks = 0;
+    m_total_tick_time = 0;
+    m_max_tick_time = 0;
+    m_overruns = 0;
+    m_catch_up_frames = 0;
+    m_max_frame_ticks = 0;
+    m_max_lag = 0;
+    m_suppressed_overruns = 0;
+    m_last_overrun_log = 0;
+    m_tick_start = 0;
+    const uint64_t now = StkTime::getMonoTimeUs();
+    m_last_report = now;
+    resynchronise(now);
+}   // TickScheduler
+
+// ----------------------------------------------------------------------------
+TickScheduler::~TickScheduler()
+{
+    report(StkTime::getMonoTimeUs(), /*force*/true);
+}   // ~TickScheduler
+
+// ----------------------------------------------------------------------------
+/** Starts counting the ticks from now again, dropping the ticks not run
+ *  yet. Used when the time passed must not be simulated (e.g. loading).
+ */
+void TickScheduler::resynchronise(uint64_t now)
+{
+    m_start_time = now;
+    m_ticks_scheduled = 0;
+    m_frame_start = now;
+    m_frame_ticks = 0;
+    m_sections.clear();
+}   // resynchronise
+
+// ----------------------------------------------------------------------------
+/** Drops the ticks the world time is behind real time beyond max_ticks.
+ *  Used when no world is running, where nothing has to stay in step with
+ *  the clients and a slow frame must not cause a burst of updates.
+ *  \param now Monotonic time in microseconds.
+ *  \param max_ticks Maximum number of ticks to catch up.
+ */
+void TickScheduler::limitLag(uint64_t now, uint64_t max_ticks)
+{
+    const uint64_t lag = getLag(now);
+    if (lag > max_ticks)
+        m_ticks_scheduled += lag - max_ticks;
+}   // limitLag
+
+// ----------------------------------------------------------------------------
+/** Limits the number of frames per second, the ticks due are then run
+ *  together in fewer frames. The limit is raised if needed so that the
+ *  maximum ticks per frame can still keep up with real time.
+ *  \param max_fps Maximum frames per second, 0 for no limit.
+ */
+void TickScheduler::setMaxFPS(int max_fps)
+{
+    if (max_fps <= 0)
+    {
+        m_min_frame_time = 0;
+        return;
+    }
+    m_min_frame_time = 1000000 / max_fps;
+    if (m_max_ticks_per_frame > 0)
+    {
+        m_min_frame_time = std::min(m_min_frame_time,
+            (uint64_t)m_max_ticks_per_frame * 1000000 / m_ticks_per_second);
+    }
+}   // setMaxFPS
+
+// ----------------------------------------------------------------------------
+/** Returns the number of ticks to run at the given time, limited by the
+ *  maximum ticks per frame, and counts them as scheduled.
+ *  \param now Monotonic time in microseconds.
+ */
+int TickScheduler::getTicksDue(uint64_t now)
+{
+    if (now <= m_start_time)
+        return 0;
+    const uint64_t due =
+        (now - m_start_time) * m_ticks_per_second / 1000000;
+    if (due <= m_ticks_scheduled)
+        return 0;
+    uint64_t ticks = due - m_ticks_scheduled;
+    if (m_max_ticks_per_frame > 0 && ticks > (uint64_t)m_max_ticks_per_frame)
+        ticks = m_max_ticks_per_frame;
+    m_ticks_scheduled += ticks;
+    return (int)ticks;
+}   // getTicksDue
+
+// ----------------------------------------------------------------------------
+/** Ends the current frame, sleeps until at least one tick is due and
+ *  starts a new frame.
+ *  \return Number of ticks to run in the new frame.
+ */
+int TickScheduler::waitForTicks()
+{
+    uint64_t now = StkTime::getMonoTimeUs();
+    const uint64_t earliest = m_frame_start + m_min_frame_time;
+    endFrame(now);
+    if (now < earliest)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(earliest - now));
+        now = StkTime::getMonoTimeUs();
+    }
+
+    int ticks = getTicksDue(now);
+    while (ticks == 0)
+    {
+        const uint64_t next = getTickTime(m_ticks_scheduled + 1);
+        if (next > now)
+            std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+        now = StkTime::getMonoTimeUs();
+        ticks = getTicksDue(now);
+    }
+
+    m_max_lag = std::max(m_max_lag, getLag(now) + ticks - 1);
+    if (ticks > 1)
+    {
+        m_catch_up_frames++;
+        m_max_frame_ticks = std::max(m_max_frame_ticks, ticks);
+    }
+    m_frame_start = now;
+    m_frame_ticks = ticks;
+    m_sections.clear();
+    report(now, /*force*/false);
+    return ticks;
+}   // waitForTicks
+
+// ----------------------------------------------------------------------------
+/** Checks if the frame took longer than the time its ticks are worth, which
+ *  makes the world time fall behind real time.
+ */
+void TickScheduler::endFrame(uint64_t now)
+{
+    if (m_frame_ticks == 0)
+        return;
+    const uint64_t used = now - m_frame_start;
+    const int ticks = m_frame_ticks;
+    const uint64_t budget = (uint64_t)ticks * 1000000 / m_ticks_per_second;
+    m_frame_ticks = 0;
+    if (used <= budget)
+        return;
+
+    m_overruns++;
+    if (!m_watchdog)
+        return;
+    // At most one message every 5 seconds
+    if (m_last_overrun_log != 0 && now - m_last_overrun_log < 5000000)
+    {
+        m_suppressed_overruns++;
+        return;
+    }
+    const char* longest = "unknown";
+    uint64_t longest_time = 0;
+    for (auto& s : m_sections)
+    {
+        if (s.second > longest_time)
+        {
+            longest = s.first;
+            longest_time = s.second;
+        }
+    }
+    Log::warn("TickScheduler", "%s: frame with %d ticks took %.2f ms "
+        "(budget %.2f ms), longest was %s with %.2f ms, %u overruns not "
+        "logged before.", m_name.c_str(), ticks, used / 1000.0f, budget / 1000.0f,
+        longest, longest_time / 1000.0f, m_suppressed_overruns);
+    m_suppressed_overruns = 0;
+    m_last_overrun_log = now;
+}   // endFrame
+
+// ----------------------------------------------------------------------------
+void TickScheduler::startTick()
+{
+    m_tick_start = StkTime::getMonoTimeUs();
+}   // startTick
+
+// ----------------------------------------------------------------------------
+void TickScheduler::endTick()
+{
+    const uint64_t duration = StkTime::getMonoTimeUs() - m_tick_start;
+    m_num_ticks++;
+    m_total_tick_time += duration;
+    m_max_tick_time = std::max(m_max_tick_time, duration);
+}   // endTick
+
+// ----------------------------------------------------------------------------
+/** Adds time spent in a section of the current frame.
+ *  \param name Name of the section, a string literal.
+ *  \param us Time in microseconds.
+ */
+void TickScheduler::addSectionTime(const char* name, uint64_t us)
+{
+    for (auto& s : m_sections)
+    {
+        if (strcmp(s.first, name) == 0)
+        {
+            s.second += us;
+            return;
+        }
+    }
+    m_sections.emplace_back(name, us);
+}   // addSectionTime
+
+// ----------------------------------------------------------------------------
+/** Logs the tick statistics once per minute.
+ *  \param force Log now (e.g. when the loop ends).
+ */
+void TickScheduler::report(uint64_t now, bool force)
+{
+    if (!force && now - m_last_report < 60000000)
+        return;
+    if (m_num_ticks > 0)
+    {
+        Log::info("TickScheduler", "%s: %llu ticks, %.0f us on average and "
+            "%llu us max, %u overruns, %u catch-up frames (up to %d ticks), "
+            "max lag %.1f ms.", m_name.c_str(),
+            (unsigned long long)m_num_ticks,
+            (double)m_total_tick_time / m_num_ticks,
+            (unsigned long long)m_max_tick_time, m_overruns,
+            m_catch_up_frames, m_max_frame_ticks,
+            m_max_lag * 1000.0 / m_ticks_per_second);
+    }
+    m_num_ticks = 0;
+    m_total_tick_time = 0;
+    m_max_tick_time = 0;
+    m_overruns = 0;
+    m_catch_up_frames = 0;
+    m_max_frame_ticks = 0;
+    m_max_lag = 0;
+    m_last_report = now;
+}   // report
+
+// ----------------------------------------------------------------------------
+void TickScheduler::unitTesting()
+{
+    // 120 ticks per second, a tick is due every 8333.3 us
+    TickScheduler s("UnitTest", 120, 3, false);
+    s.resynchronise(1000000);
+    assert(s.getTicksDue(1000000) == 0);
+    assert(s.getTicksDue(1008333) == 0);
+    assert(s.getTicksDue(1008334) == 1);
+    assert(s.getTicksDue(1008334) == 0);
+    assert(s.getTicksDue(1016667) == 1);
+
+    // After 100 ms 12 ticks are due, which are spread over several frames
+    assert(s.getTicksDue(1100000) == 3);
+    assert(s.getLag(1100000) == 7);
+    assert(s.getTicksDue(1100000) == 3);
+    assert(s.getTicksDue(1100000) == 3);
+    assert(s.getTicksDue(1100000) == 1);
+    assert(s.getTicksDue(1100000) == 0);
+    assert(s.getLag(1100000) == 0);
+
+    // Without limit all ticks are run at once, and no time is lost over
+    // a long time
+    TickScheduler all("UnitTest", 120, 0, false);
+    all.resynchronise(0);
+    assert(all.getTicksDue(1000000) == 120);
+    assert(all.getTicksDue(3600000000ull) == 120 * 3600 - 120);
+
+    // Resynchronising drops the ticks not run
+    all.resynchronise(3700000000ull);
+    assert(all.getTicksDue(3700000000ull) == 0);
+    assert(all.getLag(3700100000ull) == 12);
+
+    // Limiting the lag drops the ticks beyond the limit only
+    all.limitLag(3700100000ull, 6);
+    assert(all.getLag(3700100000ull) == 6);
+    all.limitLag(3700100000ull, 6);
+    assert(all.getTicksDue(3700100000ull) == 6);
+
+    // Waiting returns at least one tick, not earlier than it is due
+    TickScheduler wait("UnitTest", 120, 0, false);
+    const uint64_t start = StkTime::getMonoTimeUs();
+    wait.resynchronise(start);
+    assert(wait.waitForTicks() >= 1);
+    assert((StkTime::getMonoTimeUs() - start) * 120 >= 1000000);
+}   // unitTesting
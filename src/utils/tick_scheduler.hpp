@@ -0,0 +1,146 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2026 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_TICK_SCHEDULER_HPP
+#define HEADER_TICK_SCHEDULER_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/** \ingroup utils
+ *  Fixed time step scheduler for the server loops, with a microsecond
+ *  clock. It sleeps until the next physics tick is due and returns how many
+ *  ticks must be run to keep the world time in step with real time; while
+ *  a world runs ticks are never dropped or stretched, as the clients follow
+ *  the server time.
+ *  After a frame which took too long (a database write, loading a track)
+ *  the missing ticks are run at once, or with a maximum number of ticks per
+ *  frame spread over the next frames. Without a world the catch-up can be
+ *  limited, and the number of frames per second can be capped.
+ *  The duration of each tick and of the named sections of a frame are
+ *  measured: a watchdog logs frames which used more time than their ticks
+ *  are worth with the section which took longest, and a summary of the tick
+ *  durations, overruns and catch-ups is logged every minute.
+ */
+class TickScheduler : public NoCopy
+{
+public:
+    /** Measures the time spent in a part of a frame, e.g. the protocol
+     *  updates or the world update. */
+    class Section : public NoCopy
+    {
+    private:
+        TickScheduler* m_scheduler;
+        const char*    m_name;
+        uint64_t       m_start;
+    public:
+        Section(TickScheduler* scheduler, const char* name);
+        ~Section();
+    };   // Section
+
+private:
+    /** Name of the loop in the logs. */
+    std::string m_name;
+
+    int m_ticks_per_second;
+
+    /** Maximum number of ticks per frame, 0 for no limit. */
+    int m_max_ticks_per_frame;
+
+    /** Minimum time between the start of two frames, 0 for no limit. */
+    uint64_t m_min_frame_time;
+
+    bool m_watchdog;
+
+    /** Time ticks are counted from, and the ticks scheduled since. */
+    uint64_t m_start_time;
+    uint64_t m_ticks_scheduled;
+
+    /** Start of the current frame and of the current tick. */
+    uint64_t m_frame_start;
+    uint64_t m_tick_start;
+
+    /** Ticks returned for the current frame. */
+    int m_frame_ticks;
+
+    /** Time spent in each section of the current frame. */
+    std::vector<std::pair<const char*, uint64_t> > m_sections;
+
+    /** Statistics since the last report. */
+    uint64_t m_num_ticks;
+    uint64_t m_total_tick_time;
+    uint64_t m_max_tick_time;
+    unsigned m_overruns;
+    unsigned m_catch_up_frames;
+    int      m_max_frame_ticks;
+    uint64_t m_max_lag;
+    uint64_t m_last_report;
+
+    /** Overruns not logged because of the log rate limit. */
+    unsigned m_suppressed_overruns;
+    uint64_t m_last_overrun_log;
+
+    // ------------------------------------------------------------------------
+    uint64_t getTickTime(uint64_t tick) const
+    {
+        return m_start_time + tick * 1000000 / m_ticks_per_second;
+    }   // getTickTime
+    // ------------------------------------------------------------------------
+    void endFrame(uint64_t now);
+    // ------------------------------------------------------------------------
+    void report(uint64_t now, bool force);
+
+public:
+    TickScheduler(const std::string& name, int ticks_per_second,
+                  int max_ticks_per_frame, bool watchdog);
+    // ------------------------------------------------------------------------
+    ~TickScheduler();
+    // ------------------------------------------------------------------------
+    void resynchronise(uint64_t now);
+    // ------------------------------------------------------------------------
+    void limitLag(uint64_t now, uint64_t max_ticks);
+    // ------------------------------------------------------------------------
+    void setMaxFPS(int max_fps);
+    // ------------------------------------------------------------------------
+    int getTicksDue(uint64_t now);
+    // ------------------------------------------------------------------------
+    int waitForTicks();
+    // ------------------------------------------------------------------------
+    void startTick();
+    // ------------------------------------------------------------------------
+    void endTick();
+    // ------------------------------------------------------------------------
+    void addSectionTime(const char* name, uint64_t us);
+    // ------------------------------------------------------------------------
+    /** Returns the number of ticks the world time is behind real time. */
+    uint64_t getLag(uint64_t now) const
+    {
+        const uint64_t due = now <= m_start_time ? 0 :
+            (now - m_start_time) * m_ticks_per_second / 1000000;
+        return due > m_ticks_scheduled ? due - m_ticks_scheduled : 0;
+    }   // getLag
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // class TickScheduler
+
+#endif
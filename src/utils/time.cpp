@@ -27,6 +27,7 @@
 irr::ITimer *StkTime::m_timer = NULL;
 std::chrono::steady_clock::time_point
    StkTime::m_mono_start = std::chrono::steady_clock::now();
+std::atomic<int64_t> StkTime::m_virtual_mono_time(-1);
 
 /** Init function for the timer. It grabs a copy of the timer of the
  *  current irrlicht device (which is the NULL device). This way the
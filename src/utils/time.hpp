@@ -21,6 +21,7 @@
 
 #include "ITimer.h"
 
+#include <atomic>
 #include <chrono>
 #include <stdexcept>
 
@@ -49,6 +50,10 @@ private:
 
     /** Initalized when STK starts. */
     static std::chrono::steady_clock::time_point m_mono_start;
+
+    /** If not negative, returned by getMonoTimeMs instead of the real time,
+     *  so that a packet replay can run the server faster than real time. */
+    static std::atomic<int64_t> m_virtual_mono_time;
 public:
     typedef time_t TimeType;
 
@@ -105,12 +110,34 @@ public:
      */
     static uint64_t getMonoTimeMs()
     {
+        const int64_t virtual_time =
+            m_virtual_mono_time.load(std::memory_order_relaxed);
+        if (virtual_time >= 0)
+            return (uint64_t)virtual_time;
         auto duration = std::chrono::steady_clock::now() - m_mono_start;
         auto value =
             std::chrono::duration_cast<std::chrono::milliseconds>(duration);
         return value.count();
     }
     // ------------------------------------------------------------------------
+    /** Sets the time returned by getMonoTimeMs, or -1 to use the real time
+     *  again. The microsecond clock is not affected, so that the time taken
+     *  by the code can still be measured. */
+    static void setVirtualMonoTimeMs(int64_t ms)
+    {
+        m_virtual_mono_time.store(ms, std::memory_order_relaxed);
+    }
+    // ------------------------------------------------------------------------
+    /** Returns the monotonic time since the starting of stk in microseconds.
+     */
+    static uint64_t getMonoTimeUs()
+    {
+        auto duration = std::chrono::steady_clock::now() - m_mono_start;
+        auto value =
+            std::chrono::duration_cast<std::chrono::microseconds>(duration);
+        return value.count();
+    }
+    // ------------------------------------------------------------------------
     /**
      * \brief Compare two different times.
      * \return A signed integral indicating the relation between the time.